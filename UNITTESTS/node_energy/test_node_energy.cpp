@@ -0,0 +1,148 @@
+/**
+ * @file test_node_energy.cpp
+ *
+ * @brief Host test of the energy model against the LoRa airtime reference,
+ *        and of the accounting on the ticker fake, over gaps longer than the
+ *        32-bit microsecond ticker wraps
+ *
+ * @author AdvanWISE
+ */
+
+#include "gtest/gtest.h"
+#include "us_ticker_fake.h"
+#include "node_energy.h"
+
+#define MINUTE_US   60000000U
+
+class TestNodeEnergy : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        node_energy_init();
+    }
+
+    /** @brief Let time pass with the ticker interrupt running, as on the board */
+    static void advance_minutes(unsigned int minutes)
+    {
+        for (unsigned int i = 0; i < minutes; i++)
+            us_ticker_fake_advance(MINUTE_US);
+    }
+
+    static uint64_t bucket_us(int bucket)
+    {
+        struct node_energy_report report;
+
+        node_energy_get_report(&report);
+        return report.time_us[bucket];
+    }
+};
+
+TEST_F(TestNodeEnergy, airtime_matches_the_lora_reference)
+{
+    // 11 byte payload, 125 kHz, CR 4/5, explicit header, CRC on
+    EXPECT_EQ(61696u, node_energy_airtime_us(5, 11));
+    EXPECT_EQ(1482752u, node_energy_airtime_us(0, 11));
+    // Low data rate optimisation from SF11
+    EXPECT_EQ(823296u, node_energy_airtime_us(1, 11));
+    // Data rates past SF7 count as SF7
+    EXPECT_EQ(node_energy_airtime_us(5, 11), node_energy_airtime_us(6, 11));
+}
+
+TEST_F(TestNodeEnergy, report_adds_up)
+{
+    uint64_t time_us[NODE_ENERGY_BUCKETS] = {0};
+    struct node_energy_report report;
+
+    time_us[NODE_ENERGY_RUN] = 3600000000ULL;
+    time_us[NODE_ENERGY_RADIO_TX] = 1000000;
+    node_energy_fill(time_us, 10, &report);
+
+    // 3 mA for an hour and 44 mA for a second
+    EXPECT_NEAR(3000.0f, report.charge_uah[NODE_ENERGY_RUN], 0.1f);
+    EXPECT_NEAR(12.22f, report.charge_uah[NODE_ENERGY_RADIO_TX], 0.01f);
+    EXPECT_NEAR(3012.22f, report.total_uah, 0.1f);
+    EXPECT_NEAR(301.22f, report.uah_per_uplink, 0.01f);
+    EXPECT_NEAR(72.29f, report.mah_per_day, 0.01f);
+    EXPECT_NEAR(NODE_ENERGY_BATTERY_MAH / report.mah_per_day, report.battery_days, 0.01f);
+
+    memset(time_us, 0, sizeof(time_us));
+    node_energy_fill(time_us, 0, &report);
+    EXPECT_EQ(0, report.total_uah);
+    EXPECT_EQ(0, report.mah_per_day);
+    EXPECT_EQ(0, report.battery_days);
+}
+
+TEST_F(TestNodeEnergy, simulate_projects_a_day)
+{
+    struct node_energy_profile profile = { 600, 2, 11, 50000, { 20000, 0 }, 1 };
+    struct node_energy_report report;
+
+    node_energy_simulate(&profile, &report);
+
+    EXPECT_EQ(144u, report.uplinks);
+    EXPECT_EQ(144ULL * 50000, report.time_us[NODE_ENERGY_RUN]);
+    EXPECT_EQ(86400000000ULL - 144ULL * 50000, report.time_us[NODE_ENERGY_DEEP_SLEEP]);
+    EXPECT_EQ(144ULL * node_energy_airtime_us(2, 11), report.time_us[NODE_ENERGY_RADIO_TX]);
+    // Both windows at SF10
+    EXPECT_EQ(144ULL * 2 * NODE_ENERGY_RX_SYMBOLS * 8192, report.time_us[NODE_ENERGY_RADIO_RX]);
+    // Deep sleep 360 uAh, TX 652, RX 60, run 6
+    EXPECT_NEAR(1.079f, report.mah_per_day, 0.001f);
+
+    profile.deep_sleep = 0;
+    node_energy_simulate(&profile, &report);
+    EXPECT_EQ(0u, report.time_us[NODE_ENERGY_DEEP_SLEEP]);
+    EXPECT_GT(report.mah_per_day, 28.0f);
+}
+
+TEST_F(TestNodeEnergy, awake_time_counts_as_run)
+{
+    us_ticker_fake_advance(1000000);
+    EXPECT_EQ(1000000u, bucket_us(NODE_ENERGY_RUN));
+}
+
+TEST_F(TestNodeEnergy, gaps_longer_than_the_ticker_wrap_are_counted_in_full)
+{
+    // 2^32 us is about 71.6 minutes; nothing is accounted for two hours
+    advance_minutes(120);
+    EXPECT_EQ(120ULL * MINUTE_US, bucket_us(NODE_ENERGY_RUN));
+
+    node_energy_load(NODE_ENERGY_SENSOR1, 1);
+    advance_minutes(75);
+    node_energy_load(NODE_ENERGY_SENSOR1, 0);
+    EXPECT_EQ(75ULL * MINUTE_US, bucket_us(NODE_ENERGY_SENSOR1));
+    EXPECT_EQ(195ULL * MINUTE_US, bucket_us(NODE_ENERGY_RUN));
+}
+
+TEST_F(TestNodeEnergy, radio_time_is_capped_by_tx_done)
+{
+    node_energy_tx_start(5, 11);
+    us_ticker_fake_advance(50000);
+    node_energy_tx_done();
+    EXPECT_EQ(50000u, bucket_us(NODE_ENERGY_RADIO_TX));
+    EXPECT_EQ(0u, bucket_us(NODE_ENERGY_RADIO_RX));
+
+    node_energy_tx_start(5, 11);
+    us_ticker_fake_advance(2000000);
+    node_energy_tx_done();
+    EXPECT_EQ(50000u + 61696u, bucket_us(NODE_ENERGY_RADIO_TX));
+    EXPECT_EQ(2u * NODE_ENERGY_RX_SYMBOLS * 1024, bucket_us(NODE_ENERGY_RADIO_RX));
+
+    // A done without a start is ignored
+    node_energy_tx_done();
+    struct node_energy_report report;
+    node_energy_get_report(&report);
+    EXPECT_EQ(2u, report.uplinks);
+    EXPECT_EQ(50000u + 61696u, report.time_us[NODE_ENERGY_RADIO_TX]);
+}
+
+TEST_F(TestNodeEnergy, declared_deep_sleep_is_added)
+{
+    node_energy_deep_sleep(3600);
+    EXPECT_EQ(3600000000ULL, bucket_us(NODE_ENERGY_DEEP_SLEEP));
+
+    node_energy_set_current(NODE_ENERGY_DEEP_SLEEP, 30);
+    struct node_energy_report report;
+    node_energy_get_report(&report);
+    EXPECT_NEAR(30.0f, report.charge_uah[NODE_ENERGY_DEEP_SLEEP], 0.01f);
+    node_energy_set_current(NODE_ENERGY_DEEP_SLEEP, 15);
+}
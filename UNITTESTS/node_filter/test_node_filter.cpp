@@ -0,0 +1,240 @@
+/**
+ * @file test_node_filter.cpp
+ *
+ * @brief Host test of the streaming filter: the precomputed low-pass
+ *        coefficients against their formula and by their measured response,
+ *        and each stage on the signals the SEN0159 path feeds it
+ *
+ * @author AdvanWISE
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include "gtest/gtest.h"
+#include "node_filter.h"
+
+#define PI          3.14159265358979323846
+
+static const float lowpass_0_05[5] = NODE_FILTER_LOWPASS_0_05;
+static const float lowpass_0_1[5] = NODE_FILTER_LOWPASS_0_1;
+static const float lowpass_0_2[5] = NODE_FILTER_LOWPASS_0_2;
+
+static const struct
+{
+    double fc;
+    const float *biquad;
+} lowpasses[] = {
+    { 0.05, lowpass_0_05 },
+    { 0.1, lowpass_0_1 },
+    { 0.2, lowpass_0_2 },
+};
+
+#define LOWPASS_COUNT   (sizeof(lowpasses) / sizeof(lowpasses[0]))
+
+class TestNodeFilter : public testing::Test {
+protected:
+    struct node_filter filter;
+
+    void init(unsigned char median_len, const float *biquad, float alpha)
+    {
+        struct node_filter_config config = { median_len, { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f }, alpha };
+
+        if (biquad)
+            memcpy(config.biquad, biquad, sizeof(config.biquad));
+        ASSERT_EQ(NODE_FILTER_OK, node_filter_init(&filter, &config));
+    }
+
+    /** @brief Gain of the filter for a sine at f of the sample rate, once settled */
+    double gain(double f)
+    {
+        const int settle = 1000;
+        const int len = 2000;   // Whole periods of every f tested
+        double re = 0.0;
+        double im = 0.0;
+
+        for (int n = 0; n < settle + len; n++)
+        {
+            float y = node_filter_update(&filter, (float)sin(2 * PI * f * n));
+
+            if (n >= settle)
+            {
+                re += y * sin(2 * PI * f * n);
+                im += y * cos(2 * PI * f * n);
+            }
+        }
+        return 2.0 * sqrt(re * re + im * im) / len;
+    }
+
+    /** @brief Uniform noise in [-1, 1), the same sequence on every run */
+    static float noise(uint32_t *seed)
+    {
+        *seed = *seed * 1664525U + 1013904223U;
+        return (float)(*seed >> 8) / (1 << 23) - 1.0f;
+    }
+};
+
+TEST_F(TestNodeFilter, lowpass_coefficients_match_the_formula)
+{
+    for (unsigned int i = 0; i < LOWPASS_COUNT; i++)
+    {
+        double w0 = 2 * PI * lowpasses[i].fc;
+        double c = cos(w0);
+        double a = sin(w0) / sqrt(2.0);
+        double b0 = (1 - c) / 2 / (1 + a);
+        double expected[5] = { b0, 2 * b0, b0, 2 * c / (1 + a), -(1 - a) / (1 + a) };
+
+        for (int k = 0; k < 5; k++)
+            EXPECT_NEAR(expected[k], lowpasses[i].biquad[k], 1e-7) << lowpasses[i].fc << " " << k;
+    }
+}
+
+TEST_F(TestNodeFilter, lowpass_unity_dc_gain_and_zero_at_nyquist)
+{
+    for (unsigned int i = 0; i < LOWPASS_COUNT; i++)
+    {
+        const float *c = lowpasses[i].biquad;
+
+        EXPECT_NEAR(1.0, (c[0] + c[1] + c[2]) / (1.0 - c[3] - c[4]), 1e-6) << lowpasses[i].fc;
+        EXPECT_NEAR(0.0, c[0] - c[1] + c[2], 1e-7) << lowpasses[i].fc;
+    }
+}
+
+TEST_F(TestNodeFilter, lowpass_response)
+{
+    for (unsigned int i = 0; i < LOWPASS_COUNT; i++)
+    {
+        double fc = lowpasses[i].fc;
+
+        init(0, lowpasses[i].biquad, 1.0f);
+        EXPECT_NEAR(1.0, gain(fc / 10), 1e-3) << fc;
+        init(0, lowpasses[i].biquad, 1.0f);
+        // -3 dB at the cutoff
+        EXPECT_NEAR(sqrt(0.5), gain(fc), 1e-3) << fc;
+        init(0, lowpasses[i].biquad, 1.0f);
+        // Second order: -12 dB per octave above it
+        EXPECT_LT(gain(fc * 2), 0.25) << fc;
+    }
+
+    init(0, lowpass_0_1, 1.0f);
+    EXPECT_LT(gain(0.45), 0.01);
+}
+
+TEST_F(TestNodeFilter, lowpass_step_response)
+{
+    init(0, lowpass_0_1, 1.0f);
+    float peak = 0.0f;
+
+    // Primed on the first sample: no transient at all from a constant input
+    for (int n = 0; n < 10; n++)
+        EXPECT_FLOAT_EQ(100.0f, node_filter_update(&filter, 100.0f));
+
+    for (int n = 0; n < 100; n++)
+    {
+        float y = node_filter_update(&filter, 200.0f);
+
+        if (y > peak)
+            peak = y;
+    }
+    // Near the 4.3% overshoot of the analog Butterworth, which the
+    // discrete design raises a little this close to Nyquist
+    EXPECT_GT(peak, 204.0f);
+    EXPECT_LT(peak, 206.0f);
+    EXPECT_NEAR(200.0f, node_filter_value(&filter), 1e-3f);
+}
+
+TEST_F(TestNodeFilter, median_drops_spikes)
+{
+    init(5, NULL, 1.0f);
+
+    EXPECT_FLOAT_EQ(10.0f, node_filter_update(&filter, 10.0f));
+    // Half of an even window averages its middle pair
+    EXPECT_FLOAT_EQ(15.0f, node_filter_update(&filter, 20.0f));
+    EXPECT_FLOAT_EQ(10.0f, node_filter_update(&filter, 10.0f));
+    EXPECT_FLOAT_EQ(10.0f, node_filter_update(&filter, 10.0f));
+    EXPECT_FLOAT_EQ(10.0f, node_filter_update(&filter, 1000.0f));
+    EXPECT_FLOAT_EQ(10.0f, node_filter_update(&filter, 10.0f));
+    EXPECT_FLOAT_EQ(10.0f, node_filter_update(&filter, -1000.0f));
+    EXPECT_FLOAT_EQ(10.0f, node_filter_update(&filter, 10.0f));
+    // A step gets through once it fills half the window
+    EXPECT_FLOAT_EQ(10.0f, node_filter_update(&filter, 50.0f));
+    EXPECT_FLOAT_EQ(10.0f, node_filter_update(&filter, 50.0f));
+    EXPECT_FLOAT_EQ(50.0f, node_filter_update(&filter, 50.0f));
+}
+
+TEST_F(TestNodeFilter, smoothing)
+{
+    init(0, NULL, 0.25f);
+
+    EXPECT_FLOAT_EQ(0.0f, node_filter_update(&filter, 0.0f));
+    EXPECT_FLOAT_EQ(25.0f, node_filter_update(&filter, 100.0f));
+    EXPECT_FLOAT_EQ(43.75f, node_filter_update(&filter, 100.0f));
+}
+
+TEST_F(TestNodeFilter, sensor_path_rejects_noise_and_spikes)
+{
+    // The main.cpp configuration, on a step with uniform noise and 5% spikes
+    init(5, lowpass_0_1, 1.0f);
+    uint32_t seed = 1;
+    double raw_err = 0.0;
+    double filtered_err = 0.0;
+    int samples = 0;
+
+    for (int n = 0; n < 2000; n++)
+    {
+        float truth = (n < 1000) ? 20000.0f : 30000.0f;
+        float sample = truth + 500.0f * noise(&seed);
+
+        if (noise(&seed) > 0.9f)
+            sample = (noise(&seed) > 0.0f) ? 65535.0f : 0.0f;
+
+        float y = node_filter_update(&filter, sample);
+
+        // Away from the step, where any low-pass lags
+        if (n % 1000 >= 50)
+        {
+            raw_err += (sample - truth) * (sample - truth);
+            filtered_err += (y - truth) * (y - truth);
+            samples++;
+        }
+    }
+    raw_err = sqrt(raw_err / samples);
+    filtered_err = sqrt(filtered_err / samples);
+    EXPECT_GT(raw_err, 2000.0);
+    EXPECT_LT(filtered_err, 200.0);
+}
+
+TEST_F(TestNodeFilter, change_since_mark)
+{
+    init(0, NULL, 1.0f);
+
+    EXPECT_FLOAT_EQ(0.0f, node_filter_value(&filter));
+    node_filter_update(&filter, 50.0f);
+    EXPECT_FLOAT_EQ(0.0f, node_filter_change(&filter));
+    node_filter_update(&filter, 30.0f);
+    EXPECT_FLOAT_EQ(20.0f, node_filter_change(&filter));
+    node_filter_mark(&filter);
+    EXPECT_FLOAT_EQ(0.0f, node_filter_change(&filter));
+    node_filter_update(&filter, 35.0f);
+    EXPECT_FLOAT_EQ(5.0f, node_filter_change(&filter));
+
+    node_filter_reset(&filter);
+    EXPECT_FLOAT_EQ(0.0f, node_filter_value(&filter));
+    EXPECT_FLOAT_EQ(80.0f, node_filter_update(&filter, 80.0f));
+    EXPECT_FLOAT_EQ(0.0f, node_filter_change(&filter));
+}
+
+TEST_F(TestNodeFilter, init_checks_the_config)
+{
+    struct node_filter_config config = { NODE_FILTER_MEDIAN_MAX, NODE_FILTER_LOWPASS_0_1, 1.0f };
+
+    EXPECT_EQ(NODE_FILTER_OK, node_filter_init(&filter, &config));
+    config.median_len = NODE_FILTER_MEDIAN_MAX + 1;
+    EXPECT_EQ(NODE_FILTER_ERR_PARAM, node_filter_init(&filter, &config));
+    config.median_len = 0;
+    config.alpha = 0.0f;
+    EXPECT_EQ(NODE_FILTER_ERR_PARAM, node_filter_init(&filter, &config));
+    config.alpha = 1.5f;
+    EXPECT_EQ(NODE_FILTER_ERR_PARAM, node_filter_init(&filter, &config));
+    config.alpha = NAN;
+    EXPECT_EQ(NODE_FILTER_ERR_PARAM, node_filter_init(&filter, &config));
+}
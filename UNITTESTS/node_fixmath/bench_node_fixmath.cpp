@@ -0,0 +1,62 @@
+/**
+ * @file bench_node_fixmath.cpp
+ *
+ * @brief Time per conversion of the fixed-point sensor conversions and of the
+ *        float code they replaced, over every raw reading. The host runs the
+ *        double arithmetic of the float code in hardware, where the target's
+ *        single-precision FPU calls soft-float routines; expect a larger gain
+ *        there
+ *
+ *   bench_node_fixmath [passes]
+ *
+ * @author AdvanWISE
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "fixmath_float.h"
+
+#define BENCH_PASSES    100
+
+static volatile int bench_sink;
+
+static int bench_float_temp(uint16_t raw)   { return float_hdc1010_temp(raw); }
+static int bench_fixed_temp(uint16_t raw)   { return node_fixmath_hdc1010_temp(raw); }
+static int bench_float_hum(uint16_t raw)    { return float_hdc1010_hum(raw); }
+static int bench_fixed_hum(uint16_t raw)    { return node_fixmath_hdc1010_hum(raw); }
+static int bench_float_co2(uint16_t raw)    { return float_mg_percentage(float_mg_volts(raw), CO2Curve_float); }
+static int bench_fixed_co2(uint16_t raw)    { return fixed_mg_percentage(raw); }
+
+static double bench_run(int (*convert)(uint16_t), unsigned int passes)
+{
+    struct timespec start, end;
+    int sum = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int pass = 0; pass < passes; pass++)
+        for (uint32_t raw = 0; raw <= 0xFFFF; raw++)
+            sum += convert(raw);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    bench_sink = sum;
+
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / (passes * 65536.0);
+}
+
+static void bench_pair(const char *name, int (*fixed)(uint16_t), int (*fp)(uint16_t), unsigned int passes)
+{
+    double ns_float = bench_run(fp, passes);
+    double ns_fixed = bench_run(fixed, passes);
+
+    printf("%-12s float %6.2f ns, fixed %6.2f ns, %5.2fx\n", name, ns_float, ns_fixed, ns_float / ns_fixed);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int passes = argc > 1 ? atoi(argv[1]) : BENCH_PASSES;
+
+    bench_pair("temperature", bench_fixed_temp, bench_float_temp, passes);
+    bench_pair("humidity", bench_fixed_hum, bench_float_hum, passes);
+    bench_pair("co2", bench_fixed_co2, bench_float_co2, passes);
+    return 0;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file fixmath_float.h
+ *
+ * @brief The float conversions of main.cpp that node_fixmath replaced, as
+ *        they were, for the host tests to compare against
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _FIXMATH_FLOAT_H_
+#define _FIXMATH_FLOAT_H_
+
+#include <math.h>
+#include <stdint.h>
+#include "node_fixmath.h"
+
+#define DC_GAIN                     (8.5)
+#define ZERO_POINT_VOLTAGE          (0.305)
+#define REACTION_VOLTGAE            (0.030)
+#define MG_MV_FULL_SCALE            (3420)
+#define MG_VOLTS_PER_LSB            NODE_FIXMATH_SCALE(MG_MV_FULL_SCALE/1000.0/DC_GAIN/65535)
+
+static float CO2Curve_float[3] = {2.602,ZERO_POINT_VOLTAGE,(REACTION_VOLTGAE/(2.602-3))};
+static const struct node_fixmath_curve CO2Curve = NODE_FIXMATH_CURVE(2.602,ZERO_POINT_VOLTAGE,(REACTION_VOLTGAE/(2.602-3)));
+
+static inline int float_hdc1010_temp(uint16_t raw)
+{
+    float tempval = (float)(raw * 165.0 / 65536.0 - 40.0);
+    int ss = tempval*100;
+    return ss;
+}
+
+static inline unsigned int float_hdc1010_hum(uint16_t raw)
+{
+    float hempval = (float)(raw * 100.0 / 65536.0);
+    unsigned int yy = hempval*100;
+    return yy;
+}
+
+/** @brief MGRead() scaled read_average() by 3.42 to volts */
+static inline float float_mg_volts(uint16_t raw)
+{
+    return (raw / 65535.0f) * 3.42;
+}
+
+static inline int float_mg_percentage(float volts, float *pcurve)
+{
+   if ((volts/DC_GAIN )>=ZERO_POINT_VOLTAGE) {
+      return -1;
+   } else {
+      return pow(10, ((volts/DC_GAIN)-pcurve[1])/pcurve[2]+pcurve[0]);
+   }
+}
+
+/** @brief The fixed-point path of main.cpp */
+static inline int fixed_mg_percentage(uint16_t raw)
+{
+   return node_fixmath_curve_ppm(&CO2Curve, node_fixmath_scale(raw, MG_VOLTS_PER_LSB));
+}
+
+#endif
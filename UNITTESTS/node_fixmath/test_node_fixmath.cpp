@@ -0,0 +1,78 @@
+/**
+ * @file test_node_fixmath.cpp
+ *
+ * @brief Host test of the fixed-point sensor conversions against the float
+ *        code they replaced, over every raw reading
+ *
+ * @author AdvanWISE
+ */
+
+#include <stdlib.h>
+#include "gtest/gtest.h"
+#include "fixmath_float.h"
+
+TEST(TestNodeFixmath, hdc1010_temperature_within_one_lsb)
+{
+    for (uint32_t raw = 0; raw <= 0xFFFF; raw++)
+        ASSERT_LE(abs(float_hdc1010_temp(raw) - node_fixmath_hdc1010_temp(raw)), 1) << raw;
+
+    EXPECT_EQ(-4000, node_fixmath_hdc1010_temp(0));
+    EXPECT_EQ(4250, node_fixmath_hdc1010_temp(0x8000));
+    EXPECT_EQ(12499, node_fixmath_hdc1010_temp(0xFFFF));
+}
+
+TEST(TestNodeFixmath, hdc1010_humidity_within_one_lsb)
+{
+    for (uint32_t raw = 0; raw <= 0xFFFF; raw++)
+        ASSERT_LE(abs((int)float_hdc1010_hum(raw) - (int)node_fixmath_hdc1010_hum(raw)), 1) << raw;
+
+    EXPECT_EQ(0u, node_fixmath_hdc1010_hum(0));
+    EXPECT_EQ(5000u, node_fixmath_hdc1010_hum(0x8000));
+    EXPECT_EQ(9999u, node_fixmath_hdc1010_hum(0xFFFF));
+}
+
+TEST(TestNodeFixmath, co2_curve_matches_the_float_code)
+{
+    unsigned int below = 0;
+
+    for (uint32_t raw = 0; raw <= 0xFFFF; raw++)
+    {
+        int expected = float_mg_percentage(float_mg_volts(raw), CO2Curve_float);
+        int ppm = fixed_mg_percentage(raw);
+
+        if (expected == -1)
+        {
+            // Same readings below the 400 ppm point
+            ASSERT_EQ(-1, ppm) << raw;
+            below++;
+        }
+        else
+        {
+            // Within the bound node_fixmath.h gives, or the truncation of either result
+            double bound = expected * 2e-5;
+            ASSERT_LE(fabs((double)expected - ppm), bound > 1 ? bound : 1) << raw;
+        }
+    }
+    EXPECT_GT(below, 0u);
+}
+
+TEST(TestNodeFixmath, curve_range)
+{
+    struct node_fixmath_curve curve = NODE_FIXMATH_CURVE(2.602, 0.305, -0.0754);
+
+    // At and below the point of the curve
+    EXPECT_EQ(NODE_FIXMATH_ERR_RANGE, node_fixmath_curve_ppm(&curve, NODE_FIXMATH_Q24(0.305)));
+    EXPECT_EQ(NODE_FIXMATH_ERR_RANGE, node_fixmath_curve_ppm(&curve, NODE_FIXMATH_Q24(0.4)));
+    // 10^3 ppm one slope step past it
+    EXPECT_NEAR(10000, node_fixmath_curve_ppm(&curve, NODE_FIXMATH_Q24(0.305 - 0.0754 * 1.398)), 1);
+    // Past 10^9 the result does not fit
+    EXPECT_EQ(0x7FFFFFFF, node_fixmath_curve_ppm(&curve, NODE_FIXMATH_Q24(0.305 - 0.0754 * 7.5)));
+}
+
+TEST(TestNodeFixmath, scale)
+{
+    EXPECT_EQ(NODE_FIXMATH_Q24(1.0), node_fixmath_scale(1000, NODE_FIXMATH_SCALE(0.001)));
+    EXPECT_EQ(0, node_fixmath_scale(0, MG_VOLTS_PER_LSB));
+    // Full scale of the ADC, before the amplifier
+    EXPECT_NEAR(3.42 / 8.5, node_fixmath_scale(65535, MG_VOLTS_PER_LSB) / 16777216.0, 1e-6);
+}
@@ -0,0 +1,204 @@
+/**
+ * @file test_node_kvstore.cpp
+ *
+ * @brief Host test of node_kvstore on the flash fake of mbed-os/UNITTESTS
+ *
+ * @author AdvanWISE
+ */
+
+#include "gtest/gtest.h"
+#include "flash_api_fake.h"
+#include "node_kvstore.h"
+
+#define KV_SECTOR0  (FLASH_FAKE_START + FLASH_FAKE_SIZE - 2 * FLASH_FAKE_SECTOR_SIZE)
+#define KV_SECTOR1  (FLASH_FAKE_START + FLASH_FAKE_SIZE - FLASH_FAKE_SECTOR_SIZE)
+
+class TestNodeKvstore : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        flash_fake_reset();
+        ASSERT_EQ(NODE_KV_OK, node_kv_init());
+    }
+
+    static unsigned int get_uint(const char *key)
+    {
+        unsigned int value = 0;
+        EXPECT_EQ((int)sizeof(value), node_kv_get(key, &value, sizeof(value))) << key;
+        return value;
+    }
+
+    static int set_uint(const char *key, unsigned int value)
+    {
+        return node_kv_set(key, &value, sizeof(value));
+    }
+};
+
+TEST_F(TestNodeKvstore, formats_the_last_two_sectors)
+{
+    EXPECT_EQ(1u, flash_fake_erase_count(KV_SECTOR0));
+    EXPECT_EQ(0u, flash_fake_erase_count(KV_SECTOR0 - 1));
+    EXPECT_NE(0xFF, *flash_fake_memory(KV_SECTOR0));
+    EXPECT_EQ(0xFF, *flash_fake_memory(KV_SECTOR1));
+    EXPECT_EQ(0u, node_kv_image_end());
+}
+
+TEST_F(TestNodeKvstore, set_and_get)
+{
+    char value[8];
+
+    ASSERT_EQ(NODE_KV_OK, set_uint("rpt_intvl", 60));
+    EXPECT_EQ(60u, get_uint("rpt_intvl"));
+    EXPECT_EQ(NODE_KV_ERR_NOT_FOUND, node_kv_get("other", value, sizeof(value)));
+
+    // Values longer than the buffer are truncated; the stored length is returned
+    ASSERT_EQ(NODE_KV_OK, node_kv_set("name", "WISE-1510", 9));
+    memset(value, 0, sizeof(value));
+    EXPECT_EQ(9, node_kv_get("name", value, 4));
+    EXPECT_EQ(0, memcmp(value, "WISE\0", 5));
+}
+
+TEST_F(TestNodeKvstore, values_survive_a_remount)
+{
+    ASSERT_EQ(NODE_KV_OK, set_uint("a", 1));
+    ASSERT_EQ(NODE_KV_OK, set_uint("b", 2));
+    ASSERT_EQ(NODE_KV_OK, set_uint("a", 3));
+    ASSERT_EQ(NODE_KV_OK, node_kv_remove("b"));
+
+    ASSERT_EQ(NODE_KV_OK, node_kv_init());
+    EXPECT_EQ(3u, get_uint("a"));
+    unsigned int value;
+    EXPECT_EQ(NODE_KV_ERR_NOT_FOUND, node_kv_get("b", &value, sizeof(value)));
+}
+
+TEST_F(TestNodeKvstore, unchanged_values_write_nothing)
+{
+    ASSERT_EQ(NODE_KV_OK, set_uint("a", 1));
+    uint32_t programmed = flash_fake_program_bytes();
+
+    ASSERT_EQ(NODE_KV_OK, set_uint("a", 1));
+    ASSERT_EQ(NODE_KV_OK, node_kv_remove("missing"));
+    EXPECT_EQ(programmed, flash_fake_program_bytes());
+
+    // A changed value costs one record, rounded to the double word
+    ASSERT_EQ(NODE_KV_OK, set_uint("a", 2));
+    EXPECT_EQ(programmed + 24, flash_fake_program_bytes());
+}
+
+TEST_F(TestNodeKvstore, invalid_arguments)
+{
+    char key[NODE_KV_KEY_MAX + 2];
+    char value[NODE_KV_VALUE_MAX + 1] = {};
+
+    memset(key, 'k', sizeof(key) - 1);
+    key[sizeof(key) - 1] = '\0';
+    EXPECT_EQ(NODE_KV_ERR_INVALID_ARG, node_kv_set("", value, 1));
+    EXPECT_EQ(NODE_KV_ERR_INVALID_ARG, node_kv_set(NULL, value, 1));
+    EXPECT_EQ(NODE_KV_ERR_INVALID_ARG, node_kv_set(key, value, 1));
+    EXPECT_EQ(NODE_KV_ERR_INVALID_ARG, node_kv_set("a", value, sizeof(value)));
+    EXPECT_EQ(NODE_KV_ERR_INVALID_ARG, node_kv_set("a", NULL, 1));
+    EXPECT_EQ(NODE_KV_ERR_INVALID_ARG, node_kv_get("a", NULL, 1));
+
+    key[NODE_KV_KEY_MAX] = '\0';
+    EXPECT_EQ(NODE_KV_OK, node_kv_set(key, value, NODE_KV_VALUE_MAX));
+    EXPECT_EQ(NODE_KV_VALUE_MAX, node_kv_get(key, value, sizeof(value)));
+}
+
+TEST_F(TestNodeKvstore, compaction_keeps_live_values)
+{
+    ASSERT_EQ(NODE_KV_OK, set_uint("fixed", 0xABCD));
+    ASSERT_EQ(NODE_KV_OK, set_uint("gone", 1));
+    ASSERT_EQ(NODE_KV_OK, node_kv_remove("gone"));
+
+    // Enough updates to fill each sector a few times
+    for (unsigned int i = 0; i < 500; i++) {
+        ASSERT_EQ(NODE_KV_OK, set_uint("counter", i)) << i;
+    }
+    EXPECT_EQ(499u, get_uint("counter"));
+    EXPECT_EQ(0xABCDu, get_uint("fixed"));
+
+    // Both sectors took turns, and wore evenly
+    uint32_t erases0 = flash_fake_erase_count(KV_SECTOR0);
+    uint32_t erases1 = flash_fake_erase_count(KV_SECTOR1);
+    EXPECT_GE(erases0, 3u);
+    EXPECT_LE(erases0 > erases1 ? erases0 - erases1 : erases1 - erases0, 1u);
+
+    ASSERT_EQ(NODE_KV_OK, node_kv_init());
+    EXPECT_EQ(499u, get_uint("counter"));
+    EXPECT_EQ(0xABCDu, get_uint("fixed"));
+    unsigned int value;
+    EXPECT_EQ(NODE_KV_ERR_NOT_FOUND, node_kv_get("gone", &value, sizeof(value)));
+}
+
+TEST_F(TestNodeKvstore, interrupted_write_keeps_the_old_value)
+{
+    ASSERT_EQ(NODE_KV_OK, set_uint("a", 1));
+
+    // Power loss in the middle of the record
+    flash_fake_fail_after(10);
+    EXPECT_EQ(NODE_KV_ERR_FLASH, set_uint("a", 2));
+    EXPECT_EQ(1u, get_uint("a"));
+
+    ASSERT_EQ(NODE_KV_OK, node_kv_init());
+    EXPECT_EQ(1u, get_uint("a"));
+
+    // The partial record is compacted away before the next write
+    uint32_t erases = flash_fake_erase_count(KV_SECTOR1);
+    ASSERT_EQ(NODE_KV_OK, set_uint("a", 3));
+    EXPECT_EQ(erases + 1, flash_fake_erase_count(KV_SECTOR1));
+    ASSERT_EQ(NODE_KV_OK, node_kv_init());
+    EXPECT_EQ(3u, get_uint("a"));
+}
+
+TEST_F(TestNodeKvstore, interrupted_compaction_keeps_the_old_sector)
+{
+    ASSERT_EQ(NODE_KV_OK, set_uint("fixed", 7));
+    uint32_t erases = flash_fake_erase_count(KV_SECTOR1);
+    unsigned int i = 0;
+    int ret;
+
+    // A plain update programs 24 bytes; the one that compacts fails copying the second record
+    do {
+        flash_fake_fail_after(30);
+        ret = set_uint("counter", ++i);
+        flash_fake_fail_after(-1);
+    } while (ret == NODE_KV_OK && i < 1000);
+    ASSERT_EQ(NODE_KV_ERR_FLASH, ret);
+    ASSERT_EQ(erases + 1, flash_fake_erase_count(KV_SECTOR1));
+    EXPECT_EQ(i - 1, get_uint("counter"));
+
+    ASSERT_EQ(NODE_KV_OK, node_kv_init());
+    EXPECT_EQ(i - 1, get_uint("counter"));
+    EXPECT_EQ(7u, get_uint("fixed"));
+    ASSERT_EQ(NODE_KV_OK, set_uint("counter", 0));
+    EXPECT_EQ(0u, get_uint("counter"));
+    EXPECT_EQ(7u, get_uint("fixed"));
+}
+
+TEST_F(TestNodeKvstore, damaged_record_ends_the_log)
+{
+    ASSERT_EQ(NODE_KV_OK, set_uint("a", 1));
+    ASSERT_EQ(NODE_KV_OK, set_uint("a", 2));
+
+    // Clear bits of the value in the second record, after the sector header and the first one
+    *flash_fake_memory(KV_SECTOR0 + 8 + 24 + 8 + 1) &= 0xF0;
+
+    ASSERT_EQ(NODE_KV_OK, node_kv_init());
+    EXPECT_EQ(1u, get_uint("a"));
+}
+
+TEST_F(TestNodeKvstore, index_holds_max_keys)
+{
+    char key[8];
+
+    for (int i = 0; i < NODE_KV_MAX_KEYS; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        ASSERT_EQ(NODE_KV_OK, set_uint(key, i)) << key;
+    }
+    EXPECT_EQ(NODE_KV_ERR_FULL, set_uint("one_more", 0));
+
+    // Removed keys are dropped by compaction, which makes room
+    ASSERT_EQ(NODE_KV_OK, node_kv_remove("k0"));
+    EXPECT_EQ(NODE_KV_OK, set_uint("one_more", 0));
+    EXPECT_EQ((unsigned int)NODE_KV_MAX_KEYS - 1, get_uint("k31"));
+}
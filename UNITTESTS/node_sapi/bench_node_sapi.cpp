@@ -0,0 +1,106 @@
+/**
+ * @file bench_node_sapi.cpp
+ *
+ * @brief A provisioning pass over the SAPI loopback: every writable key set,
+ *        applied, saved and all keys read back, batched in one round trip and
+ *        as one request per key, with the bytes each moves and their line
+ *        time at 115200 baud
+ *
+ *   bench_node_sapi [passes]
+ *
+ * @author AdvanWISE
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "node_sapi.h"
+#include "node_api_fake.h"
+#include "sapi_loopback.h"
+
+#define BENCH_PASSES    10000
+#define BENCH_BAUD      115200
+#define BENCH_BITS      10      ///< Per byte, with start and stop bits
+
+static bool bench_writable(int key)
+{
+    return key < NODE_SAPI_KEY_RPT_INTVL;
+}
+
+static std::string bench_key_value(int key)
+{
+    const std::string &value = node_api_fake_value(key);
+    return std::string(1, (char)key) + (char)value.size() + value;
+}
+
+/** @brief The requests of a pass, one string per round trip */
+static std::vector<std::string> bench_pass(bool batched)
+{
+    std::vector<std::string> trips;
+    std::string set;
+    std::string get;
+    uint8_t tag = 0;
+
+    for (int key = 1; key < NODE_SAPI_KEY_LAST; key++)
+    {
+        if (bench_writable(key))
+            set += bench_key_value(key);
+        get += (char)key;
+    }
+    if (batched)
+    {
+        trips.push_back(sapi_frame(tag, NODE_SAPI_CMD_SET, set) + sapi_frame(tag + 1, NODE_SAPI_CMD_APPLY, "") +
+                        sapi_frame(tag + 2, NODE_SAPI_CMD_SAVE, "") + sapi_frame(tag + 3, NODE_SAPI_CMD_GET, get));
+        return trips;
+    }
+    for (int key = 1; key < NODE_SAPI_KEY_LAST; key++)
+        if (bench_writable(key))
+            trips.push_back(sapi_frame(tag++, NODE_SAPI_CMD_SET, bench_key_value(key)));
+    trips.push_back(sapi_frame(tag++, NODE_SAPI_CMD_APPLY, ""));
+    trips.push_back(sapi_frame(tag++, NODE_SAPI_CMD_SAVE, ""));
+    for (int key = 1; key < NODE_SAPI_KEY_LAST; key++)
+        trips.push_back(sapi_frame(tag++, NODE_SAPI_CMD_GET, std::string(1, (char)key)));
+    return trips;
+}
+
+static void bench_run(const char *name, bool batched, unsigned int passes)
+{
+    std::vector<std::string> trips = bench_pass(batched);
+    LoopbackFile link;
+    size_t in = 0;
+    size_t out = 0;
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int pass = 0; pass < passes; pass++)
+    {
+        for (size_t trip = 0; trip < trips.size(); trip++)
+        {
+            link.send(trips[trip]);
+            node_sapi_serve(&link);
+            size_t replied = link.receive().size();
+            if (pass == 0)
+            {
+                in += trips[trip].size();
+                out += replied;
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / passes;
+    printf("%-10s %2u round trips, %4u bytes in, %4u bytes out, %5.1f ms of line time, %6.0f ns to serve\n",
+           name, (unsigned int)trips.size(), (unsigned int)in, (unsigned int)out,
+           (in + out) * BENCH_BITS * 1000.0 / BENCH_BAUD, ns);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int passes = argc > 1 ? atoi(argv[1]) : BENCH_PASSES;
+
+    node_api_fake_reset();
+    bench_run("batched", true, passes);
+    bench_run("per key", false, passes);
+    printf("%u frames dropped\n", node_sapi_dropped());
+    return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file node_api_fake.cpp
+ *
+ * @brief Host fake of the config calls of node_api.h
+ *
+ * @author AdvanWISE
+ */
+
+#include <string.h>
+#include "mbed.h"
+#include "node_api.h"
+#include "node_sapi.h"
+#include "node_api_fake.h"
+
+static std::string fake_values[NODE_SAPI_KEY_LAST];
+static unsigned int fake_applies;
+static unsigned int fake_saves;
+
+static unsigned short fake_get(int key, char *buf_out, unsigned short buf_len)
+{
+    if (fake_values[key].size() >= buf_len)
+        return NODE_API_MEM_ERROR;
+    strcpy(buf_out, fake_values[key].c_str());
+    return NODE_API_OK;
+}
+
+static unsigned short fake_set(int key, char *buf_in)
+{
+    if (strlen(buf_in) == 0 || strlen(buf_in) > NODE_API_FAKE_VALUE_MAX)
+        return NODE_API_INVALID_ARG;
+    fake_values[key] = buf_in;
+    return NODE_API_OK;
+}
+
+#define FAKE_GET(key, get) \
+    unsigned short get(char *buf_out, unsigned short buf_len) { return fake_get(key, buf_out, buf_len); }
+#define FAKE_SET(key, set) \
+    unsigned short set(char *buf_in) { return fake_set(key, buf_in); }
+
+extern "C" {
+
+FAKE_GET(NODE_SAPI_KEY_APP_EUI, nodeApiGetAppEui)
+FAKE_SET(NODE_SAPI_KEY_APP_EUI, nodeApiSetAppEui)
+FAKE_GET(NODE_SAPI_KEY_APP_KEY, nodeApiGetAppKey)
+FAKE_SET(NODE_SAPI_KEY_APP_KEY, nodeApiSetAppKey)
+FAKE_GET(NODE_SAPI_KEY_DEV_ADDR, nodeApiGetDevAddr)
+FAKE_SET(NODE_SAPI_KEY_DEV_ADDR, nodeApiSetDevAddr)
+FAKE_GET(NODE_SAPI_KEY_NWK_SKEY, nodeApiGetNwkSKey)
+FAKE_SET(NODE_SAPI_KEY_NWK_SKEY, nodeApiSetNwkSKey)
+FAKE_GET(NODE_SAPI_KEY_APP_SKEY, nodeApiGetAppSKey)
+FAKE_SET(NODE_SAPI_KEY_APP_SKEY, nodeApiSetAppSKey)
+FAKE_GET(NODE_SAPI_KEY_ACT_MODE, nodeApiGetDevActMode)
+FAKE_SET(NODE_SAPI_KEY_ACT_MODE, nodeApiSetDevActMode)
+FAKE_GET(NODE_SAPI_KEY_OP_MODE, nodeApiGetDevOpMode)
+FAKE_SET(NODE_SAPI_KEY_OP_MODE, nodeApiSetDevOpMode)
+FAKE_GET(NODE_SAPI_KEY_CLASS, nodeApiGetDevClass)
+FAKE_SET(NODE_SAPI_KEY_CLASS, nodeApiSetDevClass)
+FAKE_GET(NODE_SAPI_KEY_FREQ, nodeApiGetDevAdvwiseFreq)
+FAKE_SET(NODE_SAPI_KEY_FREQ, nodeApiSetDevAdvwiseFreq)
+FAKE_GET(NODE_SAPI_KEY_DATA_RATE, nodeApiGetDevAdvwiseDataRate)
+FAKE_SET(NODE_SAPI_KEY_DATA_RATE, nodeApiSetDevAdvwiseDataRate)
+FAKE_GET(NODE_SAPI_KEY_NET_ID, nodeApiGetDevNetId)
+FAKE_SET(NODE_SAPI_KEY_NET_ID, nodeApiSetDevNetId)
+FAKE_GET(NODE_SAPI_KEY_TX_PWR, nodeApiGetDevAdvwiseTxPwr)
+FAKE_SET(NODE_SAPI_KEY_TX_PWR, nodeApiSetDevAdvwiseTxPwr)
+FAKE_GET(NODE_SAPI_KEY_SPS_CONF, nodeApiGetSpsConf)
+FAKE_SET(NODE_SAPI_KEY_SPS_CONF, nodeApiSetSpsConf)
+FAKE_GET(NODE_SAPI_KEY_BKEY, nodeApiGetBKey)
+FAKE_SET(NODE_SAPI_KEY_BKEY, nodeApiSetBKey)
+FAKE_GET(NODE_SAPI_KEY_VERSION, nodeApiGetVersion)
+FAKE_GET(NODE_SAPI_KEY_FUSE_DEV_EUI, nodeApiGetFuseDevEui)
+
+unsigned short nodeApiApplyCfg()
+{
+    fake_applies++;
+    return NODE_API_OK;
+}
+
+unsigned short nodeApiSaveCfg()
+{
+    fake_saves++;
+    return NODE_API_OK;
+}
+
+}
+
+/* Defined by main.cpp, without C linkage */
+FAKE_GET(NODE_SAPI_KEY_RPT_INTVL, nodeApiGetDevRptIntvlSec)
+
+void node_api_fake_reset(void)
+{
+    static const char *const values[NODE_SAPI_KEY_LAST] =
+    {
+        "",
+        "0000000000000001",
+        "2B7E151628AED2A6ABF7158809CF4F3C",
+        "01020304",
+        "2B7E151628AED2A6ABF7158809CF4F3C",
+        "2B7E151628AED2A6ABF7158809CF4F3C",
+        "1",
+        "0",
+        "0",
+        "923200000",
+        "2",
+        "0",
+        "14",
+        "0",
+        "2B7E151628AED2A6ABF7158809CF4F3C",
+        "600",
+        "1.0.9",
+        "0011223344556677",
+    };
+
+    for (int key = 0; key < NODE_SAPI_KEY_LAST; key++)
+        fake_values[key] = values[key];
+    fake_applies = 0;
+    fake_saves = 0;
+}
+
+std::string &node_api_fake_value(int key)
+{
+    return fake_values[key];
+}
+
+unsigned int node_api_fake_applies(void)
+{
+    return fake_applies;
+}
+
+unsigned int node_api_fake_saves(void)
+{
+    return fake_saves;
+}
@@ -0,0 +1,27 @@
+/**
+ * @file node_api_fake.h
+ *
+ * @brief Host fake of the config calls of node_api.h that node_sapi maps its
+ *        keys to: a string per key, and counts of the apply and save calls
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _NODE_API_FAKE_H_
+#define _NODE_API_FAKE_H_
+
+#include <string>
+
+#define NODE_API_FAKE_VALUE_MAX     64  ///< Longer values are refused with NODE_API_INVALID_ARG
+
+/** @brief Give every key a value in the format of the device, and clear the counts */
+void node_api_fake_reset(void);
+
+/** @brief Value of a key, by node_sapi_key_t */
+std::string &node_api_fake_value(int key);
+
+unsigned int node_api_fake_applies(void);
+
+unsigned int node_api_fake_saves(void);
+
+#endif
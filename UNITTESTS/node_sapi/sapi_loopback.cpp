@@ -0,0 +1,96 @@
+/**
+ * @file sapi_loopback.cpp
+ *
+ * @brief The host side of the SAPI link for the host tests
+ *
+ * @author AdvanWISE
+ */
+
+#include <algorithm>
+#include "node_sapi.h"
+#include "sapi_loopback.h"
+
+void LoopbackFile::send(const std::string &data)
+{
+    _input += data;
+}
+
+std::string LoopbackFile::receive(void)
+{
+    std::string output;
+
+    output.swap(_output);
+    return output;
+}
+
+ssize_t LoopbackFile::read(void *buffer, size_t size)
+{
+    size_t count = std::min(size, _input.size() - _pos);
+
+    memcpy(buffer, _input.data() + _pos, count);
+    _pos += count;
+    return count;
+}
+
+ssize_t LoopbackFile::write(const void *buffer, size_t size)
+{
+    _writes++;
+    _output.append((const char *)buffer, size);
+    return size;
+}
+
+uint16_t sapi_crc16(const std::string &data)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        crc ^= (uint8_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+std::string sapi_frame(uint8_t tag, uint8_t cmd, const std::string &body)
+{
+    size_t len = 2 + body.size();
+    std::string frame;
+
+    frame += (char)(len & 0xFF);
+    frame += (char)(len >> 8);
+    frame += (char)tag;
+    frame += (char)cmd;
+    frame += body;
+    uint16_t crc = sapi_crc16(frame);
+    frame += (char)(crc & 0xFF);
+    frame += (char)(crc >> 8);
+    return (char)NODE_SAPI_SYNC + frame;
+}
+
+bool sapi_parse(const std::string &stream, std::vector<sapi_reply> &replies)
+{
+    size_t pos = 0;
+
+    while (pos < stream.size())
+    {
+        if ((uint8_t)stream[pos] != NODE_SAPI_SYNC || pos + 3 > stream.size())
+            return false;
+        size_t len = (uint8_t)stream[pos + 1] | ((uint8_t)stream[pos + 2] << 8);
+        if (len < 3 || len > NODE_SAPI_FRAME_MAX || pos + 5 + len > stream.size())
+            return false;
+        std::string checked = stream.substr(pos + 1, 2 + len);
+        uint16_t crc = (uint8_t)stream[pos + 3 + len] | ((uint8_t)stream[pos + 4 + len] << 8);
+        if (crc != sapi_crc16(checked))
+            return false;
+
+        sapi_reply reply;
+        reply.tag = stream[pos + 3];
+        reply.cmd = stream[pos + 4];
+        reply.status = stream[pos + 5];
+        reply.body = stream.substr(pos + 6, len - 3);
+        replies.push_back(reply);
+        pos += 5 + len;
+    }
+    return true;
+}
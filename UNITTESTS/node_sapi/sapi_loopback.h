@@ -0,0 +1,77 @@
+/**
+ * @file sapi_loopback.h
+ *
+ * @brief The host side of the SAPI link for the host tests: a file handle
+ *        that node_sapi_serve() reads requests from and writes replies to,
+ *        and the framing of the protocol, written from node_sapi.h
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _SAPI_LOOPBACK_H_
+#define _SAPI_LOOPBACK_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "mbed.h"
+
+class LoopbackFile : public FileHandle {
+public:
+    LoopbackFile() : _pos(0), _writes(0) {}
+
+    /** @brief Bytes for the device to read */
+    void send(const std::string &data);
+
+    /** @brief Bytes the device wrote, taken */
+    std::string receive(void);
+
+    /** @brief Number of writes by the device */
+    unsigned int writes(void) const
+    {
+        return _writes;
+    }
+
+    virtual ssize_t read(void *buffer, size_t size);
+    virtual ssize_t write(const void *buffer, size_t size);
+    virtual off_t seek(off_t offset, int whence = SEEK_SET)
+    {
+        return -ESPIPE;
+    }
+    virtual int close()
+    {
+        return 0;
+    }
+    virtual short poll(short events) const
+    {
+        return (_pos < _input.size() ? POLLIN : 0) | POLLOUT;
+    }
+
+private:
+    std::string _input;
+    size_t _pos;
+    std::string _output;
+    unsigned int _writes;
+};
+
+struct sapi_reply
+{
+    uint8_t tag;
+    uint8_t cmd;
+    uint8_t status;
+    std::string body;
+};
+
+/** @brief CRC-16/CCITT as the protocol specifies it, bit by bit */
+uint16_t sapi_crc16(const std::string &data);
+
+/** @brief A request frame */
+std::string sapi_frame(uint8_t tag, uint8_t cmd, const std::string &body);
+
+/** @brief Split a stream of reply frames
+ *
+ *  @returns false on a bad sync, length or CRC
+ */
+bool sapi_parse(const std::string &stream, std::vector<sapi_reply> &replies);
+
+#endif
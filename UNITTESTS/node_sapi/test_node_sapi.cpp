@@ -0,0 +1,185 @@
+/**
+ * @file test_node_sapi.cpp
+ *
+ * @brief Host loopback test of the SAPI server: pipelined requests answered in
+ *        order, frames dropped for a bad CRC or length, and every key read
+ *        back through the fake node API
+ *
+ * @author AdvanWISE
+ */
+
+#include "gtest/gtest.h"
+#include "node_sapi.h"
+#include "node_api.h"
+#include "node_api_fake.h"
+#include "sapi_loopback.h"
+
+class TestNodeSapi : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        node_api_fake_reset();
+        dropped = node_sapi_dropped();
+    }
+
+    /** @brief Send, serve once and parse the replies */
+    std::vector<sapi_reply> exchange(const std::string &requests)
+    {
+        std::vector<sapi_reply> replies;
+
+        link.send(requests);
+        node_sapi_serve(&link);
+        EXPECT_TRUE(sapi_parse(link.receive(), replies));
+        return replies;
+    }
+
+    static std::string key_value(uint8_t key, const std::string &value)
+    {
+        return std::string(1, (char)key) + (char)value.size() + value;
+    }
+
+    LoopbackFile link;
+    unsigned int dropped;
+};
+
+TEST_F(TestNodeSapi, ping_echoes_its_body_and_tag)
+{
+    std::vector<sapi_reply> replies = exchange(sapi_frame(0x42, NODE_SAPI_CMD_PING, "hello"));
+
+    ASSERT_EQ(1u, replies.size());
+    EXPECT_EQ(0x42, replies[0].tag);
+    EXPECT_EQ(NODE_SAPI_CMD_PING | NODE_SAPI_CMD_REPLY, replies[0].cmd);
+    EXPECT_EQ(NODE_SAPI_STATUS_OK, replies[0].status);
+    EXPECT_EQ("hello", replies[0].body);
+}
+
+TEST_F(TestNodeSapi, pipelined_requests_are_answered_in_order_in_one_write)
+{
+    std::string requests;
+
+    for (int tag = 0; tag < 8; tag++)
+        requests += sapi_frame(tag, NODE_SAPI_CMD_PING, std::string(tag, 'x'));
+    std::vector<sapi_reply> replies = exchange(requests);
+
+    ASSERT_EQ(8u, replies.size());
+    for (int tag = 0; tag < 8; tag++)
+    {
+        EXPECT_EQ(tag, replies[tag].tag);
+        EXPECT_EQ(std::string(tag, 'x'), replies[tag].body);
+    }
+    EXPECT_EQ(1u, link.writes());
+}
+
+TEST_F(TestNodeSapi, requests_split_across_reads_are_reassembled)
+{
+    std::string requests = sapi_frame(1, NODE_SAPI_CMD_PING, "split") + sapi_frame(2, NODE_SAPI_CMD_PING, "up");
+    std::vector<sapi_reply> replies;
+
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        link.send(requests.substr(i, 1));
+        node_sapi_serve(&link);
+    }
+    ASSERT_TRUE(sapi_parse(link.receive(), replies));
+    ASSERT_EQ(2u, replies.size());
+    EXPECT_EQ("split", replies[0].body);
+    EXPECT_EQ("up", replies[1].body);
+}
+
+TEST_F(TestNodeSapi, bad_crc_is_dropped_without_a_reply)
+{
+    std::string bad = sapi_frame(1, NODE_SAPI_CMD_PING, "bad");
+    bad[bad.size() - 1] ^= 0x01;
+    std::vector<sapi_reply> replies = exchange(bad + sapi_frame(2, NODE_SAPI_CMD_PING, "good"));
+
+    ASSERT_EQ(1u, replies.size());
+    EXPECT_EQ(2, replies[0].tag);
+    EXPECT_EQ(dropped + 1, node_sapi_dropped());
+}
+
+TEST_F(TestNodeSapi, noise_and_bad_lengths_are_skipped)
+{
+    std::string noise("\x01\x02\x03", 3);
+    // Too short, then too long for a frame
+    std::string short_frame("\x7E\x01\x00", 3);
+    std::string long_frame("\x7E\xFF\xFF", 3);
+    std::vector<sapi_reply> replies = exchange(noise + short_frame + long_frame + sapi_frame(3, NODE_SAPI_CMD_PING, ""));
+
+    ASSERT_EQ(1u, replies.size());
+    EXPECT_EQ(3, replies[0].tag);
+    EXPECT_EQ(dropped + 2, node_sapi_dropped());
+}
+
+TEST_F(TestNodeSapi, every_key_reads_back)
+{
+    std::string keys;
+
+    for (int key = 1; key < NODE_SAPI_KEY_LAST; key++)
+        keys += (char)key;
+    std::vector<sapi_reply> replies = exchange(sapi_frame(7, NODE_SAPI_CMD_GET, keys));
+
+    ASSERT_EQ(1u, replies.size());
+    ASSERT_EQ(NODE_SAPI_STATUS_OK, replies[0].status);
+    const std::string &body = replies[0].body;
+    size_t pos = 0;
+    for (int key = 1; key < NODE_SAPI_KEY_LAST; key++)
+    {
+        ASSERT_LE(pos + 3, body.size());
+        EXPECT_EQ(key, body[pos]);
+        EXPECT_EQ(NODE_API_OK, body[pos + 1]);
+        size_t len = (uint8_t)body[pos + 2];
+        EXPECT_EQ(node_api_fake_value(key), body.substr(pos + 3, len)) << key;
+        pos += 3 + len;
+    }
+    EXPECT_EQ(body.size(), pos);
+}
+
+TEST_F(TestNodeSapi, set_then_get_in_one_round_trip)
+{
+    std::string set = key_value(NODE_SAPI_KEY_DEV_ADDR, "0A0B0C0D") + key_value(NODE_SAPI_KEY_TX_PWR, "20");
+    std::string get;
+    get += (char)NODE_SAPI_KEY_DEV_ADDR;
+    get += (char)NODE_SAPI_KEY_TX_PWR;
+    std::vector<sapi_reply> replies = exchange(sapi_frame(1, NODE_SAPI_CMD_SET, set) +
+                                               sapi_frame(2, NODE_SAPI_CMD_APPLY, "") +
+                                               sapi_frame(3, NODE_SAPI_CMD_SAVE, "") +
+                                               sapi_frame(4, NODE_SAPI_CMD_GET, get));
+
+    ASSERT_EQ(4u, replies.size());
+    EXPECT_EQ(std::string("\x03\x00\x0C\x00", 4), replies[0].body);
+    EXPECT_EQ(std::string(1, NODE_API_OK), replies[1].body);
+    EXPECT_EQ(std::string(1, NODE_API_OK), replies[2].body);
+    EXPECT_EQ(std::string("\x03\x00\x08" "0A0B0C0D" "\x0C\x00\x02" "20", 16), replies[3].body);
+    EXPECT_EQ(1u, node_api_fake_applies());
+    EXPECT_EQ(1u, node_api_fake_saves());
+}
+
+TEST_F(TestNodeSapi, read_only_and_unknown_keys_are_refused)
+{
+    std::string set = key_value(NODE_SAPI_KEY_VERSION, "9.9") + key_value(0, "x") + key_value(99, "x") +
+                      key_value(NODE_SAPI_KEY_FREQ, "");
+    std::string get("\x00\x63", 2);
+    std::vector<sapi_reply> replies = exchange(sapi_frame(1, NODE_SAPI_CMD_SET, set) + sapi_frame(2, NODE_SAPI_CMD_GET, get));
+
+    ASSERT_EQ(2u, replies.size());
+    EXPECT_EQ(std::string("\x10\xFD" "\x00\xFE" "\x63\xFE" "\x09\x01", 8), replies[0].body);
+    EXPECT_EQ(std::string("\x00\xFE\x00" "\x63\xFE\x00", 6), replies[1].body);
+    EXPECT_EQ("1.0.9", node_api_fake_value(NODE_SAPI_KEY_VERSION));
+}
+
+TEST_F(TestNodeSapi, malformed_requests_get_an_error_status)
+{
+    // A value running past the end of the body
+    std::string set("\x03\x08" "0A0B", 6);
+    std::string big_get(NODE_SAPI_FRAME_MAX - 2, (char)NODE_SAPI_KEY_APP_KEY);
+    std::vector<sapi_reply> replies = exchange(sapi_frame(1, NODE_SAPI_CMD_SET, set) +
+                                               sapi_frame(2, 0x7F, "") +
+                                               sapi_frame(3, NODE_SAPI_CMD_GET, big_get));
+
+    ASSERT_EQ(3u, replies.size());
+    EXPECT_EQ(NODE_SAPI_STATUS_BAD_LEN, replies[0].status);
+    EXPECT_EQ(NODE_SAPI_STATUS_BAD_CMD, replies[1].status);
+    // The reply would not fit in a frame
+    EXPECT_EQ(NODE_SAPI_STATUS_BAD_LEN, replies[2].status);
+    EXPECT_EQ("01020304", node_api_fake_value(NODE_SAPI_KEY_DEV_ADDR));
+}
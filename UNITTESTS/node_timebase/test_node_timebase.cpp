@@ -0,0 +1,199 @@
+/**
+ * @file test_node_timebase.cpp
+ *
+ * @brief Host test of the timebase estimator, against clocks with a known
+ *        drift and timestamp jitter
+ *
+ * @author AdvanWISE
+ */
+
+#include "gtest/gtest.h"
+#include "node_timebase.h"
+
+#define BEACON_PERIOD_US    ((uint64_t)NODE_TIMEBASE_BEACON_PERIOD_MS * 1000)
+#define SIM_SAMPLES         200
+
+/* Pass thresholds of the beacon tracking simulation for a timestamp jitter */
+struct timebase_limits
+{
+    unsigned int jitter_us;
+    unsigned int drift_error_ppb;   ///< Fitted less injected drift
+    unsigned int max_error_us;      ///< Corrected clock to the reference, once converged
+    unsigned int window_us;         ///< Window one beacon period ahead
+};
+
+static const struct timebase_limits timebase_limits[] = {
+    { 0,        5,      2,      2 },
+    { 100,      5,      100,    120 },
+    { 2000,     10,     2000,   2500 },
+    { 20000,    5000,   20000,  25000 },
+};
+
+// -1%, as the MSI clock may be off before it is trimmed, to +1%
+static const int32_t timebase_drifts_ppb[] = { -10000000, -100000, -20000, -1, 0, 1, 5000, 40000, 1000000, 10000000 };
+
+TEST(TestNodeTimebase, beacon_tracking_meets_its_limits)
+{
+    for (unsigned int i = 0; i < sizeof(timebase_limits) / sizeof(timebase_limits[0]); i++) {
+        const struct timebase_limits &limits = timebase_limits[i];
+
+        for (unsigned int j = 0; j < sizeof(timebase_drifts_ppb) / sizeof(timebase_drifts_ppb[0]); j++) {
+            struct node_timebase_sim sim;
+            SCOPED_TRACE(testing::Message() << "drift " << timebase_drifts_ppb[j] << " ppb, jitter "
+                         << limits.jitter_us << " us");
+
+            node_timebase_simulate(timebase_drifts_ppb[j], limits.jitter_us, BEACON_PERIOD_US, SIM_SAMPLES, &sim);
+            EXPECT_EQ(1, sim.monotonic);
+            EXPECT_LE((unsigned int)abs(sim.drift_error_ppb), limits.drift_error_ppb);
+            EXPECT_LE(sim.max_error_us, limits.max_error_us);
+            EXPECT_LE(sim.window_us, limits.window_us);
+            // Three standard deviations: an odd beacon may fall outside
+            EXPECT_LE(sim.missed, SIM_SAMPLES / 50u);
+        }
+    }
+}
+
+TEST(TestNodeTimebase, window_narrows_as_the_fit_converges)
+{
+    struct node_timebase_sim sim;
+    unsigned int previous = 0xFFFFFFFF;
+
+    EXPECT_EQ(0xFFFFFFFFu, (node_timebase_simulate(20000, 2000, BEACON_PERIOD_US, 2, &sim), sim.window_us));
+    for (unsigned int samples = 4; samples <= NODE_TIMEBASE_SAMPLES; samples *= 2) {
+        node_timebase_simulate(20000, 2000, BEACON_PERIOD_US, samples, &sim);
+        EXPECT_LT(sim.window_us, previous) << samples;
+        previous = sim.window_us;
+    }
+}
+
+class TestNodeTimebaseUpdate : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        node_timebase_reset(&tb, 0);
+        local = 0;
+        ref = 0;
+        last = 0;
+    }
+
+    /* Samples one second apart, from a clock running drift_ppb fast */
+    void track(unsigned int samples, int32_t drift_ppb, int64_t ref_offset_us = 0)
+    {
+        for (unsigned int i = 0; i < samples; i++) {
+            local += 1000000 + 1000000LL * drift_ppb / 1000000000;
+            ref += 1000000;
+            expect_monotonic(local);
+            ASSERT_EQ(NODE_TIMEBASE_OK, node_timebase_update(&tb, local, ref + ref_offset_us, 0));
+            expect_monotonic(local);
+        }
+    }
+
+    void expect_monotonic(uint64_t at)
+    {
+        uint64_t now = node_timebase_convert(&tb, at);
+        ASSERT_GE(now, last) << at;
+        last = now;
+    }
+
+    struct node_timebase tb;
+    uint64_t local;
+    uint64_t ref;
+    uint64_t last;
+};
+
+TEST_F(TestNodeTimebaseUpdate, repeated_and_reordered_samples_are_ignored)
+{
+    track(3, 0);
+    EXPECT_EQ(NODE_TIMEBASE_ERR_IGNORED, node_timebase_update(&tb, local, ref + 1000000, 0));
+    EXPECT_EQ(NODE_TIMEBASE_ERR_IGNORED, node_timebase_update(&tb, local + 1000000, ref, 0));
+    EXPECT_EQ(NODE_TIMEBASE_ERR_IGNORED, node_timebase_update(&tb, local - 1, ref + 1000000, 0));
+    EXPECT_EQ(3, tb.count);
+}
+
+TEST_F(TestNodeTimebaseUpdate, uncertainty_needs_three_samples)
+{
+    EXPECT_EQ(0xFFFFFFFFu, node_timebase_uncertainty(&tb, 1000000));
+    track(2, 0);
+    EXPECT_EQ(0xFFFFFFFFu, node_timebase_uncertainty(&tb, 1000000));
+    track(1, 0);
+    EXPECT_LE(node_timebase_uncertainty(&tb, 1000000), 2u);
+}
+
+TEST_F(TestNodeTimebaseUpdate, drift_is_fitted_in_ppb)
+{
+    track(NODE_TIMEBASE_SAMPLES, 250000);
+    EXPECT_NEAR(250000, tb.drift_ppb, 2);
+    EXPECT_NEAR((double)ref, (double)node_timebase_convert(&tb, local), 1);
+    // A second ahead, the clock keeps the reference rate
+    EXPECT_NEAR((double)(ref + 1000000), (double)node_timebase_convert(&tb, local + 1000250), 1);
+}
+
+TEST_F(TestNodeTimebaseUpdate, clock_slews_back_to_a_reference_behind_it)
+{
+    track(4, 0);
+
+    // 5 ms behind: under the step, so the clock slows down rather than going back,
+    // by at most NODE_TIMEBASE_SLEW_PPM
+    track(1, 0, -5000);
+    EXPECT_GE(node_timebase_convert(&tb, local), ref - NODE_TIMEBASE_SLEW_PPM);
+    track(3 * NODE_TIMEBASE_SAMPLES, 0, -5000);
+    EXPECT_NEAR((double)(ref - 5000), (double)node_timebase_convert(&tb, local), 100);
+}
+
+TEST_F(TestNodeTimebaseUpdate, clock_steps_forward_to_a_reference_ahead)
+{
+    track(4, 0);
+
+    // 50 ms ahead: over the step and under the resync, so the clock steps to
+    // the sample, and the fit restarts from it at the same rate
+    track(1, 0, 50000);
+    EXPECT_EQ(ref + 50000, node_timebase_convert(&tb, local));
+    EXPECT_EQ(1, tb.count);
+    track(2 * NODE_TIMEBASE_SAMPLES, 0, 50000);
+    EXPECT_NEAR((double)(ref + 50000), (double)node_timebase_convert(&tb, local), 1);
+    EXPECT_NEAR(0, tb.drift_ppb, 1);
+}
+
+TEST_F(TestNodeTimebaseUpdate, far_samples_restart_the_fit_without_going_back)
+{
+    track(8, 0);
+
+    // The ticker stopped for a while, e.g. in deep sleep: the reference is far ahead
+    ref += 5000000;
+    local += 1000000;
+    ref += 1000000;
+    EXPECT_EQ(NODE_TIMEBASE_ERR_RESYNC, node_timebase_update(&tb, local, ref, 0));
+    expect_monotonic(local);
+    EXPECT_EQ(ref, node_timebase_convert(&tb, local));
+    EXPECT_EQ(1, tb.count);
+    track(4, 0);
+
+    // A reference far behind, as after a ticker jump, restarts the fit too,
+    // but the clock waits for it
+    local += 6000000;
+    ref += 1000000;
+    EXPECT_EQ(NODE_TIMEBASE_ERR_RESYNC, node_timebase_update(&tb, local, ref, 0));
+    expect_monotonic(local);
+    EXPECT_EQ(1, tb.count);
+}
+
+TEST_F(TestNodeTimebaseUpdate, seconds_counter_reaches_ppm_accuracy_in_hours)
+{
+    const int32_t drift_ppb = 30000;
+    const uint64_t period_us = (uint64_t)NODE_TIMEBASE_RTC_PERIOD_S * 1000000;
+
+    uint64_t t = 0;
+
+    // An RTC read every period; it only counts whole seconds
+    for (unsigned int i = 1; i <= NODE_TIMEBASE_SAMPLES * 4; i++) {
+        t = i * period_us + (i * 7919 % 1000) * 1000;
+        local = t + (uint64_t)((int64_t)t * drift_ppb / 1000000000);
+        expect_monotonic(local);
+        int rc = node_timebase_update(&tb, local, t / 1000000 * 1000000 + 500000, 500000);
+        ASSERT_EQ(NODE_TIMEBASE_OK, rc) << i;
+        expect_monotonic(local);
+    }
+    // The fit spans 2.5 hours, with half a second of error on each sample
+    EXPECT_NEAR(drift_ppb, tb.drift_ppb, 50000);
+    EXPECT_NEAR((double)t, (double)node_timebase_convert(&tb, local), 500000);
+}
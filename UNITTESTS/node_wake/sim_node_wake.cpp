@@ -0,0 +1,56 @@
+/**
+ * @file sim_node_wake.cpp
+ *
+ * @brief Wakeups per hour and deep-sleep residency of the sensor tasks, with a
+ *        thread per task as before node_wake, and coalesced
+ *
+ *   sim_node_wake [hours]
+ *
+ * @author AdvanWISE
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "node_wake.h"
+
+#define SIM_WAKE_MS     1       ///< Time a wakeup keeps the CPU awake besides the tasks
+
+/* Periods and tolerances as main.cpp schedules them; run times from the waits of the sensor code */
+static const struct node_wake_task sim_temp_hum = { 1000, 500, 55, 0, NULL };      ///< HDC1010 conversion wait
+static const struct node_wake_task sim_sku = { 2000, 500, 1, 0, NULL };            ///< SEN0159 sample
+static const struct node_wake_task sim_co2_voc = { 3000, 1000, 2, 0, NULL };       ///< IAQ-Core read
+static const struct node_wake_task sim_rtc = { 600000, 60000, 1, 0, NULL };        ///< Timebase RTC sample
+
+static void sim_print(const char *name, const struct node_wake_task *tasks, int count, uint64_t duration_ms)
+{
+    struct node_wake_sim before, after;
+
+    node_wake_simulate(tasks, count, duration_ms, SIM_WAKE_MS, 0, &before);
+    node_wake_simulate(tasks, count, duration_ms, SIM_WAKE_MS, 1, &after);
+    printf("%-28s %8.0f -> %8.0f wakeups/h   deep sleep %5.1f%% -> %5.1f%%   awake %4.1f%% -> %4.1f%%\n",
+           name, before.wakeups_per_hour, after.wakeups_per_hour,
+           before.deep_sleep * 100, after.deep_sleep * 100, before.awake * 100, after.awake * 100);
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t duration_ms = 3600000ULL * ((argc > 1) ? strtoul(argv[1], NULL, 0) : 1);
+    struct node_wake_task tasks[NODE_WAKE_TASKS];
+
+    printf("Thread per task -> coalesced, gaps of %d ms or more counted as deep sleep:\n",
+           NODE_WAKE_DEEP_SLEEP_MIN_MS);
+
+    tasks[0] = sim_temp_hum;
+    tasks[1] = sim_rtc;
+    sim_print("temp/hum", tasks, 2, duration_ms);
+
+    tasks[1] = sim_sku;
+    tasks[2] = sim_rtc;
+    sim_print("temp/hum + SEN0159", tasks, 3, duration_ms);
+
+    tasks[2] = sim_co2_voc;
+    tasks[3] = sim_rtc;
+    sim_print("temp/hum + SEN0159 + VOC", tasks, 4, duration_ms);
+    return 0;
+}
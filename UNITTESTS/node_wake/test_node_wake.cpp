@@ -0,0 +1,127 @@
+/**
+ * @file test_node_wake.cpp
+ *
+ * @brief Host test of the wake coalescing plan and its simulation
+ *
+ * @author AdvanWISE
+ */
+
+#include "gtest/gtest.h"
+#include "node_wake.h"
+
+#define HOUR_MS     3600000ULL
+
+static struct node_wake_task wake_task(unsigned int period_ms, unsigned int tolerance_ms, unsigned int run_ms)
+{
+    struct node_wake_task task;
+
+    memset(&task, 0, sizeof(task));
+    task.period_ms = period_ms;
+    task.tolerance_ms = tolerance_ms;
+    task.run_ms = run_ms;
+    return task;
+}
+
+static void expect_shares_add_up(const struct node_wake_sim &sim)
+{
+    EXPECT_NEAR(1.0f, sim.awake + sim.sleep + sim.deep_sleep, 1e-4f);
+}
+
+TEST(TestNodeWake, window_is_the_earliest_deadline_plus_tolerance)
+{
+    struct node_wake_task tasks[3] = { wake_task(1000, 500, 0), wake_task(2000, 100, 0), wake_task(500, 0, 0) };
+
+    tasks[0].due_ms = 1000;
+    tasks[1].due_ms = 1450;
+    tasks[2].due_ms = 1600;
+    EXPECT_EQ(1500u, node_wake_window(tasks, 3));
+    tasks[1].due_ms = 1350;
+    EXPECT_EQ(1450u, node_wake_window(tasks, 3));
+    EXPECT_EQ(1500u, node_wake_window(tasks, 1));
+    EXPECT_EQ(NODE_WAKE_NEVER, node_wake_window(tasks, 0));
+}
+
+TEST(TestNodeWake, related_periods_share_every_wakeup)
+{
+    struct node_wake_task tasks[2] = { wake_task(1000, 500, 5), wake_task(2000, 500, 5) };
+    struct node_wake_sim sim;
+
+    // Once a second, from 1.5 s, with both tasks on every other wakeup
+    node_wake_simulate(tasks, 2, HOUR_MS, 1, 1, &sim);
+    EXPECT_EQ(3599u, sim.wakeups);
+    EXPECT_NEAR(3599.0f, sim.wakeups_per_hour, 0.01f);
+    EXPECT_NEAR((3599 * 6 + 1799 * 5) / (float)HOUR_MS, sim.awake, 1e-6f);
+    EXPECT_EQ(0.0f, sim.sleep);
+    expect_shares_add_up(sim);
+
+    // A thread per task wakes for each of them
+    struct node_wake_sim threads;
+    node_wake_simulate(tasks, 2, HOUR_MS, 1, 0, &threads);
+    EXPECT_GT(threads.wakeups, 5000u);
+    EXPECT_GT(threads.wakeups, sim.wakeups);
+    expect_shares_add_up(threads);
+}
+
+TEST(TestNodeWake, tasks_without_tolerance_wake_on_their_own)
+{
+    struct node_wake_task tasks[2] = { wake_task(1000, 0, 0), wake_task(1500, 0, 0) };
+    struct node_wake_sim sim;
+
+    // 1, 1.5, 2, 3 (both), 4, 4.5, 5, 6 (both) ...: four wakeups every 3 s, up to 29 s
+    node_wake_simulate(tasks, 2, 30000, 1, 1, &sim);
+    EXPECT_EQ(39u, sim.wakeups);
+
+    // The second task now runs with the first, at 2, 3, 5, 6 ...
+
+    tasks[1].tolerance_ms = 500;
+    node_wake_simulate(tasks, 2, 30000, 1, 1, &sim);
+    EXPECT_EQ(29u, sim.wakeups);
+}
+
+TEST(TestNodeWake, short_gaps_are_not_deep_sleep)
+{
+    struct node_wake_task tasks[1] = { wake_task(NODE_WAKE_DEEP_SLEEP_MIN_MS, 0, 1) };
+    struct node_wake_sim sim;
+
+    // Awake 2 ms of every period, asleep for the rest: too short for deep sleep,
+    // but for the wait before the first run
+    node_wake_simulate(tasks, 1, 10000, 1, 1, &sim);
+    EXPECT_EQ(999u, sim.wakeups);
+    EXPECT_NEAR((float)NODE_WAKE_DEEP_SLEEP_MIN_MS / 10000, sim.deep_sleep, 1e-6f);
+    EXPECT_GT(sim.sleep, 0.7f);
+    expect_shares_add_up(sim);
+
+    tasks[0].period_ms = NODE_WAKE_DEEP_SLEEP_MIN_MS + 2;
+    node_wake_simulate(tasks, 1, 12000, 1, 1, &sim);
+    EXPECT_EQ(0.0f, sim.sleep);
+    EXPECT_GT(sim.deep_sleep, 0.8f);
+    expect_shares_add_up(sim);
+}
+
+TEST(TestNodeWake, overlapping_runs_are_one_wakeup)
+{
+    // The second task is due at 1.1, 2.2 and 3.3 s while the first one still runs
+    struct node_wake_task tasks[2] = { wake_task(1000, 0, 300), wake_task(1100, 0, 0) };
+    struct node_wake_sim sim;
+
+    node_wake_simulate(tasks, 2, 10000, 0, 1, &sim);
+    EXPECT_EQ(9u + 9u - 3u, sim.wakeups);
+    EXPECT_NEAR(9 * 300 / 10000.0f, sim.awake, 1e-6f);
+    expect_shares_add_up(sim);
+}
+
+TEST(TestNodeWake, invalid_task_sets_simulate_nothing)
+{
+    struct node_wake_task tasks[NODE_WAKE_TASKS + 1];
+    struct node_wake_sim sim;
+
+    for (int i = 0; i <= NODE_WAKE_TASKS; i++) {
+        tasks[i] = wake_task(1000, 100, 1);
+    }
+    node_wake_simulate(tasks, NODE_WAKE_TASKS + 1, HOUR_MS, 1, 1, &sim);
+    EXPECT_EQ(0u, sim.wakeups);
+    node_wake_simulate(tasks, 0, HOUR_MS, 1, 1, &sim);
+    EXPECT_EQ(0u, sim.wakeups);
+    node_wake_simulate(tasks, 1, 0, 1, 1, &sim);
+    EXPECT_EQ(0u, sim.wakeups);
+}
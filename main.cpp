@@ -11,6 +11,14 @@
 
 #include "mbed.h"
 #include "node_api.h"
+#include "node_kvstore.h"
+#include "node_journal.h"
+#include "node_sapi.h"
+#include "node_energy.h"
+#include "node_wake.h"
+#include "node_fixmath.h"
+#include "node_filter.h"
+#include "node_timebase.h"
 
 #define HYUNJAE 1                     /* 20210425 : Code define */
 
@@ -22,23 +30,29 @@
 #define         MG_PIN                       (ADC0)     //define which analog input channel you are going to use
 #define         BOOL_PIN                     (2)
 #define         DC_GAIN                      (8.5)   //define the DC gain of amplifier
+#define         MG_MV_FULL_SCALE             (3420)  //define the output of SEN-000007 in millivolts at full scale of the ADC
+#define         MG_VOLTS_PER_LSB             NODE_FIXMATH_SCALE(MG_MV_FULL_SCALE/1000.0/DC_GAIN/65535)
+                                                     //define the sensor voltage, before the amplifier, per read_u16() unit
 /***********************Software Related Macros************************************/
-#define         READ_SAMPLE_INTERVAL         (50)    //define how many samples you are going to take in normal operation
-#define         READ_SAMPLE_TIMES            (5)     //define the time interval(in milisecond) between each samples in
-                                                     //normal operation
+#define         READ_OVERSAMPLE              (16)    //define how many conversions the ADC averages into each sample
+#define         READ_MEDIAN_LEN              (5)     //define how many samples the moving median takes, to drop spikes
+#define         READ_LOWPASS                 NODE_FILTER_LOWPASS_0_1
+                                                     //define the low-pass filter, cutoff at 0.1 of the sample rate:
+                                                     //0.05 Hz with one sample per NODE_SENSOR_SKU_PERIOD_MS of 2000
 /**********************Application Related Macros**********************************/
 //These two values differ from sensor to sensor. user should derermine this value.
 #define         ZERO_POINT_VOLTAGE           (0.305) //define the output of the sensor in volts when the concentration of CO2 is 400PPM
 #define         REACTION_VOLTGAE             (0.030) //define the voltage drop of the sensor when move the sensor from air into 1000ppm CO2
 /*****************************Globals***********************************************/
-float           CO2Curve[3]  =  {2.602,ZERO_POINT_VOLTAGE,(REACTION_VOLTGAE/(2.602-3))};
+static const struct node_fixmath_curve CO2Curve = NODE_FIXMATH_CURVE(2.602,ZERO_POINT_VOLTAGE,(REACTION_VOLTGAE/(2.602-3)));
                                                      //two points are taken from the curve.
                                                      //with these two points, a line is formed which is
                                                      //"approximately equivalent" to the original curve.
                                                      //data format:{ x, y, slope}; point1: (lg400, 0.324), point2: (lg4000, 0.280)
                                                      //slope = ( reaction voltage ) / (log400 –log1000)
 
-AnalogIn ain(MG_PIN);
+AnalogInBurst ain(MG_PIN);
+static struct node_filter mg_filter;
 
 static unsigned int co2_sensor_value = 0;
 #endif
@@ -51,14 +65,44 @@ static unsigned int co2_sensor_value = 0;
 #define NODE_SENSOR_TEMP_HUM_ENABLE    1    ///< Enable or disable TEMP/HUM sensor report, default disable
 #define NODE_SENSOR_CO2_VOC_ENABLE     0   ///< Enable or disable CO2/VOC sensor report, default disable
 
+/* Sensor tasks share one scheduler thread; each may run up to its tolerance late to share a wakeup */
+#define NODE_SENSOR_TEMP_HUM_PERIOD_MS 1000
+#define NODE_SENSOR_TEMP_HUM_TOL_MS    500
+#define NODE_SENSOR_CO2_VOC_PERIOD_MS  3000 ///< IAQ-Core needs 2 sec between reads: period less tolerance
+#define NODE_SENSOR_CO2_VOC_TOL_MS     1000
+#define NODE_SENSOR_SKU_PERIOD_MS      2000 ///< SEN0159 sample interval, one reading per filtered sample
+#define NODE_SENSOR_SKU_TOL_MS         500
+#define NODE_TIMEBASE_RTC_TOL_MS       60000 ///< RTC samples of the timebase; their exact time does not matter
+
 #define NODE_DEBUG(x,args...) node_printf_to_serial(x,##args)
 
 #define NODE_DEEP_SLEEP_MODE_SUPPORT   1    ///< Flag to Enable/Disable deep sleep mode
 #define NODE_ACTIVE_PERIOD_IN_SEC      (node_sensor_report_interval)     ///< Period time to read/send sensor data  >= 3sec
 #define NODE_RXWINDOW_PERIOD_IN_SEC    4    ///< Rx windown time  
 #define NODE_ACTIVE_TX_PORT            1    ///< Lora Port to send data
+#define NODE_CFG_RX_PORT               10   ///< Lora Port of downlink settings, kept in node_kvstore
+#define NODE_BACKLOG_TX_PORT           2    ///< Lora Port to replay journaled data
+/*
+ * Journal wear while unjoined: a sensor frame of up to 30 bytes takes a 48 byte
+ * record, so a 2 KB sector holds 42 and the 8 sector ring 336 per erase lap.
+ * At 10k erase cycles that is 3.3M records: one frame per minute while unjoined
+ * lasts over 6 years, one per 10 sec report barely one. Frames equal to the
+ * last one journaled are skipped as well.
+ */
+#define NODE_UNJOINED_SPOOL_SEC        60   ///< Shortest time between frames journaled while unjoined
+#define NODE_BACKLOG_FRAME_MAX         64   ///< Longest backlog frame, at data rates that allow it
+#define NODE_ENERGY_REPORT_UPLINKS     24   ///< Uplinks between energy reports on the debug port
+
+#define NODE_KV_RPT_INTVL              "rpt_intvl"  ///< Report interval set by downlink, in seconds
 
 #define NODE_M2_COM_UART 0    ///< Declare M2 COM UART for easy debug
+#define NODE_SAPI_ENABLE 0    ///< Binary provisioning API on the M2 COM UART; its receiver keeps the MCU out of deep sleep
+
+#if NODE_SAPI_ENABLE && NODE_M2_COM_UART
+#undef NODE_M2_COM_UART
+#define NODE_M2_COM_UART 0    ///< The SAPI server owns the M2 COM UART, so debug output stays on the debug port
+#endif
+
 #define NODE_WISE_1510E MBED_CONF_TARGET_LSE_AVAILABLE
 
 #define SENSOR1_IO_PIN	GPIO0
@@ -105,8 +149,21 @@ volatile node_state_t node_state = NODE_STATE_INIT;
 static char node_class=1;
 static char node_op_mode=1;
 static char node_act_mode=1;
+static unsigned char node_data_rate=2;
 static char node_beacon_state=NODE_BCN_STATE_LOTTERY1;
 
+static volatile bool node_tx_result_pending=false;   ///< TX done callback ran, result not yet handled
+static volatile unsigned char node_tx_rc;
+/*
+ * Application payload limit of each uplink data rate: the smallest of EU868,
+ * US915 and AS923 with dwell time limits (11 bytes at US915 DR0 and AS923 DR2).
+ */
+static const unsigned char node_backlog_payload_max[]={11, 51, 11, 53, 125, 242, 242, 242};
+
+static char node_tx_frame[64];                       ///< Live frame of the last uplink, journaled if it fails
+static unsigned char node_tx_frame_len;
+static unsigned int node_tx_backlog;                 ///< Journaled frames carried by the last uplink
+
 #if NODE_SENSOR_TEMP_HUM_ENABLE
 static unsigned int  node_sensor_temp_hum=0; ///<Temperature and humidity sensor global
 #endif
@@ -178,20 +235,22 @@ unsigned int iaq_core_sensor(void)
     return vc;
 }
 
-/** @brief TVOC and CO2 sensor thread
+/** @brief TVOC and CO2 sensor init
  *
  */
-static void node_sensor_voc_co2_thread(void const *args) 
+static void node_sensor_voc_co2_init(void)
 {
     char data_write[1];
     data_write[0]=0x06;//0x2;
     i2c.write(0xe0, data_write, 1, 0); // i2c expander enable channel_1 and ch2,no stop
-     
-    while(1) 
-    {      
-        node_sensor_voc_co2=( unsigned int)iaq_core_sensor();
-        Thread::wait(2000);//need more than 2 sec to read 
-    }
+}
+
+/** @brief TVOC and CO2 sensor task
+ *
+ */
+static void node_sensor_voc_co2_task(void)
+{
+    node_sensor_voc_co2=( unsigned int)iaq_core_sensor();
 }
 #endif
 
@@ -209,6 +268,7 @@ static unsigned int hdc1510_sensor(void)
     
     data_write[0]=HDC1510_REG_TEMP;
 
+    node_energy_load(NODE_ENERGY_SENSOR1, 1);
     #if NODE_DEEP_SLEEP_MODE_SUPPORT
     if(node_op_mode==4)
     {
@@ -229,59 +289,57 @@ static unsigned int hdc1510_sensor(void)
     Thread::wait(50);
     i2c.read(HDC1510_ADDR, data_read, 4, 0);
     #endif
+    node_energy_load(NODE_ENERGY_SENSOR1, 0);
     
-    float tempval = (float)((data_read[0] << 8 | data_read[1]) * 165.0 / 65536.0 - 40.0);
-
     /*Temperature*/
-    int ss = tempval*100;
+    int ss = node_fixmath_hdc1010_temp(data_read[0] << 8 | data_read[1]);
     unsigned int yy=0;
-    //printf("Temperature: %.2f C\r\n",tempval );
+    //printf("Temperature: %d.%02d C\r\n",ss/100,abs(ss%100));
     /*Humidity*/
-    float hempval = (float)((data_read[2] << 8 | data_read[3]) * 100.0 / 65536.0);   
-    yy=hempval*100;
-    // printf("Humidity: %.2f %\r\n",hempval);
+    yy = node_fixmath_hdc1010_hum(data_read[2] << 8 | data_read[3]);
+    // printf("Humidity: %u.%02u %\r\n",yy/100,yy%100);
 
     return (yy<<16)|ss; 
 }
 
-/** @brief Temperature and humidity sensor thread
+/** @brief Temperature and humidity sensor task
  *
  */
-static void node_sensor_temp_hum_thread(void const *args)
+static void node_sensor_temp_hum_task(void)
 {
-    while(1) 
-    {
-        Thread::wait(1000);
-        node_sensor_temp_hum=(unsigned int )hdc1510_sensor();
-    }
+    node_sensor_temp_hum=(unsigned int )hdc1510_sensor();
 }
 #endif
 
 
 #if HYUNJAE         /* Creation Date : 20210425 */
-/*****************************  MGRead *********************************************
-Input:   mg_pin - analog channel
-Output:  output of SEN-000007
-Remarks: This function reads the output of SEN-000007
+/*****************************  MGInit *********************************************
+Input:   none
+Output:  NODE_FILTER_OK, or negative error if the filter settings are invalid
+Remarks: This function sets up the filter of the SEN-000007 samples
 ************************************************************************************/
-float MGRead(void)
+int MGInit(void)
 {
-    int i;
-    float v=0;
+    static const struct node_filter_config config = { READ_MEDIAN_LEN, READ_LOWPASS, 1.0f };
 
-    for (i=0;i<READ_SAMPLE_TIMES;i++) {
-        v += ain;
-        // delay(READ_SAMPLE_INTERVAL);
-        Thread::wait(1000);
+    return node_filter_init(&mg_filter, &config);
+}
 
-    }
-    //v = (v/READ_SAMPLE_TIMES) *5/1024 ;
-    v = (v/READ_SAMPLE_TIMES) *3.42 ;
-    return v;
+/*****************************  MGRead *********************************************
+Input:   none
+Output:  output of SEN-000007 as read_u16(), filtered
+Remarks: This function takes one sample of SEN-000007 per call, so that the
+         sampling interval is left to the caller
+************************************************************************************/
+unsigned int MGRead(void)
+{
+    float v = node_filter_update(&mg_filter, ain.read_average_u16(READ_OVERSAMPLE));
+
+    return (v > 0.0f) ? (unsigned int)(v + 0.5f) : 0;
 }
 
 /*****************************  MQGetPercentage **********************************
-Input:   volts   - SEN-000007 output measured in volts
+Input:   raw     - SEN-000007 output as read_u16()
          pcurve  - pointer to the curve of the target gas
 Output:  ppm of the target gas
 Remarks: By using the slope and a point of the line. The x(logarithmic value of ppm)
@@ -289,26 +347,20 @@ Remarks: By using the slope and a point of the line. The x(logarithmic value of
          logarithmic coordinate, power of 10 is used to convert the result to non-logarithmic
          value.
 ************************************************************************************/
-int  MGGetPercentage(float volts, float *pcurve)
+int  MGGetPercentage(unsigned int raw, const struct node_fixmath_curve *pcurve)
 {
-   if ((volts/DC_GAIN )>=ZERO_POINT_VOLTAGE) {
-      return -1;
-   } else {
-      return pow(10, ((volts/DC_GAIN)-pcurve[1])/pcurve[2]+pcurve[0]);
-   }
+   return node_fixmath_curve_ppm(pcurve, node_fixmath_scale(raw, MG_VOLTS_PER_LSB));
 }
 
-static unsigned int co2_sensor_sku_sen0159(void)
+static unsigned int co2_sensor_sku_sen0159(unsigned int raw)
 {
     int percentage;
-    float volts;
 
-    volts = MGRead();
     NODE_DEBUG("SEN0159 : ");
-    NODE_DEBUG("%f",volts);
-    NODE_DEBUG(" V           ");
+    NODE_DEBUG("%u",raw*MG_MV_FULL_SCALE/65535);
+    NODE_DEBUG(" mV          ");
 
-    percentage = MGGetPercentage(volts,CO2Curve);
+    percentage = MGGetPercentage(raw,&CO2Curve);
     NODE_DEBUG("CO2:");
     if (percentage == -1) {
         NODE_DEBUG(" <400 ");
@@ -317,18 +369,15 @@ static unsigned int co2_sensor_sku_sen0159(void)
     }
 
     NODE_DEBUG(" ppm " );
+    NODE_DEBUG(" (%u mV since report)",(unsigned int)node_filter_change(&mg_filter)*MG_MV_FULL_SCALE/65535);
     NODE_DEBUG("\n\r");
 
     return percentage;
 }
 
-static void node_sensor_sku_thread(void const *args)
+static void node_sensor_sku_task(void)
 {
-    while(1){
-        Thread::wait(1000);
-        NODE_DEBUG("HYUNJAE : Thread test \r\n");
-        co2_sensor_value = co2_sensor_sku_sen0159(); 
-    }
+    co2_sensor_value = co2_sensor_sku_sen0159(MGRead());
 }
 #endif
 
@@ -337,7 +386,9 @@ static void node_sensor_sku_thread(void const *args)
  */
 int node_tx_done_cb(unsigned char rc)
 {
-
+    node_energy_tx_done();
+    node_tx_rc=rc;
+    node_tx_result_pending=true;
     node_state=NODE_STATE_LOWPOWER;
     return 0;
 }
@@ -360,6 +411,9 @@ int node_beacon_cb(unsigned char state, short rssi, signed char snr)
 {
     node_beacon_state=NODE_BCN_STATE_LOTTERY1;
 
+    if(state<=NODE_BCN_STATE_LOTTERY2 || state==NODE_BCN_STATE_BCN_FOUND)
+        node_timebase_beacon();
+
     switch(state)
     {
         case NODE_BCN_STATE_LOTTERY1:
@@ -526,12 +580,21 @@ void node_get_config()
         NODE_DEBUG("DevRptIntvlSec=%d\r\n", node_sensor_report_interval);
     }
 
+    /* A report interval set by downlink overrides the module config */
+    unsigned int rpt_intvl;
+    if(node_kv_get(NODE_KV_RPT_INTVL, &rpt_intvl, sizeof(rpt_intvl))==sizeof(rpt_intvl))
+    {
+        node_sensor_report_interval=rpt_intvl;
+        NODE_DEBUG("DevRptIntvlSec=%d (downlink)\r\n", node_sensor_report_interval);
+    }
+
     if(node_op_mode==1||node_op_mode==2)
     {
         memset(buf_out, 0, 256);
         ret=nodeApiGetDevAdvwiseDataRate(buf_out, 256);
         if(ret==NODE_API_OK)
         {
+            node_data_rate=atoi(buf_out);
             NODE_DEBUG("DevAdvwiseDataRate=%s\r\n", buf_out);
         }
     }
@@ -610,6 +673,7 @@ unsigned char node_get_sensor_data (char *data)
     len++; 
     sensor_data[len+2]=co2_sensor_value&0xff;
     len++; 
+    node_filter_mark(&mg_filter);
     
 
     #endif
@@ -659,6 +723,99 @@ unsigned char node_get_sensor_data (char *data)
 }
 
 
+/** @brief Keep a frame that could not be sent in the journal
+ *
+ *  @param frame sensor data
+ *  @param frame_len data length
+ */
+static void node_spool_frame(const char *frame, unsigned char frame_len)
+{
+    if(frame_len==0)
+        return;
+
+    if(node_journal_append(frame, frame_len)!=NODE_JOURNAL_OK)
+        NODE_DEBUG("Journal append failed\r\n");
+}
+
+/** @brief Pack the oldest journaled frames into one uplink
+ *
+ *  Each frame is sent as [seq high][seq low][length][data]. Frames are packed up
+ *  to the payload limit of the data rate; the oldest frame is sent on its own
+ *  even if it exceeds it, as the live frame would be.
+ *  @param data backlog frame, NODE_BACKLOG_FRAME_MAX bytes
+ *  @param count number of journaled frames packed
+ *  @returns data_length
+ */
+static unsigned char node_get_backlog_data(char *data, unsigned int *count)
+{
+    unsigned char len=0;
+    unsigned char max_len=NODE_BACKLOG_FRAME_MAX;
+    unsigned int seq;
+    int ret;
+
+    if(node_data_rate<sizeof(node_backlog_payload_max)&&node_backlog_payload_max[node_data_rate]<max_len)
+        max_len=node_backlog_payload_max[node_data_rate];
+
+    *count=0;
+    while(len+3<NODE_BACKLOG_FRAME_MAX)
+    {
+        ret=node_journal_peek(*count, &seq, &data[len+3], NODE_BACKLOG_FRAME_MAX-len-3);
+        if(ret<0||len+3+ret>NODE_BACKLOG_FRAME_MAX)
+            break;
+        if(*count>0&&len+3+ret>max_len)
+            break;
+
+        data[len]=(seq>>8)&0xff;
+        data[len+1]=seq&0xff;
+        data[len+2]=ret;
+        len+=3+ret;
+        (*count)++;
+    }
+
+    return len;
+}
+
+/** @brief Print the energy used so far and the battery life it projects
+ *
+ */
+static void node_energy_print()
+{
+    struct node_energy_report report;
+
+    node_energy_get_report(&report);
+    NODE_DEBUG("Energy: %.1f uAh (run %.1f, deep sleep %.1f, tx %.1f, rx %.1f, sensor %.1f)\r\n",
+               report.total_uah, report.charge_uah[NODE_ENERGY_RUN], report.charge_uah[NODE_ENERGY_DEEP_SLEEP],
+               report.charge_uah[NODE_ENERGY_RADIO_TX], report.charge_uah[NODE_ENERGY_RADIO_RX],
+               report.charge_uah[NODE_ENERGY_SENSOR1]);
+    NODE_DEBUG("Energy: %.2f uAh/uplink, %.3f mAh/day, %.0f days on %d mAh\r\n",
+               report.uah_per_uplink, report.mah_per_day, report.battery_days, NODE_ENERGY_BATTERY_MAH);
+}
+
+/** @brief Handle the result of the last uplink
+ *
+ */
+static void node_tx_result()
+{
+    static unsigned int uplinks=0;
+
+    node_tx_result_pending=false;
+    if(++uplinks%NODE_ENERGY_REPORT_UPLINKS==0)
+        node_energy_print();
+
+    if(node_tx_rc==NODE_TXDONE_RC_TXNOK)
+    {
+        /* Journaled frames stay journaled; the live frame joins them */
+        if(node_tx_backlog==0)
+            node_spool_frame(node_tx_frame, node_tx_frame_len);
+    }
+    else if(node_tx_backlog)
+    {
+        if(node_journal_ack(node_tx_backlog)!=NODE_JOURNAL_OK)
+            NODE_DEBUG("Journal ack failed\r\n");
+    }
+    node_tx_backlog=0;
+}
+
 /** @brief An loop to read and send sensor data via LoRa periodically
  *  
  */
@@ -685,10 +842,30 @@ void node_state_loop()
     {
         if(nodeApiJoinState()==0)
         {   
+            static unsigned int unjoined_sec=0;
+
             if(join_state==2)
                 NODE_DEBUG("LoRa is not joined.\r\n");  
 
             Thread::wait(1000);
+
+            /* Keep reading, replayed after joining; the rate is bounded for flash wear */
+            if(++unjoined_sec>=NODE_ACTIVE_PERIOD_IN_SEC&&unjoined_sec>=NODE_UNJOINED_SPOOL_SEC)
+            {
+                static char last_frame[64];
+                static unsigned char last_frame_len=0;
+                char frame[64]={};
+                unsigned char frame_len;
+
+                unjoined_sec=0;
+                frame_len=node_get_sensor_data(frame);
+                if(frame_len!=last_frame_len||memcmp(frame, last_frame, frame_len)!=0)
+                {
+                    node_spool_frame(frame, frame_len);
+                    memcpy(last_frame, frame, frame_len);
+                    last_frame_len=frame_len;
+                }
+            }
             
             join_state=1;
             continue;
@@ -714,6 +891,9 @@ void node_state_loop()
 
             join_state=2;       
         }
+
+        if(node_tx_result_pending)
+            node_tx_result();
     
         switch(node_state)
         {
@@ -746,6 +926,7 @@ void node_state_loop()
                         *p_lpin=0;
                         nodeApiSetDevSleepRTCWakeup(NODE_ACTIVE_PERIOD_IN_SEC-NODE_RXWINDOW_PERIOD_IN_SEC);
                         *p_lpin=1;
+                        node_energy_deep_sleep(NODE_ACTIVE_PERIOD_IN_SEC-NODE_RXWINDOW_PERIOD_IN_SEC);
                         #else
                         Thread::wait((NODE_ACTIVE_PERIOD_IN_SEC-NODE_RXWINDOW_PERIOD_IN_SEC)*1000);
                         #endif
@@ -761,6 +942,7 @@ void node_state_loop()
             {
                 int i=0,ret=0;
                 unsigned char frame_len=0;
+                unsigned char port=NODE_ACTIVE_TX_PORT;
                 char frame[64]={};
                 
                 frame_len=node_get_sensor_data(frame);
@@ -771,14 +953,36 @@ void node_state_loop()
                     break;
                 }
 
+                memcpy(node_tx_frame, frame, frame_len);
+                node_tx_frame_len=frame_len;
+                node_tx_backlog=0;
+
+                /*
+                 * While a backlog is pending, the live frame queues behind it and the
+                 * uplink of this period replays the oldest frames instead, so the
+                 * backlog drains without extra uplinks against the duty cycle.
+                 */
+                if(node_journal_pending())
+                {
+                    node_spool_frame(frame, frame_len);
+                    frame_len=node_get_backlog_data(frame, &node_tx_backlog);
+                    port=NODE_BACKLOG_TX_PORT;
+
+                    if(frame_len==0)
+                    {
+                        node_state=NODE_STATE_LOWPOWER;
+                        break;
+                    }
+                }
 
                 if(node_beacon_state==NODE_BCN_STATE_SPS)
-                    ret=nodeApiSendDataHighPri(NODE_ACTIVE_TX_PORT, frame, frame_len);
+                    ret=nodeApiSendDataHighPri(port, frame, frame_len);
                 else
-                    ret=nodeApiSendData(NODE_ACTIVE_TX_PORT, frame, frame_len);
+                    ret=nodeApiSendData(port, frame, frame_len);
 
                 if(ret==0)
                 {
+                    node_energy_tx_start(node_data_rate, frame_len);
                     NODE_DEBUG("TX: ");
 
                     for(i=0;i<frame_len;i++)
@@ -793,6 +997,9 @@ void node_state_loop()
                 else
                 {
                     NODE_DEBUG("TX: Forbidden!\n\r ");
+                    if(node_tx_backlog==0)
+                        node_spool_frame(frame, frame_len);
+                    node_tx_backlog=0;
                     node_state=NODE_STATE_LOWPOWER;
                 }
             }
@@ -822,6 +1029,18 @@ void node_state_loop()
                     // Downlink data handling
                                    // Data port of downlink is the same as uplinlk Tag ID in TLV format
                     //
+                    if(node_rx_done_data.data_port==NODE_CFG_RX_PORT && node_rx_done_data.data_len==2)
+                    {
+                        /* Report interval in seconds, big endian; only this field is written to flash */
+                        unsigned int rpt_intvl=(node_rx_done_data.data[0]<<8)|node_rx_done_data.data[1];
+                        if(rpt_intvl>=3)
+                        {
+                            node_sensor_report_interval=rpt_intvl;
+                            if(node_kv_set(NODE_KV_RPT_INTVL, &rpt_intvl, sizeof(rpt_intvl))!=NODE_KV_OK)
+                                NODE_DEBUG("Save DevRptIntvlSec failed\r\n");
+                        }
+                    }
+
                     #if NODE_GPIO_ENABLE
                     if(node_rx_done_data.data_port==5 && node_rx_done_data.data_len==1)
                     {
@@ -858,21 +1077,22 @@ void node_state_loop()
 }
 
 
+/** @brief Add a task to the wake scheduler, logging a failure
+ */
+static void node_wake_schedule(const char *name, unsigned int period_ms, unsigned int tolerance_ms, node_wake_fp fp)
+{
+    int ret=node_wake_add(period_ms, tolerance_ms, fp);
+
+    if(ret<0)
+        NODE_DEBUG("Schedule %s task failed: %d\r\n", name, ret);
+}
+
+
 /** @brief Main function
  */
 int main () 
 {
-    /*Create sensor thread*/
-    #if NODE_SENSOR_TEMP_HUM_ENABLE
-    Thread *p_node_sensor_temp_hum_thread;
-    #endif
-    #if NODE_SENSOR_CO2_VOC_ENABLE
-    Thread *p_node_sensor_co2_thread;
-    #endif
-    
-    #if HYUNJAE             /* creation date : 20210425 */
-    Thread *p_node_sensor_sku_thread;
-    #endif
+    int ret;
 
     /* Init carrier board, must be first step */
     nodeApiInitCarrierBoard();
@@ -885,15 +1105,26 @@ int main ()
 	nodeApiInit(&debug_serial, &debug_serial);
 	#endif
 
+    node_timebase_init();
+
+    /*Schedule sensor tasks*/
     #if NODE_SENSOR_TEMP_HUM_ENABLE
-    p_node_sensor_temp_hum_thread=new Thread(node_sensor_temp_hum_thread);
+    node_wake_schedule("temp/hum", NODE_SENSOR_TEMP_HUM_PERIOD_MS, NODE_SENSOR_TEMP_HUM_TOL_MS, node_sensor_temp_hum_task);
     #endif
     #if NODE_SENSOR_CO2_VOC_ENABLE
-    p_node_sensor_co2_thread=new Thread(node_sensor_voc_co2_thread);
+    node_sensor_voc_co2_init();
+    node_wake_schedule("CO2/VOC", NODE_SENSOR_CO2_VOC_PERIOD_MS, NODE_SENSOR_CO2_VOC_TOL_MS, node_sensor_voc_co2_task);
     #endif
     #if HYUNJAE             /* creation date : 20210425 */
-    p_node_sensor_sku_thread = new Thread(node_sensor_sku_thread);
-    #endif    
+    if(MGInit()!=NODE_FILTER_OK)
+        NODE_DEBUG("MG filter init failed\r\n");
+    else
+        node_wake_schedule("SKU", NODE_SENSOR_SKU_PERIOD_MS, NODE_SENSOR_SKU_TOL_MS, node_sensor_sku_task);
+    #endif
+    node_wake_schedule("RTC", NODE_TIMEBASE_RTC_PERIOD_S*1000, NODE_TIMEBASE_RTC_TOL_MS, node_timebase_rtc);
+    ret=node_wake_start();
+    if(ret!=NODE_WAKE_OK)
+        NODE_DEBUG("Wake scheduler start failed: %d\r\n", ret);
 
     /* Display version information */
     NODE_DEBUG("\f");
@@ -935,8 +1166,23 @@ int main ()
     /* Apply to module */
     nodeApiApplyCfg();
 
+    if(node_kv_init()!=NODE_KV_OK)
+        NODE_DEBUG("KV store init failed\r\n");
+
+    node_energy_init();
+
+    if(node_journal_init()!=NODE_JOURNAL_OK)
+        NODE_DEBUG("Journal init failed\r\n");
+    else if(node_journal_pending())
+        NODE_DEBUG("Journal: %d frames to replay\r\n", node_journal_pending());
+
     node_get_config();  
 
+    #if NODE_SAPI_ENABLE
+    if(node_sapi_start(PC_4, PB_11, 115200)!=NODE_SAPI_OK)
+        NODE_DEBUG("SAPI start failed\r\n");
+    #endif
+
 	#if NODE_DEEP_SLEEP_MODE_SUPPORT
 	if(node_op_mode==1)
 	{
@@ -0,0 +1,137 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Bus idle time of a multi-segment access, as a chain and as transfer() calls
+ * issued from each callback. The fake bus clock only moves for time on the
+ * wire and for requested delays, so "idle us" is the idle time the driver
+ * adds by itself and should stay 0. The host clock gives the cost of each
+ * segment handoff, which is the remaining idle time on a target. Run the -O2
+ * build; the handoff numbers are only meaningful relative to each other. */
+#include <stdio.h>
+#include <time.h>
+#include "drivers/SPI.h"
+#include "drivers/DigitalOut.h"
+#include "spi_api_fake.h"
+
+using namespace mbed;
+
+#define BENCH_CLOCK_HZ      8000000
+#define BENCH_ROUNDS        20000
+#define BENCH_SEGMENTS      4
+
+static SPI *spi;
+static DigitalOut *cs;
+static char tx[BENCH_SEGMENTS][16];
+static char rx[BENCH_SEGMENTS][16];
+static int next_segment;
+static bool finished;
+
+static uint64_t host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void chain_done(int)
+{
+    finished = true;
+}
+
+// What a driver without chains does: one transfer() per callback, with the
+// chip select driven around it by the callback itself
+static void sequence_done(int)
+{
+    if (next_segment == BENCH_SEGMENTS) {
+        cs->write(1);
+        finished = true;
+        return;
+    }
+    int i = next_segment++;
+    spi->transfer((const char *)tx[i], sizeof(tx[i]), (char *)rx[i], sizeof(rx[i]),
+                  callback(sequence_done));
+}
+
+static void start_chain(void)
+{
+    static SPI::Segment segments[BENCH_SEGMENTS];
+    for (int i = 0; i < BENCH_SEGMENTS; i++) {
+        segments[i].tx_buffer = tx[i];
+        segments[i].rx_buffer = rx[i];
+        segments[i].length = sizeof(tx[i]);
+        segments[i].cs_release = false;
+        segments[i].delay_us = 0;
+    }
+    spi->transfer_chain(segments, BENCH_SEGMENTS, cs, callback(chain_done));
+}
+
+static void start_sequence(void)
+{
+    cs->write(0);
+    next_segment = 1;
+    spi->transfer((const char *)tx[0], sizeof(tx[0]), (char *)rx[0], sizeof(rx[0]),
+                  callback(sequence_done));
+}
+
+// Bus idle time between the segments of one access, in fake microseconds
+static uint32_t idle_us(void)
+{
+    uint32_t idle = 0;
+    for (int i = 1; i < spi_fake_transfer_count; i++) {
+        idle += spi_fake_transfers[i].start_us - spi_fake_transfers[i - 1].end_us;
+    }
+    return idle;
+}
+
+static void run(const char *name, void (*start)(void))
+{
+    uint32_t idle = 0;
+    uint32_t wire = 0;
+    uint64_t handoff_ns = 0;
+
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        spi_fake_reset();
+        spi_fake_set_clock(BENCH_CLOCK_HZ);
+        finished = false;
+        start();
+        while (!finished) {
+            uint64_t t0 = host_ns();
+            spi_fake_complete(SPI_EVENT_COMPLETE);
+            handoff_ns += host_ns() - t0;
+        }
+        idle += idle_us();
+        wire += spi_fake_transfers[spi_fake_transfer_count - 1].end_us;
+    }
+
+    printf("%-10s %12.2f %12.2f %14.1f\n", name,
+           (double)idle / BENCH_ROUNDS, (double)wire / BENCH_ROUNDS,
+           (double)handoff_ns / ((uint64_t)BENCH_ROUNDS * BENCH_SEGMENTS));
+}
+
+int main()
+{
+    SPI bus(P0_0, P0_1, P0_2);
+    DigitalOut select(P0_3, 1);
+    spi = &bus;
+    cs = &select;
+
+    printf("%d segments of %d bytes at %d Hz, %d rounds\n",
+           BENCH_SEGMENTS, (int)sizeof(tx[0]), BENCH_CLOCK_HZ, BENCH_ROUNDS);
+    printf("%-10s %12s %12s %14s\n", "", "idle us", "access us", "ns/segment");
+    run("chain", start_chain);
+    run("sequence", start_sequence);
+    return 0;
+}
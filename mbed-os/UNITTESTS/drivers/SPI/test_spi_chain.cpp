@@ -0,0 +1,355 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of the SPI transfer chains, on the fake HAL of UNITTESTS/stubs */
+#include "gtest/gtest.h"
+#include "drivers/SPI.h"
+#include "drivers/DigitalOut.h"
+#include "spi_api_fake.h"
+
+using namespace mbed;
+
+// Order in which the callbacks ran, one letter each, and the events they got
+static char callbacks[16];
+static int callback_events[16];
+static int callback_count;
+
+static void done(char name, int event)
+{
+    if (callback_count < (int)sizeof(callbacks) - 1) {
+        callback_events[callback_count] = event;
+        callbacks[callback_count++] = name;
+    }
+}
+
+static void done_a(int event)
+{
+    done('a', event);
+}
+
+static void done_b(int event)
+{
+    done('b', event);
+}
+
+class TestSPIChain : public testing::Test {
+protected:
+    TestSPIChain() : spi(P0_0, P0_1, P0_2), cs(P0_3, 1)
+    {
+    }
+
+    virtual void SetUp()
+    {
+        spi_fake_reset();
+        memset(callbacks, 0, sizeof(callbacks));
+        memset(callback_events, 0, sizeof(callback_events));
+        callback_count = 0;
+        memset(rx, 0, sizeof(rx));
+    }
+
+    virtual void TearDown()
+    {
+        spi.abort_all_transfers();
+    }
+
+    // Chip select releases logged so far
+    static int cs_releases()
+    {
+        int n = 0;
+        for (int i = 0; i < spi_fake_gpio_write_count; i++) {
+            n += spi_fake_gpio_writes[i].value;
+        }
+        return n;
+    }
+
+    SPI spi;
+    DigitalOut cs;
+    char rx[4][4];
+};
+
+static const char tx_cmd[4] = { 0x0B, 0x01, 0x02, 0x03 };
+static const char tx_data[4] = { 0x10, 0x11, 0x12, 0x13 };
+static const char tx_other[4] = { 0x20, 0x21, 0x22, 0x23 };
+
+TEST_F(TestSPIChain, transfer_waits_for_chain_delay)
+{
+    SPI::Segment segments[2] = {
+        { tx_cmd, rx[0], 4, true, 100 },
+        { tx_data, rx[1], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(segments, 2, &cs, callback(done_a)));
+    ASSERT_EQ(1, spi_fake_transfer_count);
+    EXPECT_EQ(0, spi_fake_transfers[0].cs);
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_EQ(1, cs.read());
+
+    // The peripheral is idle during the delay, but the chain still owns the bus
+    ASSERT_EQ(0, spi.transfer(tx_other, 4, rx[2], 4, callback(done_b)));
+    EXPECT_EQ(1, spi_fake_transfer_count);
+
+    us_ticker_fake_advance(99);
+    EXPECT_EQ(1, spi_fake_transfer_count);
+    us_ticker_fake_advance(1);
+    ASSERT_EQ(2, spi_fake_transfer_count);
+    EXPECT_EQ(tx_data, spi_fake_transfers[1].tx);
+    EXPECT_EQ(100u, spi_fake_transfers[1].start_us);
+    EXPECT_EQ(0, spi_fake_transfers[1].cs);
+
+    // The queued transfer starts when the chain ends, before its callback
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_STREQ("a", callbacks);
+    ASSERT_EQ(3, spi_fake_transfer_count);
+    EXPECT_EQ(tx_other, spi_fake_transfers[2].tx);
+    EXPECT_EQ(1, spi_fake_transfers[2].cs);
+
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_STREQ("ab", callbacks);
+    EXPECT_EQ(0, memcmp(rx[0], tx_cmd, 4));
+    EXPECT_EQ(0, memcmp(rx[1], tx_data, 4));
+    EXPECT_EQ(0, memcmp(rx[2], tx_other, 4));
+    EXPECT_FALSE(spi_fake_complete(SPI_EVENT_COMPLETE));
+}
+
+TEST_F(TestSPIChain, chain_waits_for_chain_delay)
+{
+    SPI::Segment first[2] = {
+        { tx_cmd, rx[0], 4, true, 50 },
+        { tx_data, rx[1], 4, false, 0 },
+    };
+    SPI::Segment second[1] = {
+        { tx_other, rx[2], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(first, 2, &cs, callback(done_a)));
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    ASSERT_EQ(0, spi.transfer_chain(second, 1, &cs, callback(done_b)));
+    EXPECT_EQ(1, spi_fake_transfer_count);
+
+    us_ticker_fake_advance(50);
+    ASSERT_EQ(2, spi_fake_transfer_count);
+    EXPECT_EQ(tx_data, spi_fake_transfers[1].tx);
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    ASSERT_EQ(3, spi_fake_transfer_count);
+    EXPECT_EQ(tx_other, spi_fake_transfers[2].tx);
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_STREQ("ab", callbacks);
+}
+
+TEST_F(TestSPIChain, abort_during_delay_starts_queued_transfer)
+{
+    SPI::Segment segments[2] = {
+        { tx_cmd, rx[0], 4, true, 100 },
+        { tx_data, rx[1], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(segments, 2, &cs, callback(done_a)));
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    ASSERT_EQ(0, spi.transfer(tx_other, 4, rx[2], 4, callback(done_b)));
+    EXPECT_EQ(1, spi_fake_transfer_count);
+
+    spi.abort_transfer();
+    ASSERT_EQ(2, spi_fake_transfer_count);
+    EXPECT_EQ(tx_other, spi_fake_transfers[1].tx);
+
+    // The delay of the aborted chain must not fire into the new transfer
+    us_ticker_fake_advance(200);
+    EXPECT_EQ(2, spi_fake_transfer_count);
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_STREQ("b", callbacks);
+}
+
+TEST_F(TestSPIChain, cs_released_after_marked_segments_only)
+{
+    SPI::Segment segments[3] = {
+        { tx_cmd, rx[0], 4, true, 0 },
+        { tx_data, rx[1], 4, false, 0 },
+        { tx_other, rx[2], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(segments, 3, &cs, callback(done_a)));
+    EXPECT_EQ(0, cs.read());
+    EXPECT_EQ(0, cs_releases());
+
+    // Released after the first segment, asserted again for the second
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    ASSERT_EQ(2, spi_fake_transfer_count);
+    EXPECT_EQ(1, cs_releases());
+    EXPECT_EQ(0, spi_fake_transfers[1].cs);
+
+    // Held across the second and third
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    ASSERT_EQ(3, spi_fake_transfer_count);
+    EXPECT_EQ(1, cs_releases());
+    EXPECT_EQ(0, spi_fake_transfers[2].cs);
+
+    // Released at the end of the job, before the callback
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_EQ(2, cs_releases());
+    EXPECT_EQ(1, cs.read());
+    EXPECT_STREQ("a", callbacks);
+    EXPECT_EQ(SPI_EVENT_COMPLETE, callback_events[0]);
+}
+
+TEST_F(TestSPIChain, segments_move_their_own_buffers)
+{
+    char rx_only[4];
+    SPI::Segment segments[4] = {
+        { tx_cmd, NULL, 4, false, 0 },          // command, reply discarded
+        { tx_data, rx[0], 2, false, 0 },        // shorter than the buffers
+        { NULL, rx_only, 4, false, 0 },         // read with the fill character
+        { tx_other, rx[1], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(segments, 4, &cs, callback(done_a)));
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(i + 1, spi_fake_transfer_count);
+        ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    }
+
+    EXPECT_EQ(tx_cmd, spi_fake_transfers[0].tx);
+    EXPECT_EQ(4u, spi_fake_transfers[0].tx_length);
+    EXPECT_EQ(0u, spi_fake_transfers[0].rx_length);
+    EXPECT_EQ(2u, spi_fake_transfers[1].tx_length);
+    EXPECT_EQ(2u, spi_fake_transfers[1].rx_length);
+    EXPECT_EQ(0u, spi_fake_transfers[2].tx_length);
+    EXPECT_EQ(rx_only, spi_fake_transfers[2].rx);
+    EXPECT_EQ(4u, spi_fake_transfers[2].rx_length);
+    EXPECT_EQ(0, memcmp(rx[0], tx_data, 2));
+    EXPECT_EQ(0, rx[0][2]);
+    EXPECT_EQ(0, memcmp(rx[1], tx_other, 4));
+    EXPECT_EQ(1, cs_releases());
+    EXPECT_STREQ("a", callbacks);
+}
+
+TEST_F(TestSPIChain, short_delay_spins)
+{
+    SPI::Segment segments[2] = {
+        { tx_cmd, rx[0], 4, true, 10 },         // the default spi-chain-spin-delay
+        { tx_data, rx[1], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(segments, 2, &cs, callback(done_a)));
+    us_ticker_fake_advance(5);
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+
+    // Started from the same interrupt, after the delay
+    ASSERT_EQ(2, spi_fake_transfer_count);
+    EXPECT_EQ(15u, spi_fake_transfers[1].start_us);
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_STREQ("a", callbacks);
+}
+
+TEST_F(TestSPIChain, failed_segment_ends_the_job)
+{
+    SPI::Segment segments[3] = {
+        { tx_cmd, rx[0], 4, false, 0 },
+        { tx_data, rx[1], 4, false, 0 },
+        { tx_other, rx[2], 4, false, 0 },
+    };
+    SPI::Segment next[1] = {
+        { tx_other, rx[3], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(segments, 3, &cs, callback(done_a), SPI_EVENT_ALL));
+    ASSERT_EQ(0, spi.transfer_chain(next, 1, &cs, callback(done_b)));
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_ERROR));
+
+    // The third segment never runs; chip select is released and the queued
+    // job takes over the bus
+    ASSERT_EQ(3, spi_fake_transfer_count);
+    EXPECT_EQ(rx[3], spi_fake_transfers[2].rx);
+    EXPECT_EQ(1, cs_releases());
+    EXPECT_EQ(0, spi_fake_transfers[2].cs);
+    EXPECT_STREQ("a", callbacks);
+    EXPECT_EQ(SPI_EVENT_ERROR, callback_events[0]);
+
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_STREQ("ab", callbacks);
+    EXPECT_EQ(SPI_EVENT_COMPLETE, callback_events[1]);
+}
+
+TEST_F(TestSPIChain, unrequested_events_are_not_reported)
+{
+    SPI::Segment segments[1] = {
+        { tx_cmd, rx[0], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(segments, 1, &cs, callback(done_a), SPI_EVENT_ERROR));
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_EQ(0, callback_count);
+    EXPECT_EQ(1, cs.read());
+    EXPECT_FALSE(spi_fake_busy());
+}
+
+TEST_F(TestSPIChain, abort_during_segment)
+{
+    SPI::Segment segments[2] = {
+        { tx_cmd, rx[0], 4, false, 0 },
+        { tx_data, rx[1], 4, false, 0 },
+    };
+    SPI::Segment next[1] = {
+        { tx_other, rx[2], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(segments, 2, &cs, callback(done_a)));
+    ASSERT_EQ(0, spi.transfer_chain(next, 1, NULL, callback(done_b)));
+
+    // Chip select is released and the aborted job reports nothing
+    spi.abort_transfer();
+    EXPECT_EQ(1, cs.read());
+    EXPECT_EQ(0, callback_count);
+    ASSERT_EQ(2, spi_fake_transfer_count);
+    EXPECT_EQ(tx_other, spi_fake_transfers[1].tx);
+
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_STREQ("b", callbacks);
+    EXPECT_EQ(1, cs_releases());
+}
+
+TEST_F(TestSPIChain, queue_full)
+{
+    SPI::Segment segments[1] = {
+        { tx_cmd, rx[0], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(segments, 1, &cs, callback(done_a)));
+    for (int i = 0; i < TRANSACTION_QUEUE_SIZE_SPI; i++) {
+        ASSERT_EQ(0, spi.transfer_chain(segments, 1, &cs, callback(done_a)));
+    }
+    EXPECT_EQ(-1, spi.transfer_chain(segments, 1, &cs, callback(done_a)));
+
+    for (int i = 0; i <= TRANSACTION_QUEUE_SIZE_SPI; i++) {
+        ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    }
+    EXPECT_EQ(TRANSACTION_QUEUE_SIZE_SPI + 1, callback_count);
+    EXPECT_FALSE(spi_fake_busy());
+}
+
+TEST_F(TestSPIChain, no_chip_select)
+{
+    SPI::Segment segments[2] = {
+        { tx_cmd, rx[0], 4, true, 0 },
+        { tx_data, rx[1], 4, false, 0 },
+    };
+
+    ASSERT_EQ(0, spi.transfer_chain(segments, 2, NULL, callback(done_a)));
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    ASSERT_TRUE(spi_fake_complete(SPI_EVENT_COMPLETE));
+    EXPECT_EQ(0, spi_fake_gpio_write_count);
+    EXPECT_STREQ("a", callbacks);
+}
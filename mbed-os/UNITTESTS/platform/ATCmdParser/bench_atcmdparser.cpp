@@ -0,0 +1,99 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Cost per received character of ATCmdParser::recv() looking for a response
+ * behind lines of other output, next to the sscanf rescan it replaced
+ *
+ *   bench_atcmdparser [lines] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "platform/ATCmdParser.h"
+#include "scripted_file.h"
+#include "rescan_matcher.h"
+
+#define BENCH_LINES     2000
+
+using namespace mbed;
+
+#define BENCH_RUNS      5
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Best of BENCH_RUNS, in ns per character; 0 if the two disagree */
+static void bench(const char *format, const std::string &input, double *recv_ns, double *rescan_ns)
+{
+    *recv_ns = 1e9;
+    *rescan_ns = 1e9;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        ScriptedFile file(input);
+        ATCmdParser parser(&file, "\r\n", 256, 0);
+        int rssi = 0, ber = 0;
+        double start = now_ns();
+        bool matched = parser.recv(format, &rssi, &ber);
+        double ns = (now_ns() - start) / file.pos();
+        *recv_ns = ns < *recv_ns ? ns : *recv_ns;
+
+        RescanMatcher rescan(format);
+        start = now_ns();
+        long pos = rescan.match(input);
+        ns = (now_ns() - start) / pos;
+        *rescan_ns = ns < *rescan_ns ? ns : *rescan_ns;
+
+        if (!matched || (size_t)pos != file.pos() || rssi != 17) {
+            *recv_ns = 0;
+            *rescan_ns = 0;
+            return;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int lines = (argc > 1) ? strtol(argv[1], NULL, 0) : BENCH_LINES;
+    static const int lengths[] = { 16, 64, 128, 240 };
+    const char *format = "+CSQ: %d,%d";
+
+    // Unsolicited output the response has to wait behind: lines that differ
+    // early, and lines that only fail at their end
+    printf("                 other lines, ns/char    near misses, ns/char\n");
+    printf("line length      recv()    rescan        recv()    rescan\n");
+    for (unsigned int l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        std::string other = "+NOISE: " + std::string(lengths[l] - 10, 'a') + "\r\n";
+        std::string near_miss = "+CSQ: " + std::string(lengths[l] - 9, '1') + ";\r\n";
+        std::string input[2];
+        for (int i = 0; i < lines; i++) {
+            input[0] += other;
+            input[1] += near_miss;
+        }
+        double ns[4];
+        for (int k = 0; k < 2; k++) {
+            input[k] += "+CSQ: 17,99\r\n";
+            bench(format, input[k], &ns[2 * k], &ns[2 * k + 1]);
+            if (ns[2 * k] == 0) {
+                printf("recv() and the rescan disagree\n");
+                return 1;
+            }
+        }
+        printf("%11d  %10.1f  %8.1f    %10.1f  %8.1f\n", lengths[l], ns[0], ns[1], ns[2], ns[3]);
+    }
+    return 0;
+}
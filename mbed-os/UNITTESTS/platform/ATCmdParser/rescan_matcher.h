@@ -0,0 +1,89 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef RESCAN_MATCHER_H
+#define RESCAN_MATCHER_H
+
+/* The matching that ATCmdParser::vrecv() did before the compiled matcher:
+ * after every received character, sscanf() runs over the whole line with
+ * the values suppressed, and the line matches once %n reaches its end.
+ * The host tests take it as the reference, the benchmark as the baseline.
+ * "%%" is kept whole; the rescan used to clobber its second '%'. */
+
+#include <stdio.h>
+#include <string>
+
+class RescanMatcher {
+public:
+    /** @param format one line of a recv() format */
+    RescanMatcher(const char *format) : _whole_line_wanted(false)
+    {
+        for (int i = 0; format[i]; i++) {
+            _format += format[i];
+            if (format[i] == '%' && format[i + 1] == '%') {
+                _format += format[++i];
+            } else if (format[i] == '%' && format[i + 1] != '*') {
+                _format += '*';
+            } else if (format[i] == '\n' && !(i >= 2 && format[i - 2] == '[' && format[i - 1] == '^')) {
+                _whole_line_wanted = true;
+                break;
+            }
+        }
+        _format += "%n";
+    }
+
+    /** Find the first match in @a input
+     *
+     * @return number of characters of @a input read up to the match, or -1
+     */
+    long match(const std::string &input) const
+    {
+        std::string line;
+        char prev = 0;
+
+        for (size_t pos = 0; pos < input.size(); pos++) {
+            char c = input[pos];
+            // Newlines are simplified as ATCmdParser does
+            if ((c == '\r' && prev != '\n') || (c == '\n' && prev != '\r')) {
+                prev = c;
+                c = '\n';
+            } else if (c == '\r' || c == '\n') {
+                prev = c;
+                continue;
+            } else {
+                prev = c;
+            }
+            line += c;
+
+            if (!_whole_line_wanted || c == '\n') {
+                int count = -1;
+                sscanf(line.c_str(), _format.c_str(), &count);
+                if (count == (int)line.size()) {
+                    return pos + 1;
+                }
+            }
+            if (c == '\n') {
+                line.clear();
+            }
+        }
+        return -1;
+    }
+
+private:
+    std::string _format;
+    bool _whole_line_wanted;
+};
+
+#endif
@@ -0,0 +1,34 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "scripted_file.h"
+
+namespace mbed {
+
+/* Host build: a poll() that never blocks */
+int poll(pollfh fhs[], unsigned nfhs, int timeout)
+{
+    int count = 0;
+
+    for (unsigned i = 0; i < nfhs; i++) {
+        fhs[i].revents = fhs[i].fh->poll(fhs[i].events) & fhs[i].events;
+        if (fhs[i].revents) {
+            count++;
+        }
+    }
+    return count;
+}
+
+}
@@ -0,0 +1,83 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SCRIPTED_FILE_H
+#define SCRIPTED_FILE_H
+
+/* A FileHandle that plays back a fixed input and records the output, for
+ * the host tests of ATCmdParser; poll() reports it readable until the input
+ * runs out, which the parser then sees as a timeout */
+
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include "platform/FileHandle.h"
+
+class ScriptedFile : public mbed::FileHandle {
+public:
+    ScriptedFile(const std::string &input = "") : _input(input), _pos(0) {}
+
+    void feed(const std::string &input)
+    {
+        _input += input;
+    }
+
+    /** Characters read so far */
+    size_t pos() const
+    {
+        return _pos;
+    }
+
+    const std::string &output() const
+    {
+        return _output;
+    }
+
+    virtual ssize_t read(void *buffer, size_t size)
+    {
+        size_t count = std::min(size, _input.size() - _pos);
+        memcpy(buffer, _input.data() + _pos, count);
+        _pos += count;
+        return count;
+    }
+
+    virtual ssize_t write(const void *buffer, size_t size)
+    {
+        _output.append((const char *)buffer, size);
+        return size;
+    }
+
+    virtual off_t seek(off_t offset, int whence = SEEK_SET)
+    {
+        return -1;
+    }
+
+    virtual int close()
+    {
+        return 0;
+    }
+
+    virtual short poll(short events) const
+    {
+        return (_pos < _input.size() ? POLLIN : 0) | POLLOUT;
+    }
+
+private:
+    std::string _input;
+    size_t _pos;
+    std::string _output;
+};
+
+#endif
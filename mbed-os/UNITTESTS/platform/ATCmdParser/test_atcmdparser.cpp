@@ -0,0 +1,258 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of the ATCmdParser response matcher and oob trie, against the
+ * sscanf rescan it replaced */
+#include <stdlib.h>
+#include "gtest/gtest.h"
+#include "platform/ATCmdParser.h"
+#include "scripted_file.h"
+#include "rescan_matcher.h"
+
+using namespace mbed;
+
+class TestATCmdParser : public testing::Test {
+public:
+    TestATCmdParser() : parser(&file, "\r\n", 256, 0), oob_count(0), other_count(0) {}
+
+    void oob_seen()
+    {
+        oob_count++;
+    }
+
+    void other_seen()
+    {
+        other_count++;
+    }
+
+    void oob_abort()
+    {
+        oob_count++;
+        parser.abort();
+    }
+
+protected:
+    ScriptedFile file;
+    ATCmdParser parser;
+    int oob_count;
+    int other_count;
+};
+
+TEST_F(TestATCmdParser, values_come_from_the_matching_line)
+{
+    int rssi = -1, ber = -1;
+
+    file.feed("AT+CSQ\r\n+CREG: 1\r\n+CSQ: 17,99\r\nOK\r\n");
+    EXPECT_TRUE(parser.recv("+CSQ: %d,%d\n", &rssi, &ber));
+    EXPECT_EQ(17, rssi);
+    EXPECT_EQ(99, ber);
+    EXPECT_TRUE(parser.recv("OK"));
+    EXPECT_EQ(file.pos(), strlen("AT+CSQ\r\n+CREG: 1\r\n+CSQ: 17,99\r\nOK"));
+}
+
+TEST_F(TestATCmdParser, several_lines_in_one_format)
+{
+    char imei[32] = "";
+    unsigned int id = 0;
+    char name[16] = "";
+
+    file.feed("+CGSN: 356938035643809\r\n\r\nOK\r\nID: lora0,0x2a\r\n");
+    EXPECT_TRUE(parser.recv("+CGSN: %31s\nOK\n", imei));
+    EXPECT_STREQ("356938035643809", imei);
+    EXPECT_TRUE(parser.recv("ID: %15[^,],%x\n", name, &id));
+    EXPECT_STREQ("lora0", name);
+    EXPECT_EQ(0x2au, id);
+}
+
+TEST_F(TestATCmdParser, fields_follow_the_sscanf_rules)
+{
+    int a = 0, b = 0;
+    char c = 0;
+    unsigned short h = 0;
+    unsigned long l = 0;
+    char s[8] = "";
+
+    // Widths, length modifiers, whitespace and %%. Without a newline in the
+    // format a line matches as soon as it can, as with the rescan
+    file.feed("12345 x\r\n  -7 ,\t8\r\n100% 0777\r\n65535;4000000000\r\nab:cd\r\n");
+    EXPECT_TRUE(parser.recv("%3d%d %c\n", &a, &b, &c));
+    EXPECT_EQ(123, a);
+    EXPECT_EQ(45, b);
+    EXPECT_EQ('x', c);
+    EXPECT_TRUE(parser.recv("%d , %d\n", &a, &b));
+    EXPECT_EQ(-7, a);
+    EXPECT_EQ(8, b);
+    EXPECT_TRUE(parser.recv("100%% %o\n", &a));
+    EXPECT_EQ(0777, a);
+    EXPECT_TRUE(parser.recv("%hu;%lu\n", &h, &l));
+    EXPECT_EQ(65535, h);
+    EXPECT_EQ(4000000000UL, l);
+    EXPECT_TRUE(parser.recv("%2s:%2c", s, s + 4));
+    EXPECT_STREQ("ab", s);
+    EXPECT_EQ('c', s[4]);
+}
+
+TEST_F(TestATCmdParser, formats_outside_the_subset_still_match)
+{
+    int a = 0, n = 0;
+
+    // %i is not compiled: the sscanf rescan takes over
+    file.feed("VAL 0x10 end\r\n");
+    EXPECT_TRUE(parser.recv("VAL %i end%n", &a, &n));
+    EXPECT_EQ(16, a);
+}
+
+TEST_F(TestATCmdParser, values_match_as_early_as_they_can)
+{
+    unsigned int value = 0;
+
+    file.feed("0x2a\r\n");
+    EXPECT_TRUE(parser.recv("%x", &value));
+    EXPECT_EQ(0u, value);
+    EXPECT_EQ(1u, file.pos());
+}
+
+TEST_F(TestATCmdParser, no_match_runs_into_the_timeout)
+{
+    int a;
+
+    file.feed("+CSQ: x\r\nERROR\r\n");
+    EXPECT_FALSE(parser.recv("+CSQ: %d", &a));
+    EXPECT_EQ(file.pos(), strlen("+CSQ: x\r\nERROR\r\n"));
+}
+
+TEST_F(TestATCmdParser, scanf_returns_the_characters_read)
+{
+    int a = 0;
+
+    file.feed("+X: 42;\r\n");
+    EXPECT_EQ(7, parser.scanf("+X: %d;", &a));
+    EXPECT_EQ(42, a);
+}
+
+TEST_F(TestATCmdParser, oob_during_recv)
+{
+    parser.oob("+UUSORD:", callback(this, &TestATCmdParser::oob_seen));
+
+    file.feed("+UUSORD: 0,12\r\nOK\r\n");
+    EXPECT_TRUE(parser.recv("OK"));
+    EXPECT_EQ(1, oob_count);
+
+    // An oob prefix is only seen at the start of a line
+    file.feed("x+UUSORD: 0,12\r\nOK\r\n");
+    EXPECT_TRUE(parser.recv("OK"));
+    EXPECT_EQ(1, oob_count);
+}
+
+TEST_F(TestATCmdParser, oob_prefixes_share_the_trie)
+{
+    parser.oob("+UUSO", callback(this, &TestATCmdParser::other_seen));
+    parser.oob("+UUSORD:", callback(this, &TestATCmdParser::oob_seen));
+    parser.oob("+UUSORF:", callback(this, &TestATCmdParser::oob_seen));
+
+    // The shortest prefix of a line fires first, as the list scan did
+    file.feed("+UUSORD: 0,12\r\n+UUSX\r\n+UUSORF: 1\r\n");
+    EXPECT_TRUE(parser.process_oob());
+    EXPECT_EQ(1, other_count);
+    EXPECT_EQ(0, oob_count);
+
+    // The rest of that line, then a line that leaves the trie
+    EXPECT_TRUE(parser.process_oob());
+    EXPECT_EQ(2, other_count);
+    EXPECT_FALSE(parser.process_oob());
+}
+
+TEST_F(TestATCmdParser, latest_oob_registration_wins)
+{
+    parser.oob("+EV", callback(this, &TestATCmdParser::other_seen));
+    parser.oob("+EV", callback(this, &TestATCmdParser::oob_seen));
+
+    file.feed("+EV\r\n");
+    EXPECT_TRUE(parser.process_oob());
+    EXPECT_EQ(1, oob_count);
+    EXPECT_EQ(0, other_count);
+}
+
+TEST_F(TestATCmdParser, oob_can_abort_recv)
+{
+    parser.oob("+CLOSED", callback(this, &TestATCmdParser::oob_abort));
+
+    file.feed("+CLOSED\r\nOK\r\n");
+    EXPECT_FALSE(parser.recv("OK"));
+    EXPECT_EQ(1, oob_count);
+}
+
+TEST_F(TestATCmdParser, process_oob_without_input)
+{
+    EXPECT_FALSE(parser.process_oob());
+}
+
+/* Formats of the equivalence sweep, one line each */
+static const char *const sweep_formats[] = {
+    "OK", "OK\n", "ERROR", "+CSQ: %d,%d", "+CSQ: %d,%d\n", "+CME ERROR: %d\n",
+    "%d", "%u", "%x", "%o", "%s", "%c", " %c", "%3d", "%2s%d", "%d %d", "%d,%d",
+    "+IPD,%d:", "ID: %[^,],%u", "%[0-9a-f]", "%[^\n]", "%[^\n]\n", "A %s B",
+    "v%o", "%%%d", "100%%", "%hd,%lu", "%*d,%d", "+X:%d\n", "%s\n", "%c%c%c",
+};
+
+/* Fragments of the random input lines */
+static const char *const sweep_fragments[] = {
+    "OK", "ERROR", "+CSQ: ", "+CME ERROR: ", "+IPD,", "ID: ", "A ", " B", "v",
+    "12", "-3", "+4", "0", "0x1F", "fe", "777", "99999999999", ",", ":", " ",
+    "  ", "\t", "%", "ab", "x", "lora", "100", "+X:", "\r\n", "\n", "\r",
+};
+
+TEST(TestATCmdParserSweep, compiled_matcher_agrees_with_the_rescan)
+{
+    const int formats = sizeof(sweep_formats) / sizeof(sweep_formats[0]);
+    const int fragments = sizeof(sweep_fragments) / sizeof(sweep_fragments[0]);
+    // Room for any value the formats store
+    static union {
+        char bytes[256];
+        unsigned long align;
+    } values[8];
+    int matches = 0;
+
+    srand(1510);
+    for (int round = 0; round < 20000; round++) {
+        const char *format = sweep_formats[round % formats];
+        std::string input;
+        int lines = 1 + rand() % 3;
+        for (int line = 0; line < lines; line++) {
+            int parts = 1 + rand() % 6;
+            for (int i = 0; i < parts; i++) {
+                input += sweep_fragments[rand() % fragments];
+            }
+            input += "\r\n";
+        }
+
+        long expected = RescanMatcher(format).match(input);
+
+        ScriptedFile file(input);
+        ATCmdParser parser(&file, "\r\n", 256, 0);
+        bool matched = parser.recv(format, &values[0], &values[1], &values[2],
+                                   &values[3], &values[4], &values[5]);
+
+        ASSERT_EQ(expected >= 0, matched) << "format \"" << format << "\" input \"" << input << "\"";
+        if (matched) {
+            ASSERT_EQ((size_t)expected, file.pos()) << "format \"" << format << "\" input \"" << input << "\"";
+            matches++;
+        }
+    }
+    // Enough of both outcomes to mean something
+    EXPECT_GT(matches, 2000);
+    EXPECT_LT(matches, 18000);
+}
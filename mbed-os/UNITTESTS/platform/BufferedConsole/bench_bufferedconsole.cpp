@@ -0,0 +1,103 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Console writes for mem-trace style output, each line one _write() with
+ * the newline conversion of the retarget layer: straight to the console,
+ * then through a 256-byte BufferedConsole, line buffered and fully
+ * buffered. On the target each console write is a call into the UART
+ * driver, and a wait for it when its buffer is full.
+ *
+ *   bench_bufferedconsole [lines] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "platform/BufferedConsole.h"
+#include "console_file.h"
+
+#define BENCH_LINES     1000
+
+using namespace mbed;
+
+/* The '\n' to "\r\n" conversion of PREFIX(_write) in mbed_retarget.cpp */
+static void write_converted(FileHandle *fh, const char *buffer, size_t length)
+{
+    static char prev;
+    size_t written = 0;
+
+    for (size_t cur = 0; cur < length; cur++) {
+        if (buffer[cur] == '\n' && prev != '\r') {
+            if (cur > written) {
+                written += fh->write(buffer + written, cur - written);
+            }
+            fh->write("\r", 1);
+        }
+        prev = buffer[cur];
+    }
+    if (written < length) {
+        fh->write(buffer + written, length - written);
+    }
+}
+
+/* The lines of the default mem-trace callback */
+static int trace_line(char *line, size_t size, unsigned n)
+{
+    unsigned res = 0x20001000 + (n * 40) % 0x4000;
+    unsigned caller = 0x08004000 + (n * 1234) % 0x10000;
+
+    switch (n % 4) {
+        case 0:
+            return snprintf(line, size, "#m:0x%x;0x%x-%u\n", res, caller, n % 200);
+        case 1:
+            return snprintf(line, size, "#r:0x%x;0x%x-0x%x;%u\n", res, caller, res - 64, n % 300);
+        case 2:
+            return snprintf(line, size, "#c:0x%x;0x%x-%u;%u\n", res, caller, n % 8, n % 32);
+        default:
+            return snprintf(line, size, "#f:0x%x;0x%x-0x%x\n", res, caller, res - 64);
+    }
+}
+
+static std::string run(const char *name, ConsoleFile &console, FileHandle *fh, unsigned lines)
+{
+    char line[64];
+
+    for (unsigned n = 0; n < lines; n++) {
+        write_converted(fh, line, trace_line(line, sizeof(line), n));
+    }
+    fh->sync();
+    printf("%-16s %6u writes of %5.1f bytes\n", name, console.writes(),
+           (double) console.output().size() / console.writes());
+    return console.output();
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned lines = argc > 1 ? atoi(argv[1]) : BENCH_LINES;
+
+    ConsoleFile direct;
+    std::string expected = run("direct", direct, &direct, lines);
+
+    ConsoleFile line_console;
+    BufferedConsole line_buffered(&line_console, true);
+    bool same = run("line buffered", line_console, &line_buffered, lines) == expected;
+
+    ConsoleFile full_console;
+    BufferedConsole full_buffered(&full_console, false);
+    same = run("fully buffered", full_console, &full_buffered, lines) == expected && same;
+
+    printf("output %s\n", same ? "identical" : "DIFFERS");
+    return same ? 0 : 1;
+}
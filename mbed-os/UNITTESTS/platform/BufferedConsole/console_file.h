@@ -0,0 +1,105 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CONSOLE_FILE_H
+#define CONSOLE_FILE_H
+
+/* A FileHandle standing in for the console: it records what it is sent and
+ * in how many writes, and can be made to take only part of a write, or to
+ * fail */
+
+#include <string.h>
+#include <string>
+#include "platform/FileHandle.h"
+
+class ConsoleFile : public mbed::FileHandle {
+public:
+    ConsoleFile() : _writes(0), _syncs(0), _limit(0), _error(0) {}
+
+    const std::string &output() const
+    {
+        return _output;
+    }
+
+    unsigned writes() const
+    {
+        return _writes;
+    }
+
+    unsigned syncs() const
+    {
+        return _syncs;
+    }
+
+    /** Take at most @a limit bytes per write, 0 for all */
+    void limit(size_t limit)
+    {
+        _limit = limit;
+    }
+
+    /** Fail every write with @a error, 0 to succeed */
+    void fail(ssize_t error)
+    {
+        _error = error;
+    }
+
+    virtual ssize_t write(const void *buffer, size_t size)
+    {
+        if (_error) {
+            return _error;
+        }
+        if (_limit && size > _limit) {
+            size = _limit;
+        }
+        _writes++;
+        _output.append((const char *)buffer, size);
+        return size;
+    }
+
+    virtual ssize_t read(void *buffer, size_t size)
+    {
+        return -EAGAIN;
+    }
+
+    virtual off_t seek(off_t offset, int whence = SEEK_SET)
+    {
+        return -ESPIPE;
+    }
+
+    virtual int sync()
+    {
+        _syncs++;
+        return 0;
+    }
+
+    virtual int close()
+    {
+        return 0;
+    }
+
+    virtual int isatty()
+    {
+        return true;
+    }
+
+private:
+    std::string _output;
+    unsigned _writes;
+    unsigned _syncs;
+    size_t _limit;
+    ssize_t _error;
+};
+
+#endif
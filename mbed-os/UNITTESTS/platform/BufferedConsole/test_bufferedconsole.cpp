@@ -0,0 +1,126 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of BufferedConsole on a 64-byte ring: when the console is
+ * written to, in how many writes, and what happens when it takes only part
+ * of a write or fails */
+#include <string>
+#include "gtest/gtest.h"
+#include "platform/BufferedConsole.h"
+#include "console_file.h"
+
+using namespace mbed;
+
+TEST(TestBufferedConsole, line_mode_passes_each_line_on_in_one_write)
+{
+    ConsoleFile console;
+    BufferedConsole buffered(&console, true);
+
+    EXPECT_EQ(3, buffered.write("abc", 3));
+    EXPECT_EQ(3, buffered.write("def", 3));
+    EXPECT_EQ(0u, console.writes());
+    EXPECT_EQ(1, buffered.write("\n", 1));
+    EXPECT_EQ(1u, console.writes());
+    EXPECT_EQ("abcdef\n", console.output());
+}
+
+TEST(TestBufferedConsole, full_mode_holds_lines_until_sync)
+{
+    ConsoleFile console;
+    BufferedConsole buffered(&console, false);
+
+    EXPECT_EQ(6, buffered.write("one\ntw", 6));
+    EXPECT_EQ(2, buffered.write("o\n", 2));
+    EXPECT_EQ(0u, console.writes());
+    EXPECT_EQ(0, buffered.sync());
+    EXPECT_EQ(1u, console.writes());
+    EXPECT_EQ(1u, console.syncs());
+    EXPECT_EQ("one\ntwo\n", console.output());
+}
+
+TEST(TestBufferedConsole, wrapped_ring_drains_in_two_writes)
+{
+    ConsoleFile console;
+    BufferedConsole buffered(&console, false);
+    std::string first(40, 'a');
+    std::string second(40, 'b');
+
+    buffered.write(first.data(), first.size());
+    buffered.sync();
+    EXPECT_EQ(1u, console.writes());
+    // 24 bytes up to the end of the ring, 16 from its start
+    buffered.write(second.data(), second.size());
+    buffered.sync();
+    EXPECT_EQ(3u, console.writes());
+    EXPECT_EQ(first + second, console.output());
+}
+
+TEST(TestBufferedConsole, write_larger_than_the_ring_keeps_its_order)
+{
+    ConsoleFile console;
+    BufferedConsole buffered(&console, false);
+    std::string text;
+
+    for (int i = 0; i < 200; i++) {
+        text += char('A' + i % 26);
+    }
+    EXPECT_EQ(200, buffered.write(text.data(), text.size()));
+    // Each time the ring fills, all of it goes in one write
+    EXPECT_EQ(3u, console.writes());
+    buffered.close();
+    EXPECT_EQ(text, console.output());
+}
+
+TEST(TestBufferedConsole, partial_console_writes_are_continued)
+{
+    ConsoleFile console;
+    BufferedConsole buffered(&console, true);
+
+    console.limit(5);
+    EXPECT_EQ(12, buffered.write("hello world\n", 12));
+    EXPECT_EQ(3u, console.writes());
+    EXPECT_EQ("hello world\n", console.output());
+}
+
+TEST(TestBufferedConsole, console_error_is_returned_once_the_ring_is_full)
+{
+    ConsoleFile console;
+    BufferedConsole buffered(&console, false);
+    std::string text(100, 'x');
+
+    console.fail(-EIO);
+    // What fits in the ring is taken, as a short write
+    EXPECT_EQ(64, buffered.write(text.data(), text.size()));
+    EXPECT_EQ(-EIO, buffered.write(text.data(), text.size()));
+    EXPECT_EQ(-EIO, buffered.sync());
+    EXPECT_EQ(0u, console.syncs());
+
+    // Nothing was lost while the console failed
+    console.fail(0);
+    EXPECT_EQ(0, buffered.sync());
+    EXPECT_EQ(text.substr(0, 64), console.output());
+}
+
+TEST(TestBufferedConsole, queries_go_to_the_console)
+{
+    ConsoleFile console;
+    BufferedConsole buffered(&console);
+
+    EXPECT_EQ(&console, buffered.console());
+    EXPECT_EQ(1, buffered.isatty());
+    EXPECT_EQ(-ESPIPE, buffered.seek(0, SEEK_SET));
+    EXPECT_EQ(POLLIN | POLLOUT, buffered.poll(POLLIN | POLLOUT));
+}
@@ -0,0 +1,83 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Dispatch cost of CallChain::call() for 1 to 16 handlers, next to a plain
+ * array of function pointers, as InterruptManager dispatches an interrupt
+ *
+ *   bench_callchain [calls] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "platform/mbed_toolchain.h"
+#undef MBED_DEPRECATED_SINCE
+#define MBED_DEPRECATED_SINCE(...)
+#include "platform/CallChain.h"
+
+#define BENCH_HANDLERS  16
+#define BENCH_CALLS     1000000
+
+using namespace mbed;
+
+static volatile uint32_t sink;
+
+MBED_NOINLINE static void handler(void)
+{
+    sink++;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int calls = (argc > 1) ? strtoul(argv[1], NULL, 0) : BENCH_CALLS;
+    void (*volatile array[BENCH_HANDLERS])(void);
+
+    printf("handlers  CallChain  array of pointers, ns per dispatch\n");
+    for (int count = 1; count <= BENCH_HANDLERS; count++) {
+        CallChain chain;
+
+        for (int i = 0; i < count; i++) {
+            // Some at a higher priority, as drivers add them
+            if (chain.insert(handler, (int8_t)(i % 3)) == NULL) {
+                printf("%d handlers do not fit; raise platform.callchain-capacity\n", count);
+                return 1;
+            }
+            array[i] = handler;
+        }
+
+        double start = now_ns();
+        for (unsigned int n = 0; n < calls; n++) {
+            chain.call();
+        }
+        double chain_ns = (now_ns() - start) / calls;
+
+        start = now_ns();
+        for (unsigned int n = 0; n < calls; n++) {
+            for (int i = 0; i < count; i++) {
+                array[i]();
+            }
+        }
+        double array_ns = (now_ns() - start) / calls;
+
+        printf("%8d  %9.1f  %17.1f\n", count, chain_ns, array_ns);
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of the fixed-size CallChain: call order by priority, handles,
+ * and a full chain */
+#include "gtest/gtest.h"
+#include "platform/mbed_toolchain.h"
+#undef MBED_DEPRECATED_SINCE
+#define MBED_DEPRECATED_SINCE(...)
+#include "platform/CallChain.h"
+
+using namespace mbed;
+
+static char calls[64];
+static int call_count;
+
+class Recorder {
+public:
+    Recorder(char name) : _name(name) {}
+
+    void call()
+    {
+        calls[call_count++] = _name;
+        calls[call_count] = '\0';
+    }
+
+private:
+    char _name;
+};
+
+class TestCallChain : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        call_count = 0;
+        calls[0] = '\0';
+        for (int i = 0; i < 26; i++) {
+            recorders[i] = new Recorder('a' + i);
+        }
+    }
+
+    virtual void TearDown()
+    {
+        for (int i = 0; i < 26; i++) {
+            delete recorders[i];
+        }
+    }
+
+    Callback<void()> func(char name)
+    {
+        return callback(recorders[name - 'a'], &Recorder::call);
+    }
+
+    const char *run()
+    {
+        call_count = 0;
+        calls[0] = '\0';
+        chain.call();
+        return calls;
+    }
+
+    CallChain chain;
+    Recorder *recorders[26];
+};
+
+TEST_F(TestCallChain, calls_by_priority_then_in_order_added)
+{
+    chain.add(func('a'));
+    chain.add(func('b'));
+    chain.add_front(func('c'));
+    chain.insert(func('d'), 5);
+    chain.insert(func('e'), -5);
+    chain.insert(func('f'), 5);
+    chain.insert(func('g'), 0);
+    EXPECT_STREQ("dfcabge", run());
+    EXPECT_EQ(7, chain.size());
+}
+
+TEST_F(TestCallChain, handles_remove_their_function)
+{
+    pFunctionPointer_t a = chain.add(func('a'));
+    pFunctionPointer_t b = chain.add(func('b'));
+    pFunctionPointer_t c = chain.add(func('c'));
+
+    EXPECT_EQ(1, chain.find(b));
+    EXPECT_EQ(b, chain.get(1));
+    EXPECT_TRUE(chain.remove(b));
+    EXPECT_STREQ("ac", run());
+    EXPECT_EQ(-1, chain.find(b));
+
+    // A removed handle, or one of another chain, is refused
+    CallChain other;
+    pFunctionPointer_t foreign = other.add(func('z'));
+    EXPECT_FALSE(chain.remove(b));
+    EXPECT_FALSE(chain.remove(foreign));
+    EXPECT_FALSE(chain.remove(NULL));
+
+    // The slot is reused, in call order of its own
+    pFunctionPointer_t d = chain.add_front(func('d'));
+    EXPECT_EQ(b, d);
+    EXPECT_STREQ("dac", run());
+    EXPECT_TRUE(chain.remove(a));
+    EXPECT_TRUE(chain.remove(c));
+    EXPECT_TRUE(chain.remove(d));
+    EXPECT_STREQ("", run());
+    EXPECT_EQ(NULL, chain.get(0));
+}
+
+TEST_F(TestCallChain, full_chain_refuses_more)
+{
+    for (int i = 0; i < MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY; i++) {
+        ASSERT_TRUE(chain.insert(func('a' + i % 26), -i) != NULL) << i;
+    }
+    EXPECT_EQ(NULL, chain.add(func('z')));
+    EXPECT_EQ(NULL, chain.add_front(func('z')));
+    EXPECT_EQ(MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY, chain.size());
+    EXPECT_EQ('a', run()[0]);
+
+    chain.clear();
+    EXPECT_EQ(0, chain.size());
+    EXPECT_TRUE(chain.add(func('z')) != NULL);
+    EXPECT_STREQ("z", run());
+}
+
+TEST_F(TestCallChain, sixteen_handlers_fit_by_default)
+{
+    EXPECT_GE(MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY, 16);
+}
@@ -0,0 +1,166 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Throughput of RingBuffer between a producer and a consumer thread, by
+ * element, in bulk and through spans, and the cost of a push and pop next to
+ * CircularBuffer on one thread. The host critical section is empty, so the
+ * CircularBuffer figure is a lower bound of its cost on the target.
+ *
+ *   bench_ringbuffer [bytes] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <thread>
+#include "platform/RingBuffer.h"
+#include "platform/CircularBuffer.h"
+
+#define BENCH_BYTES     (64 * 1024 * 1024)
+#define BENCH_SIZE      256
+#define BENCH_CHUNK     64
+
+using namespace mbed;
+
+static RingBuffer<uint8_t, BENCH_SIZE> ring;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+enum bench_mode_t {
+    MODE_ELEMENT,
+    MODE_BULK,
+    MODE_SPAN
+};
+
+static void produce(bench_mode_t mode, uint32_t total)
+{
+    uint8_t chunk[BENCH_CHUNK];
+    uint32_t sent = 0;
+
+    memset(chunk, 0x55, sizeof(chunk));
+    while (sent < total) {
+        if (ring.full()) {
+            // Let the consumer run on a single core
+            std::this_thread::yield();
+            continue;
+        }
+        if (mode == MODE_ELEMENT) {
+            sent += ring.push((uint8_t)sent);
+        } else if (mode == MODE_BULK) {
+            uint32_t count = total - sent < BENCH_CHUNK ? total - sent : BENCH_CHUNK;
+            sent += ring.push(chunk, count);
+        } else {
+            uint32_t count;
+            uint8_t *span = ring.write_span(count);
+            if (count > total - sent) {
+                count = total - sent;
+            }
+            memset(span, 0x55, count);
+            ring.commit(count);
+            sent += count;
+        }
+    }
+}
+
+static uint32_t consume(bench_mode_t mode, uint32_t total)
+{
+    uint8_t chunk[BENCH_CHUNK];
+    uint32_t received = 0;
+    uint32_t sum = 0;
+
+    while (received < total) {
+        if (ring.empty()) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (mode == MODE_ELEMENT) {
+            uint8_t data;
+            if (ring.pop(data)) {
+                sum += data;
+                received++;
+            }
+        } else if (mode == MODE_BULK) {
+            uint32_t count = ring.pop(chunk, BENCH_CHUNK);
+            sum += count ? chunk[0] : 0;
+            received += count;
+        } else {
+            uint32_t count;
+            const uint8_t *span = ring.read_span(count);
+            memcpy(chunk, span, count < BENCH_CHUNK ? count : BENCH_CHUNK);
+            sum += count ? chunk[0] : 0;
+            ring.release(count);
+            received += count;
+        }
+    }
+    return sum;
+}
+
+static void bench_threads(const char *name, bench_mode_t mode, uint32_t total)
+{
+    uint32_t sum = 0;
+
+    ring.reset();
+    double start = now_ns();
+    std::thread consumer([&]() {
+        sum = consume(mode, total);
+    });
+    produce(mode, total);
+    consumer.join();
+    double ns = now_ns() - start;
+
+    printf("%-28s %8.1f MB/s  %6.2f ns/byte  (%u)\n", name, total / ns * 1e3, ns / total, sum & 1);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t total = (argc > 1) ? strtoul(argv[1], NULL, 0) : BENCH_BYTES;
+
+    printf("producer and consumer threads, %u bytes through %u\n", total, BENCH_SIZE);
+    bench_threads("RingBuffer push/pop", MODE_ELEMENT, total / 8);
+    bench_threads("RingBuffer bulk", MODE_BULK, total);
+    bench_threads("RingBuffer spans", MODE_SPAN, total);
+
+    // Both with an element always waiting, as a UART drain sees them
+    static CircularBuffer<uint8_t, BENCH_SIZE> circular;
+    uint32_t count = total / 8;
+    uint8_t data = 0;
+    uint32_t sum = 0;
+
+    ring.reset();
+    double start = now_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        ring.push((uint8_t)i);
+        ring.pop(data);
+        sum += data;
+    }
+    double ring_ns = (now_ns() - start) / count;
+
+    start = now_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        circular.push((uint8_t)i);
+        circular.pop(data);
+        sum += data;
+    }
+    double circular_ns = (now_ns() - start) / count;
+
+    printf("one thread, push and pop: RingBuffer %.2f ns, CircularBuffer %.2f ns  (%u)\n",
+           ring_ns, circular_ns, sum & 1);
+    return 0;
+}
@@ -0,0 +1,200 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of the single producer, single consumer RingBuffer */
+#include <string.h>
+#include <thread>
+#include "gtest/gtest.h"
+#include "platform/RingBuffer.h"
+
+using namespace mbed;
+
+TEST(TestRingBuffer, starts_empty)
+{
+    RingBuffer<int, 8> buffer;
+    int data;
+
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_FALSE(buffer.full());
+    EXPECT_EQ(0u, buffer.size());
+    EXPECT_EQ(8u, buffer.capacity());
+    EXPECT_FALSE(buffer.pop(data));
+    EXPECT_FALSE(buffer.peek(data));
+}
+
+TEST(TestRingBuffer, full_buffer_is_not_overwritten)
+{
+    RingBuffer<int, 4> buffer;
+    int data;
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(buffer.push(i));
+    }
+    EXPECT_TRUE(buffer.full());
+    EXPECT_FALSE(buffer.push(99));
+    EXPECT_EQ(4u, buffer.size());
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(buffer.peek(data));
+        EXPECT_EQ(i, data);
+        EXPECT_TRUE(buffer.pop(data));
+        EXPECT_EQ(i, data);
+    }
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(TestRingBuffer, elements_keep_their_order_across_the_wrap)
+{
+    RingBuffer<int, 8> buffer;
+    int next_in = 0, next_out = 0;
+    int data;
+
+    // Sizes coprime with the capacity, to end at every offset
+    for (int round = 0; round < 100; round++) {
+        for (int i = 0; i < 5 && buffer.push(next_in); i++) {
+            next_in++;
+        }
+        for (int i = 0; i < 3 && buffer.pop(data); i++) {
+            ASSERT_EQ(next_out++, data);
+        }
+        ASSERT_EQ((uint32_t)(next_in - next_out), buffer.size());
+    }
+    while (buffer.pop(data)) {
+        ASSERT_EQ(next_out++, data);
+    }
+    EXPECT_EQ(next_in, next_out);
+}
+
+TEST(TestRingBuffer, bulk_transfers_are_cut_to_fit)
+{
+    RingBuffer<uint8_t, 16> buffer;
+    uint8_t in[32], out[32];
+
+    for (int i = 0; i < 32; i++) {
+        in[i] = i;
+    }
+    EXPECT_EQ(10u, buffer.push(in, 10));
+    EXPECT_EQ(8u, buffer.pop(out, 8));
+    // 8 free at the end and 6 at the start
+    EXPECT_EQ(14u, buffer.push(in + 10, 20));
+    EXPECT_TRUE(buffer.full());
+    EXPECT_EQ(0u, buffer.push(in, 1));
+
+    EXPECT_EQ(16u, buffer.pop(out + 8, 32));
+    EXPECT_EQ(0, memcmp(in, out, 24));
+    EXPECT_EQ(0u, buffer.pop(out, 1));
+}
+
+TEST(TestRingBuffer, spans_stop_at_the_end_of_the_storage)
+{
+    RingBuffer<uint8_t, 16> buffer;
+    uint8_t data[16];
+    uint32_t count;
+
+    uint8_t *write = buffer.write_span(count);
+    EXPECT_EQ(16u, count);
+    memset(write, 0xAA, 12);
+    buffer.commit(12);
+
+    const uint8_t *read = buffer.read_span(count);
+    EXPECT_EQ(12u, count);
+    EXPECT_EQ(0xAA, read[11]);
+    buffer.release(10);
+
+    // 4 free before the end, then 10 after the wrap
+    write = buffer.write_span(count);
+    EXPECT_EQ(4u, count);
+    for (uint32_t i = 0; i < count; i++) {
+        write[i] = i;
+    }
+    buffer.commit(count);
+    write = buffer.write_span(count);
+    EXPECT_EQ(10u, count);
+    for (uint32_t i = 0; i < count; i++) {
+        write[i] = 4 + i;
+    }
+    buffer.commit(count);
+    EXPECT_TRUE(buffer.full());
+    buffer.write_span(count);
+    EXPECT_EQ(0u, count);
+
+    // Released elements are dropped, the rest are read back in order
+    read = buffer.read_span(count);
+    EXPECT_EQ(6u, count);
+    EXPECT_EQ(0xAA, read[0]);
+    EXPECT_EQ(0, read[2]);
+    buffer.release(2);
+    EXPECT_EQ(14u, buffer.pop(data, 16));
+    for (int i = 0; i < 14; i++) {
+        EXPECT_EQ(i, data[i]);
+    }
+    buffer.read_span(count);
+    EXPECT_EQ(0u, count);
+}
+
+TEST(TestRingBuffer, reset_empties_the_buffer)
+{
+    RingBuffer<int, 4> buffer;
+
+    int data[8] = { 0 };
+
+    buffer.push(1);
+    buffer.push(2);
+    buffer.reset();
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(4u, buffer.push(data, 8));
+}
+
+TEST(TestRingBuffer, one_producer_and_one_consumer_thread)
+{
+    static RingBuffer<uint32_t, 64> buffer;
+    const uint32_t total = 1000000;
+    bool in_order = true;
+
+    std::thread consumer([&]() {
+        uint32_t expected = 0;
+        uint32_t data[16];
+        while (expected < total) {
+            uint32_t count = buffer.pop(data, 16);
+            if (count == 0) {
+                std::this_thread::yield();
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                if (data[i] != expected++) {
+                    in_order = false;
+                }
+            }
+        }
+    });
+
+    uint32_t next = 0;
+    while (next < total) {
+        uint32_t count;
+        uint32_t *span = buffer.write_span(count);
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+        for (uint32_t i = 0; i < count && next < total; i++) {
+            span[i] = next++;
+            if (i + 1 == count || next == total) {
+                buffer.commit(i + 1);
+            }
+        }
+    }
+    consumer.join();
+    EXPECT_TRUE(in_order);
+    EXPECT_TRUE(buffer.empty());
+}
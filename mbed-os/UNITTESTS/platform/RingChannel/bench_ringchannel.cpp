@@ -0,0 +1,173 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Records through RingChannel between a producer and a consumer thread, next
+ * to a queue that copies each record under a mutex and signals a condition
+ * variable, as a kernel message queue does, and the number of wakes each
+ * needs. The host has no RTX, so the queue stands in for Queue<T,N>.
+ *
+ *   bench_ringchannel [records] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <thread>
+#include "rtos/RingChannel.h"
+
+#define BENCH_RECORDS   1000000
+#define BENCH_RING      1024
+#define BENCH_SLOTS     16
+#define BENCH_MAX       64
+
+using namespace rtos;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Fixed slots of the largest record, a kernel call on each side */
+class CopyQueue {
+public:
+    CopyQueue() : _head(0), _tail(0), _wakes(0)
+    {
+        pthread_mutex_init(&_mutex, NULL);
+        pthread_cond_init(&_cond, NULL);
+    }
+
+    void put(const void *data, uint32_t size)
+    {
+        pthread_mutex_lock(&_mutex);
+        while (_head - _tail == BENCH_SLOTS) {
+            pthread_cond_wait(&_cond, &_mutex);
+        }
+        slot_t &slot = _slots[_head % BENCH_SLOTS];
+        slot.size = size;
+        memcpy(slot.data, data, size);
+        _head++;
+        _wakes++;
+        pthread_cond_broadcast(&_cond);
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    uint32_t get(void *data)
+    {
+        pthread_mutex_lock(&_mutex);
+        while (_head == _tail) {
+            pthread_cond_wait(&_cond, &_mutex);
+        }
+        slot_t &slot = _slots[_tail % BENCH_SLOTS];
+        uint32_t size = slot.size;
+        memcpy(data, slot.data, size);
+        _tail++;
+        pthread_cond_broadcast(&_cond);
+        pthread_mutex_unlock(&_mutex);
+        return size;
+    }
+
+    uint32_t wakes() const
+    {
+        return _wakes;
+    }
+
+private:
+    struct slot_t {
+        uint32_t size;
+        uint8_t data[BENCH_MAX];
+    };
+
+    pthread_mutex_t _mutex;
+    pthread_cond_t _cond;
+    slot_t _slots[BENCH_SLOTS];
+    uint32_t _head;
+    uint32_t _tail;
+    uint32_t _wakes;
+};
+
+/* Record sizes cycle through 4 to BENCH_MAX bytes */
+static uint32_t record_size(uint32_t n)
+{
+    return 4 + (n * 12) % (BENCH_MAX - 3);
+}
+
+static void bench_channel(uint32_t records)
+{
+    static EventFlags flags;
+    static RingChannel<BENCH_RING> channel(&flags);
+    uint32_t sum = 0;
+
+    double start = now_ns();
+    std::thread consumer([&]() {
+        uint32_t size = 0;
+        for (uint32_t n = 0; n < records; n++) {
+            const uint8_t *data = (const uint8_t *)channel.peek(size, osWaitForever);
+            sum += data[size - 1];
+            channel.release();
+        }
+    });
+    for (uint32_t n = 0; n < records; n++) {
+        uint32_t size = record_size(n);
+        uint8_t *data;
+        while ((data = (uint8_t *)channel.reserve(size)) == NULL) {
+            std::this_thread::yield();
+        }
+        memset(data, (uint8_t)n, size);
+        channel.commit(size);
+    }
+    consumer.join();
+    double ns = now_ns() - start;
+
+    printf("RingChannel<%u>     %7.1f ns/record  %6.3f wakes/record  (%u)\n",
+           BENCH_RING, ns / records, (double)flags.set_count() / records, sum & 1);
+}
+
+static void bench_queue(uint32_t records)
+{
+    static CopyQueue queue;
+    uint32_t sum = 0;
+
+    double start = now_ns();
+    std::thread consumer([&]() {
+        uint8_t data[BENCH_MAX];
+        for (uint32_t n = 0; n < records; n++) {
+            uint32_t size = queue.get(data);
+            sum += data[size - 1];
+        }
+    });
+    uint8_t data[BENCH_MAX];
+    for (uint32_t n = 0; n < records; n++) {
+        uint32_t size = record_size(n);
+        memset(data, (uint8_t)n, size);
+        queue.put(data, size);
+    }
+    consumer.join();
+    double ns = now_ns() - start;
+
+    printf("copy queue of %u     %7.1f ns/record  %6.3f wakes/record  (%u)\n",
+           BENCH_SLOTS, ns / records, (double)queue.wakes() / records, sum & 1);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t records = (argc > 1) ? strtoul(argv[1], NULL, 0) : BENCH_RECORDS;
+
+    printf("%u records of 4 to %u bytes, producer and consumer threads\n", records, BENCH_MAX);
+    bench_channel(records);
+    bench_queue(records);
+    return 0;
+}
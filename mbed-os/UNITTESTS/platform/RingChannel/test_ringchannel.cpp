@@ -0,0 +1,227 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of RingChannel: records in place, the wrap marker, a full ring,
+ * and one wake per burst through the stub EventFlags */
+#include <string.h>
+#include <thread>
+#include "gtest/gtest.h"
+#include "rtos/RingChannel.h"
+
+using namespace rtos;
+
+TEST(TestRingChannel, records_come_out_as_they_went_in)
+{
+    RingChannel<64> channel;
+    uint32_t size;
+
+    EXPECT_TRUE(channel.empty());
+    EXPECT_EQ(NULL, channel.peek(size));
+
+    EXPECT_TRUE(channel.put("hello", 5));
+    EXPECT_TRUE(channel.put("", 0));
+    char *record = (char *)channel.reserve(10);
+    ASSERT_TRUE(record != NULL);
+    memcpy(record, "abc", 3);
+    channel.commit(3);
+    EXPECT_FALSE(channel.empty());
+
+    const char *data = (const char *)channel.peek(size);
+    ASSERT_EQ(5u, size);
+    EXPECT_EQ(0, memcmp("hello", data, 5));
+    // Peeking again returns the same record until it is released
+    EXPECT_EQ(data, channel.peek(size));
+    channel.release();
+
+    channel.peek(size);
+    EXPECT_EQ(0u, size);
+    channel.release();
+
+    data = (const char *)channel.peek(size);
+    ASSERT_EQ(3u, size);
+    EXPECT_EQ(0, memcmp("abc", data, 3));
+    channel.release();
+    EXPECT_TRUE(channel.empty());
+}
+
+TEST(TestRingChannel, records_are_word_aligned_and_contiguous)
+{
+    RingChannel<64> channel;
+    uint8_t payload[24];
+    uint32_t size;
+
+    for (int i = 0; i < 24; i++) {
+        payload[i] = i;
+    }
+    // Sizes that leave every offset of the ring, past several wraps
+    for (int round = 0; round < 50; round++) {
+        uint32_t length = 1 + (round * 7) % 24;
+        ASSERT_TRUE(channel.put(payload, length)) << round;
+        const uint8_t *data = (const uint8_t *)channel.peek(size);
+        ASSERT_EQ(length, size);
+        EXPECT_EQ(0u, (uintptr_t)data % sizeof(uint32_t));
+        EXPECT_EQ(0, memcmp(payload, data, length));
+        channel.release();
+    }
+    EXPECT_TRUE(channel.empty());
+}
+
+TEST(TestRingChannel, a_record_at_the_end_skips_to_the_start)
+{
+    RingChannel<64> channel;
+    uint8_t payload[28] = { 0 };
+    uint32_t size;
+
+    // 32 + 20 bytes used, 12 left before the end
+    ASSERT_TRUE(channel.put(payload, 28));
+    ASSERT_TRUE(channel.put(payload, 16));
+    channel.peek(size);
+    channel.release();
+
+    // 20 bytes do not fit in the 12 at the end, but do after the wrap
+    uint8_t *record = (uint8_t *)channel.reserve(16);
+    ASSERT_TRUE(record != NULL);
+    memset(record, 0x5A, 16);
+    channel.commit(16);
+
+    channel.peek(size);
+    EXPECT_EQ(16u, size);
+    channel.release();
+    const uint8_t *data = (const uint8_t *)channel.peek(size);
+    ASSERT_EQ(16u, size);
+    EXPECT_EQ(0x5A, data[15]);
+    // The record starts the ring again
+    EXPECT_EQ(record, data);
+    channel.release();
+    EXPECT_TRUE(channel.empty());
+}
+
+TEST(TestRingChannel, a_full_ring_refuses_records)
+{
+    RingChannel<64> channel;
+    uint8_t payload[32] = { 0 };
+    uint32_t size;
+
+    EXPECT_EQ(28u, channel.max_record_size());
+    EXPECT_EQ(NULL, channel.reserve(29));
+
+    // 32 + 28 bytes used, 4 left
+    EXPECT_TRUE(channel.put(payload, 28));
+    EXPECT_TRUE(channel.put(payload, 24));
+    EXPECT_FALSE(channel.put(payload, 4));
+    EXPECT_TRUE(channel.put(payload, 0));
+    EXPECT_FALSE(channel.put(payload, 0));
+
+    // The space comes back once the oldest record is released
+    channel.peek(size);
+    channel.release();
+    EXPECT_TRUE(channel.put(payload, 28));
+}
+
+TEST(TestRingChannel, commit_may_shrink_the_reservation)
+{
+    RingChannel<64> channel;
+    uint32_t size;
+
+    channel.reserve(28);
+    channel.commit(4);
+    // Only 8 bytes were taken, leaving room for 32 + 16 more
+    uint8_t payload[28] = { 0 };
+    EXPECT_TRUE(channel.put(payload, 28));
+    EXPECT_TRUE(channel.put(payload, 12));
+    channel.peek(size);
+    EXPECT_EQ(4u, size);
+}
+
+TEST(TestRingChannel, consumer_is_woken_once_per_burst)
+{
+    EventFlags flags;
+    RingChannel<256> channel(&flags, 0x4);
+    uint32_t size;
+
+    for (int i = 0; i < 5; i++) {
+        channel.put(&i, sizeof(i));
+    }
+    EXPECT_EQ(1u, flags.set_count());
+    EXPECT_EQ(0x4u, flags.get());
+
+    // Draining part of the burst does not rearm the wake
+    channel.peek(size);
+    channel.release();
+    channel.put(&size, sizeof(size));
+    EXPECT_EQ(1u, flags.set_count());
+
+    while (channel.peek(size)) {
+        channel.release();
+    }
+    int i = 0;
+    channel.put(&i, sizeof(i));
+    EXPECT_EQ(2u, flags.set_count());
+}
+
+TEST(TestRingChannel, peek_waits_for_a_record)
+{
+    EventFlags flags;
+    RingChannel<256> channel(&flags);
+    uint32_t size;
+
+    EXPECT_EQ(NULL, channel.peek(size, 10));
+
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        channel.put("late", 4);
+    });
+    const void *data = channel.peek(size, 5000);
+    producer.join();
+    ASSERT_TRUE(data != NULL);
+    EXPECT_EQ(4u, size);
+    EXPECT_EQ(0, memcmp("late", data, 4));
+}
+
+TEST(TestRingChannel, one_producer_and_one_consumer_thread)
+{
+    static EventFlags flags;
+    static RingChannel<512> channel(&flags);
+    const uint32_t total = 200000;
+    bool in_order = true;
+
+    std::thread consumer([&]() {
+        uint32_t size;
+        for (uint32_t expected = 0; expected < total; expected++) {
+            const uint32_t *data = (const uint32_t *)channel.peek(size, osWaitForever);
+            // Each record repeats its sequence number, 1 to 8 times
+            if (size != sizeof(uint32_t) * (1 + expected % 8) || data[size / 4 - 1] != expected) {
+                in_order = false;
+            }
+            channel.release();
+        }
+    });
+
+    uint32_t record[8];
+    for (uint32_t next = 0; next < total; next++) {
+        uint32_t count = 1 + next % 8;
+        for (uint32_t i = 0; i < count; i++) {
+            record[i] = next;
+        }
+        while (!channel.put(record, count * sizeof(uint32_t))) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    EXPECT_TRUE(in_order);
+    EXPECT_TRUE(channel.empty());
+    EXPECT_LT(flags.set_count(), total);
+}
@@ -0,0 +1,85 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Benchmark driver of the latency regression gate: times critical sections
+ * from two call sites and a user interrupt handler on the host clock, then
+ * prints the "lat:" dump for tools/latency_report.py.
+ *
+ *   bench_latency > base.log
+ *   latency_report.py base.log -e json -o baseline.json
+ *   bench_latency 4 > slow.log
+ *   latency_report.py slow.log -b baseline.json      # fails: 4x slower handler
+ *
+ * The optional argument multiplies the work of the handler. */
+#include <stdio.h>
+#include <stdlib.h>
+#include "platform/mbed_latency.h"
+#include "platform/mbed_toolchain.h"
+
+#define BENCH_ROUNDS        2000
+#define BENCH_WORK          2000    // Loop iterations of the handler, some 10 us
+
+static volatile uint32_t sink;
+
+static void work(uint32_t loops)
+{
+    for (uint32_t i = 0; i < loops; i++) {
+        sink += i;
+    }
+}
+
+// What core_util_critical_section_enter() does, keyed by its caller
+MBED_NOINLINE static void critical_enter(void)
+{
+    mbed_latency_critical_enter(MBED_CALLER_ADDR());
+}
+
+MBED_NOINLINE static void short_section(void)
+{
+    critical_enter();
+    work(BENCH_WORK / 20);
+    mbed_latency_critical_exit();
+}
+
+MBED_NOINLINE static void long_section(void)
+{
+    critical_enter();
+    work(BENCH_WORK / 2);
+    mbed_latency_critical_exit();
+}
+
+static void handler(uint32_t slowdown)
+{
+    uint32_t start = mbed_latency_now();
+    work(BENCH_WORK * slowdown);
+    mbed_latency_irq_exit(MBED_LATENCY_IRQ_USER, start);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t slowdown = argc > 1 ? (uint32_t)atoi(argv[1]) : 1;
+
+    mbed_latency_reset();
+    mbed_latency_start();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        short_section();
+        long_section();
+        handler(slowdown);
+    }
+    mbed_latency_stop();
+    mbed_latency_print();
+    return 0;
+}
@@ -0,0 +1,35 @@
+# mbed Microcontroller Library
+# Copyright (c) 2018 ARM Limited
+# SPDX-License-Identifier: Apache-2.0
+#
+# Baseline a benchmark run with latency_report.py, then check that a run with
+# a 4x slower handler fails against it. An equal run is not checked: on a
+# shared host its worst case is too noisy for a 10% tolerance.
+
+function(run_report NAME)
+    execute_process(COMMAND ${PYTHON} ${REPORT} ${WORK_DIR}/${NAME}.log ${ARGN}
+        RESULT_VARIABLE result OUTPUT_VARIABLE output)
+    message(STATUS "${NAME}:\n${output}")
+    set(report_result ${result} PARENT_SCOPE)
+endfunction()
+
+foreach(run base:1 slow:4)
+    string(REPLACE ":" ";" run ${run})
+    list(GET run 0 name)
+    list(GET run 1 slowdown)
+    execute_process(COMMAND ${BENCH} ${slowdown} OUTPUT_FILE ${WORK_DIR}/${name}.log
+        RESULT_VARIABLE result)
+    if(result)
+        message(FATAL_ERROR "bench_latency ${slowdown} failed: ${result}")
+    endif()
+endforeach()
+
+run_report(base -e json -o ${WORK_DIR}/baseline.json)
+if(report_result)
+    message(FATAL_ERROR "latency_report.py could not read the baseline run")
+endif()
+
+run_report(slow -b ${WORK_DIR}/baseline.json)
+if(NOT report_result)
+    message(FATAL_ERROR "latency_report.py did not flag a 4x slower handler")
+endif()
@@ -0,0 +1,121 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of the latency histograms; the source is included for its bucket
+ * functions, and built with MBED_LATENCY_HOST */
+#include "gtest/gtest.h"
+#include "platform/mbed_latency.c"
+
+class TestLatency : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        mbed_latency_reset();
+        mbed_latency_start();
+    }
+
+    virtual void TearDown()
+    {
+        mbed_latency_stop();
+    }
+};
+
+TEST_F(TestLatency, durations_fall_inside_their_bucket)
+{
+    uint32_t previous = 0;
+
+    for (uint32_t duration = 0; duration <= 5000000; duration += 1 + duration / 64) {
+        uint32_t bucket = latency_bucket(duration);
+        ASSERT_LE(duration, latency_bucket_top(bucket)) << duration;
+        if (bucket > 0) {
+            ASSERT_GT(duration, latency_bucket_top(bucket - 1)) << duration;
+        }
+        // Buckets never get wider than half their lower bound
+        if (bucket >= 2 && bucket < MBED_LATENCY_BUCKETS - 1) {
+            uint32_t bottom = latency_bucket_top(bucket - 1) + 1;
+            ASSERT_LE(latency_bucket_top(bucket), bottom + bottom / 2) << duration;
+        }
+        ASSERT_GE(bucket, previous);
+        previous = bucket;
+    }
+    EXPECT_EQ((uint32_t)MBED_LATENCY_BUCKETS - 1, latency_bucket(0xFFFFFFFFUL));
+}
+
+TEST_F(TestLatency, sites_are_keyed_by_kind_and_id)
+{
+    uint32_t now = mbed_latency_now();
+    mbed_latency_record(MBED_LATENCY_CRITICAL, 0x1000, now);
+    mbed_latency_record(MBED_LATENCY_CRITICAL, 0x1000, now);
+    mbed_latency_record(MBED_LATENCY_CRITICAL, 0x2000, now);
+    mbed_latency_record(MBED_LATENCY_IRQ_TICKER, 0x1000, now);
+
+    mbed_latency_site_t sites[4];
+    ASSERT_EQ(3u, mbed_latency_read(sites, 4));
+    EXPECT_EQ(0x1000u, sites[0].id);
+    EXPECT_EQ(2u, sites[0].count);
+    EXPECT_EQ(0x2000u, sites[1].id);
+    EXPECT_EQ((uint32_t)MBED_LATENCY_IRQ_TICKER, sites[2].kind);
+    EXPECT_EQ(1u, sites[2].count);
+}
+
+TEST_F(TestLatency, full_table_drops_new_sites)
+{
+    uint32_t now = mbed_latency_now();
+    for (uint32_t id = 0; id <= MBED_LATENCY_SITES; id++) {
+        mbed_latency_record(MBED_LATENCY_IRQ_USER, id, now);
+    }
+    mbed_latency_record(MBED_LATENCY_IRQ_USER, 0, now);
+
+    EXPECT_EQ(1u, mbed_latency_dropped());
+    mbed_latency_site_t site;
+    ASSERT_EQ(1u, mbed_latency_read(&site, 1));
+    EXPECT_EQ(2u, site.count);
+}
+
+TEST_F(TestLatency, stopped_records_nothing)
+{
+    mbed_latency_stop();
+    mbed_latency_record(MBED_LATENCY_IRQ_USER, 1, mbed_latency_now());
+
+    mbed_latency_site_t site;
+    EXPECT_EQ(0u, mbed_latency_read(&site, 1));
+}
+
+TEST_F(TestLatency, percentiles_are_bucket_tops_up_to_the_max)
+{
+    mbed_latency_site_t site;
+    memset(&site, 0, sizeof(site));
+    site.buckets[latency_bucket(100)] = 98;
+    site.buckets[latency_bucket(1000)] = 1;
+    site.buckets[latency_bucket(5000)] = 1;
+    site.count = 100;
+    site.max = 5000;
+
+    EXPECT_EQ(latency_bucket_top(latency_bucket(100)), mbed_latency_percentile(&site, 50));
+    EXPECT_EQ(latency_bucket_top(latency_bucket(1000)), mbed_latency_percentile(&site, 99));
+    EXPECT_EQ(5000u, mbed_latency_percentile(&site, 100));
+}
+
+TEST_F(TestLatency, critical_section_is_keyed_by_caller)
+{
+    mbed_latency_critical_enter((void *)0x0800abcd);
+    mbed_latency_critical_exit();
+
+    mbed_latency_site_t site;
+    ASSERT_EQ(1u, mbed_latency_read(&site, 1));
+    EXPECT_EQ((uint32_t)MBED_LATENCY_CRITICAL, site.kind);
+    EXPECT_EQ(0x0800abcdu, site.id);
+}
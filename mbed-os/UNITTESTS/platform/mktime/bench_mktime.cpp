@@ -0,0 +1,107 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Throughput of the calendar conversions: one _rtc_localtime() and one
+ * _rtc_maketime() per timestamp, over the 32-bit range, next to the 64-bit
+ * versions and the host C library.
+ *
+ *   bench_mktime [rounds] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "platform/mbed_mktime.h"
+
+#define BENCH_TIMESTAMPS    4096
+#define BENCH_ROUNDS        1000
+
+static uint32_t timestamps[BENCH_TIMESTAMPS];
+static volatile int64_t sink;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void rtc_pair(uint32_t timestamp)
+{
+    struct tm tm;
+    time_t seconds = 0;
+
+    _rtc_localtime(timestamp, &tm, RTC_FULL_LEAP_YEAR_SUPPORT);
+    _rtc_maketime(&tm, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT);
+    sink += seconds;
+}
+
+static void rtc_pair_4_year(uint32_t timestamp)
+{
+    struct tm tm;
+    time_t seconds = 0;
+
+    _rtc_localtime(timestamp, &tm, RTC_4_YEAR_LEAP_YEAR_SUPPORT);
+    _rtc_maketime(&tm, &seconds, RTC_4_YEAR_LEAP_YEAR_SUPPORT);
+    sink += seconds;
+}
+
+static void rtc_pair_64(uint32_t timestamp)
+{
+    struct tm tm;
+    int64_t seconds = 0;
+
+    _rtc_localtime64(timestamp, &tm);
+    _rtc_maketime64(&tm, &seconds);
+    sink += seconds;
+}
+
+static void host_pair(uint32_t timestamp)
+{
+    struct tm tm;
+    time_t host_time = timestamp;
+
+    gmtime_r(&host_time, &tm);
+    sink += timegm(&tm);
+}
+
+static void run(const char *name, void (*pair)(uint32_t), unsigned int rounds)
+{
+    double start = now_ns();
+
+    for (unsigned int round = 0; round < rounds; round++) {
+        for (unsigned int i = 0; i < BENCH_TIMESTAMPS; i++) {
+            pair(timestamps[i]);
+        }
+    }
+    printf("%-24s %8.1f ns\n", name, (now_ns() - start) / ((double)rounds * BENCH_TIMESTAMPS));
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int rounds = (argc > 1) ? strtoul(argv[1], NULL, 0) : BENCH_ROUNDS;
+    uint32_t seed = 1;
+
+    for (unsigned int i = 0; i < BENCH_TIMESTAMPS; i++) {
+        seed = seed * 1664525 + 1013904223;
+        timestamps[i] = seed;
+    }
+
+    printf("localtime + maketime, per timestamp:\n");
+    run("_rtc (full leap years)", rtc_pair, rounds);
+    run("_rtc (4-year leap years)", rtc_pair_4_year, rounds);
+    run("_rtc 64-bit", rtc_pair_64, rounds);
+    run("gmtime_r + timegm", host_pair, rounds);
+    return 0;
+}
@@ -0,0 +1,313 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of the calendar conversions, against the C library of the host
+ * (timegm(), gmtime_r()) and against a day by day walk of the calendar, which
+ * also covers RTCs with partial leap year support.
+ *
+ * Every day of the 32-bit range is checked, with every second of the first
+ * and last days, and every day of 10000 BC to 9999 AD in 64 bits. The check of every second of the range takes minutes; run
+ * it by hand with --gtest_also_run_disabled_tests. */
+#include <time.h>
+#include "gtest/gtest.h"
+#include "platform/mbed_mktime.h"
+
+#define SECONDS_BY_DAY      86400
+#define LAST_DAY            (UINT32_MAX / SECONDS_BY_DAY)   // 7th of February 2106
+
+static bool rtc_full_leap_year(int year)
+{
+    return _rtc_is_leap_year(year, RTC_FULL_LEAP_YEAR_SUPPORT);
+}
+
+static bool rtc_4_year_leap_year(int year)
+{
+    return _rtc_is_leap_year(year, RTC_4_YEAR_LEAP_YEAR_SUPPORT);
+}
+
+static bool gregorian_leap_year(int year)
+{
+    year += 1900;
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+/* A calendar, one day at a time from the 1st of January of a year */
+class CalendarWalk {
+public:
+    CalendarWalk(bool (*is_leap_year)(int), int32_t year, int wday) : _is_leap_year(is_leap_year)
+    {
+        memset(&tm, 0, sizeof(tm));
+        tm.tm_year = year;
+        tm.tm_mday = 1;
+        tm.tm_wday = wday;
+    }
+
+    void next_day()
+    {
+        static const int days_by_month[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        int last = days_by_month[tm.tm_mon] + (tm.tm_mon == 1 && _is_leap_year(tm.tm_year));
+
+        tm.tm_wday = (tm.tm_wday + 1) % 7;
+        tm.tm_yday++;
+        if (++tm.tm_mday > last) {
+            tm.tm_mday = 1;
+            if (++tm.tm_mon == 12) {
+                tm.tm_mon = 0;
+                tm.tm_yday = 0;
+                tm.tm_year++;
+            }
+        }
+    }
+
+    struct tm tm;
+
+private:
+    bool (*_is_leap_year)(int);
+};
+
+// The 1st of January 1970 was a Thursday
+#define EPOCH_WDAY  4
+
+static void expect_same_tm(const struct tm &expected, const struct tm &actual, int64_t timestamp)
+{
+    ASSERT_EQ(expected.tm_sec, actual.tm_sec) << timestamp;
+    ASSERT_EQ(expected.tm_min, actual.tm_min) << timestamp;
+    ASSERT_EQ(expected.tm_hour, actual.tm_hour) << timestamp;
+    ASSERT_EQ(expected.tm_mday, actual.tm_mday) << timestamp;
+    ASSERT_EQ(expected.tm_mon, actual.tm_mon) << timestamp;
+    ASSERT_EQ(expected.tm_year, actual.tm_year) << timestamp;
+    ASSERT_EQ(expected.tm_wday, actual.tm_wday) << timestamp;
+    ASSERT_EQ(expected.tm_yday, actual.tm_yday) << timestamp;
+}
+
+/* Both conversions of one timestamp, in both leap year modes where they agree */
+static void check_timestamp(uint32_t timestamp)
+{
+    struct tm expected, actual;
+    time_t host_time = timestamp;
+    time_t seconds;
+
+    ASSERT_TRUE(gmtime_r(&host_time, &expected) != NULL);
+    memset(&actual, 0, sizeof(actual));
+    ASSERT_TRUE(_rtc_localtime(timestamp, &actual, RTC_FULL_LEAP_YEAR_SUPPORT));
+    expect_same_tm(expected, actual, timestamp);
+
+    ASSERT_TRUE(_rtc_maketime(&expected, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT)) << timestamp;
+    ASSERT_EQ((time_t)timestamp, seconds);
+}
+
+TEST(TestMktime, every_day_matches_the_host_library)
+{
+    CalendarWalk walk(rtc_full_leap_year, 70, EPOCH_WDAY);
+    static const uint32_t times_of_day[] = { 0, 1, 59, 60, 3599, 3600, 43200, 86399 };
+
+    for (uint32_t day = 0; day <= LAST_DAY; day++, walk.next_day()) {
+        struct tm actual;
+        time_t host_time = (time_t)day * SECONDS_BY_DAY;
+        time_t seconds;
+
+        ASSERT_EQ(host_time, timegm(&walk.tm)) << day;
+        ASSERT_TRUE(_rtc_localtime(host_time, &actual, RTC_FULL_LEAP_YEAR_SUPPORT));
+        expect_same_tm(walk.tm, actual, host_time);
+        ASSERT_TRUE(_rtc_maketime(&walk.tm, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT));
+        ASSERT_EQ(host_time, seconds);
+
+        for (unsigned int i = 0; i < sizeof(times_of_day) / sizeof(times_of_day[0]); i++) {
+            uint64_t timestamp = (uint64_t)day * SECONDS_BY_DAY + times_of_day[i];
+            if (timestamp <= UINT32_MAX) {
+                check_timestamp((uint32_t)timestamp);
+            }
+        }
+    }
+}
+
+TEST(TestMktime, every_second_of_the_first_and_last_days)
+{
+    for (uint32_t timestamp = 0; timestamp < SECONDS_BY_DAY; timestamp++) {
+        check_timestamp(timestamp);
+    }
+    for (uint32_t timestamp = LAST_DAY * SECONDS_BY_DAY; timestamp != 0; timestamp++) {
+        check_timestamp(timestamp);
+    }
+}
+
+TEST(TestMktime, DISABLED_every_second_matches_the_host_library)
+{
+    uint32_t timestamp = 0;
+
+    do {
+        check_timestamp(timestamp);
+    } while (++timestamp != 0);
+}
+
+TEST(TestMktime, partial_leap_year_support_has_a_29th_of_february_2100)
+{
+    CalendarWalk walk(rtc_4_year_leap_year, 70, EPOCH_WDAY);
+
+    // The RTC counts one more day than the true calendar, so its range ends a day earlier
+    for (uint32_t day = 0; day < LAST_DAY; day++, walk.next_day()) {
+        struct tm actual;
+        time_t timestamp = (time_t)day * SECONDS_BY_DAY + 12345;
+        time_t seconds;
+
+        walk.tm.tm_sec = 45;
+        walk.tm.tm_min = 25;
+        walk.tm.tm_hour = 3;
+        memset(&actual, 0, sizeof(actual));
+        ASSERT_TRUE(_rtc_localtime(timestamp, &actual, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+        expect_same_tm(walk.tm, actual, timestamp);
+        ASSERT_TRUE(_rtc_maketime(&walk.tm, &seconds, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+        ASSERT_EQ(timestamp, seconds);
+    }
+
+    struct tm tm;
+    time_t seconds;
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = 200;
+    tm.tm_mon = 1;
+    tm.tm_mday = 29;
+    EXPECT_TRUE(_rtc_maketime(&tm, &seconds, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+    EXPECT_EQ((time_t)47541 * SECONDS_BY_DAY, seconds);
+    // Without the leap day, the 29th is taken for the 1st of March
+    EXPECT_TRUE(_rtc_maketime(&tm, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT));
+    EXPECT_EQ((time_t)47541 * SECONDS_BY_DAY, seconds);
+}
+
+TEST(TestMktime, maketime_rejects_times_out_of_range)
+{
+    struct tm tm;
+    time_t seconds;
+
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = 206;
+    tm.tm_mon = 1;
+    tm.tm_mday = 7;
+    tm.tm_hour = 6;
+    tm.tm_min = 28;
+    tm.tm_sec = 15;
+    EXPECT_TRUE(_rtc_maketime(&tm, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT));
+    EXPECT_EQ((time_t)UINT32_MAX, seconds);
+    tm.tm_sec = 16;
+    EXPECT_FALSE(_rtc_maketime(&tm, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT));
+    tm.tm_mday = 6;
+    EXPECT_FALSE(_rtc_maketime(&tm, &seconds, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+    tm.tm_sec = 15;
+    EXPECT_TRUE(_rtc_maketime(&tm, &seconds, RTC_4_YEAR_LEAP_YEAR_SUPPORT));
+    EXPECT_EQ((time_t)UINT32_MAX, seconds);
+
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_mday = 1;
+    tm.tm_year = 69;
+    EXPECT_FALSE(_rtc_maketime(&tm, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT));
+    tm.tm_year = 207;
+    EXPECT_FALSE(_rtc_maketime(&tm, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT));
+    tm.tm_year = 70;
+    tm.tm_mon = 12;
+    EXPECT_FALSE(_rtc_maketime(&tm, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT));
+    tm.tm_mon = -1;
+    EXPECT_FALSE(_rtc_maketime(&tm, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT));
+    EXPECT_FALSE(_rtc_maketime(NULL, &seconds, RTC_FULL_LEAP_YEAR_SUPPORT));
+    EXPECT_FALSE(_rtc_localtime(0, NULL, RTC_FULL_LEAP_YEAR_SUPPORT));
+}
+
+/* Both 64-bit conversions of one timestamp */
+static void check_timestamp64(int64_t timestamp)
+{
+    struct tm expected, actual;
+    time_t host_time = timestamp;
+    int64_t seconds;
+
+    ASSERT_TRUE(gmtime_r(&host_time, &expected) != NULL) << timestamp;
+    memset(&actual, 0, sizeof(actual));
+    ASSERT_TRUE(_rtc_localtime64(timestamp, &actual));
+    expect_same_tm(expected, actual, timestamp);
+
+    ASSERT_TRUE(_rtc_maketime64(&expected, &seconds)) << timestamp;
+    ASSERT_EQ(timestamp, seconds);
+}
+
+TEST(TestMktime, every_day_of_twenty_thousand_years_in_64_bits)
+{
+    // The 1st of January of 10000 BC, year -9999 of the proleptic calendar, was a Monday
+    CalendarWalk walk(gregorian_leap_year, -9999 - 1900, 1);
+    int64_t day = -4371587;
+
+    for (; walk.tm.tm_year < 10000 - 1900; day++, walk.next_day()) {
+        struct tm actual;
+        int64_t seconds;
+
+        memset(&actual, 0, sizeof(actual));
+        ASSERT_TRUE(_rtc_localtime64(day * SECONDS_BY_DAY, &actual));
+        expect_same_tm(walk.tm, actual, day * SECONDS_BY_DAY);
+        ASSERT_TRUE(_rtc_maketime64(&walk.tm, &seconds));
+        ASSERT_EQ(day * SECONDS_BY_DAY, seconds);
+
+        // And a time of day in the host library, on some of the days
+        if (day % 13 == 0) {
+            check_timestamp64(day * SECONDS_BY_DAY + (day & 0xFFFF) % SECONDS_BY_DAY);
+        }
+    }
+    EXPECT_EQ(2932897, day);
+}
+
+TEST(TestMktime, whole_64_bit_range_matches_the_host_library)
+{
+    // Every 10007th day, and the seconds around its midnight
+    for (int64_t day = -1500000000; day <= 1500000000; day += 10007) {
+        check_timestamp64(day * SECONDS_BY_DAY);
+        check_timestamp64(day * SECONDS_BY_DAY + 1);
+        check_timestamp64(day * SECONDS_BY_DAY + 43210);
+        check_timestamp64(day * SECONDS_BY_DAY + SECONDS_BY_DAY - 1);
+    }
+    check_timestamp64(1500000000LL * SECONDS_BY_DAY + SECONDS_BY_DAY - 1);
+
+    struct tm tm;
+    EXPECT_FALSE(_rtc_localtime64(1500000001LL * SECONDS_BY_DAY, &tm));
+    EXPECT_FALSE(_rtc_localtime64(-1500000000LL * SECONDS_BY_DAY - 1, &tm));
+    EXPECT_FALSE(_rtc_localtime64(0, NULL));
+}
+
+TEST(TestMktime, maketime64_takes_its_whole_year_range)
+{
+    struct tm tm;
+    int64_t seconds;
+
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_mday = 1;
+    tm.tm_year = 4110000 - 1900;
+    tm.tm_mon = 11;
+    tm.tm_mday = 31;
+    tm.tm_hour = 23;
+    tm.tm_min = 59;
+    tm.tm_sec = 59;
+    ASSERT_TRUE(_rtc_maketime64(&tm, &seconds));
+    EXPECT_EQ(timegm(&tm), seconds);
+
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_mday = 1;
+    tm.tm_year = -4110000 - 1900;
+    ASSERT_TRUE(_rtc_maketime64(&tm, &seconds));
+    EXPECT_EQ(timegm(&tm), seconds);
+
+    tm.tm_year--;
+    EXPECT_FALSE(_rtc_maketime64(&tm, &seconds));
+    tm.tm_year = 4110001 - 1900;
+    EXPECT_FALSE(_rtc_maketime64(&tm, &seconds));
+    tm.tm_year = 70;
+    tm.tm_mon = 12;
+    EXPECT_FALSE(_rtc_maketime64(&tm, &seconds));
+    EXPECT_FALSE(_rtc_maketime64(NULL, &seconds));
+}
@@ -0,0 +1,89 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* How long a blocked poll() takes to return once a file handle calls
+ * poll_change(), and how often it scans its file handles while nothing
+ * happens. bench_poll_rescan is the same with a 100 ms poll-rescan-period,
+ * the old default; on the target each scan is a wake of the thread.
+ *
+ *   bench_poll [rounds] [idle ms] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "event_file.h"
+
+#define BENCH_ROUNDS    2000
+#define BENCH_IDLE_MS   2000
+
+#ifndef MBED_CONF_PLATFORM_POLL_RESCAN_PERIOD
+#define MBED_CONF_PLATFORM_POLL_RESCAN_PERIOD   0
+#endif
+
+using namespace mbed;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench_wake(int rounds)
+{
+    double total = 0;
+
+    for (int n = 0; n < rounds; n++) {
+        EventFile file;
+        std::atomic<double> changed(0);
+        std::thread driver([&]() {
+            while (file.scans() == 0) {
+                std::this_thread::yield();
+            }
+            // Give the poller time to go to sleep
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            changed = now_ns();
+            file.set(POLLIN);
+        });
+        pollfh fhs[] = { { &file, POLLIN, 0 } };
+        poll(fhs, 1, -1);
+        total += now_ns() - changed;
+        driver.join();
+    }
+    printf("wake on poll_change: %8.0f ns\n", total / rounds);
+}
+
+static void bench_idle(int idle_ms)
+{
+    EventFile file;
+    pollfh fhs[] = { { &file, POLLIN, 0 } };
+
+    poll(fhs, 1, idle_ms);
+    printf("idle for %d ms:      %8u scans\n", idle_ms, file.scans());
+}
+
+int main(int argc, char *argv[])
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : BENCH_ROUNDS;
+    int idle_ms = argc > 2 ? atoi(argv[2]) : BENCH_IDLE_MS;
+
+    printf("poll-rescan-period %d ms\n", MBED_CONF_PLATFORM_POLL_RESCAN_PERIOD);
+    bench_wake(rounds);
+    bench_idle(idle_ms);
+    return 0;
+}
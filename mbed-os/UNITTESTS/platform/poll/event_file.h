@@ -0,0 +1,73 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EVENT_FILE_H
+#define EVENT_FILE_H
+
+/* A FileHandle whose poll() events are set by the test, which calls
+ * poll_change() as a driver does from its interrupt, and which counts how
+ * often poll() scans it */
+
+#include <atomic>
+#include "platform/FileHandle.h"
+#include "platform/mbed_poll.h"
+
+class EventFile : public mbed::FileHandle {
+public:
+    EventFile() : _revents(0), _scans(0) {}
+
+    void set(short revents)
+    {
+        _revents = revents;
+        mbed::poll_change();
+    }
+
+    unsigned scans() const
+    {
+        return _scans;
+    }
+
+    virtual ssize_t read(void *buffer, size_t size)
+    {
+        return -EAGAIN;
+    }
+
+    virtual ssize_t write(const void *buffer, size_t size)
+    {
+        return -EAGAIN;
+    }
+
+    virtual off_t seek(off_t offset, int whence = SEEK_SET)
+    {
+        return -ESPIPE;
+    }
+
+    virtual int close()
+    {
+        return 0;
+    }
+
+    virtual short poll(short events) const
+    {
+        _scans++;
+        return _revents & events;
+    }
+
+private:
+    std::atomic<short> _revents;
+    mutable std::atomic<unsigned> _scans;
+};
+
+#endif
@@ -0,0 +1,35 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <pthread.h>
+
+/* Host build: critical sections on a recursive mutex, as the threads that
+ * call poll_change() stand in for interrupts */
+
+static pthread_mutex_t critical_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+extern "C" {
+
+void core_util_critical_section_enter(void)
+{
+    pthread_mutex_lock(&critical_mutex);
+}
+
+void core_util_critical_section_exit(void)
+{
+    pthread_mutex_unlock(&critical_mutex);
+}
+
+}
@@ -0,0 +1,139 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of mbed::poll() with the RTOS: a blocked poll() sleeps until a
+ * file handle calls poll_change() or the timeout expires, and scans its file
+ * handles once per wake rather than every poll-rescan-period */
+#include <chrono>
+#include <thread>
+#include "gtest/gtest.h"
+#include "event_file.h"
+
+using namespace mbed;
+
+static int64_t elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(TestPoll, ready_file_handle_returns_at_once)
+{
+    EventFile file;
+    file.set(POLLOUT);
+    pollfh fhs[] = { { &file, POLLIN | POLLOUT, 0 } };
+
+    EXPECT_EQ(1, poll(fhs, 1, -1));
+    EXPECT_EQ(POLLOUT, fhs[0].revents);
+    EXPECT_EQ(1u, file.scans());
+}
+
+TEST(TestPoll, missing_file_handle_is_invalid)
+{
+    EventFile file;
+    pollfh fhs[] = { { &file, POLLIN, 0 }, { NULL, POLLIN, 0 } };
+
+    EXPECT_EQ(1, poll(fhs, 2, -1));
+    EXPECT_EQ(0, fhs[0].revents);
+    EXPECT_EQ(POLLNVAL, fhs[1].revents);
+}
+
+TEST(TestPoll, zero_timeout_scans_once)
+{
+    EventFile file;
+    pollfh fhs[] = { { &file, POLLIN, 0 } };
+
+    EXPECT_EQ(0, poll(fhs, 1, 0));
+    EXPECT_EQ(0, fhs[0].revents);
+    EXPECT_EQ(1u, file.scans());
+}
+
+TEST(TestPoll, timeout_sleeps_without_rescanning)
+{
+    EventFile file;
+    pollfh fhs[] = { { &file, POLLIN, 0 } };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    EXPECT_EQ(0, poll(fhs, 1, 250));
+    EXPECT_GE(elapsed_ms(start), 250);
+    // Once on entry and once when the timeout expires
+    EXPECT_LE(file.scans(), 3u);
+}
+
+TEST(TestPoll, change_wakes_a_blocked_poll)
+{
+    EventFile file;
+    pollfh fhs[] = { { &file, POLLIN, 0 } };
+
+    std::thread driver([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        // Events that were not asked for wake the poll, which sleeps again
+        file.set(POLLOUT);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        file.set(POLLIN | POLLOUT);
+    });
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    EXPECT_EQ(1, poll(fhs, 1, -1));
+    int64_t elapsed = elapsed_ms(start);
+    driver.join();
+
+    EXPECT_EQ(POLLIN, fhs[0].revents);
+    EXPECT_GE(elapsed, 350);
+    EXPECT_LT(elapsed, 1000);
+    EXPECT_EQ(3u, file.scans());
+}
+
+TEST(TestPoll, change_wakes_every_blocked_poll)
+{
+    EventFile first;
+    EventFile second;
+    int result[2] = { -1, -1 };
+
+    std::thread waiter1([&]() {
+        pollfh fhs[] = { { &first, POLLIN, 0 } };
+        result[0] = poll(fhs, 1, 5000);
+    });
+    std::thread waiter2([&]() {
+        pollfh fhs[] = { { &second, POLLIN, 0 } };
+        result[1] = poll(fhs, 1, 5000);
+    });
+    while (first.scans() == 0 || second.scans() == 0) {
+        std::this_thread::yield();
+    }
+    first.set(POLLIN);
+    second.set(POLLIN);
+    waiter1.join();
+    waiter2.join();
+
+    EXPECT_EQ(1, result[0]);
+    EXPECT_EQ(1, result[1]);
+}
+
+TEST(TestPoll, change_during_the_scan_is_not_lost)
+{
+    // The change lands after poll() registered itself, before it sleeps
+    for (int round = 0; round < 200; round++) {
+        EventFile file;
+        pollfh fhs[] = { { &file, POLLIN, 0 } };
+        std::thread driver([&]() {
+            while (file.scans() == 0) {
+                std::this_thread::yield();
+            }
+            file.set(POLLIN);
+        });
+        ASSERT_EQ(1, poll(fhs, 1, 5000)) << round;
+        driver.join();
+    }
+}
@@ -0,0 +1,96 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Cost of recording an event into the RAM ring, enabled and filtered out,
+ * and of reading it back
+ *
+ *   bench_event_recorder [events] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "EventRecorder.h"
+#include "rtos/rtos_event_recorder.h"
+#include "cmsis_os2.h"
+
+#define BENCH_EVENTS    10000000
+
+#define THREAD_API      EventID(EventLevelAPI, RTOS_EVENT_COMPONENT_THREAD, 1)
+#define THREAD_DETAIL   EventID(EventLevelDetail, RTOS_EVENT_COMPONENT_THREAD, 1)
+
+extern "C" {
+
+uint32_t osThreadEnumerate(osThreadId_t *thread_array, uint32_t array_items)
+{
+    return 0;
+}
+
+const char *osThreadGetName(osThreadId_t thread_id)
+{
+    return NULL;
+}
+
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t events = (argc > 1) ? strtoul(argv[1], NULL, 0) : BENCH_EVENTS;
+    rtos_event_record_t records[MBED_EVENT_RECORDER_RECORDS];
+    uint32_t sum = 0;
+
+    rtos_event_recorder_init();
+
+    double start = now_ns();
+    for (uint32_t i = 0; i < events; i++) {
+        sum += EventRecord2(THREAD_API, i, 0);
+    }
+    double record2_ns = (now_ns() - start) / events;
+
+    start = now_ns();
+    for (uint32_t i = 0; i < events; i++) {
+        sum += EventRecord4(THREAD_API, i, 0, 0, 0);
+    }
+    double record4_ns = (now_ns() - start) / events;
+
+    start = now_ns();
+    for (uint32_t i = 0; i < events; i++) {
+        sum += EventRecord2(THREAD_DETAIL, i, 0);
+    }
+    double filtered_ns = (now_ns() - start) / events;
+
+    // Fill the ring, then drain it
+    uint32_t rounds = events / MBED_EVENT_RECORDER_RECORDS;
+    double read_ns = 0;
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < MBED_EVENT_RECORDER_RECORDS; i++) {
+            EventRecord2(THREAD_API, i, 0);
+        }
+        start = now_ns();
+        sum += rtos_event_recorder_read(records, MBED_EVENT_RECORDER_RECORDS);
+        read_ns += now_ns() - start;
+    }
+    read_ns /= (double)rounds * MBED_EVENT_RECORDER_RECORDS;
+
+    printf("EventRecord2 %.2f ns, EventRecord4 %.2f ns, filtered out %.2f ns, read %.2f ns per record  (%u)\n",
+           record2_ns, record4_ns, filtered_ns, read_ns, sum & 1);
+    return 0;
+}
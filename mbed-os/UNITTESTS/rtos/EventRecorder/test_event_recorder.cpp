@@ -0,0 +1,253 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Host test of the RAM ring behind the RTX event recorder, with a ring of
+ * 16 records; the source is included for its ring state */
+#include <thread>
+#include "gtest/gtest.h"
+#include "us_ticker_fake.h"
+#include "mbed_rtx_evr.c"
+
+#define THREAD_API(msg)     EventID(EventLevelAPI, RTOS_EVENT_COMPONENT_THREAD, msg)
+#define MUTEX_API(msg)      EventID(EventLevelAPI, RTOS_EVENT_COMPONENT_MUTEX, msg)
+#define THREAD_DETAIL(msg)  EventID(EventLevelDetail, RTOS_EVENT_COMPONENT_THREAD, msg)
+
+extern "C" {
+
+static const char *thread_name = "main";
+
+uint32_t osThreadEnumerate(osThreadId_t *thread_array, uint32_t array_items)
+{
+    thread_array[0] = (osThreadId_t)0x20001000;
+    return 1;
+}
+
+const char *osThreadGetName(osThreadId_t thread_id)
+{
+    return thread_name;
+}
+
+}
+
+class TestEventRecorder : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memset(evr_ring, 0, sizeof(evr_ring));
+        evr_head = 0;
+        evr_tail = 0;
+        evr_lost = 0;
+        us_ticker_fake_reset();
+        rtos_event_recorder_init();
+    }
+
+    size_t read_all()
+    {
+        return rtos_event_recorder_read(records, sizeof(records) / sizeof(records[0]));
+    }
+
+    rtos_event_record_t records[64];
+};
+
+TEST_F(TestEventRecorder, records_come_back_in_order)
+{
+    for (uint32_t i = 0; i < 5; i++) {
+        EXPECT_EQ(1u, EventRecord2(THREAD_API(i), i, ~i));
+        us_ticker_fake_advance(10);
+    }
+
+    ASSERT_EQ(5u, read_all());
+    for (uint32_t i = 0; i < 5; i++) {
+        EXPECT_EQ(i * 10, records[i].timestamp);
+        // The lap tag is stripped
+        EXPECT_EQ((uint32_t)THREAD_API(i), records[i].id);
+        EXPECT_EQ(i, records[i].val1);
+        EXPECT_EQ(~i, records[i].val2);
+    }
+    EXPECT_EQ(0u, read_all());
+    EXPECT_EQ(0u, rtos_event_recorder_lost());
+}
+
+TEST_F(TestEventRecorder, four_values_take_two_records)
+{
+    us_ticker_fake_advance(1234);
+    EventRecord4(MUTEX_API(3), 1, 2, 3, 4);
+
+    ASSERT_EQ(2u, read_all());
+    EXPECT_EQ((uint32_t)MUTEX_API(3), records[0].id);
+    EXPECT_EQ(MUTEX_API(3) | RTOS_EVENT_RECORD_CONTINUED, records[1].id);
+    EXPECT_EQ(1234u, records[1].timestamp);
+    EXPECT_EQ(1u, records[0].val1);
+    EXPECT_EQ(2u, records[0].val2);
+    EXPECT_EQ(3u, records[1].val1);
+    EXPECT_EQ(4u, records[1].val2);
+}
+
+TEST_F(TestEventRecorder, data_keeps_its_length_and_first_word)
+{
+    EventRecordData(THREAD_API(1), "\x01\x02\x03\x04\x05", 5);
+    EventRecordData(THREAD_API(2), "\x01\x02", 2);
+
+    ASSERT_EQ(2u, read_all());
+    EXPECT_EQ(5u, records[0].val1);
+    EXPECT_EQ(0x04030201u, records[0].val2);
+    EXPECT_EQ(2u, records[1].val1);
+    EXPECT_EQ(0x0201u, records[1].val2);
+}
+
+TEST_F(TestEventRecorder, levels_and_components_can_be_turned_off)
+{
+    // Detail is off at boot
+    EXPECT_EQ(0u, EventRecord2(THREAD_DETAIL(1), 0, 0));
+
+    rtos_event_recorder_disable(RTOS_EVENT_LEVEL_API, RTOS_EVENT_COMPONENT_MUTEX,
+                                RTOS_EVENT_COMPONENT_MUTEX);
+    EXPECT_EQ(0u, EventRecord2(MUTEX_API(1), 0, 0));
+    EXPECT_EQ(0u, EventRecord4(MUTEX_API(1), 0, 0, 0, 0));
+    EXPECT_EQ(1u, EventRecord2(THREAD_API(1), 0, 0));
+
+    EventRecorderEnable(EventRecordAPI | EventRecordDetail, 0x00, 0xFF);
+    EXPECT_EQ(1u, EventRecord2(MUTEX_API(2), 0, 0));
+    EXPECT_EQ(1u, EventRecord2(THREAD_DETAIL(2), 0, 0));
+
+    ASSERT_EQ(3u, read_all());
+    EXPECT_EQ((uint32_t)THREAD_API(1), records[0].id);
+    EXPECT_EQ((uint32_t)MUTEX_API(2), records[1].id);
+    EXPECT_EQ((uint32_t)THREAD_DETAIL(2), records[2].id);
+}
+
+TEST_F(TestEventRecorder, oldest_records_are_overwritten_and_counted)
+{
+    for (uint32_t i = 0; i < 40; i++) {
+        EventRecord2(THREAD_API(1), i, 0);
+    }
+
+    ASSERT_EQ(16u, read_all());
+    EXPECT_EQ(24u, rtos_event_recorder_lost());
+    for (uint32_t i = 0; i < 16; i++) {
+        EXPECT_EQ(24 + i, records[i].val1);
+    }
+
+    // A partial read, then another lap
+    for (uint32_t i = 0; i < 10; i++) {
+        EventRecord2(THREAD_API(1), 100 + i, 0);
+    }
+    EXPECT_EQ(4u, rtos_event_recorder_read(records, 4));
+    for (uint32_t i = 0; i < 20; i++) {
+        EventRecord2(THREAD_API(1), 200 + i, 0);
+    }
+    ASSERT_EQ(16u, read_all());
+    EXPECT_EQ(24u + 6 + 4, rtos_event_recorder_lost());
+    EXPECT_EQ(204u, records[0].val1);
+}
+
+TEST_F(TestEventRecorder, a_slot_being_written_stops_the_read)
+{
+    // On the second lap, so the slot still holds a finished record of the first
+    for (uint32_t i = 0; i < 20; i++) {
+        EventRecord2(THREAD_API(1), i, 0);
+    }
+    read_all();
+
+    EventRecord2(THREAD_API(1), 20, 0);
+    // A writer interrupted between claiming its slot and publishing it
+    uint32_t seq = core_util_atomic_incr_u32(&evr_head, 1) - 1;
+    EventRecord2(THREAD_API(1), 22, 0);
+
+    ASSERT_EQ(1u, read_all());
+    EXPECT_EQ(20u, records[0].val1);
+    EXPECT_EQ(0u, read_all());
+
+    evr_put(seq, THREAD_API(1), 0, 21, 0);
+    ASSERT_EQ(2u, read_all());
+    EXPECT_EQ(21u, records[0].val1);
+    EXPECT_EQ(22u, records[1].val1);
+    // Only the first lap was lost
+    EXPECT_EQ(4u, rtos_event_recorder_lost());
+}
+
+TEST_F(TestEventRecorder, zeroed_ram_is_not_a_record)
+{
+    evr_head = 1;
+    EXPECT_EQ(0u, read_all());
+}
+
+TEST_F(TestEventRecorder, print_writes_the_lines_rtx_trace_reads)
+{
+    us_ticker_fake_advance(0x100);
+    EventRecord2(THREAD_API(7), 0x11, 0x22);
+
+    testing::internal::CaptureStdout();
+    rtos_event_recorder_print();
+    std::string output = testing::internal::GetCapturedStdout();
+
+    EXPECT_EQ("evr: freq=1000000 bits=32\r\n"
+              "evr: 00000100 0001f207 00000011 00000022\r\n"
+              "evr: thread id=0x20001000 name=main\r\n"
+              "evr: lost=0\r\n", output);
+}
+
+TEST_F(TestEventRecorder, writer_threads_and_a_reader)
+{
+    const uint32_t writers = 4;
+    const uint32_t per_writer = 200000;
+    uint32_t next[writers] = { 0 };
+    uint32_t read = 0;
+    bool consistent = true;
+    volatile bool done = false;
+
+    auto check = [&](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            // The message number names the writer, val2 counts its records
+            uint32_t writer = records[i].val1;
+            if (writer >= writers || (records[i].id & 0xFF) != writer ||
+                    records[i].val2 < next[writer]) {
+                consistent = false;
+                return;
+            }
+            next[writer] = records[i].val2 + 1;
+        }
+        read += n;
+    };
+
+    std::thread reader([&]() {
+        while (!done) {
+            size_t n = read_all();
+            if (n == 0) {
+                std::this_thread::yield();
+            }
+            check(n);
+        }
+    });
+    std::thread threads[writers];
+    for (uint32_t w = 0; w < writers; w++) {
+        threads[w] = std::thread([w, per_writer]() {
+            for (uint32_t i = 0; i < per_writer; i++) {
+                EventRecord2(THREAD_API(w), w, i);
+            }
+        });
+    }
+    for (uint32_t w = 0; w < writers; w++) {
+        threads[w].join();
+    }
+    done = true;
+    reader.join();
+    check(read_all());
+
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(writers * per_writer, read + rtos_event_recorder_lost());
+    EXPECT_GT(read, 0u);
+}
@@ -0,0 +1,29 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_DEVICE_H
+#define MBED_DEVICE_H
+
+/* Host build: the peripherals that the fakes in this directory provide */
+#define DEVICE_SPI                  1
+#define DEVICE_SPI_ASYNCH           1
+
+#ifndef TRANSACTION_QUEUE_SIZE_SPI
+#define TRANSACTION_QUEUE_SIZE_SPI  4
+#endif
+
+#include "objects.h"
+
+#endif
@@ -0,0 +1,82 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "drivers/TimerEvent.h"
+#include "platform/mbed_assert.h"
+
+#include <stddef.h>
+
+/* Host build: TimerEvent as on target, but the ticker event ID is an index
+ * into a table rather than the object address, which does not fit the 32-bit
+ * ID on a 64-bit PC. */
+
+#define TIMER_EVENT_MAX     16
+
+namespace mbed {
+
+static TimerEvent *timer_events[TIMER_EVENT_MAX];
+
+static uint32_t timer_event_id(TimerEvent *timer_event)
+{
+    for (uint32_t i = 0; i < TIMER_EVENT_MAX; i++) {
+        if (timer_events[i] == timer_event) {
+            return i;
+        }
+    }
+    for (uint32_t i = 0; i < TIMER_EVENT_MAX; i++) {
+        if (timer_events[i] == NULL) {
+            timer_events[i] = timer_event;
+            return i;
+        }
+    }
+    MBED_ASSERT(0);
+    return 0;
+}
+
+TimerEvent::TimerEvent() : event(), _ticker_data(get_us_ticker_data()) {
+    ticker_set_handler(_ticker_data, (&TimerEvent::irq));
+}
+
+TimerEvent::TimerEvent(const ticker_data_t *data) : event(), _ticker_data(data) {
+    ticker_set_handler(_ticker_data, (&TimerEvent::irq));
+}
+
+void TimerEvent::irq(uint32_t id) {
+    TimerEvent *timer_event = timer_events[id];
+    timer_event->handler();
+}
+
+TimerEvent::~TimerEvent() {
+    remove();
+    for (uint32_t i = 0; i < TIMER_EVENT_MAX; i++) {
+        if (timer_events[i] == this) {
+            timer_events[i] = NULL;
+        }
+    }
+}
+
+void TimerEvent::insert(timestamp_t timestamp) {
+    ticker_insert_event(_ticker_data, &event, timestamp, timer_event_id(this));
+}
+
+void TimerEvent::insert_absolute(us_timestamp_t timestamp) {
+    ticker_insert_event_us(_ticker_data, &event, timestamp, timer_event_id(this));
+}
+
+void TimerEvent::remove() {
+    ticker_remove_event(_ticker_data, &event);
+}
+
+} // namespace mbed
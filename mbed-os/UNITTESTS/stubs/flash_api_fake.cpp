@@ -0,0 +1,136 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "flash_api_fake.h"
+#include "hal/flash_api.h"
+
+static uint8_t flash_memory[FLASH_FAKE_SIZE];
+static uint32_t flash_erases[FLASH_FAKE_SIZE / FLASH_FAKE_SECTOR_SIZE];
+static uint32_t flash_programmed;
+static int32_t flash_fail_after = -1;
+
+static bool flash_fake_in_range(uint32_t address, uint32_t size)
+{
+    return address >= FLASH_FAKE_START && size <= FLASH_FAKE_SIZE &&
+           address - FLASH_FAKE_START <= FLASH_FAKE_SIZE - size;
+}
+
+void flash_fake_reset(void)
+{
+    memset(flash_memory, 0xFF, sizeof(flash_memory));
+    memset(flash_erases, 0, sizeof(flash_erases));
+    flash_programmed = 0;
+    flash_fail_after = -1;
+}
+
+uint8_t *flash_fake_memory(uint32_t address)
+{
+    return &flash_memory[address - FLASH_FAKE_START];
+}
+
+void flash_fake_fail_after(int32_t bytes)
+{
+    flash_fail_after = bytes;
+}
+
+uint32_t flash_fake_erase_count(uint32_t address)
+{
+    return flash_erases[(address - FLASH_FAKE_START) / FLASH_FAKE_SECTOR_SIZE];
+}
+
+uint32_t flash_fake_program_bytes(void)
+{
+    return flash_programmed;
+}
+
+int32_t flash_init(flash_t *obj)
+{
+    (void)obj;
+    return 0;
+}
+
+int32_t flash_free(flash_t *obj)
+{
+    (void)obj;
+    return 0;
+}
+
+int32_t flash_erase_sector(flash_t *obj, uint32_t address)
+{
+    (void)obj;
+    if (!flash_fake_in_range(address, FLASH_FAKE_SECTOR_SIZE) ||
+        (address - FLASH_FAKE_START) % FLASH_FAKE_SECTOR_SIZE) {
+        return -1;
+    }
+    memset(flash_fake_memory(address), 0xFF, FLASH_FAKE_SECTOR_SIZE);
+    flash_erases[(address - FLASH_FAKE_START) / FLASH_FAKE_SECTOR_SIZE]++;
+    return 0;
+}
+
+int32_t flash_read(flash_t *obj, uint32_t address, uint8_t *data, uint32_t size)
+{
+    (void)obj;
+    if (!flash_fake_in_range(address, size)) {
+        return -1;
+    }
+    memcpy(data, flash_fake_memory(address), size);
+    return 0;
+}
+
+int32_t flash_program_page(flash_t *obj, uint32_t address, const uint8_t *data, uint32_t size)
+{
+    (void)obj;
+    if (!flash_fake_in_range(address, size) || address % FLASH_FAKE_PAGE_SIZE || size % FLASH_FAKE_PAGE_SIZE) {
+        return -1;
+    }
+    uint8_t *memory = flash_fake_memory(address);
+    for (uint32_t i = 0; i < size; i++) {
+        if (flash_fail_after == 0) {
+            flash_fail_after = -1;
+            return -1;
+        }
+        if (flash_fail_after > 0) {
+            flash_fail_after--;
+        }
+        memory[i] &= data[i];
+        flash_programmed++;
+    }
+    return 0;
+}
+
+uint32_t flash_get_sector_size(const flash_t *obj, uint32_t address)
+{
+    (void)obj;
+    return flash_fake_in_range(address, 1) ? FLASH_FAKE_SECTOR_SIZE : MBED_FLASH_INVALID_SIZE;
+}
+
+uint32_t flash_get_page_size(const flash_t *obj)
+{
+    (void)obj;
+    return FLASH_FAKE_PAGE_SIZE;
+}
+
+uint32_t flash_get_start_address(const flash_t *obj)
+{
+    (void)obj;
+    return FLASH_FAKE_START;
+}
+
+uint32_t flash_get_size(const flash_t *obj)
+{
+    (void)obj;
+    return FLASH_FAKE_SIZE;
+}
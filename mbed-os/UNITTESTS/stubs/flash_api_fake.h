@@ -0,0 +1,58 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_FLASH_API_FAKE_H
+#define MBED_FLASH_API_FAKE_H
+
+#include <stdint.h>
+
+/* Fake flash_api for host tests, laid out as the STM32L443RC: 256 KB from
+ * 0x08000000 in 2 KB sectors, programmed a double word at a time. Like NOR
+ * flash, programming only clears bits, so writes over data that was not
+ * erased show up as corruption rather than passing silently. */
+
+#define FLASH_FAKE_START        0x08000000UL
+#define FLASH_FAKE_SIZE         0x40000UL
+#define FLASH_FAKE_SECTOR_SIZE  0x800UL
+#define FLASH_FAKE_PAGE_SIZE    8UL
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Erase all of the flash, clear the counters and the injected failure */
+void flash_fake_reset(void);
+
+/** Memory of the flash at an address, for tests that inspect or corrupt it */
+uint8_t *flash_fake_memory(uint32_t address);
+
+/** Fail a program operation once this many more bytes have been programmed
+ *
+ *  The bytes before the failure are programmed, as with a power loss in the
+ *  middle of a write. -1 for no failure.
+ */
+void flash_fake_fail_after(int32_t bytes);
+
+/** Erases of the sector holding an address since the last reset */
+uint32_t flash_fake_erase_count(uint32_t address);
+
+/** Bytes programmed since the last reset */
+uint32_t flash_fake_program_bytes(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
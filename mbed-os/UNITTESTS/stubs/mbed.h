@@ -0,0 +1,40 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_H
+#define MBED_H
+
+/* Host build: the parts of mbed.h that the application modules under test
+ * use, with the fakes of this directory behind them */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform/mbed_toolchain.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_critical.h"
+#include "platform/NonCopyable.h"
+#include "platform/Callback.h"
+#include "platform/FileHandle.h"
+#include "drivers/FlashIAP.h"
+#include "drivers/MbedCRC.h"
+
+namespace mbed {
+class RawSerial;    // In the signatures of the application's node_api.h
+}
+
+using namespace mbed;
+
+#endif
@@ -0,0 +1,68 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Host build: the platform functions that the drivers under test call, with
+ * a single thread and no interrupts to mask */
+
+extern "C" {
+
+void core_util_critical_section_enter(void)
+{
+}
+
+void core_util_critical_section_exit(void)
+{
+}
+
+bool core_util_atomic_cas_ptr(void *volatile *ptr, void **expectedCurrentValue, void *desiredValue)
+{
+    if (*ptr != *expectedCurrentValue) {
+        *expectedCurrentValue = *ptr;
+        return false;
+    }
+    *ptr = desiredValue;
+    return true;
+}
+
+uint32_t core_util_atomic_incr_u32(volatile uint32_t *valuePtr, uint32_t delta)
+{
+    // Writers of the event recorder run in threads of their own
+    return __atomic_add_fetch(valuePtr, delta, __ATOMIC_SEQ_CST);
+}
+
+void sleep_manager_lock_deep_sleep_internal(void)
+{
+}
+
+void sleep_manager_unlock_deep_sleep_internal(void)
+{
+}
+
+void mbed_assert_internal(const char *expr, const char *file, int line)
+{
+    fprintf(stderr, "mbed assertation failed: %s, file: %s, line %d\n", expr, file, line);
+    abort();
+}
+
+void NVIC_SystemReset(void)
+{
+    abort();
+}
+
+}
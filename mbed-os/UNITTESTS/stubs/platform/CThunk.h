@@ -0,0 +1,130 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __CTHUNK_H__
+#define __CTHUNK_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Host build: the target CThunk runs a Thumb code trampoline. Here entry()
+ * is a handle, and a fake HAL calls it back through cthunk_call(). */
+
+typedef void (*CThunkEntry)(void);
+
+#define CTHUNK_MAX  8
+
+struct cthunk_slot {
+    void *thunk;
+    void (*call)(void *thunk);
+};
+
+extern cthunk_slot cthunk_slots[CTHUNK_MAX];
+
+/** Call the thunk behind an entry() handle */
+void cthunk_call(uint32_t entry);
+
+template<class T>
+class CThunk
+{
+    public:
+        typedef void (T::*CCallbackSimple)(void);
+        typedef void (T::*CCallback)(void* context);
+
+        inline CThunk(T *instance)
+        {
+            init(instance, NULL, NULL);
+        }
+
+        inline CThunk(T *instance, CCallback callback)
+        {
+            init(instance, callback, NULL);
+        }
+
+        inline CThunk(T *instance, CCallbackSimple callback)
+        {
+            init(instance, (CCallback)callback, NULL);
+        }
+
+        ~CThunk()
+        {
+            for (int i = 0; i < CTHUNK_MAX; i++) {
+                if (cthunk_slots[i].thunk == this) {
+                    cthunk_slots[i].thunk = NULL;
+                }
+            }
+        }
+
+        inline void callback(CCallback callback)
+        {
+            m_callback = callback;
+        }
+
+        inline void callback(CCallbackSimple callback)
+        {
+            m_callback = (CCallback)callback;
+        }
+
+        inline void context(void* context)
+        {
+            m_context = context;
+        }
+
+        inline uint32_t entry(void)
+        {
+            int free = -1;
+            for (int i = 0; i < CTHUNK_MAX; i++) {
+                if (cthunk_slots[i].thunk == this) {
+                    return i + 1;
+                }
+                if (free < 0 && cthunk_slots[i].thunk == NULL) {
+                    free = i;
+                }
+            }
+            if (free < 0) {
+                return 0;
+            }
+            cthunk_slots[free].thunk = this;
+            cthunk_slots[free].call = &CThunk::trampoline;
+            return free + 1;
+        }
+
+        inline void call(void)
+        {
+            trampoline(this);
+        }
+
+    private:
+        static void trampoline(void *thunk)
+        {
+            CThunk *self = static_cast<CThunk *>(thunk);
+            if (self->m_instance && self->m_callback) {
+                (self->m_instance->*self->m_callback)(self->m_context);
+            }
+        }
+
+        inline void init(T *instance, CCallback callback, void* context)
+        {
+            m_instance = instance;
+            m_callback = callback;
+            m_context = context;
+        }
+
+        T* m_instance;
+        CCallback m_callback;
+        void* m_context;
+};
+
+#endif
@@ -0,0 +1,129 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EVENT_FLAG_H
+#define EVENT_FLAG_H
+
+/* Host build: EventFlags on a pthread mutex and condition variable, counting
+ * the calls to set() so tests can check how often a consumer is woken */
+
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#ifndef osWaitForever
+#define osWaitForever         0xFFFFFFFFU
+#endif
+#define osFlagsError          0x80000000U
+#define osFlagsErrorTimeout   0xFFFFFFFEU
+#define osFlagsErrorResource  0xFFFFFFFDU
+
+namespace rtos {
+
+class EventFlags {
+public:
+    EventFlags() : _flags(0), _set_count(0)
+    {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&_cond, &attr);
+        pthread_condattr_destroy(&attr);
+        pthread_mutex_init(&_mutex, NULL);
+    }
+
+    ~EventFlags()
+    {
+        pthread_cond_destroy(&_cond);
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    uint32_t set(uint32_t flags)
+    {
+        pthread_mutex_lock(&_mutex);
+        _flags |= flags;
+        _set_count++;
+        uint32_t result = _flags;
+        pthread_cond_broadcast(&_cond);
+        pthread_mutex_unlock(&_mutex);
+        return result;
+    }
+
+    uint32_t clear(uint32_t flags = 0x7fffffff)
+    {
+        pthread_mutex_lock(&_mutex);
+        uint32_t previous = _flags;
+        _flags &= ~flags;
+        pthread_mutex_unlock(&_mutex);
+        return previous;
+    }
+
+    uint32_t get() const
+    {
+        return _flags;
+    }
+
+    /** Wait for any of @a flags, and clear those that are set */
+    uint32_t wait_any(uint32_t flags = 0, uint32_t millisec = osWaitForever, bool clear = true)
+    {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += millisec / 1000;
+        deadline.tv_nsec += (millisec % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        pthread_mutex_lock(&_mutex);
+        uint32_t result = 0;
+        while (!(_flags & flags)) {
+            if (millisec == 0) {
+                result = osFlagsErrorResource;
+            } else if (millisec == osWaitForever) {
+                pthread_cond_wait(&_cond, &_mutex);
+            } else if (pthread_cond_timedwait(&_cond, &_mutex, &deadline) == ETIMEDOUT) {
+                result = osFlagsErrorTimeout;
+            }
+            if (result) {
+                pthread_mutex_unlock(&_mutex);
+                return result;
+            }
+        }
+        result = _flags & flags;
+        if (clear) {
+            _flags &= ~result;
+        }
+        pthread_mutex_unlock(&_mutex);
+        return result;
+    }
+
+    /** Number of calls to set() so far */
+    uint32_t set_count() const
+    {
+        return _set_count;
+    }
+
+private:
+    pthread_mutex_t _mutex;
+    pthread_cond_t _cond;
+    volatile uint32_t _flags;
+    volatile uint32_t _set_count;
+};
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+/* Host build: Semaphore on a pthread mutex and condition variable */
+
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#ifndef osWaitForever
+#define osWaitForever         0xFFFFFFFFU
+#endif
+
+namespace rtos {
+
+class Semaphore {
+public:
+    Semaphore(int32_t count = 0, uint16_t max_count = 0xffff) : _count(count), _max_count(max_count)
+    {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&_cond, &attr);
+        pthread_condattr_destroy(&attr);
+        pthread_mutex_init(&_mutex, NULL);
+    }
+
+    ~Semaphore()
+    {
+        pthread_cond_destroy(&_cond);
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    /** Wait for a token: the number of tokens before, or 0 on a timeout */
+    int32_t wait(uint32_t millisec = osWaitForever)
+    {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += millisec / 1000;
+        deadline.tv_nsec += (millisec % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        pthread_mutex_lock(&_mutex);
+        while (_count == 0) {
+            if (millisec == 0) {
+                break;
+            } else if (millisec == osWaitForever) {
+                pthread_cond_wait(&_cond, &_mutex);
+            } else if (pthread_cond_timedwait(&_cond, &_mutex, &deadline) == ETIMEDOUT) {
+                break;
+            }
+        }
+        int32_t tokens = _count;
+        if (_count) {
+            _count--;
+        }
+        pthread_mutex_unlock(&_mutex);
+        return tokens;
+    }
+
+    int32_t release(void)
+    {
+        pthread_mutex_lock(&_mutex);
+        int32_t status = -1;
+        if (_count < _max_count) {
+            _count++;
+            status = 0;
+            pthread_cond_signal(&_cond);
+        }
+        pthread_mutex_unlock(&_mutex);
+        return status;
+    }
+
+private:
+    pthread_mutex_t _mutex;
+    pthread_cond_t _cond;
+    int32_t _count;
+    int32_t _max_count;
+};
+
+}
+
+#endif
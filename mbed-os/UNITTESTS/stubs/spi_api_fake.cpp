@@ -0,0 +1,212 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spi_api_fake.h"
+#include "hal/spi_api.h"
+#include "hal/gpio_api.h"
+#include "platform/CThunk.h"
+
+spi_fake_transfer_t spi_fake_transfers[SPI_FAKE_MAX_LOG];
+int spi_fake_transfer_count;
+spi_fake_gpio_write_t spi_fake_gpio_writes[SPI_FAKE_MAX_LOG];
+int spi_fake_gpio_write_count;
+
+cthunk_slot cthunk_slots[CTHUNK_MAX];
+
+// The spi_t of the running transfer
+static spi_t *spi_fake_active;
+
+static uint32_t spi_fake_clock;
+
+void cthunk_call(uint32_t entry)
+{
+    if (entry == 0 || entry > CTHUNK_MAX || cthunk_slots[entry - 1].thunk == NULL) {
+        fprintf(stderr, "cthunk_call: bad entry %lu\n", (unsigned long)entry);
+        abort();
+    }
+    cthunk_slots[entry - 1].call(cthunk_slots[entry - 1].thunk);
+}
+
+void spi_fake_reset(void)
+{
+    if (spi_fake_active) {
+        spi_fake_active->spi.active = 0;
+        spi_fake_active = NULL;
+    }
+    spi_fake_transfer_count = 0;
+    spi_fake_gpio_write_count = 0;
+    spi_fake_clock = 0;
+    us_ticker_fake_reset();
+}
+
+void spi_fake_set_clock(uint32_t hz)
+{
+    spi_fake_clock = hz;
+}
+
+bool spi_fake_busy(void)
+{
+    return spi_fake_active != NULL;
+}
+
+bool spi_fake_complete(int event)
+{
+    spi_t *obj = spi_fake_active;
+    if (obj == NULL) {
+        return false;
+    }
+    spi_fake_transfer_t &t = spi_fake_transfers[spi_fake_transfer_count - 1];
+    if (spi_fake_clock) {
+        size_t length = t.tx_length > t.rx_length ? t.tx_length : t.rx_length;
+        us_ticker_fake_advance((uint32_t)((uint64_t)length * 8 * 1000000 / spi_fake_clock));
+    }
+    t.end_us = us_ticker_fake_now();
+    if (t.rx && t.tx) {
+        memcpy(t.rx, t.tx, t.rx_length < t.tx_length ? t.rx_length : t.tx_length);
+    }
+    spi_fake_active = NULL;
+    obj->spi.active = 0;
+    obj->spi.event = event;
+    cthunk_call(obj->spi.handler);
+    return true;
+}
+
+/* spi_api */
+
+void spi_init(spi_t *obj, PinName mosi, PinName miso, PinName sclk, PinName ssel)
+{
+    (void)mosi;
+    (void)miso;
+    (void)sclk;
+    (void)ssel;
+    memset(obj, 0, sizeof(*obj));
+}
+
+void spi_free(spi_t *obj)
+{
+    (void)obj;
+}
+
+void spi_format(spi_t *obj, int bits, int mode, int slave)
+{
+    (void)mode;
+    (void)slave;
+    obj->spi.bits = bits;
+}
+
+void spi_frequency(spi_t *obj, int hz)
+{
+    (void)obj;
+    (void)hz;
+}
+
+int spi_master_write(spi_t *obj, int value)
+{
+    (void)obj;
+    return value;
+}
+
+int spi_master_block_write(spi_t *obj, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, char write_fill)
+{
+    (void)obj;
+    for (int i = 0; i < rx_length; i++) {
+        rx_buffer[i] = i < tx_length ? tx_buffer[i] : write_fill;
+    }
+    return tx_length > rx_length ? tx_length : rx_length;
+}
+
+int spi_busy(spi_t *obj)
+{
+    return obj->spi.active;
+}
+
+void spi_master_transfer(spi_t *obj, const void *tx, size_t tx_length, void *rx, size_t rx_length, uint8_t bit_width, uint32_t handler, uint32_t event, DMAUsage hint)
+{
+    (void)bit_width;
+    (void)event;
+    (void)hint;
+    if (spi_fake_active || spi_fake_transfer_count == SPI_FAKE_MAX_LOG) {
+        fprintf(stderr, "spi_master_transfer: %s\n", spi_fake_active ? "bus busy" : "log full");
+        abort();
+    }
+    spi_fake_transfer_t &t = spi_fake_transfers[spi_fake_transfer_count++];
+    t.tx = tx;
+    t.tx_length = tx_length;
+    t.rx = rx;
+    t.rx_length = rx_length;
+    t.start_us = us_ticker_fake_now();
+    t.end_us = t.start_us;
+    t.cs = spi_fake_gpio_write_count ? spi_fake_gpio_writes[spi_fake_gpio_write_count - 1].value : 1;
+    obj->spi.active = 1;
+    obj->spi.handler = handler;
+    obj->spi.event = 0;
+    spi_fake_active = obj;
+}
+
+uint32_t spi_irq_handler_asynch(spi_t *obj)
+{
+    return obj->spi.event;
+}
+
+uint8_t spi_active(spi_t *obj)
+{
+    return obj->spi.active;
+}
+
+void spi_abort_asynch(spi_t *obj)
+{
+    obj->spi.active = 0;
+    if (spi_fake_active == obj) {
+        spi_fake_active = NULL;
+    }
+}
+
+/* gpio_api, for DigitalOut */
+
+void gpio_init_out(gpio_t *gpio, PinName pin)
+{
+    gpio->pin = pin;
+}
+
+void gpio_init_out_ex(gpio_t *gpio, PinName pin, int value)
+{
+    gpio->pin = pin;
+    gpio_write(gpio, value);
+}
+
+int gpio_is_connected(const gpio_t *obj)
+{
+    return obj->pin != NC;
+}
+
+void gpio_write(gpio_t *obj, int value)
+{
+    (void)obj;
+    if (spi_fake_gpio_write_count < SPI_FAKE_MAX_LOG) {
+        spi_fake_gpio_write_t &w = spi_fake_gpio_writes[spi_fake_gpio_write_count++];
+        w.value = value;
+        w.time_us = us_ticker_fake_now();
+    }
+}
+
+int gpio_read(gpio_t *obj)
+{
+    (void)obj;
+    return spi_fake_gpio_write_count ? spi_fake_gpio_writes[spi_fake_gpio_write_count - 1].value : 0;
+}
@@ -0,0 +1,71 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SPI_API_FAKE_H
+#define MBED_SPI_API_FAKE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "us_ticker_fake.h"
+
+/* Fake spi_api and gpio for host tests of the SPI driver. A transfer only
+ * ends when the test calls spi_fake_complete(), so every interleaving with
+ * the ticker of us_ticker_fake.h is explicit. */
+
+#define SPI_FAKE_MAX_LOG    64
+
+/** A transfer started through spi_master_transfer() */
+typedef struct {
+    const void *tx;
+    size_t tx_length;
+    void *rx;
+    size_t rx_length;
+    uint32_t start_us;      /**< Fake time at the start */
+    uint32_t end_us;        /**< Fake time at the end, once spi_fake_complete() ran */
+    int cs;                 /**< Level of the last written chip select at the start */
+} spi_fake_transfer_t;
+
+/** A write to a DigitalOut */
+typedef struct {
+    int value;
+    uint32_t time_us;
+} spi_fake_gpio_write_t;
+
+extern spi_fake_transfer_t spi_fake_transfers[SPI_FAKE_MAX_LOG];
+extern int spi_fake_transfer_count;
+extern spi_fake_gpio_write_t spi_fake_gpio_writes[SPI_FAKE_MAX_LOG];
+extern int spi_fake_gpio_write_count;
+
+/** Forget the logs, stop all transfers, set the time to 0 and stop the bus clock */
+void spi_fake_reset(void);
+
+/** Let transfers take time
+ *
+ *  @param hz  Bus clock; spi_fake_complete() first moves the time on by the
+ *             duration of the transfer. 0 for transfers that take no time.
+ */
+void spi_fake_set_clock(uint32_t hz);
+
+/** End the running transfer: loop tx back into rx and call its handler
+ *
+ *  @param event  SPI_EVENT_* reported by spi_irq_handler_asynch()
+ *  @return false if no transfer was running
+ */
+bool spi_fake_complete(int event);
+
+/** Whether a transfer is running */
+bool spi_fake_busy(void);
+
+#endif
@@ -0,0 +1,102 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "us_ticker_fake.h"
+#include "hal/us_ticker_api.h"
+#include "platform/mbed_wait_api.h"
+
+static uint32_t ticker_now;
+static uint32_t ticker_target;
+static bool ticker_armed;
+static bool ticker_pending;
+
+void us_ticker_init(void)
+{
+}
+
+void us_ticker_free(void)
+{
+}
+
+uint32_t us_ticker_read(void)
+{
+    return ticker_now;
+}
+
+void us_ticker_set_interrupt(timestamp_t timestamp)
+{
+    ticker_target = timestamp;
+    ticker_armed = true;
+}
+
+void us_ticker_disable_interrupt(void)
+{
+    ticker_armed = false;
+}
+
+void us_ticker_clear_interrupt(void)
+{
+    ticker_pending = false;
+}
+
+void us_ticker_fire_interrupt(void)
+{
+    ticker_pending = true;
+}
+
+const ticker_info_t *us_ticker_get_info(void)
+{
+    static const ticker_info_t info = { 1000000, 32 };
+    return &info;
+}
+
+void us_ticker_fake_reset(void)
+{
+    ticker_now = 0;
+    ticker_armed = false;
+    ticker_pending = false;
+}
+
+uint32_t us_ticker_fake_now(void)
+{
+    return ticker_now;
+}
+
+void us_ticker_fake_advance(uint32_t us)
+{
+    uint32_t end = ticker_now + us;
+
+    while (1) {
+        if (ticker_pending) {
+            ticker_pending = false;
+            us_ticker_irq_handler();
+        } else if (ticker_armed && (int32_t)(ticker_target - end) <= 0) {
+            if ((int32_t)(ticker_target - ticker_now) > 0) {
+                ticker_now = ticker_target;
+            }
+            ticker_armed = false;
+            us_ticker_irq_handler();
+        } else {
+            break;
+        }
+    }
+    ticker_now = end;
+}
+
+// A spin: time moves but no interrupt can run
+void wait_us(int us)
+{
+    ticker_now += us;
+}
@@ -0,0 +1,41 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_US_TICKER_FAKE_H
+#define MBED_US_TICKER_FAKE_H
+
+#include <stdint.h>
+
+/* Fake us_ticker for host tests. Time only moves with us_ticker_fake_advance()
+ * and wait_us(), so every interleaving with ticker interrupts is explicit. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Set the time to 0 and drop the armed interrupt */
+void us_ticker_fake_reset(void);
+
+/** Current fake time, in microseconds */
+uint32_t us_ticker_fake_now(void);
+
+/** Move the fake time forward, firing the ticker interrupt when it is due */
+void us_ticker_fake_advance(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+# mbed Microcontroller Library
+# Copyright (c) 2018 ARM Limited
+# SPDX-License-Identifier: Apache-2.0
+#
+# Helpers for the host unit tests. Included by the CMakeLists.txt of this
+# directory, and by that of any application that adds tests of its own.
+
+cmake_minimum_required(VERSION 3.10)
+
+find_package(GTest REQUIRED)
+find_package(Threads REQUIRED)
+
+get_filename_component(MBED_PATH ${CMAKE_CURRENT_LIST_DIR}/.. ABSOLUTE)
+set(MBED_UNITTESTS_STUBS ${CMAKE_CURRENT_LIST_DIR}/stubs)
+
+if(NOT CMAKE_CXX_STANDARD)
+    # GoogleTest needs C++14; the sources under test are C++98
+    set(CMAKE_CXX_STANDARD 14)
+endif()
+
+# Sources of the fakes and of the drivers, shared by several tests
+set(MBED_UNITTESTS_TICKER_SOURCES
+    ${MBED_UNITTESTS_STUBS}/us_ticker_fake.cpp
+    ${MBED_UNITTESTS_STUBS}/mbed_stubs.cpp
+    ${MBED_UNITTESTS_STUBS}/drivers/TimerEvent.cpp
+    ${MBED_PATH}/drivers/Ticker.cpp
+    ${MBED_PATH}/drivers/Timeout.cpp
+    ${MBED_PATH}/hal/mbed_ticker_api.c
+    ${MBED_PATH}/hal/mbed_us_ticker_api.c
+    ${MBED_PATH}/platform/mbed_latency.c
+)
+
+# Sources of the flash fake and of FlashIAP, with the CRCs that storage uses
+set(MBED_UNITTESTS_FLASH_SOURCES
+    ${MBED_UNITTESTS_STUBS}/flash_api_fake.cpp
+    ${MBED_UNITTESTS_STUBS}/mbed_stubs.cpp
+    ${MBED_PATH}/drivers/FlashIAP.cpp
+    ${MBED_PATH}/drivers/MbedCRC.cpp
+    ${MBED_PATH}/drivers/TableCRC.cpp
+)
+set(MBED_UNITTESTS_FLASH_INCLUDES ${MBED_PATH}/hal/TARGET_FLASH_CMSIS_ALGO)
+# FlashIAP.cpp tests it before any include, as the build passes it from targets.json
+set(MBED_UNITTESTS_FLASH_DEFINES DEVICE_FLASH=1)
+
+# Common settings of a test or benchmark executable
+function(mbed_unittest_target NAME)
+    cmake_parse_arguments(UT "" "" "SOURCES;INCLUDES;DEFINES;LIBRARIES" ${ARGN})
+    add_executable(${NAME} ${UT_SOURCES})
+    # The stubs come first, to replace the target headers
+    target_include_directories(${NAME} PRIVATE
+        ${MBED_UNITTESTS_STUBS}
+        ${UT_INCLUDES}
+        ${MBED_PATH}
+        ${MBED_PATH}/hal
+        ${MBED_PATH}/platform
+        ${MBED_PATH}/drivers
+    )
+    target_compile_definitions(${NAME} PRIVATE ${UT_DEFINES})
+    target_compile_options(${NAME} PRIVATE -Wall)
+    target_link_libraries(${NAME} PRIVATE ${UT_LIBRARIES} Threads::Threads)
+endfunction()
+
+# A GoogleTest executable, run by ctest
+function(mbed_unittest NAME)
+    mbed_unittest_target(${NAME} ${ARGN} LIBRARIES GTest::gtest GTest::gtest_main)
+    add_test(NAME ${NAME} COMMAND ${NAME})
+endfunction()
+
+# A benchmark executable: built with the tests, run by hand, as its numbers
+# depend on the machine
+function(mbed_benchmark NAME)
+    mbed_unittest_target(${NAME} ${ARGN})
+    target_compile_options(${NAME} PRIVATE -O2)
+endfunction()
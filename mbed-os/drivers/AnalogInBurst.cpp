@@ -0,0 +1,138 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "drivers/AnalogInBurst.h"
+#include "platform/mbed_critical.h"
+#include "platform/mbed_power_mgmt.h"
+
+#if DEVICE_ANALOGIN_BURST
+
+namespace mbed {
+
+#define BURST_DONE  (1 << 0)
+
+AnalogInBurst::AnalogInBurst(PinName pin) : AnalogIn(pin), _busy(false), _count(0)
+{
+    lock();
+    _dma = analogin_burst_init(&_adc, &AnalogInBurst::irq_handler, (uint32_t)this) == 0;
+    unlock();
+}
+
+AnalogInBurst::~AnalogInBurst()
+{
+    lock();
+    abort();
+    if (_dma) {
+        analogin_burst_free(&_adc);
+    }
+    unlock();
+}
+
+int AnalogInBurst::max_oversample()
+{
+    return analogin_burst_max_oversample();
+}
+
+bool AnalogInBurst::start(uint16_t *buffer, int count, int oversample)
+{
+    if (!_dma || _busy || count <= 0 || oversample <= 0 || oversample > max_oversample() ||
+            (oversample & (oversample - 1)) != 0) {
+        return false;
+    }
+
+#if MBED_CONF_RTOS_PRESENT
+    _event.clear(BURST_DONE);
+#endif
+    _busy = true;
+    // The ADC and DMA stop in deep sleep
+    sleep_manager_lock_deep_sleep();
+    analogin_burst_start(&_adc, buffer, count, oversample);
+    return true;
+}
+
+int AnalogInBurst::read(uint16_t *buffer, int count, int oversample, const event_callback_t &callback)
+{
+    lock();
+    if (_busy) {
+        unlock();
+        return -1;
+    }
+    _callback = callback;
+    bool started = start(buffer, count, oversample);
+    unlock();
+    return started ? 0 : -1;
+}
+
+unsigned short AnalogInBurst::read_average_u16(int oversample)
+{
+    uint16_t value = 0;
+
+    lock();
+    _callback = NULL;
+    if (start(&value, 1, oversample)) {
+#if MBED_CONF_RTOS_PRESENT
+        _event.wait_any(BURST_DONE);
+#else
+        while (_busy) {
+            sleep();
+        }
+#endif
+        if (_count != 1) {
+            value = 0;
+        }
+    }
+    unlock();
+    return value;
+}
+
+float AnalogInBurst::read_average(int oversample)
+{
+    return (float)read_average_u16(oversample) * (1.0f / (float)0xFFFF);
+}
+
+void AnalogInBurst::abort()
+{
+    core_util_critical_section_enter();
+    if (_busy) {
+        analogin_burst_abort(&_adc);
+        _busy = false;
+        sleep_manager_unlock_deep_sleep();
+    }
+    core_util_critical_section_exit();
+}
+
+void AnalogInBurst::complete(int count)
+{
+    _count = count;
+    _busy = false;
+    sleep_manager_unlock_deep_sleep();
+    if (_callback) {
+        _callback.call(count);
+    }
+#if MBED_CONF_RTOS_PRESENT
+    _event.set(BURST_DONE);
+#endif
+}
+
+void AnalogInBurst::irq_handler(uint32_t id, uint32_t count)
+{
+    AnalogInBurst *handler = (AnalogInBurst *)id;
+    handler->complete(count);
+}
+
+} // namespace mbed
+
+#endif
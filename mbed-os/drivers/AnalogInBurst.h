@@ -0,0 +1,131 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_ANALOGINBURST_H
+#define MBED_ANALOGINBURST_H
+
+#include "platform/platform.h"
+
+#if defined (DEVICE_ANALOGIN_BURST) || defined(DOXYGEN_ONLY)
+
+#include "drivers/AnalogIn.h"
+#include "hal/analogin_burst_api.h"
+#include "platform/Callback.h"
+#include "platform/NonCopyable.h"
+#if MBED_CONF_RTOS_PRESENT
+#include "rtos/EventFlags.h"
+#endif
+
+namespace mbed {
+/** \addtogroup drivers */
+
+/** An analog input that reads several samples from one start
+ *
+ * The samples are taken and moved to memory by the ADC and DMA, without the
+ * CPU, which may sleep meanwhile. Each sample can be the average of up to
+ * max_oversample() conversions, computed by the ADC.
+ *
+ * Only one AnalogInBurst can exist per ADC. Reads through AnalogIn on the
+ * same ADC wait for a blocking burst, but must not overlap a background one.
+ *
+ * @note Synchronization level: Thread safe
+ *
+ * Example:
+ * @code
+ * // Read the average of 64 conversions
+ *
+ * #include "mbed.h"
+ *
+ * AnalogInBurst sensor(A0);
+ *
+ * int main() {
+ *     printf("%f\n", sensor.read_average(64));
+ * }
+ * @endcode
+ * @ingroup drivers
+ */
+class AnalogInBurst : public AnalogIn, private NonCopyable<AnalogInBurst> {
+
+public:
+
+    /** Create an AnalogInBurst, connected to the specified pin
+     *
+     * @param pin AnalogIn pin to connect to
+     */
+    AnalogInBurst(PinName pin);
+
+    virtual ~AnalogInBurst();
+
+    /** Start reading samples in the background
+     *
+     * @param buffer     Receives count samples, scaled as by read_u16(); must
+     *                   stay valid until the callback
+     * @param count      Number of samples
+     * @param oversample Conversions averaged into each sample, a power of two
+     *                   up to max_oversample()
+     * @param callback   Called from interrupt context with the number of
+     *                   samples read, which is count unless a DMA error ended
+     *                   the burst early
+     * @return 0 on success, -1 if a burst is running, the parameters are
+     *         invalid or the ADC has no DMA channel
+     */
+    int read(uint16_t *buffer, int count, int oversample, const event_callback_t &callback);
+
+    /** Read the average of several conversions, in one burst
+     *
+     * @param oversample Conversions to average, a power of two up to max_oversample()
+     * @return The average, normalized to a 16-bit value; 0 on error
+     */
+    unsigned short read_average_u16(int oversample);
+
+    /** Read the average of several conversions, in one burst
+     *
+     * @param oversample Conversions to average, a power of two up to max_oversample()
+     * @return The average, as a percentage of the reference voltage in the range 0.0 to 1.0
+     */
+    float read_average(int oversample);
+
+    /** Abort a background read; its callback is not called
+     */
+    void abort();
+
+    /** Largest number of conversions the ADC can average into one sample
+     *
+     * @return The ratio; 1 if the ADC cannot oversample
+     */
+    static int max_oversample();
+
+    using AnalogIn::read;
+
+protected:
+
+    bool start(uint16_t *buffer, int count, int oversample);
+    void complete(int count);
+    static void irq_handler(uint32_t id, uint32_t count);
+
+    bool _dma;
+    volatile bool _busy;
+    event_callback_t _callback;
+    volatile int _count;
+#if MBED_CONF_RTOS_PRESENT
+    rtos::EventFlags _event;
+#endif
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "drivers/InterruptIn.h"
+#include "platform/mbed_latency.h"
 
 #if DEVICE_INTERRUPTIN
 
@@ -87,6 +88,9 @@ void InterruptIn::fall(Callback<void()> func) {
 }
 
 void InterruptIn::_irq_handler(uint32_t id, gpio_irq_event event) {
+#if defined(MBED_LATENCY_ENABLED)
+    uint32_t latency_start = mbed_latency_now();
+#endif
     InterruptIn *handler = (InterruptIn*)id;
     switch (event) {
         case IRQ_RISE: 
@@ -101,6 +105,9 @@ void InterruptIn::_irq_handler(uint32_t id, gpio_irq_event event) {
             break;
         case IRQ_NONE: break;
     }
+#if defined(MBED_LATENCY_ENABLED)
+    mbed_latency_irq_exit(MBED_LATENCY_IRQ_GPIO, latency_start);
+#endif
 }
 
 void InterruptIn::enable_irq() {
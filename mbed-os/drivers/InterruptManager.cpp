@@ -24,9 +24,10 @@
 
 #include "drivers/InterruptManager.h"
 #include "platform/mbed_critical.h"
+#include "platform/mbed_latency.h"
+#include "platform/SingletonPtr.h"
 #include <string.h>
-
-#define CHAIN_INITIAL_SIZE    4
+#include <new>
 
 namespace mbed {
 
@@ -34,30 +35,25 @@ typedef void (*pvoidf)(void);
 
 InterruptManager* InterruptManager::_instance = (InterruptManager*)NULL;
 
+// The instance lives here rather than on the heap. Its Callbacks may hold
+// 8-byte aligned member function pointers, so the storage is aligned for them.
+MBED_ALIGN(8) static uint8_t instance_data[sizeof(InterruptManager)];
+
 InterruptManager* InterruptManager::get() {
 
     if (NULL == _instance) {
-        InterruptManager* temp = new InterruptManager();
-
-        // Atomically set _instance
-        core_util_critical_section_enter();
+        singleton_lock();
         if (NULL == _instance) {
-            _instance = temp;
+            _instance = new (instance_data) InterruptManager();
         }
-        core_util_critical_section_exit();
-
-        // Another thread got there first so delete ours
-        if (temp != _instance) {
-            delete temp;
-        }
-
+        singleton_unlock();
     }
     return _instance;
 }
 
-InterruptManager::InterruptManager() {
+InterruptManager::InterruptManager() : _chains_used(0) {
     // No mutex needed in constructor
-    memset(_chains, 0, NVIC_NUM_VECTORS * sizeof(CallChain*));
+    memset(_chain_index, 0, sizeof(_chain_index));
 }
 
 void InterruptManager::destroy() {
@@ -65,52 +61,49 @@ void InterruptManager::destroy() {
     // is under the control of the handler; otherwise, a system crash
     // is very likely to occur
     if (NULL != _instance) {
-        delete _instance;
+        _instance->~InterruptManager();
         _instance = (InterruptManager*)NULL;
     }
 }
 
 InterruptManager::~InterruptManager() {
-    for(int i = 0; i < NVIC_NUM_VECTORS; i++)
-        if (NULL != _chains[i])
-            delete _chains[i];
+    // The chains are members, nothing to free
 }
 
-bool InterruptManager::must_replace_vector(IRQn_Type irq) {
-    lock();
-
-    int ret = false;
+CallChain *InterruptManager::get_chain(IRQn_Type irq, bool create) {
     int irq_pos = get_irq_index(irq);
-    if (NULL == _chains[irq_pos]) {
-        _chains[irq_pos] = new CallChain(CHAIN_INITIAL_SIZE);
-        _chains[irq_pos]->add((pvoidf)NVIC_GetVector(irq));
-        ret = true;
+
+    if (0 == _chain_index[irq_pos]) {
+        if (!create || _chains_used == MBED_CONF_PLATFORM_INTERRUPT_MANAGER_CHAINS) {
+            return NULL;
+        }
+        // The original vector stays the first handler of its priority
+        _chains[_chains_used].add((pvoidf)NVIC_GetVector(irq));
+        _chain_index[irq_pos] = ++_chains_used;
+        NVIC_SetVector(irq, (uint32_t)&InterruptManager::static_irq_helper);
     }
-    unlock();
-    return ret;
+    return &_chains[_chain_index[irq_pos] - 1];
 }
 
-pFunctionPointer_t InterruptManager::add_common(void (*function)(void), IRQn_Type irq, bool front) {
-    lock();
-    int irq_pos = get_irq_index(irq);
-    bool change = must_replace_vector(irq);
+pFunctionPointer_t InterruptManager::add_common(Callback<void()> func, IRQn_Type irq, int8_t priority, bool front) {
+    pFunctionPointer_t pf = NULL;
 
-    pFunctionPointer_t pf = front ? _chains[irq_pos]->add_front(function) : _chains[irq_pos]->add(function);
-    if (change)
-        NVIC_SetVector(irq, (uint32_t)&InterruptManager::static_irq_helper);
+    lock();
+    CallChain *chain = get_chain(irq, true);
+    if (chain != NULL) {
+        pf = front ? chain->add_front(func) : chain->insert(func, priority);
+    }
     unlock();
     return pf;
 }
 
 bool InterruptManager::remove_handler(pFunctionPointer_t handler, IRQn_Type irq) {
-    int irq_pos = get_irq_index(irq);
     bool ret = false;
 
     lock();
-    if (_chains[irq_pos] != NULL) {
-        if (_chains[irq_pos]->remove(handler)) {
-            ret = true;
-        }
+    CallChain *chain = get_chain(irq, false);
+    if (chain != NULL) {
+        ret = chain->remove(handler);
     }
     unlock();
 
@@ -118,7 +111,13 @@ bool InterruptManager::remove_handler(pFunctionPointer_t handler, IRQn_Type irq)
 }
 
 void InterruptManager::irq_helper() {
-    _chains[__get_IPSR()]->call();
+#if defined(MBED_LATENCY_ENABLED)
+    uint32_t latency_start = mbed_latency_now();
+    _chains[_chain_index[__get_IPSR()] - 1].call();
+    mbed_latency_irq_exit(MBED_LATENCY_IRQ_CHAIN, latency_start);
+#else
+    _chains[_chain_index[__get_IPSR()] - 1].call();
+#endif
 }
 
 int InterruptManager::get_irq_index(IRQn_Type irq) {
@@ -22,12 +22,20 @@
 #include "platform/NonCopyable.h"
 #include <string.h>
 
+#ifndef MBED_CONF_PLATFORM_INTERRUPT_MANAGER_CHAINS
+#define MBED_CONF_PLATFORM_INTERRUPT_MANAGER_CHAINS 4
+#endif
+
 namespace mbed {
 /** \addtogroup drivers */
 
 /** Use this singleton if you need to chain interrupt handlers.
  *  @deprecated Do not use this class. This class is not part of the public API of mbed-os and is being removed in the future.
  *
+ * Up to MBED_CONF_PLATFORM_INTERRUPT_MANAGER_CHAINS interrupts can be chained,
+ * each with up to MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY handlers, the original
+ * vector included. The manager and its chains are statically allocated.
+ *
  * @note Synchronization level: Thread safe
  *
  * Example (for LPC1768):
@@ -84,13 +92,33 @@ public:
      *  @param irq interrupt number
      *
      *  @returns
-     *  The function object created for 'function'
+     *  The function object created for 'function', NULL if no chain or
+     *  chain slot is left
      */
     MBED_DEPRECATED_SINCE("mbed-os-5.6", "This class is not part of the "
         "public API of mbed-os and is being removed in the future.")
     pFunctionPointer_t add_handler(void (*function)(void), IRQn_Type irq) {
         // Underlying call is thread safe
-        return add_common(function, irq);
+        return add_common(function, irq, 0, false);
+    }
+
+    /** Add a handler for an interrupt by priority
+     *
+     *  Handlers of a higher priority are called first, handlers of the same
+     *  priority in the order they were added. The original vector and the
+     *  other add functions use priority 0.
+     *
+     *  @param function the handler to add
+     *  @param irq interrupt number
+     *  @param priority -128 to 127
+     *
+     *  @returns
+     *  The function object created for 'function', NULL if no chain or
+     *  chain slot is left
+     */
+    pFunctionPointer_t add_handler(void (*function)(void), IRQn_Type irq, int8_t priority) {
+        // Underlying call is thread safe
+        return add_common(function, irq, priority, false);
     }
 
     /** Add a handler for an interrupt at the beginning of the handler list
@@ -101,13 +129,14 @@ public:
      *  @param irq interrupt number
      *
      *  @returns
-     *  The function object created for 'function'
+     *  The function object created for 'function', NULL if no chain or
+     *  chain slot is left
      */
     MBED_DEPRECATED_SINCE("mbed-os-5.6", "This class is not part of the "
         "public API of mbed-os and is being removed in the future.")
     pFunctionPointer_t add_handler_front(void (*function)(void), IRQn_Type irq) {
         // Underlying call is thread safe
-        return add_common(function, irq, true);
+        return add_common(function, irq, 0, true);
     }
 
     /** Add a handler for an interrupt at the end of the handler list
@@ -119,14 +148,15 @@ public:
      *  @param irq interrupt number
      *
      *  @returns
-     *  The function object created for 'tptr' and 'mptr'
+     *  The function object created for 'tptr' and 'mptr', NULL if no chain or
+     *  chain slot is left
      */
     template<typename T>
     MBED_DEPRECATED_SINCE("mbed-os-5.6", "This class is not part of the "
         "public API of mbed-os and is being removed in the future.")
     pFunctionPointer_t add_handler(T* tptr, void (T::*mptr)(void), IRQn_Type irq) {
         // Underlying call is thread safe
-        return add_common(tptr, mptr, irq);
+        return add_common(callback(tptr, mptr), irq, 0, false);
     }
 
     /** Add a handler for an interrupt at the beginning of the handler list
@@ -138,14 +168,15 @@ public:
      *  @param irq interrupt number
      *
      *  @returns
-     *  The function object created for 'tptr' and 'mptr'
+     *  The function object created for 'tptr' and 'mptr', NULL if no chain or
+     *  chain slot is left
      */
     template<typename T>
     MBED_DEPRECATED_SINCE("mbed-os-5.6", "This class is not part of the "
         "public API of mbed-os and is being removed in the future.")
     pFunctionPointer_t add_handler_front(T* tptr, void (T::*mptr)(void), IRQn_Type irq) {
         // Underlying call is thread safe
-        return add_common(tptr, mptr, irq, true);
+        return add_common(callback(tptr, mptr), irq, 0, true);
     }
 
     /** Remove a handler from an interrupt
@@ -169,27 +200,16 @@ private:
     void lock();
     void unlock();
 
-    template<typename T>
-    pFunctionPointer_t add_common(T *tptr, void (T::*mptr)(void), IRQn_Type irq, bool front=false) {
-        _mutex.lock();
-        int irq_pos = get_irq_index(irq);
-        bool change = must_replace_vector(irq);
-
-        pFunctionPointer_t pf = front ? _chains[irq_pos]->add_front(tptr, mptr) : _chains[irq_pos]->add(tptr, mptr);
-        if (change)
-            NVIC_SetVector(irq, (uint32_t)&InterruptManager::static_irq_helper);
-        _mutex.unlock();
-        return pf;
-    }
-
-    pFunctionPointer_t add_common(void (*function)(void), IRQn_Type irq, bool front=false);
-    bool must_replace_vector(IRQn_Type irq);
+    pFunctionPointer_t add_common(Callback<void()> func, IRQn_Type irq, int8_t priority, bool front);
+    CallChain *get_chain(IRQn_Type irq, bool create);
     int get_irq_index(IRQn_Type irq);
     void irq_helper();
     void add_helper(void (*function)(void), IRQn_Type irq, bool front=false);
     static void static_irq_helper();
 
-    CallChain* _chains[NVIC_NUM_VECTORS];
+    CallChain _chains[MBED_CONF_PLATFORM_INTERRUPT_MANAGER_CHAINS];
+    uint8_t _chains_used;
+    uint8_t _chain_index[NVIC_NUM_VECTORS];     // 1 + chain of each vector, 0 if not chained
     static InterruptManager* _instance;
     PlatformMutex _mutex;
 };
@@ -17,6 +17,7 @@
 #include <stddef.h>
 #include "drivers/TableCRC.h"
 #include "drivers/MbedCRC.h"
+#include "platform/mbed_critical.h"
 
 namespace mbed {
 /** \addtogroup drivers */
@@ -104,6 +105,28 @@ MbedCRC<POLY_8BIT_CCITT, 8>::MbedCRC():
     mbed_crc_ctor();
 }
 
+namespace internal {
+
+/* Object computing with the hardware CRC unit, NULL when it is free */
+static void *volatile crc_hardware_owner;
+
+bool crc_hardware_claim(const void *owner)
+{
+    void *expected = NULL;
+    if (core_util_atomic_cas_ptr(&crc_hardware_owner, &expected, const_cast<void *>(owner))) {
+        return true;
+    }
+    return expected == owner;
+}
+
+void crc_hardware_release(const void *owner)
+{
+    void *expected = const_cast<void *>(owner);
+    core_util_atomic_cas_ptr(&crc_hardware_owner, &expected, NULL);
+}
+
+} // namespace internal
+
 /** @}*/
 } // namespace mbed
 
@@ -17,6 +17,7 @@
 #define MBED_CRC_API_H
 
 #include "drivers/TableCRC.h"
+#include "drivers/SliceCRC.h"
 #include "hal/crc_api.h"
 #include "platform/mbed_assert.h"
 
@@ -46,6 +47,13 @@ namespace mbed {
  *  software CRC computation, if ROM tables are not available then CRC is computed runtime
  *  bit by bit for all data input.
  *
+ *  CRCs of 8 bits or more whose data and remainder are reflected alike are
+ *  computed four or eight bytes at a time instead, with slice tables the
+ *  compiler generates for the polynomial (see drivers.crc-table-slices).
+ *
+ *  The hardware CRC unit, where present, serves one computation at a time.
+ *  A computation started while another object holds it is done in software.
+ *
  *  @tparam  polynomial CRC polynomial value in hex
  *  @tparam  width CRC polynomial width
  *
@@ -96,7 +104,7 @@ template <uint32_t polynomial=POLY_32BIT_ANSI, uint8_t width=32>
 class MbedCRC
 {
 public:
-    enum CrcMode { HARDWARE = 0, TABLE, BITWISE };
+    enum CrcMode { HARDWARE = 0, TABLE, BITWISE, SLICE };
 
 public:
     typedef uint64_t crc_data_size_t;
@@ -125,7 +133,11 @@ public:
     MbedCRC();
     virtual ~MbedCRC()
     {
-        // Do nothing
+#ifdef DEVICE_CRC
+        if (_active == HARDWARE) {
+            internal::crc_hardware_release(this);
+        }
+#endif
     }
 
     /** Compute CRC for the data input
@@ -170,7 +182,7 @@ public:
      */
     int32_t compute_partial(void *buffer, crc_data_size_t size, uint32_t *crc)
     {
-        switch (_mode)
+        switch (_active)
         {
             case HARDWARE:
 #ifdef DEVICE_CRC
@@ -182,6 +194,11 @@ public:
                 return table_compute_partial(buffer, size, crc);
             case BITWISE:
                 return bitwise_compute_partial(buffer, size, crc);
+            case SLICE:
+                MBED_ASSERT(crc != NULL);
+                MBED_ASSERT(buffer != NULL);
+                *crc = slicer::compute(*crc, static_cast<const uint8_t *>(buffer), size);
+                return 0;
         }
 
         return -1;
@@ -190,7 +207,8 @@ public:
     /** Compute partial start, indicate start of partial computation
      *
      *  This API should be called before performing any partial computation
-     *  with compute_partial API.
+     *  with compute_partial API. It claims the hardware CRC unit, if used,
+     *  until compute_partial_stop.
      *
      *  @param  crc  Initial CRC value set by the API
      *  @return  0  on success or a negative in case of failure
@@ -201,8 +219,15 @@ public:
     {
         MBED_ASSERT(crc != NULL);
 
+        if (_active != HARDWARE) {
+            _active = _sw_mode;
+        }
+
 #ifdef DEVICE_CRC
-        if (_mode == HARDWARE) {
+        // A restart keeps the unit this object already holds
+        if (_mode == HARDWARE && (_active == HARDWARE || internal::crc_hardware_claim(this))) {
+            _active = HARDWARE;
+
             crc_mbed_config_t config;
             config.polynomial  = polynomial;
             config.width       = width;
@@ -215,7 +240,11 @@ public:
         }
 #endif // DEVICE_CRC
 
-        *crc = _initial_value;
+        if (_active == SLICE) {
+            *crc = slicer::start(_initial_value);
+        } else {
+            *crc = _initial_value;
+        }
         return 0;
     }
 
@@ -231,15 +260,22 @@ public:
     {
         MBED_ASSERT(crc != NULL);
 
-        if (_mode == HARDWARE) {
+        if (_active == HARDWARE) {
 #ifdef DEVICE_CRC
             *crc = hal_crc_get_result();
+            internal::crc_hardware_release(this);
+            _active = _sw_mode;
             return 0;
 #else
             return -1;
 #endif
         }
 
+        if (_active == SLICE) {
+            *crc = slicer::stop(*crc, _final_xor);
+            return 0;
+        }
+
         uint32_t p_crc = *crc;
         if ((width < 8) && (NULL == _crc_table)) {
             p_crc = (uint32_t)(p_crc << (8 - width));
@@ -267,12 +303,19 @@ public:
     }
 
 private:
+    typedef internal::crc_slicer<polynomial, width> slicer;
+
     uint32_t _initial_value;
     uint32_t _final_xor;
     bool _reflect_data;
     bool _reflect_remainder;
     uint32_t *_crc_table;
+    /** Preferred mode, HARDWARE if the unit supports the configuration */
     CrcMode _mode;
+    /** Mode used when the hardware unit is busy or unsupported */
+    CrcMode _sw_mode;
+    /** Mode of the computation in progress */
+    CrcMode _active;
 
     /** Get the current CRC data size
      *
@@ -438,7 +481,13 @@ private:
     {
         MBED_STATIC_ASSERT(width <= 32, "Max 32-bit CRC supported");
 
-        _mode = (_crc_table != NULL) ? TABLE : BITWISE;
+        if (slicer::handles(_reflect_data, _reflect_remainder)) {
+            _sw_mode = SLICE;
+        } else {
+            _sw_mode = (_crc_table != NULL) ? TABLE : BITWISE;
+        }
+        _mode = _sw_mode;
+        _active = _sw_mode;
 
 #ifdef DEVICE_CRC
         crc_mbed_config_t config;
@@ -18,6 +18,11 @@
 
 #if DEVICE_SPI_ASYNCH
 #include "platform/mbed_power_mgmt.h"
+#include "platform/mbed_wait_api.h"
+#endif
+
+#ifndef MBED_CONF_DRIVERS_SPI_CHAIN_SPIN_DELAY
+#define MBED_CONF_DRIVERS_SPI_CHAIN_SPIN_DELAY  10
 #endif
 
 #if DEVICE_SPI
@@ -26,6 +31,7 @@ namespace mbed {
 
 #if DEVICE_SPI_ASYNCH && TRANSACTION_QUEUE_SIZE_SPI
 CircularBuffer<Transaction<SPI>, TRANSACTION_QUEUE_SIZE_SPI> SPI::_transaction_buffer;
+CircularBuffer<SPI::chain_t, TRANSACTION_QUEUE_SIZE_SPI> SPI::_chain_buffer;
 #endif
 
 SPI::SPI(PinName mosi, PinName miso, PinName sclk, PinName ssel) :
@@ -41,6 +47,10 @@ SPI::SPI(PinName mosi, PinName miso, PinName sclk, PinName ssel) :
         _write_fill(SPI_FILL_CHAR) {
     // No lock needed in the constructor
 
+#if DEVICE_SPI_ASYNCH
+    _chain.segments = NULL;
+    _chain_index = 0;
+#endif
     spi_init(&_spi, mosi, miso, sclk, ssel);
     _acquire();
 }
@@ -131,19 +141,57 @@ void SPI::set_default_write_value(char data) {
 
 int SPI::transfer(const void *tx_buffer, int tx_length, void *rx_buffer, int rx_length, unsigned char bit_width, const event_callback_t& callback, int event)
 {
-    if (spi_active(&_spi)) {
+    if (spi_active(&_spi) || _chain.segments) {
         return queue_transfer(tx_buffer, tx_length, rx_buffer, rx_length, bit_width, callback, event);
     }
     start_transfer(tx_buffer, tx_length, rx_buffer, rx_length, bit_width, callback, event);
     return 0;
 }
 
+int SPI::transfer_chain(const Segment *segments, int count, DigitalOut *cs, const event_callback_t& callback, int event)
+{
+    MBED_ASSERT(segments != NULL && count > 0);
+    for (int i = 0; i < count; i++) {
+        // The HAL does nothing, and never completes, without a buffer
+        MBED_ASSERT(segments[i].length > 0 && (segments[i].tx_buffer || segments[i].rx_buffer));
+    }
+
+    chain_t chain = { this, segments, count, cs, callback, event };
+    int ret = 0;
+
+    core_util_critical_section_enter();
+    if (spi_active(&_spi) || _chain.segments) {
+#if TRANSACTION_QUEUE_SIZE_SPI
+        if (!_chain_buffer.full()) {
+            _chain_buffer.push(chain);
+        } else {
+            ret = -1;
+        }
+#else
+        ret = -1;
+#endif
+    } else {
+        start_chain(chain);
+    }
+    core_util_critical_section_exit();
+    return ret;
+}
+
 void SPI::abort_transfer()
 {
     spi_abort_asynch(&_spi);
+    if (_chain.segments) {
+        _chain_delay.detach();
+        if (_chain.cs) {
+            _chain.cs->write(1);
+        }
+        _chain.segments = NULL;
+    }
     unlock_deep_sleep();
 #if TRANSACTION_QUEUE_SIZE_SPI
-    dequeue_transaction();
+    if (!spi_active(&_spi) && !_chain.segments) {
+        dequeue_transaction();
+    }
 #endif
 }
 
@@ -152,6 +200,7 @@ void SPI::clear_transfer_buffer()
 {
 #if TRANSACTION_QUEUE_SIZE_SPI
     _transaction_buffer.reset();
+    _chain_buffer.reset();
 #endif
 }
 
@@ -163,7 +212,7 @@ void SPI::abort_all_transfers()
 
 int SPI::set_dma_usage(DMAUsage usage)
 {
-    if (spi_active(&_spi)) {
+    if (spi_active(&_spi) || _chain.segments) {
         return -1;
     }
     _usage = usage;
@@ -188,7 +237,8 @@ int SPI::queue_transfer(const void *tx_buffer, int tx_length, void *rx_buffer, i
     } else {
         core_util_critical_section_enter();
         _transaction_buffer.push(transaction);
-        if (!spi_active(&_spi)) {
+        // During a segment delay of a chain the peripheral is idle but the bus is not free
+        if (!spi_active(&_spi) && !_chain.segments) {
             dequeue_transaction();
         }
         core_util_critical_section_exit();
@@ -224,6 +274,52 @@ void SPI::unlock_deep_sleep()
     }
 }
 
+void SPI::start_chain(const chain_t &chain)
+{
+    lock_deep_sleep();
+    _acquire();
+    _chain = chain;
+    _chain_index = 0;
+    _irq.callback(&SPI::irq_handler_asynch);
+    chain_start_segment();
+}
+
+void SPI::chain_start_segment()
+{
+    const Segment &segment = _chain.segments[_chain_index];
+    if (_chain.cs) {
+        _chain.cs->write(0);
+    }
+    spi_master_transfer(&_spi, segment.tx_buffer, segment.tx_buffer ? segment.length : 0,
+                        segment.rx_buffer, segment.rx_buffer ? segment.length : 0,
+                        _bits > 8 ? 16 : 8, _irq.entry(), SPI_EVENT_ALL, _usage);
+}
+
+void SPI::chain_continue()
+{
+    if (++_chain_index < _chain.count) {
+        chain_start_segment();
+    } else {
+        chain_finish(SPI_EVENT_COMPLETE);
+    }
+}
+
+void SPI::chain_finish(int event)
+{
+    // The next job may reuse _chain before the callback runs
+    event_callback_t callback = _chain.callback;
+    event &= _chain.event;
+
+    _chain.segments = NULL;
+    unlock_deep_sleep();
+#if TRANSACTION_QUEUE_SIZE_SPI
+    dequeue_transaction();
+#endif
+    if (callback && event) {
+        callback.call(event);
+    }
+}
+
 #if TRANSACTION_QUEUE_SIZE_SPI
 
 void SPI::start_transaction(transaction_t *data)
@@ -233,6 +329,12 @@ void SPI::start_transaction(transaction_t *data)
 
 void SPI::dequeue_transaction()
 {
+    chain_t chain;
+    if (_chain_buffer.pop(chain)) {
+        chain.obj->start_chain(chain);
+        return;
+    }
+
     Transaction<SPI> t;
     if (_transaction_buffer.pop(t)) {
         SPI* obj = t.get_object();
@@ -246,6 +348,29 @@ void SPI::dequeue_transaction()
 void SPI::irq_handler_asynch(void)
 {
     int event = spi_irq_handler_asynch(&_spi);
+    if (_chain.segments) {
+        if (!(event & SPI_EVENT_ALL)) {
+            return;
+        }
+        const Segment &segment = _chain.segments[_chain_index];
+        bool last = (_chain_index + 1 == _chain.count);
+        bool failed = (event & SPI_EVENT_ALL) != SPI_EVENT_COMPLETE;
+        if (_chain.cs && (segment.cs_release || last || failed)) {
+            _chain.cs->write(1);
+        }
+        if (failed) {
+            chain_finish(event & SPI_EVENT_ALL);
+        } else if (segment.delay_us == 0) {
+            chain_continue();
+        } else if (segment.delay_us <= MBED_CONF_DRIVERS_SPI_CHAIN_SPIN_DELAY) {
+            // Shorter than setting up a timeout
+            wait_us(segment.delay_us);
+            chain_continue();
+        } else {
+            _chain_delay.attach_us(callback(this, &SPI::chain_continue), segment.delay_us);
+        }
+        return;
+    }
     if (_callback && (event & SPI_EVENT_ALL)) {
         unlock_deep_sleep();
         _callback.call(event & SPI_EVENT_ALL);
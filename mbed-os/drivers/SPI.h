@@ -31,6 +31,8 @@
 #include "platform/CircularBuffer.h"
 #include "platform/FunctionPointer.h"
 #include "platform/Transaction.h"
+#include "drivers/DigitalOut.h"
+#include "drivers/Timeout.h"
 #endif
 
 namespace mbed {
@@ -170,13 +172,49 @@ public:
      */
     template<typename Type>
     int transfer(const Type *tx_buffer, int tx_length, Type *rx_buffer, int rx_length, const event_callback_t& callback, int event = SPI_EVENT_COMPLETE) {
-        if (spi_active(&_spi)) {
+        if (spi_active(&_spi) || _chain.segments) {
             return queue_transfer(tx_buffer, tx_length, rx_buffer, rx_length, sizeof(Type)*8, callback, event);
         }
         start_transfer(tx_buffer, tx_length, rx_buffer, rx_length, sizeof(Type)*8, callback, event);
         return 0;
     }
 
+    /** One segment of a transfer chain, such as the command or the data
+     *  phase of a flash or radio access
+     */
+    struct Segment {
+        const void *tx_buffer;  /**< Data to send, or NULL to send the fill character */
+        void *rx_buffer;        /**< Buffer for received data, or NULL to discard it */
+        int length;             /**< Length of the segment in bytes */
+        bool cs_release;        /**< Release chip select after the segment */
+        uint32_t delay_us;      /**< Idle time after the segment, in microseconds */
+    };
+
+    /** Start a chain of segments as one non-blocking job
+     *
+     * Each segment is started from the interrupt that ends the previous one,
+     * so a multi-phase access costs no thread round trips. Chip select is
+     * asserted for the first segment and after every release, released after
+     * segments with cs_release and at the end of the job, and stays asserted
+     * across the other segments. The delay of a segment runs after chip
+     * select is released, if it is, so it can also give a deselect time.
+     *
+     * If the bus is busy the job is queued; queued jobs start before queued
+     * single transfers. The next job is started before the callback of the
+     * previous one is called.
+     *
+     * This function locks the deep sleep until the job has finished.
+     *
+     * @param segments  The segments, which must stay valid until the callback
+     * @param count     Number of segments, at least 1
+     * @param cs        Chip select, active low, or NULL if driven by the caller
+     * @param callback  Called once, when the last segment has been transferred
+     *                  or when a segment failed
+     * @param event     The logical OR of events to report. Look at spi hal header file for SPI events.
+     * @return Zero if the job has started or was queued, or -1 if the queue is full
+     */
+    int transfer_chain(const Segment *segments, int count, DigitalOut *cs, const event_callback_t& callback, int event = SPI_EVENT_COMPLETE);
+
     /** Abort the on-going SPI transfer, and continue with transfer's in the queue if any.
      */
     void abort_transfer();
@@ -253,6 +291,32 @@ private:
     /** Unlock deep sleep in case it is locked */
     void unlock_deep_sleep();
 
+    /** A queued or running transfer chain */
+    struct chain_t {
+        SPI *obj;
+        const Segment *segments;    // NULL when no chain is running
+        int count;
+        DigitalOut *cs;
+        event_callback_t callback;
+        int event;
+    };
+
+    /** Take over the bus for a chain and start its first segment */
+    void start_chain(const chain_t &chain);
+
+    /** Start the current segment of the running chain */
+    void chain_start_segment();
+
+    /** Continue the running chain after a segment and its delay */
+    void chain_continue();
+
+    /** End the running chain, start the next job and report the events */
+    void chain_finish(int event);
+
+    chain_t _chain;
+    int _chain_index;
+    Timeout _chain_delay;
+
 
 #if TRANSACTION_QUEUE_SIZE_SPI
 
@@ -267,6 +331,7 @@ private:
     */
     void dequeue_transaction();
     static CircularBuffer<Transaction<SPI>, TRANSACTION_QUEUE_SIZE_SPI> _transaction_buffer;
+    static CircularBuffer<chain_t, TRANSACTION_QUEUE_SIZE_SPI> _chain_buffer;
 #endif
 
 #endif
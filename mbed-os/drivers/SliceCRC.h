@@ -0,0 +1,287 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SLICE_CRC_H
+#define SLICE_CRC_H
+
+#include <stdint.h>
+
+#ifndef MBED_CONF_DRIVERS_CRC_TABLE_SLICES
+#define MBED_CONF_DRIVERS_CRC_TABLE_SLICES  4
+#endif
+
+#if MBED_CONF_DRIVERS_CRC_TABLE_SLICES != 1 && MBED_CONF_DRIVERS_CRC_TABLE_SLICES != 4 && \
+    MBED_CONF_DRIVERS_CRC_TABLE_SLICES != 8
+#error "drivers.crc-table-slices must be 1, 4 or 8"
+#endif
+
+namespace mbed {
+/** \addtogroup drivers */
+/** @{*/
+
+namespace internal {
+
+/* Slicing-by-4/8 CRC tables, computed by the compiler for any polynomial of
+ * 8 to 32 bits.
+ *
+ * The register is kept in one of two forms so that whole words can be
+ * folded in at once:
+ * - normal: MSB aligned, the polynomial shifted up to bit 31, input bytes
+ *   taken big endian;
+ * - reflected: LSB aligned, the polynomial bit reversed, input bytes taken
+ *   little endian. This is the form of CRCs that reflect both input and
+ *   output (CRC-32, CRC-16/IBM), and needs no per-byte reflection.
+ *
+ * Table k holds the CRC of a byte followed by k zero bytes.
+ */
+
+/** Reverse the low bits of data */
+template<uint32_t data, int bits>
+struct crc_reflect {
+    static const uint32_t value = ((data & 1) << (bits - 1)) | crc_reflect<(data >> 1), bits - 1>::value;
+};
+
+template<uint32_t data>
+struct crc_reflect<data, 0> {
+    static const uint32_t value = 0;
+};
+
+/** Shift bits through the register */
+template<uint32_t poly, bool reflected, uint32_t crc, int bits>
+struct crc_bits {
+    static const uint32_t next = reflected ? ((crc & 1) ? (crc >> 1) ^ poly : (crc >> 1))
+                                           : ((crc & 0x80000000UL) ? (crc << 1) ^ poly : (crc << 1));
+    static const uint32_t value = crc_bits<poly, reflected, next, bits - 1>::value;
+};
+
+template<uint32_t poly, bool reflected, uint32_t crc>
+struct crc_bits<poly, reflected, crc, 0> {
+    static const uint32_t value = crc;
+};
+
+/** Entry of table slice, the CRC of byte index followed by slice zero bytes */
+template<uint32_t poly, bool reflected, int slice, uint32_t index>
+struct crc_slice_entry {
+    static const uint32_t prev = crc_slice_entry<poly, reflected, slice - 1, index>::value;
+    static const uint32_t value = reflected
+        ? (prev >> 8) ^ crc_slice_entry<poly, reflected, 0, (prev & 0xFF)>::value
+        : (prev << 8) ^ crc_slice_entry<poly, reflected, 0, (prev >> 24)>::value;
+};
+
+template<uint32_t poly, bool reflected, uint32_t index>
+struct crc_slice_entry<poly, reflected, 0, index> {
+    static const uint32_t value = crc_bits<poly, reflected, (reflected ? index : index << 24), 8>::value;
+};
+
+template<uint32_t poly, bool reflected>
+struct crc_slice_table {
+    static const uint32_t table[MBED_CONF_DRIVERS_CRC_TABLE_SLICES][256];
+};
+
+#define MBED_CRC_E(k, i)    crc_slice_entry<poly, reflected, k, (i)>::value
+#define MBED_CRC_E4(k, i)   MBED_CRC_E(k, i), MBED_CRC_E(k, (i) + 1), MBED_CRC_E(k, (i) + 2), MBED_CRC_E(k, (i) + 3)
+#define MBED_CRC_E16(k, i)  MBED_CRC_E4(k, i), MBED_CRC_E4(k, (i) + 4), MBED_CRC_E4(k, (i) + 8), MBED_CRC_E4(k, (i) + 12)
+#define MBED_CRC_E64(k, i)  MBED_CRC_E16(k, i), MBED_CRC_E16(k, (i) + 16), MBED_CRC_E16(k, (i) + 32), MBED_CRC_E16(k, (i) + 48)
+#define MBED_CRC_E256(k)    { MBED_CRC_E64(k, 0), MBED_CRC_E64(k, 64), MBED_CRC_E64(k, 128), MBED_CRC_E64(k, 192) }
+
+template<uint32_t poly, bool reflected>
+const uint32_t crc_slice_table<poly, reflected>::table[MBED_CONF_DRIVERS_CRC_TABLE_SLICES][256] = {
+    MBED_CRC_E256(0),
+#if MBED_CONF_DRIVERS_CRC_TABLE_SLICES >= 4
+    MBED_CRC_E256(1),
+    MBED_CRC_E256(2),
+    MBED_CRC_E256(3),
+#endif
+#if MBED_CONF_DRIVERS_CRC_TABLE_SLICES >= 8
+    MBED_CRC_E256(4),
+    MBED_CRC_E256(5),
+    MBED_CRC_E256(6),
+    MBED_CRC_E256(7),
+#endif
+};
+
+#undef MBED_CRC_E
+#undef MBED_CRC_E4
+#undef MBED_CRC_E16
+#undef MBED_CRC_E64
+#undef MBED_CRC_E256
+
+/** Slicing loop over the register in one form; only the tables of that form are instantiated */
+template<uint32_t polynomial, uint8_t width, bool reflected>
+struct crc_slice_kernel;
+
+template<uint32_t polynomial, uint8_t width>
+struct crc_slice_kernel<polynomial, width, true> {
+    static uint32_t compute(uint32_t crc, const uint8_t *data, uint64_t size)
+    {
+        const uint32_t (*t)[256] = crc_slice_table<crc_reflect<polynomial, width>::value, true>::table;
+#if MBED_CONF_DRIVERS_CRC_TABLE_SLICES == 8
+        for (; size >= 8; size -= 8, data += 8) {
+            uint32_t lo = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24));
+            uint32_t hi = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                  t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        }
+#endif
+        for (; size >= 4; size -= 4, data += 4) {
+            crc ^= data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+            crc = t[3][crc & 0xFF] ^ t[2][(crc >> 8) & 0xFF] ^ t[1][(crc >> 16) & 0xFF] ^ t[0][crc >> 24];
+        }
+        for (; size; size--) {
+            crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+};
+
+template<uint32_t polynomial, uint8_t width>
+struct crc_slice_kernel<polynomial, width, false> {
+    static uint32_t compute(uint32_t crc, const uint8_t *data, uint64_t size)
+    {
+        const uint32_t (*t)[256] = crc_slice_table<(uint32_t)(polynomial << (32 - width)), false>::table;
+#if MBED_CONF_DRIVERS_CRC_TABLE_SLICES == 8
+        for (; size >= 8; size -= 8, data += 8) {
+            uint32_t hi = crc ^ (((uint32_t)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3]);
+            uint32_t lo = ((uint32_t)data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
+            crc = t[7][hi >> 24] ^ t[6][(hi >> 16) & 0xFF] ^ t[5][(hi >> 8) & 0xFF] ^ t[4][hi & 0xFF] ^
+                  t[3][lo >> 24] ^ t[2][(lo >> 16) & 0xFF] ^ t[1][(lo >> 8) & 0xFF] ^ t[0][lo & 0xFF];
+        }
+#endif
+        for (; size >= 4; size -= 4, data += 4) {
+            crc ^= ((uint32_t)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+            crc = t[3][crc >> 24] ^ t[2][(crc >> 16) & 0xFF] ^ t[1][(crc >> 8) & 0xFF] ^ t[0][crc & 0xFF];
+        }
+        for (; size; size--) {
+            crc = t[0][(crc >> 24) ^ *data++] ^ (crc << 8);
+        }
+        return crc;
+    }
+};
+
+/** Register form sliced for a polynomial: the one of its default configuration
+ *
+ * Other configurations of the polynomial keep using the byte tables or the
+ * bitwise code, so each polynomial costs one set of slice tables at most.
+ */
+template<uint32_t polynomial, uint8_t width>
+struct crc_slice_form {
+    static const bool reflected = false;
+};
+
+template<>
+struct crc_slice_form<0x04C11DB7, 32> {        // POLY_32BIT_ANSI
+    static const bool reflected = true;
+};
+
+template<>
+struct crc_slice_form<0x8005, 16> {            // POLY_16BIT_IBM
+    static const bool reflected = true;
+};
+
+/** Sliced CRC of one polynomial, for widths of 8 bits or more */
+template<uint32_t polynomial, uint8_t width, bool enabled = (width >= 8)>
+class crc_slicer {
+public:
+    static const bool reflected = crc_slice_form<polynomial, width>::reflected;
+    static const bool supported = enabled && MBED_CONF_DRIVERS_CRC_TABLE_SLICES > 1;
+
+    /** Whether a configuration can be sliced */
+    static bool handles(bool reflect_data, bool reflect_remainder)
+    {
+        return supported && reflect_data == reflected && reflect_remainder == reflected;
+    }
+
+    /** Register value for a seed given in the usual (unreflected) form */
+    static uint32_t start(uint32_t initial_xor)
+    {
+        initial_xor &= mask();
+        if (reflected) {
+            uint32_t crc = 0;
+            for (int bit = 0; bit < width; bit++) {
+                crc = (crc << 1) | ((initial_xor >> bit) & 1);
+            }
+            return crc;
+        }
+        return initial_xor << (32 - width);
+    }
+
+    static uint32_t compute(uint32_t crc, const uint8_t *data, uint64_t size)
+    {
+        return crc_slice_kernel<polynomial, width, reflected>::compute(crc, data, size);
+    }
+
+    /** Final CRC from the register; reflection of the output is implied by the form */
+    static uint32_t stop(uint32_t crc, uint32_t final_xor)
+    {
+        if (!reflected) {
+            crc >>= 32 - width;
+        }
+        return (crc ^ final_xor) & mask();
+    }
+
+private:
+    static uint32_t mask()
+    {
+        return (uint32_t)((1ull << width) - 1);
+    }
+};
+
+/* Narrower CRCs keep using the byte tables or the bitwise code; this keeps
+ * their slice tables from being instantiated at all. */
+template<uint32_t polynomial, uint8_t width>
+class crc_slicer<polynomial, width, false> {
+public:
+    static const bool supported = false;
+
+    static bool handles(bool, bool)
+    {
+        return false;
+    }
+
+    static uint32_t start(uint32_t initial_xor)
+    {
+        return initial_xor;
+    }
+
+    static uint32_t compute(uint32_t crc, const uint8_t *, uint64_t)
+    {
+        return crc;
+    }
+
+    static uint32_t stop(uint32_t crc, uint32_t)
+    {
+        return crc;
+    }
+};
+
+/** Claim the hardware CRC unit for one computation
+ *
+ * @param owner  Object doing the computation
+ * @return true if the unit was free or already held by @a owner
+ */
+bool crc_hardware_claim(const void *owner);
+
+/** Hand back the hardware CRC unit
+ *
+ * @param owner  Object that claimed the unit
+ */
+void crc_hardware_release(const void *owner);
+
+} // namespace internal
+
+/** @}*/
+} // namespace mbed
+
+#endif
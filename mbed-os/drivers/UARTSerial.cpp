@@ -20,12 +20,21 @@
 #include "UARTSerial.h"
 #include "platform/mbed_poll.h"
 
+#include "hal/us_ticker_api.h"
+
 #if MBED_CONF_RTOS_PRESENT
-#include "rtos/Thread.h"
+#include "cmsis_os2.h"
 #else
-#include "platform/mbed_wait_api.h"
+#include "drivers/Timeout.h"
+#include "platform/mbed_power_mgmt.h"
 #endif
 
+// Events signalled from interrupt context, on buffer state transitions only
+#define RX_READY    (1UL << 0)  // receive buffer became non-empty
+#define TX_SPACE    (1UL << 1)  // transmit buffer became non-full
+#define TX_EMPTY    (1UL << 2)  // transmit buffer drained
+#define TIMED_OUT   (1UL << 3)  // wait timeout expired, without RTOS only
+
 namespace mbed {
 
 UARTSerial::UARTSerial(PinName tx, PinName rx, int baud) :
@@ -33,7 +42,17 @@ UARTSerial::UARTSerial(PinName tx, PinName rx, int baud) :
         _blocking(true),
         _tx_irq_enabled(false),
         _rx_irq_enabled(true),
-        _dcd_irq(NULL)
+        _dcd_irq(NULL),
+        _read_timeout(-1),
+        _write_timeout(-1)
+#if !MBED_CONF_RTOS_PRESENT
+        , _event_flags(0)
+#endif
+#if DEVICE_SERIAL_DMA
+        , _dma_buf(NULL)
+        , _dma_rx_tail(0)
+        , _dma_tx_length(0)
+#endif
 {
     /* Attatch IRQ routines to the serial device. */
     SerialBase::attach(callback(this, &UARTSerial::rx_irq), RxIrq);
@@ -42,6 +61,12 @@ UARTSerial::UARTSerial(PinName tx, PinName rx, int baud) :
 UARTSerial::~UARTSerial()
 {
     delete _dcd_irq;
+#if DEVICE_SERIAL_DMA
+    if (_dma_buf) {
+        serial_dma_free(&_serial);
+        delete[] _dma_buf;
+    }
+#endif
 }
 
 void UARTSerial::dcd_irq()
@@ -107,18 +132,32 @@ off_t UARTSerial::seek(off_t offset, int whence)
 
 int UARTSerial::sync()
 {
+    int ret = 0;
+    us_timestamp_t start = ticker_read_us(get_us_ticker_data());
+
     api_lock();
 
-    while (!_txbuf.empty()) {
-        api_unlock();
-        // Doing better than wait would require TxIRQ to also do wake() when becoming empty. Worth it?
-        wait_ms(1);
-        api_lock();
+    // In DMA mode the last block is still being sent once the buffer is empty
+    while (!_txbuf.empty() || _tx_irq_enabled) {
+        if (!wait_event(TX_EMPTY, time_left(_write_timeout, start))) {
+            ret = -EAGAIN;
+            break;
+        }
     }
 
     api_unlock();
 
-    return 0;
+    return ret;
+}
+
+void UARTSerial::set_read_timeout(int timeout)
+{
+    _read_timeout = timeout;
+}
+
+void UARTSerial::set_write_timeout(int timeout)
+{
+    _write_timeout = timeout;
 }
 
 void UARTSerial::sigio(Callback<void()> func) {
@@ -137,35 +176,43 @@ ssize_t UARTSerial::write(const void* buffer, size_t length)
 {
     size_t data_written = 0;
     const char *buf_ptr = static_cast<const char *>(buffer);
+    bool timed_out = false;
 
     if (length == 0) {
         return 0;
     }
 
+    us_timestamp_t start = ticker_read_us(get_us_ticker_data());
+
     api_lock();
 
     // Unlike read, we should write the whole thing if blocking. POSIX only
     // allows partial as a side-effect of signal handling; it normally tries to
     // write everything if blocking. Without signals we can always write all.
-    while (data_written < length) {
+    while (data_written < length && !timed_out) {
 
         if (_txbuf.full()) {
             if (!_blocking) {
                 break;
             }
             do {
-                api_unlock();
-                wait_ms(1); // XXX todo - proper wait, WFE for non-rtos ?
-                api_lock();
+                if (!wait_event(TX_SPACE, time_left(_write_timeout, start))) {
+                    timed_out = true;
+                    break;
+                }
             } while (_txbuf.full());
         }
 
-        while (data_written < length && !_txbuf.full()) {
-            _txbuf.push(*buf_ptr++);
-            data_written++;
-        }
+        data_written += _txbuf.push(buf_ptr + data_written, length - data_written);
 
         core_util_critical_section_enter();
+#if DEVICE_SERIAL_DMA
+        if (_dma_buf) {
+            if (!_tx_irq_enabled) {
+                dma_tx();
+            }
+        } else
+#endif
         if (!_tx_irq_enabled) {
             UARTSerial::tx_irq();                // only write to hardware in one place
             if (!_txbuf.empty()) {
@@ -191,24 +238,25 @@ ssize_t UARTSerial::read(void* buffer, size_t length)
         return 0;
     }
 
+    us_timestamp_t start = ticker_read_us(get_us_ticker_data());
+
     api_lock();
 
     while (_rxbuf.empty()) {
-        if (!_blocking) {
+        if (!_blocking || !wait_event(RX_READY, time_left(_read_timeout, start))) {
             api_unlock();
             return -EAGAIN;
         }
-        api_unlock();
-        wait_ms(1);  // XXX todo - proper wait, WFE for non-rtos ?
-        api_lock();
     }
 
-    while (data_read < length && !_rxbuf.empty()) {
-        _rxbuf.pop(*ptr++);
-        data_read++;
-    }
+    data_read = _rxbuf.pop(ptr, length);
 
     core_util_critical_section_enter();
+#if DEVICE_SERIAL_DMA
+    if (_dma_buf) {
+        dma_rx();                           // pick up what did not fit before
+    } else
+#endif
     if (!_rx_irq_enabled) {
         UARTSerial::rx_irq();               // only read from hardware in one place
         if (!_rxbuf.full()) {
@@ -233,6 +281,7 @@ void UARTSerial::wake()
     if (_sigio_cb) {
         _sigio_cb();
     }
+    poll_change();
 }
 
 short UARTSerial::poll(short events) const {
@@ -297,6 +346,7 @@ void UARTSerial::rx_irq(void)
 
     /* Report the File handler that data is ready to be read from the buffer. */
     if (was_empty && !_rxbuf.empty()) {
+        signal_event(RX_READY);
         wake();
     }
 }
@@ -316,25 +366,192 @@ void UARTSerial::tx_irq(void)
     if (_tx_irq_enabled && _txbuf.empty()) {
         SerialBase::attach(NULL, TxIrq);
         _tx_irq_enabled = false;
+        signal_event(TX_EMPTY);
     }
 
     /* Report the File handler that data can be written to peripheral. */
-    if (was_full && !_txbuf.full() && !hup()) {
+    if (was_full && !_txbuf.full()) {
+        signal_event(TX_SPACE);
+        if (!hup()) {
+            wake();
+        }
+    }
+}
+
+#if DEVICE_SERIAL_DMA
+int UARTSerial::set_dma_usage(DMAUsage usage)
+{
+    bool enable = usage != DMA_USAGE_NEVER;
+    uint8_t *buf = NULL;
+    int ret = 0;
+
+    sync();
+
+    api_lock();
+
+    if (enable && !_dma_buf) {
+        buf = new uint8_t[MBED_CONF_DRIVERS_UART_SERIAL_DMA_RXBUF_SIZE];
+        core_util_critical_section_enter();
+        if (serial_dma_init(&_serial, &UARTSerial::dma_irq, (uint32_t)this) == 0) {
+            if (_rx_irq_enabled) {
+                SerialBase::attach(NULL, RxIrq);
+                _rx_irq_enabled = false;
+            }
+            _dma_buf = buf;
+            _dma_rx_tail = 0;
+            buf = NULL;
+            serial_dma_rx_start(&_serial, _dma_buf, MBED_CONF_DRIVERS_UART_SERIAL_DMA_RXBUF_SIZE);
+        } else {
+            ret = -ENODEV;
+        }
+        core_util_critical_section_exit();
+    } else if (!enable && _dma_buf) {
+        core_util_critical_section_enter();
+        dma_rx();
+        serial_dma_free(&_serial);
+        buf = _dma_buf;
+        _dma_buf = NULL;
+        if (!_rxbuf.full()) {
+            SerialBase::attach(callback(this, &UARTSerial::rx_irq), RxIrq);
+            _rx_irq_enabled = true;
+        }
+        core_util_critical_section_exit();
+    }
+
+    api_unlock();
+
+    delete[] buf;
+    return ret;
+}
+
+void UARTSerial::dma_irq(uint32_t id, SerialDmaEvent event)
+{
+    UARTSerial *handler = (UARTSerial *)id;
+
+    if (event == SERIAL_DMA_RX) {
+        handler->dma_rx();
+    } else {
+        handler->dma_tx();
+    }
+}
+
+void UARTSerial::dma_rx(void)
+{
+    uint32_t head = serial_dma_rx_head(&_serial);
+    bool was_empty = _rxbuf.empty();
+
+    // What does not fit stays in the DMA ring until read() makes room, which
+    // works as long as the ring does not wrap onto it in the meantime
+    while (_dma_rx_tail != head) {
+        uint32_t end = head > _dma_rx_tail ? head : MBED_CONF_DRIVERS_UART_SERIAL_DMA_RXBUF_SIZE;
+        uint32_t n = _rxbuf.push((const char *)_dma_buf + _dma_rx_tail, end - _dma_rx_tail);
+        if (n == 0) {
+            break;
+        }
+        _dma_rx_tail = (_dma_rx_tail + n) % MBED_CONF_DRIVERS_UART_SERIAL_DMA_RXBUF_SIZE;
+    }
+
+    if (was_empty && !_rxbuf.empty()) {
+        signal_event(RX_READY);
         wake();
     }
 }
 
-void UARTSerial::wait_ms(uint32_t millisec)
+// Also called from write to start transfer; _tx_irq_enabled tells a block is in flight
+void UARTSerial::dma_tx(void)
+{
+    bool was_full = _txbuf.full();
+    uint32_t length;
+
+    // DMA reads straight from the buffer, so a block is only released
+    // once it has been sent
+    _txbuf.release(_dma_tx_length);
+    const char *block = _txbuf.read_span(length);
+    _dma_tx_length = length;
+
+    if (length) {
+        serial_dma_tx_start(&_serial, (const uint8_t *)block, length);
+        _tx_irq_enabled = true;
+    } else if (_tx_irq_enabled) {
+        _tx_irq_enabled = false;
+        signal_event(TX_EMPTY);
+    }
+
+    if (was_full && !_txbuf.full()) {
+        signal_event(TX_SPACE);
+        if (!hup()) {
+            wake();
+        }
+    }
+}
+#endif
+
+int UARTSerial::time_left(int timeout, us_timestamp_t start)
 {
-    /* wait_ms implementation for RTOS spins until exact microseconds - we
-     * want to just sleep until next tick.
-     */
+    if (timeout < 0) {
+        return -1;
+    }
+    us_timestamp_t elapsed = (ticker_read_us(get_us_ticker_data()) - start) / 1000;
+    return elapsed >= (us_timestamp_t)timeout ? 0 : timeout - (int)elapsed;
+}
+
 #if MBED_CONF_RTOS_PRESENT
-    rtos::Thread::wait(millisec);
+
+void UARTSerial::signal_event(uint32_t flags)
+{
+    _event.set(flags);
+}
+
+bool UARTSerial::wait_event(uint32_t flag, int timeout)
+{
+    // A flag left over from an earlier transition only costs one more check
+    // of the buffer by the caller
+    api_unlock();
+    uint32_t flags = _event.wait_any(flag, timeout < 0 ? osWaitForever : (uint32_t)timeout);
+    api_lock();
+    return !(flags & osFlagsError);
+}
+
 #else
-    ::wait_ms(millisec);
-#endif
+
+void UARTSerial::signal_event(uint32_t flags)
+{
+    _event_flags |= flags;
+}
+
+void UARTSerial::timeout_irq()
+{
+    signal_event(TIMED_OUT);
+}
+
+bool UARTSerial::wait_event(uint32_t flag, int timeout)
+{
+    Timeout timer;
+    if (timeout >= 0) {
+        timer.attach_us(callback(this, &UARTSerial::timeout_irq), (us_timestamp_t)timeout * 1000);
+    }
+
+    api_unlock();
+
+    // Sleep with interrupts masked so that no event is lost between the
+    // check and the sleep; a pending interrupt still ends the sleep, and
+    // runs when the critical section is left
+    core_util_critical_section_enter();
+    while (!(_event_flags & (flag | TIMED_OUT))) {
+        sleep();
+        core_util_critical_section_exit();
+        core_util_critical_section_enter();
+    }
+    uint32_t flags = _event_flags;
+    _event_flags &= ~(flag | TIMED_OUT);
+    core_util_critical_section_exit();
+
+    timer.detach();
+    api_lock();
+    return flags & flag;
 }
+
+#endif
 } //namespace mbed
 
 #endif //(DEVICE_SERIAL && DEVICE_INTERRUPTIN)
@@ -26,8 +26,15 @@
 #include "InterruptIn.h"
 #include "PlatformMutex.h"
 #include "serial_api.h"
-#include "CircularBuffer.h"
+#include "ticker_api.h"
+#include "RingBuffer.h"
 #include "platform/NonCopyable.h"
+#if MBED_CONF_RTOS_PRESENT
+#include "rtos/EventFlags.h"
+#endif
+#if DEVICE_SERIAL_DMA
+#include "serial_dma_api.h"
+#endif
 
 #ifndef MBED_CONF_DRIVERS_UART_SERIAL_RXBUF_SIZE
 #define MBED_CONF_DRIVERS_UART_SERIAL_RXBUF_SIZE  256
@@ -37,6 +44,10 @@
 #define MBED_CONF_DRIVERS_UART_SERIAL_TXBUF_SIZE  256
 #endif
 
+#ifndef MBED_CONF_DRIVERS_UART_SERIAL_DMA_RXBUF_SIZE
+#define MBED_CONF_DRIVERS_UART_SERIAL_DMA_RXBUF_SIZE  64
+#endif
+
 namespace mbed {
 
 /** \addtogroup drivers */
@@ -76,6 +87,8 @@ public:
      * * if blocking, block until all data is written
      * * if no data can be written, and non-blocking set, return -EAGAIN
      * * if some data can be written, and non-blocking set, write partial
+     * * if blocking and the write timeout expires, write partial, or
+     *   return -EAGAIN if nothing was written
      *
      *  @param buffer   The buffer to write from
      *  @param length   The number of bytes to write
@@ -89,6 +102,7 @@ public:
      *
      *  * if no data is available, and non-blocking set return -EAGAIN
      *  * if no data is available, and blocking set, wait until data is available
+     *    or the read timeout expires, then return -EAGAIN
      *  * If any data is available, call returns immediately
      *
      *  @param buffer   The buffer to read in to
@@ -127,7 +141,9 @@ public:
 
     /** Flush any buffers associated with the file
      *
-     *  @return         0 on success, negative error code on failure
+     *  Waits for the transmit buffer to drain, up to the write timeout.
+     *
+     *  @return         0 on success, -EAGAIN if the write timeout expired
      */
     virtual int sync();
 
@@ -151,6 +167,39 @@ public:
         return _blocking;
     }
 
+    /** Set how long a blocking read waits for data
+     *
+     *  Waiting threads sleep until the receive interrupt signals data, they
+     *  do not poll the buffer.
+     *
+     *  @param timeout  Timeout in milliseconds, -1 to wait forever (default)
+     */
+    void set_read_timeout(int timeout);
+
+    /** Set how long a blocking write or sync waits for buffer space
+     *
+     *  @param timeout  Timeout in milliseconds, -1 to wait forever (default)
+     */
+    void set_write_timeout(int timeout);
+
+#if DEVICE_SERIAL_DMA
+    /** Move data with DMA instead of one interrupt per character
+     *
+     *  Reception runs continuously into a DMA ring, which is copied to the
+     *  receive buffer when half of it has filled and when the line goes idle.
+     *  Transmission sends straight out of the transmit buffer. This avoids
+     *  overruns at high baud rates, as long as interrupts are never held off
+     *  for half a DMA ring of characters.
+     *
+     *  Waits for pending output to be sent before switching.
+     *
+     *  @param usage    DMA_USAGE_NEVER to use character interrupts (default),
+     *                  any other value to use DMA
+     *  @return         0 on success, -ENODEV if the port has no DMA channels
+     */
+    int set_dma_usage(DMAUsage usage);
+#endif
+
     /** Register a callback on state change of the file.
      *
      *  The specified callback will be called on state changes such as when
@@ -224,7 +273,11 @@ public:
 
 private:
 
-    void wait_ms(uint32_t millisec);
+    bool wait_event(uint32_t flag, int timeout);
+
+    void signal_event(uint32_t flags);
+
+    static int time_left(int timeout, us_timestamp_t start);
 
     /** SerialBase lock override */
     virtual void lock(void);
@@ -239,10 +292,11 @@ private:
     virtual void api_unlock(void);
 
     /** Software serial buffers
-     *  By default buffer size is 256 for TX and 256 for RX. Configurable through mbed_app.json
+     *  By default buffer size is 256 for TX and 256 for RX. Configurable through mbed_app.json,
+     *  sizes must be powers of two
      */
-    CircularBuffer<char, MBED_CONF_DRIVERS_UART_SERIAL_RXBUF_SIZE> _rxbuf;
-    CircularBuffer<char, MBED_CONF_DRIVERS_UART_SERIAL_TXBUF_SIZE> _txbuf;
+    RingBuffer<char, MBED_CONF_DRIVERS_UART_SERIAL_RXBUF_SIZE> _rxbuf;
+    RingBuffer<char, MBED_CONF_DRIVERS_UART_SERIAL_TXBUF_SIZE> _txbuf;
 
     PlatformMutex _mutex;
 
@@ -253,6 +307,17 @@ private:
     bool _rx_irq_enabled;
     InterruptIn *_dcd_irq;
 
+    int _read_timeout;
+    int _write_timeout;
+
+#if MBED_CONF_RTOS_PRESENT
+    rtos::EventFlags _event;
+#else
+    volatile uint32_t _event_flags;
+
+    void timeout_irq(void);
+#endif
+
     /** Device Hanged up
      *  Determines if the device hanged up on us.
      *
@@ -272,6 +337,19 @@ private:
 
     void dcd_irq(void);
 
+#if DEVICE_SERIAL_DMA
+    /** DMA mode counterparts of rx_irq and tx_irq */
+    static void dma_irq(uint32_t id, SerialDmaEvent event);
+    void dma_rx(void);
+    void dma_tx(void);
+
+    /** DMA receive ring, NULL without DMA */
+    uint8_t *_dma_buf;
+    uint32_t _dma_rx_tail;
+    /** Size of the _txbuf span being sent by DMA */
+    uint32_t _dma_tx_length;
+#endif
+
 };
 } //namespace mbed
 
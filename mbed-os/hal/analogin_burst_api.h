@@ -0,0 +1,99 @@
+
+/** \addtogroup hal */
+/** @{*/
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_ANALOGIN_BURST_API_H
+#define MBED_ANALOGIN_BURST_API_H
+
+#include "hal/analogin_api.h"
+#include "hal/dma_api.h"
+
+#if DEVICE_ANALOGIN_BURST
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \defgroup hal_analogin_burst Analogin burst acquisition
+ * Several conversions of one channel from a single start, moved by DMA.
+ *
+ * Each result may be the hardware average of several conversions
+ * (oversampling), so a burst of count results takes count * oversample
+ * conversions without the CPU. The handler is called once, from interrupt
+ * context, when the last result is in the buffer.
+ *
+ * Results are scaled to 16 bits as by analogin_read_u16().
+ *
+ * While a burst is running, analogin_read() must not be called on any
+ * channel of the same ADC.
+ * @{
+ */
+
+typedef void (*analogin_burst_handler)(uint32_t id, uint32_t count);
+
+/** Claim the DMA channel of the ADC of an initialized analogin
+ *
+ * @param obj     The analogin object
+ * @param handler Called from interrupt context when a burst completes, with
+ *                the number of results in the buffer; fewer than requested
+ *                only on a DMA error
+ * @param id      Passed to the handler
+ * @return 0 on success, DMA_ERROR_OUT_OF_CHANNELS if the ADC has no DMA
+ *         channel or it is in use
+ */
+int analogin_burst_init(analogin_t *obj, analogin_burst_handler handler, uint32_t id);
+
+/** Abort a running burst and release the DMA channel
+ *
+ * @param obj The analogin object
+ */
+void analogin_burst_free(analogin_t *obj);
+
+/** Get the largest oversampling ratio supported
+ *
+ * @return The ratio; 1 if the ADC cannot oversample
+ */
+uint32_t analogin_burst_max_oversample(void);
+
+/** Start a burst
+ *
+ * @param obj        The analogin object
+ * @param buffer     Receives the results, valid until the handler is called
+ * @param count      Number of results, greater than 0
+ * @param oversample Conversions averaged into each result, a power of two
+ *                   up to analogin_burst_max_oversample()
+ */
+void analogin_burst_start(analogin_t *obj, uint16_t *buffer, uint32_t count, uint32_t oversample);
+
+/** Abort a running burst without calling the handler
+ *
+ * @param obj The analogin object
+ */
+void analogin_burst_abort(analogin_t *obj);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEVICE_ANALOGIN_BURST
+
+#endif
+
+/** @}*/
@@ -94,6 +94,9 @@ extern "C" {
  * * Calling hal_crc_compute_partial_start() function with invalid (unsupported) polynomial.
  * * Calling hal_crc_compute_partial() or hal_crc_get_result() functions before hal_crc_compute_partial_start().
  * * Calling hal_crc_get_result() function multiple times.
+ * * Interleaving two computations. The module holds the state of a single
+ *   computation; MbedCRC arbitrates it between objects and computes in
+ *   software while another object owns it.
  *
  * # Non-functional requirements
  *
@@ -22,8 +22,10 @@
 #include "mbed_debug.h"
 #include "mbed_stats.h"
 #include "lp_ticker_api.h"
+#include "us_ticker_api.h"
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
 #include "mbed_stats.h"
 
 
@@ -125,7 +127,7 @@ static void sleep_tracker_print_stats(void)
     }
 }
 
-void sleep_tracker_lock(const char *const filename, int line)
+static void sleep_tracing_lock(const char *const filename, int line)
 {
     sleep_statistic_t *stat = sleep_tracker_find(filename);
 
@@ -139,7 +141,7 @@ void sleep_tracker_lock(const char *const filename, int line)
     debug("LOCK: %s, ln: %i, lock count: %u\r\n", filename, line, deep_sleep_lock);
 }
 
-void sleep_tracker_unlock(const char* const filename, int line)
+static void sleep_tracing_unlock(const char* const filename, int line)
 {
     sleep_statistic_t *stat = sleep_tracker_find(filename);
 
@@ -156,6 +158,140 @@ void sleep_tracker_unlock(const char* const filename, int line)
 
 #endif // MBED_SLEEP_TRACING_ENABLED
 
+#ifdef MBED_SLEEP_LOCK_STATS_ENABLED
+
+typedef struct sleep_lock_holder {
+    const char *identifier;
+    uint32_t line;
+    uint32_t held;
+    uint32_t lock_count;
+    us_timestamp_t held_since;
+    us_timestamp_t held_time;
+    us_timestamp_t max_held_time;
+    uint32_t refused_count;
+    us_timestamp_t blocked_time;
+} sleep_lock_holder_t;
+
+static sleep_lock_holder_t sleep_lock_holders[MBED_SLEEP_LOCK_STATS_MAX_HOLDERS];
+static mbed_stats_sleep_t sleep_lock_stats;
+
+// The us ticker runs whenever a lock is held, unlike the lp ticker it is always there
+static us_timestamp_t sleep_lock_read_us(void)
+{
+    return ticker_read_us(get_us_ticker_data());
+}
+
+// Ticker.h locks and Ticker.cpp unlocks: files equal up to the extension are one holder
+static bool sleep_lock_same_module(const char *a, const char *b)
+{
+    if (a == b) {
+        return true;
+    }
+    while (*a != '\0' && *a != '.' && *a == *b) {
+        a++;
+        b++;
+    }
+    return (*a == '\0' || *a == '.') && (*b == '\0' || *b == '.');
+}
+
+// Holders are never removed, so the table fills from the front
+static sleep_lock_holder_t *sleep_lock_find(const char *const filename, bool add)
+{
+    for (int i = 0; i < MBED_SLEEP_LOCK_STATS_MAX_HOLDERS; ++i) {
+        if (sleep_lock_holders[i].identifier == NULL) {
+            if (add) {
+                sleep_lock_holders[i].identifier = filename;
+                return &sleep_lock_holders[i];
+            }
+            return NULL;
+        }
+        if (sleep_lock_same_module(sleep_lock_holders[i].identifier, filename)) {
+            return &sleep_lock_holders[i];
+        }
+    }
+    return NULL;
+}
+
+static void sleep_lock_stats_lock(const char *const filename, int line)
+{
+    core_util_critical_section_enter();
+    sleep_lock_holder_t *holder = sleep_lock_find(filename, true);
+    if (holder == NULL) {
+        sleep_lock_stats.untracked_count++;
+    } else {
+        if (holder->held == 0) {
+            holder->held_since = sleep_lock_read_us();
+        }
+        holder->held++;
+        holder->lock_count++;
+        holder->line = line;
+    }
+    core_util_critical_section_exit();
+}
+
+static void sleep_lock_stats_unlock(const char *const filename, int line)
+{
+    (void)line;
+    core_util_critical_section_enter();
+    sleep_lock_holder_t *holder = sleep_lock_find(filename, false);
+    if (holder == NULL || holder->held == 0) {
+        sleep_lock_stats.unmatched_count++;
+    } else if (--holder->held == 0) {
+        us_timestamp_t held = sleep_lock_read_us() - holder->held_since;
+        holder->held_time += held;
+        if (held > holder->max_held_time) {
+            holder->max_held_time = held;
+        }
+    }
+    core_util_critical_section_exit();
+}
+
+// Called in the critical section of sleep_manager_sleep_auto
+static void sleep_lock_stats_sleep(bool deep, bool refused, us_timestamp_t slept)
+{
+    sleep_lock_stats.sleep_count++;
+    if (deep) {
+        sleep_lock_stats.deep_sleep_count++;
+    }
+    if (!refused) {
+        return;
+    }
+
+    sleep_lock_stats.refused_count++;
+    for (int i = 0; i < MBED_SLEEP_LOCK_STATS_MAX_HOLDERS && sleep_lock_holders[i].identifier != NULL; ++i) {
+        if (sleep_lock_holders[i].held) {
+            sleep_lock_holders[i].refused_count++;
+            sleep_lock_holders[i].blocked_time += slept;
+        }
+    }
+}
+
+#endif // MBED_SLEEP_LOCK_STATS_ENABLED
+
+#if defined(MBED_SLEEP_TRACING_ENABLED) || defined(MBED_SLEEP_LOCK_STATS_ENABLED)
+
+void sleep_tracker_lock(const char *const filename, int line)
+{
+#ifdef MBED_SLEEP_LOCK_STATS_ENABLED
+    sleep_lock_stats_lock(filename, line);
+#endif
+#ifdef MBED_SLEEP_TRACING_ENABLED
+    sleep_tracing_lock(filename, line);
+#endif
+}
+
+void sleep_tracker_unlock(const char *const filename, int line)
+{
+#ifdef MBED_SLEEP_LOCK_STATS_ENABLED
+    sleep_lock_stats_unlock(filename, line);
+#endif
+#ifdef MBED_SLEEP_TRACING_ENABLED
+    sleep_tracing_unlock(filename, line);
+#endif
+}
+
+#endif
+
 void sleep_manager_lock_deep_sleep_internal(void)
 {
     core_util_critical_section_enter();
@@ -191,6 +327,10 @@ void sleep_manager_sleep_auto(void)
     core_util_critical_section_enter();
     us_timestamp_t start = read_us();
     bool deep = false;
+#ifdef MBED_SLEEP_LOCK_STATS_ENABLED
+    bool refused = !sleep_manager_can_deep_sleep();
+    us_timestamp_t refused_start = refused ? sleep_lock_read_us() : 0;
+#endif
 
 // debug profile should keep debuggers attached, no deep sleep allowed
 #ifdef MBED_DEBUG
@@ -210,6 +350,9 @@ void sleep_manager_sleep_auto(void)
     } else {
         sleep_time += end - start;
     }
+#ifdef MBED_SLEEP_LOCK_STATS_ENABLED
+    sleep_lock_stats_sleep(deep, refused, refused ? sleep_lock_read_us() - refused_start : 0);
+#endif
     core_util_critical_section_exit();
 }
 
@@ -234,4 +377,65 @@ bool sleep_manager_can_deep_sleep(void)
     return false;
 }
 
+#if defined(MBED_SLEEP_TRACING_ENABLED) || defined(MBED_SLEEP_LOCK_STATS_ENABLED)
+
+void sleep_tracker_lock(const char *const filename, int line)
+{
+
+}
+
+void sleep_tracker_unlock(const char *const filename, int line)
+{
+
+}
+
+#endif
+
+#endif
+
+void mbed_stats_sleep_get(mbed_stats_sleep_t *stats)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, sizeof(mbed_stats_sleep_t));
+
+#if DEVICE_SLEEP && defined(MBED_SLEEP_LOCK_STATS_ENABLED)
+    core_util_critical_section_enter();
+    *stats = sleep_lock_stats;
+    stats->lock_count = deep_sleep_lock;
+    core_util_critical_section_exit();
 #endif
+}
+
+size_t mbed_stats_sleep_lock_get_each(mbed_stats_sleep_lock_t *stats, size_t count)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, count * sizeof(mbed_stats_sleep_lock_t));
+    size_t i = 0;
+
+#if DEVICE_SLEEP && defined(MBED_SLEEP_LOCK_STATS_ENABLED)
+    core_util_critical_section_enter();
+    us_timestamp_t now = sleep_lock_read_us();
+    for (; i < count && i < MBED_SLEEP_LOCK_STATS_MAX_HOLDERS && sleep_lock_holders[i].identifier != NULL; i++) {
+        const sleep_lock_holder_t *holder = &sleep_lock_holders[i];
+
+        stats[i].identifier = holder->identifier;
+        stats[i].line = holder->line;
+        stats[i].held = holder->held;
+        stats[i].lock_count = holder->lock_count;
+        stats[i].held_time = holder->held_time;
+        stats[i].max_held_time = holder->max_held_time;
+        stats[i].refused_count = holder->refused_count;
+        stats[i].blocked_time = holder->blocked_time;
+        if (holder->held) {
+            us_timestamp_t held = now - holder->held_since;
+            stats[i].held_time += held;
+            if (held > stats[i].max_held_time) {
+                stats[i].max_held_time = held;
+            }
+        }
+    }
+    core_util_critical_section_exit();
+#endif
+
+    return i;
+}
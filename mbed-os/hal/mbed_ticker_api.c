@@ -17,6 +17,7 @@
 #include <stddef.h>
 #include "hal/ticker_api.h"
 #include "platform/mbed_critical.h"
+#include "platform/mbed_latency.h"
 #include "mbed_assert.h"
 
 static void schedule_interrupt(const ticker_data_t *const ticker);
@@ -275,6 +276,9 @@ void ticker_set_handler(const ticker_data_t *const ticker, ticker_event_handler
 
 void ticker_irq_handler(const ticker_data_t *const ticker)
 {
+#if defined(MBED_LATENCY_ENABLED)
+    uint32_t latency_start = mbed_latency_now();
+#endif
     core_util_critical_section_enter();
 
     ticker->interface->clear_interrupt();
@@ -306,6 +310,9 @@ void ticker_irq_handler(const ticker_data_t *const ticker)
     schedule_interrupt(ticker);
 
     core_util_critical_section_exit();
+#if defined(MBED_LATENCY_ENABLED)
+    mbed_latency_irq_exit(MBED_LATENCY_IRQ_TICKER, latency_start);
+#endif
 }
 
 void ticker_insert_event(const ticker_data_t *const ticker, ticker_event_t *obj, timestamp_t timestamp, uint32_t id)
@@ -0,0 +1,58 @@
+
+/** \addtogroup hal */
+/** @{*/
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_PROFILER_TIMER_API_H
+#define MBED_PROFILER_TIMER_API_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \defgroup hal_profiler_timer Profiler sampling timer
+ * A periodic interrupt, independent of the us and lp tickers, used by the
+ * sampling profiler in platform/mbed_profiler.c.
+ *
+ * The interrupt should run at the highest priority so that samples can
+ * also be taken inside other interrupt handlers.
+ * @{
+ */
+
+/** Start the sampling timer
+ *
+ * @param frequency Interrupts per second, 16 to 500000: a 1 MHz counter with a
+ *                  16-bit reload value covers that range on most targets
+ * @param handler   Function called from each interrupt
+ */
+void profiler_timer_init(uint32_t frequency, void (*handler)(void));
+
+/** Stop the sampling timer and release the peripheral
+ */
+void profiler_timer_free(void);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/** @}*/
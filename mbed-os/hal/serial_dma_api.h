@@ -0,0 +1,108 @@
+
+/** \addtogroup hal */
+/** @{*/
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_SERIAL_DMA_API_H
+#define MBED_SERIAL_DMA_API_H
+
+#include "hal/serial_api.h"
+
+#if DEVICE_SERIAL_DMA
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \defgroup hal_serial_dma Serial DMA streaming
+ * Byte streams moved by DMA instead of one interrupt per character.
+ *
+ * Reception runs continuously into a circular buffer owned by the caller.
+ * The handler is called with SERIAL_DMA_RX when the buffer is half full,
+ * when it wraps, and when the line goes idle after a character, so a short
+ * message is delivered without waiting for the buffer to fill. The handler
+ * then reads serial_dma_rx_head() and consumes everything up to it; data
+ * not consumed within half a buffer of characters is overwritten.
+ *
+ * Transmission sends one linear block at a time and calls the handler with
+ * SERIAL_DMA_TX_DONE when it has been handed to the peripheral.
+ *
+ * The handler runs in interrupt context. serial_irq_set() keeps working for
+ * the direction that does not use DMA.
+ * @{
+ */
+
+typedef enum {
+    SERIAL_DMA_RX,          /**< New data may be in the receive buffer */
+    SERIAL_DMA_TX_DONE      /**< The transmit block has been sent */
+} SerialDmaEvent;
+
+typedef void (*serial_dma_handler)(uint32_t id, SerialDmaEvent event);
+
+/** Claim the DMA channels of the serial peripheral
+ *
+ * @param obj     The serial object
+ * @param handler Called from interrupt context on DMA events
+ * @param id      Passed to the handler
+ * @return 0 on success, DMA_ERROR_OUT_OF_CHANNELS if the peripheral has no
+ *         DMA channels or they are in use
+ */
+int serial_dma_init(serial_t *obj, serial_dma_handler handler, uint32_t id);
+
+/** Stop both directions and release the DMA channels
+ *
+ * @param obj The serial object
+ */
+void serial_dma_free(serial_t *obj);
+
+/** Start circular reception
+ *
+ * @param obj    The serial object
+ * @param buffer The receive ring, written by DMA until serial_dma_free()
+ * @param size   Size of the ring in bytes
+ */
+void serial_dma_rx_start(serial_t *obj, uint8_t *buffer, uint32_t size);
+
+/** Get the position the next received byte will be written to
+ *
+ * @param obj The serial object
+ * @return Offset in the receive ring, from 0 to size - 1
+ */
+uint32_t serial_dma_rx_head(serial_t *obj);
+
+/** Send a block of data
+ *
+ * Only one block can be in flight; start the next one from the
+ * SERIAL_DMA_TX_DONE event.
+ *
+ * @param obj    The serial object
+ * @param buffer The data, which must stay valid until SERIAL_DMA_TX_DONE
+ * @param length Number of bytes to send, greater than 0
+ */
+void serial_dma_tx_start(serial_t *obj, const uint8_t *buffer, uint32_t length);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEVICE_SERIAL_DMA
+
+#endif
+
+/** @}*/
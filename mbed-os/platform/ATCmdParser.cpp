@@ -18,6 +18,8 @@
  *
  */
 
+#include <ctype.h>
+
 #include "ATCmdParser.h"
 #include "mbed_poll.h"
 #include "mbed_debug.h"
@@ -36,6 +38,17 @@
 #define CR  13
 #endif
 
+// recv_token types
+#define RECV_SPACE      ' '     // any amount of whitespace, including none
+#define RECV_LITERAL    'L'     // characters that must match exactly
+#define RECV_PERCENT    '%'     // %%
+#define RECV_DECIMAL    'd'     // %d, %u
+#define RECV_HEX        'x'     // %x, %X
+#define RECV_OCTAL      'o'     // %o
+#define RECV_STRING     's'     // %s
+#define RECV_CHARS      'c'     // %c
+#define RECV_SET        '['     // %[...]
+
 // getc/putc handling with timeouts
 int ATCmdParser::putc(char c)
 {
@@ -128,7 +141,11 @@ int ATCmdParser::vscanf(const char *format, va_list args)
     int offset = 0;
 
     while (format[i]) {
-        if (format[i] == '%' && format[i+1] != '%' && format[i+1] != '*') {
+        if (format[i] == '%' && format[i+1] == '%') {
+            // A literal percent sign, not a conversion to clobber
+            _buffer[offset++] = format[i++];
+            _buffer[offset++] = format[i++];
+        } else if (format[i] == '%' && format[i+1] != '*') {
             _buffer[offset++] = '%';
             _buffer[offset++] = '*';
             i++;
@@ -153,6 +170,11 @@ int ATCmdParser::vscanf(const char *format, va_list args)
     // derails us.
     int j = 0;
 
+    // Formats within the matcher's subset are checked per character,
+    // the others fall back to rescanning with sscanf
+    bool compiled = recv_compile(format, i);
+    recv_reset();
+
     while (true) {
         // Ran out of space
         if (j+1 >= _buffer_size - offset) {
@@ -168,7 +190,13 @@ int ATCmdParser::vscanf(const char *format, va_list args)
 
         // Check for match
         int count = -1;
-        sscanf(_buffer+offset, _buffer, &count);
+        if (compiled) {
+            if (!_recv_dead && recv_step(c) && recv_complete()) {
+                count = j;
+            }
+        } else {
+            sscanf(_buffer+offset, _buffer, &count);
+        }
 
         // We only succeed if all characters in the response are matched
         if (count == j) {
@@ -180,6 +208,272 @@ int ATCmdParser::vscanf(const char *format, va_list args)
 }
 
 
+// Incremental response matching
+//
+// Follows what sscanf would do on the characters received so far: literals
+// match exactly, whitespace in the format skips any amount of whitespace, and
+// conversions other than %c and %[ skip leading whitespace before taking as
+// many characters as they can. Each received character is handled by the
+// current token, or passed on to the next one when it ends the field.
+bool ATCmdParser::recv_compile(const char *format, int len)
+{
+    int i = 0;
+    _recv_program_len = 0;
+
+    while (i < len) {
+        if (_recv_program_len == _recv_max_tokens) {
+            return false;
+        }
+        recv_token &t = _recv_program[_recv_program_len++];
+        t.arg = &format[i];
+        t.len = 0;
+        t.width = 0;
+        t.negate = false;
+
+        if (isspace((unsigned char)format[i])) {
+            t.type = RECV_SPACE;
+            while (i < len && isspace((unsigned char)format[i])) {
+                i++;
+            }
+            continue;
+        }
+        if (format[i] != '%') {
+            t.type = RECV_LITERAL;
+            while (i < len && format[i] != '%' && !isspace((unsigned char)format[i])) {
+                i++;
+                t.len++;
+            }
+            continue;
+        }
+
+        i++;
+        if (i < len && format[i] == '%') {
+            t.type = RECV_PERCENT;
+            i++;
+            continue;
+        }
+        if (i < len && format[i] == '*') {
+            i++;
+        }
+        while (i < len && isdigit((unsigned char)format[i])) {
+            t.width = t.width * 10 + (format[i++] - '0');
+        }
+        while (i < len && strchr("hljztL", format[i])) {
+            i++;
+        }
+        if (i >= len) {
+            return false;
+        }
+
+        switch (format[i++]) {
+            case 'd':
+            case 'u':
+                t.type = RECV_DECIMAL;
+                break;
+            case 'x':
+            case 'X':
+                t.type = RECV_HEX;
+                break;
+            case 'o':
+                t.type = RECV_OCTAL;
+                break;
+            case 's':
+                t.type = RECV_STRING;
+                break;
+            case 'c':
+                t.type = RECV_CHARS;
+                if (!t.width) {
+                    t.width = 1;
+                }
+                break;
+            case '[':
+                t.type = RECV_SET;
+                if (i < len && format[i] == '^') {
+                    t.negate = true;
+                    i++;
+                }
+                t.arg = &format[i];
+                // A ']' first in the set is a member, not the end
+                if (i < len && format[i] == ']') {
+                    i++;
+                }
+                while (i < len && format[i] != ']') {
+                    i++;
+                }
+                if (i >= len) {
+                    return false;
+                }
+                t.len = &format[i] - t.arg;
+                i++;
+                break;
+            default:
+                // %i, %n, %p and floating point are left to sscanf
+                return false;
+        }
+    }
+    return true;
+}
+
+void ATCmdParser::recv_reset()
+{
+    _recv_token = 0;
+    _recv_count = 0;
+    _recv_digits = 0;
+    _recv_last = 0;
+    _recv_dead = false;
+}
+
+void ATCmdParser::recv_next()
+{
+    _recv_token++;
+    _recv_count = 0;
+    _recv_digits = 0;
+    _recv_last = 0;
+}
+
+bool ATCmdParser::recv_takes(const recv_token &t, char c) const
+{
+    switch (t.type) {
+        case RECV_DECIMAL:
+        case RECV_HEX:
+        case RECV_OCTAL:
+            if (_recv_count == 0 && (c == '+' || c == '-')) {
+                return true;
+            }
+            if (t.type == RECV_HEX && (c == 'x' || c == 'X')) {
+                // 0x prefix
+                return _recv_digits == 1 && _recv_last == '0';
+            }
+            if (t.type == RECV_HEX) {
+                return isxdigit((unsigned char)c);
+            }
+            if (t.type == RECV_OCTAL) {
+                return c >= '0' && c <= '7';
+            }
+            return isdigit((unsigned char)c);
+        case RECV_STRING:
+            return !isspace((unsigned char)c);
+        case RECV_CHARS:
+            return true;
+        case RECV_SET: {
+            bool found = false;
+            for (int k = 0; k < t.len && !found; k++) {
+                if (k + 2 < t.len && t.arg[k + 1] == '-') {
+                    found = (unsigned char)c >= (unsigned char)t.arg[k] &&
+                            (unsigned char)c <= (unsigned char)t.arg[k + 2];
+                    k += 2;
+                } else {
+                    found = c == t.arg[k];
+                }
+            }
+            return found != t.negate;
+        }
+        default:
+            return false;
+    }
+}
+
+bool ATCmdParser::recv_field_done(const recv_token &t) const
+{
+    switch (t.type) {
+        case RECV_DECIMAL:
+        case RECV_HEX:
+        case RECV_OCTAL:
+            return _recv_digits > 0;
+        case RECV_STRING:
+        case RECV_SET:
+            return _recv_count > 0;
+        default:
+            return false;
+    }
+}
+
+bool ATCmdParser::recv_step(char c)
+{
+    // sscanf stops at a null, so binary data can never match the line
+    if (c == 0) {
+        _recv_dead = true;
+        return false;
+    }
+
+    bool space = isspace((unsigned char)c);
+    while (_recv_token < _recv_program_len) {
+        const recv_token &t = _recv_program[_recv_token];
+
+        switch (t.type) {
+            case RECV_SPACE:
+                if (space) {
+                    return true;
+                }
+                break;
+            case RECV_LITERAL:
+                if (c != t.arg[_recv_count]) {
+                    _recv_dead = true;
+                    return false;
+                }
+                if (++_recv_count == t.len) {
+                    recv_next();
+                }
+                return true;
+            case RECV_PERCENT:
+                if (space) {
+                    return true;
+                }
+                if (c != '%') {
+                    _recv_dead = true;
+                    return false;
+                }
+                recv_next();
+                return true;
+            default:
+                if (space && _recv_count == 0 && t.type != RECV_CHARS && t.type != RECV_SET) {
+                    // Leading whitespace, not part of the field
+                    return true;
+                }
+                if (recv_takes(t, c)) {
+                    _recv_count++;
+                    if (isxdigit((unsigned char)c) && t.type != RECV_STRING &&
+                            t.type != RECV_CHARS && t.type != RECV_SET) {
+                        _recv_digits++;
+                    }
+                    _recv_last = c;
+                    if (t.width && _recv_count == t.width) {
+                        recv_next();
+                    }
+                    return true;
+                }
+                if (!recv_field_done(t)) {
+                    _recv_dead = true;
+                    return false;
+                }
+                // c ends the field, the next token gets it
+                break;
+        }
+        recv_next();
+    }
+
+    // The whole format already matched, so c would be left over
+    _recv_dead = true;
+    return false;
+}
+
+bool ATCmdParser::recv_complete() const
+{
+    // Would sscanf, hitting the end of the line here, reach the final %n?
+    for (int k = _recv_token; k < _recv_program_len; k++) {
+        const recv_token &t = _recv_program[k];
+        if (t.type == RECV_SPACE) {
+            continue;
+        }
+        if (k == _recv_token && recv_field_done(t)) {
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+
 // Command parsing with line handling
 bool ATCmdParser::vsend(const char *command, va_list args)
 {
@@ -220,7 +514,11 @@ restart:
         bool whole_line_wanted = false;
 
         while (response[i]) {
-            if (response[i] == '%' && response[i+1] != '%' && response[i+1] != '*') {
+            if (response[i] == '%' && response[i+1] == '%') {
+                // A literal percent sign, not a conversion to clobber
+                _buffer[offset++] = response[i++];
+                _buffer[offset++] = response[i++];
+            } else if (response[i] == '%' && response[i+1] != '*') {
                 _buffer[offset++] = '%';
                 _buffer[offset++] = '*';
                 i++;
@@ -247,9 +545,17 @@ restart:
         // format string that only stores the matched characters (%n).
         // The other reads in the actual matched values.
         //
+        // The first pass is done by the compiled matcher, one character at a
+        // time; formats outside its subset fall back to sscanf on the whole
+        // line after every character.
+        //
         // We keep trying the match until we succeed or some other error
         // derails us.
         int j = 0;
+        bool compiled = recv_compile(response, i);
+        recv_reset();
+        oob_node *oob_at = NULL;
+        bool oob_dead = false;
 
         while (true) {
             // Receive next character
@@ -275,9 +581,12 @@ restart:
             _buffer[offset + j] = 0;
 
             // Check for oob data
-            for (struct oob *oob = _oobs; oob; oob = oob->next) {
-                if ((unsigned)j == oob->len && memcmp(
-                        oob->prefix, _buffer+offset, oob->len) == 0) {
+            if (!oob_dead) {
+                oob_at = oob_next(oob_at, c);
+                if (!oob_at) {
+                    oob_dead = true;
+                } else if (oob_at->match) {
+                    struct oob *oob = oob_at->match;
                     debug_if(_dbg_on, "AT! %s\n", oob->prefix);
                     oob->cb();
 
@@ -293,10 +602,17 @@ restart:
 
             // Check for match
             int count = -1;
+            if (compiled && !_recv_dead) {
+                recv_step(c);
+            }
             if (whole_line_wanted && c != '\n') {
                 // Don't attempt scanning until we get delimiter if they included it in format
                 // This allows recv("Foo: %s\n") to work, and not match with just the first character of a string
                 // (scanf does not itself match whitespace in its format string, so \n is not significant to it)
+            } else if (compiled) {
+                if (!_recv_dead && recv_complete()) {
+                    count = j;
+                }
             } else {
                 sscanf(_buffer+offset, _buffer, &count);
             }
@@ -321,6 +637,9 @@ restart:
             if (c == '\n' || j+1 >= _buffer_size - offset) {
                 debug_if(_dbg_on, "AT< %s", _buffer+offset);
                 j = 0;
+                recv_reset();
+                oob_at = NULL;
+                oob_dead = false;
             }
         }
     }
@@ -374,6 +693,48 @@ void ATCmdParser::oob(const char *prefix, Callback<void()> cb)
     oob->cb = cb;
     oob->next = _oobs;
     _oobs = oob;
+
+    // The latest registration of a prefix takes precedence, as it did when
+    // the list was searched from its head
+    oob_node **link = &_oob_trie;
+    oob_node *node = NULL;
+    for (const char *p = prefix; *p; p++) {
+        node = *link;
+        while (node && node->c != *p) {
+            node = node->sibling;
+        }
+        if (!node) {
+            node = new oob_node;
+            node->match = NULL;
+            node->child = NULL;
+            node->sibling = *link;
+            node->c = *p;
+            *link = node;
+        }
+        link = &node->child;
+    }
+    if (node) {
+        node->match = oob;
+    }
+}
+
+ATCmdParser::oob_node *ATCmdParser::oob_next(oob_node *node, char c) const
+{
+    oob_node *next = node ? node->child : _oob_trie;
+    while (next && next->c != c) {
+        next = next->sibling;
+    }
+    return next;
+}
+
+void ATCmdParser::oob_free(oob_node *node)
+{
+    while (node) {
+        oob_node *sibling = node->sibling;
+        oob_free(node->child);
+        delete node;
+        node = sibling;
+    }
 }
 
 void ATCmdParser::abort()
@@ -388,6 +749,8 @@ bool ATCmdParser::process_oob()
     }
 
     int i = 0;
+    oob_node *oob_at = NULL;
+    bool oob_dead = false;
     while (true) {
         // Receive next character
         int c = getc();
@@ -411,22 +774,24 @@ bool ATCmdParser::process_oob()
         _buffer[i] = 0;
 
         // Check for oob data
-        struct oob *oob = _oobs;
-        while (oob) {
-            if (i == (int)oob->len && memcmp(
-                    oob->prefix, _buffer, oob->len) == 0) {
-                debug_if(_dbg_on, "AT! %s\r\n", oob->prefix);
-                oob->cb();
+        if (!oob_dead) {
+            oob_at = oob_next(oob_at, c);
+            if (!oob_at) {
+                oob_dead = true;
+            } else if (oob_at->match) {
+                debug_if(_dbg_on, "AT! %s\r\n", oob_at->match->prefix);
+                oob_at->match->cb();
                 return true;
             }
-            oob = oob->next;
         }
-        
+
         // Clear the buffer when we hit a newline or ran out of space
         // running out of space usually means we ran into binary data
         if (((i+1) >= _buffer_size) || (c == '\n')) {
             debug_if(_dbg_on, "AT< %s", _buffer);
             i = 0;
+            oob_at = NULL;
+            oob_dead = false;
         }
     }
 }
@@ -78,6 +78,44 @@ private:
     };
     oob *_oobs;
 
+    // Registered oob prefixes as a trie, walked one character per received byte
+    struct oob_node {
+        oob *match;             // callback whose prefix ends here, or NULL
+        oob_node *child;
+        oob_node *sibling;
+        char c;
+    };
+    oob_node *_oob_trie;
+
+    // Response format compiled into a token program, advanced one received
+    // character at a time instead of rescanning the line with sscanf
+    struct recv_token {
+        const char *arg;        // literal characters or scan set, in the format string
+        uint16_t len;           // length of arg
+        uint16_t width;         // maximum field width, 0 if unlimited
+        char type;
+        bool negate;            // scan set is [^...]
+    };
+    static const int _recv_max_tokens = 16;
+    recv_token _recv_program[_recv_max_tokens];
+    int _recv_program_len;
+    int _recv_token;            // current token
+    int _recv_count;            // characters taken by the current token
+    int _recv_digits;           // digits taken by the current integer token
+    char _recv_last;            // last character taken by the current token
+    bool _recv_dead;            // the line can no longer match
+
+    bool recv_compile(const char *format, int len);
+    void recv_reset();
+    bool recv_step(char c);
+    bool recv_complete() const;
+    bool recv_takes(const recv_token &t, char c) const;
+    bool recv_field_done(const recv_token &t) const;
+    void recv_next();
+
+    oob_node *oob_next(oob_node *node, char c) const;
+    static void oob_free(oob_node *node);
+
 public:
 
     /**
@@ -91,7 +129,7 @@ public:
      */
     ATCmdParser(FileHandle *fh, const char *output_delimiter = "\r",
              int buffer_size = 256, int timeout = 8000, bool debug = false)
-            : _fh(fh), _buffer_size(buffer_size), _in_prev(0), _oobs(NULL)
+            : _fh(fh), _buffer_size(buffer_size), _in_prev(0), _oobs(NULL), _oob_trie(NULL)
     {
         _buffer = new char[buffer_size];
         set_timeout(timeout);
@@ -109,6 +147,7 @@ public:
             _oobs = oob->next;
             delete oob;
         }
+        oob_free(_oob_trie);
         delete[] _buffer;
     }
 
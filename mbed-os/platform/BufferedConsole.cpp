@@ -0,0 +1,90 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <string.h>
+#include "platform/BufferedConsole.h"
+#include "platform/mbed_critical.h"
+#include "hal/serial_api.h"
+
+#if MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE
+
+#if DEVICE_SERIAL
+extern int stdio_uart_inited;
+extern serial_t stdio_uart;
+#endif
+
+namespace mbed {
+
+ssize_t BufferedConsole::write(const void *buffer, size_t size) {
+    const char *buf = static_cast<const char *>(buffer);
+    size_t written = 0;
+    ssize_t err = 0;
+
+    _mutex.lock();
+    while (written < size) {
+        written += _buf.push(buf + written, size - written);
+        if (written < size && (err = drain()) < 0) {
+            break;
+        }
+    }
+    if (_line && err >= 0 && memchr(buf, '\n', written)) {
+        err = drain();
+    }
+    _mutex.unlock();
+    return written != 0 ? (ssize_t) written : err;
+}
+
+int BufferedConsole::sync() {
+    _mutex.lock();
+    ssize_t err = drain();
+    _mutex.unlock();
+    return err < 0 ? err : _fh->sync();
+}
+
+/* Pass the buffer on in at most two writes, one per contiguous span */
+ssize_t BufferedConsole::drain() {
+    uint32_t count;
+    const char *data;
+
+    while ((data = _buf.read_span(count)), count) {
+        ssize_t r = _fh->write(data, count);
+        if (r <= 0) {
+            return r < 0 ? r : -EIO;
+        }
+        _buf.release(r);
+    }
+    return 0;
+}
+
+/* Called on a fatal error, when the console and the mutex can no longer be
+ * relied on: the buffer goes straight to the stdio UART, the way
+ * mbed_error_vfprintf() prints, ahead of the error report. */
+void BufferedConsole::flush_from_error() {
+#if DEVICE_SERIAL
+    char c;
+    core_util_critical_section_enter();
+    if (!_buf.empty() && !stdio_uart_inited) {
+        serial_init(&stdio_uart, STDIO_UART_TX, STDIO_UART_RX);
+    }
+    while (_buf.pop(c)) {
+        serial_putc(&stdio_uart, c);
+    }
+    core_util_critical_section_exit();
+#endif
+}
+
+} // namespace mbed
+
+#endif
@@ -0,0 +1,89 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_BUFFEREDCONSOLE_H
+#define MBED_BUFFEREDCONSOLE_H
+
+#include "platform/platform.h"
+#include "platform/FileHandle.h"
+#include "platform/PlatformMutex.h"
+#include "platform/RingBuffer.h"
+#include "platform/NonCopyable.h"
+
+#ifndef MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE
+#define MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE    0
+#endif
+
+#ifndef MBED_CONF_PLATFORM_STDIO_BUFFER_LINE
+#define MBED_CONF_PLATFORM_STDIO_BUFFER_LINE    1
+#endif
+
+#if MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE
+
+namespace mbed {
+
+/* FileHandle that buffers stdout and stderr in RAM ahead of the console, so
+ * that a printf costs a copy rather than a wait for the UART. The buffer is
+ * passed on to the console a line at a time, or only when full if line
+ * buffering is off, in as few writes as the ring allows. With
+ * platform.stdio-buffered-serial the console is a UARTSerial, whose transmit
+ * interrupt then sends the data while the caller carries on.
+ *
+ * Private to the retarget layer, which puts one in front of the console when
+ * platform.stdio-buffer-size is set; it has a header of its own for the host
+ * tests.
+ */
+class BufferedConsole : public FileHandle, private NonCopyable<BufferedConsole> {
+public:
+    BufferedConsole(FileHandle *fh, bool line = MBED_CONF_PLATFORM_STDIO_BUFFER_LINE) : _fh(fh), _line(line) {}
+    virtual ssize_t write(const void *buffer, size_t size);
+    virtual ssize_t read(void *buffer, size_t size) {
+        return _fh->read(buffer, size);
+    }
+    virtual off_t seek(off_t offset, int whence = SEEK_SET) {
+        return -ESPIPE;
+    }
+    virtual off_t size() {
+        return -EINVAL;
+    }
+    virtual int isatty() {
+        return _fh->isatty();
+    }
+    virtual int sync();
+    virtual int close() {
+        return sync();
+    }
+    virtual short poll(short events) const {
+        return _fh->poll(events);
+    }
+    FileHandle *console() const {
+        return _fh;
+    }
+    void flush_from_error();
+
+private:
+    ssize_t drain();
+
+    FileHandle *_fh;
+    bool _line;
+    PlatformMutex _mutex;
+    RingBuffer<char, MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE> _buf;
+};
+
+} // namespace mbed
+
+#endif
+
+#endif
@@ -11,112 +11,116 @@
 
 namespace mbed {
 
-class CallChainLink {
-public:
-    CallChainLink(): cb(), next(NULL) {
-        // No work to do
-    }
+MBED_STATIC_ASSERT(MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY > 0 && MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY <= 32,
+                   "MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY must be 1 to 32");
 
-    CallChainLink(Callback<void()> &callback): cb(callback), next(NULL) {
-        // No work to do
-    }
-    Callback<void()> cb;
-    CallChainLink * next;
-};
+#define CALLCHAIN_ALL_FREE  (0xFFFFFFFFUL >> (32 - MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY))
 
-CallChain::CallChain(int size) : _chain(NULL) {
-    // No work to do
+CallChain::CallChain(int size) : _count(0), _free(CALLCHAIN_ALL_FREE) {
+    // The capacity is set at compile time
+    (void)size;
 }
 
 CallChain::~CallChain() {
     clear();
 }
 
-pFunctionPointer_t CallChain::add(Callback<void()> func) {
-    CallChainLink *new_link = new CallChainLink(func);
-    if (NULL == _chain) {
-        _chain = new_link;
-        return &new_link->cb;
+pFunctionPointer_t CallChain::add_common(Callback<void()> &func, int8_t priority, bool front) {
+    core_util_critical_section_enter();
+    if (0 == _free) {
+        core_util_critical_section_exit();
+        return NULL;
     }
 
-    CallChainLink *link = _chain;
-    while (true) {
-        if (NULL == link->next) {
-            link->next = new_link;
-            return &new_link->cb;
-        }
-        link = link->next;
+    uint32_t slot = __CLZ(__RBIT(_free));
+    _free &= ~(1UL << slot);
+    _slots[slot] = func;
+    _priority[slot] = priority;
+
+    // Behind the higher priorities, and before or behind the equal ones
+    int pos = 0;
+    while (pos < _count && (_priority[_order[pos]] > priority ||
+                            (!front && _priority[_order[pos]] == priority))) {
+        pos++;
     }
+    memmove(&_order[pos + 1], &_order[pos], _count - pos);
+    _order[pos] = slot;
+    _count++;
+    core_util_critical_section_exit();
+
+    return &_slots[slot];
+}
+
+pFunctionPointer_t CallChain::add(Callback<void()> func) {
+    return add_common(func, 0, false);
 }
 
 pFunctionPointer_t CallChain::add_front(Callback<void()> func) {
-    CallChainLink *link = new CallChainLink(func);
-    link->next = _chain;
-    _chain = link;
-    return &link->cb;
+    return add_common(func, 0, true);
+}
+
+pFunctionPointer_t CallChain::insert(Callback<void()> func, int8_t priority) {
+    return add_common(func, priority, false);
 }
 
 int CallChain::size() const {
-    CallChainLink *link = _chain;
-    int elements = 0;
-    while (link != NULL) {
-        elements++;
-        link = link->next;
-    }
-    return elements;
+    return _count;
 }
 
 pFunctionPointer_t CallChain::get(int idx) const {
-    CallChainLink *link = _chain;
-    for (int i = 0; i < idx; i++) {
-        if (NULL == link) {
-            break;
-        }
-        link = link->next;
+    if (idx < 0 || idx >= _count) {
+        return NULL;
     }
-    return &link->cb;
+    return const_cast<pFunctionPointer_t>(&_slots[_order[idx]]);
 }
 
 int CallChain::find(pFunctionPointer_t f) const {
-    CallChainLink *link = _chain;
-    int i = 0;
-    while (link != NULL) {
-        if (f == &link->cb) {
+    for (int i = 0; i < _count; i++) {
+        if (f == &_slots[_order[i]]) {
             return i;
         }
-        i++;
-        link = link->next;
     }
     return -1;
 }
 
 void CallChain::clear() {
-    CallChainLink *link = _chain;
-    _chain = NULL;
-    while (link != NULL) {
-        CallChainLink *temp = link->next;
-        delete link;
-        link = temp;
+    core_util_critical_section_enter();
+    _count = 0;
+    _free = CALLCHAIN_ALL_FREE;
+    for (int i = 0; i < MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY; i++) {
+        _slots[i] = Callback<void()>();
     }
+    core_util_critical_section_exit();
 }
 
 bool CallChain::remove(pFunctionPointer_t f) {
-    CallChainLink *link = _chain;
-    while (link != NULL) {
-        if (f == &link->cb) {
-            delete link;
-            return true;
-        }
-        link = link->next;
+    // The handle is the slot itself
+    if (f < &_slots[0] || f >= &_slots[MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY]) {
+        return false;
     }
-    return false;
+    uint32_t slot = f - &_slots[0];
+
+    core_util_critical_section_enter();
+    if (_free & (1UL << slot)) {
+        core_util_critical_section_exit();
+        return false;
+    }
+    int pos = 0;
+    while (_order[pos] != slot) {
+        pos++;
+    }
+    _count--;
+    memmove(&_order[pos], &_order[pos + 1], _count - pos);
+    _free |= 1UL << slot;
+    _slots[slot] = Callback<void()>();
+    core_util_critical_section_exit();
+
+    return true;
 }
 
 void CallChain::call() {
-    CallChainLink *link = _chain;
-    while (link != NULL) {
-        link->cb.call();
-        link = link->next;
+    for (int i = 0; i < _count; i++) {
+        _slots[_order[i]].call();
     }
 }
 
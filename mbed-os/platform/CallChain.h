@@ -19,13 +19,17 @@
 #include "platform/Callback.h"
 #include "platform/mbed_toolchain.h"
 #include "platform/NonCopyable.h"
+#include <stdint.h>
 #include <string.h>
 
+#ifndef MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY
+#define MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY   16
+#endif
+
 namespace mbed {
 
 
 typedef Callback<void()> *pFunctionPointer_t;
-class CallChainLink;
 
 /** \addtogroup platform */
 /** @{*/
@@ -38,8 +42,19 @@ class CallChainLink;
  * sequence using CallChain::call(). Used mostly by the interrupt chaining code,
  * but can be used for other purposes.
  *
+ * A chain holds up to MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY functions (at most
+ * 32) in an array of its own, so adding a function never allocates. Functions
+ * are called in priority order, then in the order they were added. The function
+ * object returned when adding is the handle to remove it.
+ *
+ * Finding a free slot and mapping a handle to its slot take constant time, but
+ * adding and removing also move the call order, which is linear in the number
+ * of functions in the chain.
+ *
  * @deprecated Do not use this class. This class is not part of the public API of mbed-os and is being removed in the future.
- * @note Synchronization level: Not protected
+ * @note Synchronization level: Not protected. Functions are added and removed
+ *       within a critical section, so an interrupt handler may call() the
+ *       chain while a thread changes it.
  *
  * Example:
  * @code
@@ -78,7 +93,7 @@ public:
      *  @deprecated 
      *  Do not use this function, this class is not part of the public API of mbed-os and is being removed in the future.
      *
-     *  @param size (optional) Initial size of the chain
+     *  @param size Ignored; the capacity is MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY
      */
     MBED_DEPRECATED_SINCE("mbed-os-5.6", "This class is not part of the "
         "public API of mbed-os and is being removed in the future.")
@@ -100,7 +115,7 @@ public:
      *  @param func A pointer to a void function
      *
      *  @returns
-     *  The function object created for 'func'
+     *  The function object created for 'func', NULL if the chain is full
      */
     MBED_DEPRECATED_SINCE("mbed-os-5.6", "This class is not part of the "
         "public API of mbed-os and is being removed in the future.")
@@ -134,7 +149,7 @@ public:
      *  @param func A pointer to a void function
      *
      *  @returns
-     *  The function object created for 'func'
+     *  The function object created for 'func', NULL if the chain is full
      */
     MBED_DEPRECATED_SINCE("mbed-os-5.6", "This class is not part of the "
         "public API of mbed-os and is being removed in the future.")
@@ -160,6 +175,20 @@ public:
         return add_front(callback(obj, method));
     }
 
+    /** Add a function by priority
+     *
+     *  Functions of a higher priority are called first, functions of the same
+     *  priority in the order they were added. add() and add_front() add with
+     *  priority 0, after and before the other functions of that priority.
+     *
+     *  @param func A pointer to a void function
+     *  @param priority -128 to 127
+     *
+     *  @returns
+     *  The function object created for 'func', NULL if the chain is full
+     */
+    pFunctionPointer_t insert(Callback<void()> func, int8_t priority);
+
     /** Get the number of functions in the chain
      *  @deprecated 
      *  Do not use this function, this class is not part of the public API of mbed-os and is being removed in the future.
@@ -247,7 +276,13 @@ public:
     }
 
 private:
-    CallChainLink *_chain;
+    pFunctionPointer_t add_common(Callback<void()> &func, int8_t priority, bool front);
+
+    Callback<void()> _slots[MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY];
+    int8_t _priority[MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY];
+    uint8_t _order[MBED_CONF_PLATFORM_CALLCHAIN_CAPACITY];     // Slots in call order
+    uint8_t _count;
+    uint32_t _free;                                             // One bit per free slot
 };
 
 /**@}*/
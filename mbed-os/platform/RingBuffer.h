@@ -0,0 +1,253 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_RINGBUFFER_H
+#define MBED_RINGBUFFER_H
+
+#include <stdint.h>
+
+#include "platform/mbed_assert.h"
+#include "platform/mbed_toolchain.h"
+#include "platform/NonCopyable.h"
+
+namespace mbed {
+
+/** \addtogroup platform */
+/** @{*/
+/**
+ * \defgroup platform_RingBuffer RingBuffer class
+ * @{
+ */
+
+/** Templated ring buffer for one producer and one consumer
+ *
+ *  Unlike CircularBuffer, no critical section is taken: the producer only
+ *  writes the head counter and the consumer only writes the tail counter, so
+ *  either side may run in an interrupt handler while the other runs in a
+ *  thread. Both counters run freely and are masked on access, which needs
+ *  BufferSize to be a power of two.
+ *
+ *  Besides single elements, data can be moved in bulk, or accessed in place
+ *  through the contiguous spans returned by write_span() and read_span(),
+ *  for example to point a DMA transfer straight at the buffer.
+ *
+ *  A full buffer is never overwritten; push() fails instead.
+ *
+ *  @note Synchronization level: one producer and one consumer, each of which
+ *  may be a thread or an interrupt handler. Several producers or several
+ *  consumers must serialize among themselves.
+ */
+template<typename T, uint32_t BufferSize>
+class RingBuffer : private NonCopyable<RingBuffer<T, BufferSize> > {
+public:
+    RingBuffer() : _head(0), _tail(0) {
+        MBED_STATIC_ASSERT((BufferSize & (BufferSize - 1)) == 0 && BufferSize > 0,
+                           "BufferSize must be a power of two");
+        MBED_STATIC_ASSERT(BufferSize <= 0x80000000UL, "BufferSize too large");
+    }
+
+    /** Push an element. Producer only.
+     *
+     * @param data Data to be pushed to the buffer
+     * @return True if the element was pushed, false if the buffer is full
+     */
+    bool push(const T &data) {
+        uint32_t head = _head;
+        if (head - _tail == BufferSize) {
+            return false;
+        }
+        _pool[head & MASK] = data;
+        MBED_COMPILER_BARRIER();
+        _head = head + 1;
+        return true;
+    }
+
+    /** Push as many elements as fit. Producer only.
+     *
+     * @param data  Elements to be pushed to the buffer
+     * @param count Number of elements in @a data
+     * @return Number of elements pushed
+     */
+    uint32_t push(const T *data, uint32_t count) {
+        uint32_t head = _head;
+        uint32_t space = BufferSize - (head - _tail);
+        if (count > space) {
+            count = space;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            _pool[(head + i) & MASK] = data[i];
+        }
+        MBED_COMPILER_BARRIER();
+        _head = head + count;
+        return count;
+    }
+
+    /** Pop an element. Consumer only.
+     *
+     * @param data Data to be popped from the buffer
+     * @return True if the buffer is not empty and data contains an element, false otherwise
+     */
+    bool pop(T &data) {
+        uint32_t tail = _tail;
+        if (_head == tail) {
+            return false;
+        }
+        MBED_COMPILER_BARRIER();
+        data = _pool[tail & MASK];
+        MBED_COMPILER_BARRIER();
+        _tail = tail + 1;
+        return true;
+    }
+
+    /** Pop up to count elements. Consumer only.
+     *
+     * @param data  Buffer for the popped elements
+     * @param count Maximum number of elements to pop
+     * @return Number of elements popped
+     */
+    uint32_t pop(T *data, uint32_t count) {
+        uint32_t tail = _tail;
+        uint32_t used = _head - tail;
+        if (count > used) {
+            count = used;
+        }
+        MBED_COMPILER_BARRIER();
+        for (uint32_t i = 0; i < count; i++) {
+            data[i] = _pool[(tail + i) & MASK];
+        }
+        MBED_COMPILER_BARRIER();
+        _tail = tail + count;
+        return count;
+    }
+
+    /** Peek at the oldest element without popping it. Consumer only.
+     *
+     * @param data Data to be peeked from the buffer
+     * @return True if the buffer is not empty and data contains an element, false otherwise
+     */
+    bool peek(T &data) const {
+        uint32_t tail = _tail;
+        if (_head == tail) {
+            return false;
+        }
+        MBED_COMPILER_BARRIER();
+        data = _pool[tail & MASK];
+        return true;
+    }
+
+    /** Get the free space following the newest element. Producer only.
+     *
+     *  The span ends at the end of the storage, so it may be shorter than the
+     *  total free space; call again after commit() for the rest.
+     *
+     * @param count Receives the number of writable elements, 0 if the buffer is full
+     * @return Pointer to the first writable element
+     */
+    T *write_span(uint32_t &count) {
+        uint32_t head = _head;
+        uint32_t space = BufferSize - (head - _tail);
+        uint32_t offset = head & MASK;
+        count = space < BufferSize - offset ? space : BufferSize - offset;
+        return &_pool[offset];
+    }
+
+    /** Publish elements written through write_span(). Producer only.
+     *
+     * @param count Number of elements written, at most the span returned
+     */
+    void commit(uint32_t count) {
+        MBED_ASSERT(count <= BufferSize - (_head - _tail));
+        MBED_COMPILER_BARRIER();
+        _head = _head + count;
+    }
+
+    /** Get the oldest elements in place. Consumer only.
+     *
+     *  The span ends at the end of the storage, so it may be shorter than
+     *  size(); call again after release() for the rest. The elements stay in
+     *  the buffer, and cannot be overwritten, until they are released.
+     *
+     * @param count Receives the number of readable elements, 0 if the buffer is empty
+     * @return Pointer to the oldest element
+     */
+    const T *read_span(uint32_t &count) const {
+        uint32_t tail = _tail;
+        uint32_t used = _head - tail;
+        uint32_t offset = tail & MASK;
+        count = used < BufferSize - offset ? used : BufferSize - offset;
+        MBED_COMPILER_BARRIER();
+        return &_pool[offset];
+    }
+
+    /** Drop elements accessed through read_span(). Consumer only.
+     *
+     * @param count Number of elements to drop, at most size()
+     */
+    void release(uint32_t count) {
+        MBED_ASSERT(count <= _head - _tail);
+        MBED_COMPILER_BARRIER();
+        _tail = _tail + count;
+    }
+
+    /** Check if the buffer is empty
+     *
+     * @return True if the buffer is empty, false if not
+     */
+    bool empty() const {
+        return _head == _tail;
+    }
+
+    /** Check if the buffer is full
+     *
+     * @return True if the buffer is full, false if not
+     */
+    bool full() const {
+        return _head - _tail == BufferSize;
+    }
+
+    /** Get the number of elements currently stored in the buffer */
+    uint32_t size() const {
+        return _head - _tail;
+    }
+
+    /** Get the number of elements the buffer can hold */
+    static uint32_t capacity() {
+        return BufferSize;
+    }
+
+    /** Reset the buffer
+     *
+     *  @note Neither the producer nor the consumer may be active.
+     */
+    void reset() {
+        _head = 0;
+        _tail = 0;
+    }
+
+private:
+    static const uint32_t MASK = BufferSize - 1;
+
+    T _pool[BufferSize];
+    volatile uint32_t _head;    // written by the producer only
+    volatile uint32_t _tail;    // written by the consumer only
+};
+
+/**@}*/
+
+/**@}*/
+
+}
+
+#endif
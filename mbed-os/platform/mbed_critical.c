@@ -22,6 +22,7 @@
 #include "cmsis.h"
 #include "platform/mbed_assert.h"
 #include "platform/mbed_critical.h"
+#include "platform/mbed_latency.h"
 #include "platform/mbed_toolchain.h"
 
 // if __EXCLUSIVE_ACCESS rtx macro not defined, we need to get this via own-set architecture macros
@@ -75,8 +76,18 @@ bool core_util_in_critical_section(void)
     return hal_in_critical_section();
 }
 
-void core_util_critical_section_enter(void)
+/* Critical sections are timed by call site. IAR has no MBED_CALLER_ADDR(), so
+ * the return address is read from LR before the first call of the function
+ * can change it; not inlining keeps it the address in the caller. */
+MBED_NOINLINE void core_util_critical_section_enter(void)
 {
+#if defined(MBED_LATENCY_ENABLED) && defined(__ICCARM__)
+    void *caller;
+    __asm volatile("MOV %0, LR" : "=r" (caller) : : "memory");
+#elif defined(MBED_LATENCY_ENABLED)
+    void *caller = MBED_CALLER_ADDR();
+#endif
+
 // FIXME
 #ifdef FEATURE_UVISOR
     #warning "core_util_critical_section_enter needs fixing to work from unprivileged code"
@@ -88,6 +99,12 @@ void core_util_critical_section_enter(void)
     hal_critical_section_enter();
 
     ++critical_section_reentrancy_counter;
+
+#if defined(MBED_LATENCY_ENABLED)
+    if (critical_section_reentrancy_counter == 1) {
+        mbed_latency_critical_enter(caller);
+    }
+#endif
 }
 
 void core_util_critical_section_exit(void)
@@ -105,6 +122,9 @@ void core_util_critical_section_exit(void)
     --critical_section_reentrancy_counter;
 
     if (critical_section_reentrancy_counter == 0) {
+#if defined(MBED_LATENCY_ENABLED)
+        mbed_latency_critical_exit();
+#endif
         hal_critical_section_exit();
     }
 }
@@ -54,6 +54,9 @@ static mbed_error_hook_t error_hook = NULL;
 static void print_error_report(mbed_error_ctx *ctx, const char *);
 static mbed_error_status_t handle_error(mbed_error_status_t error_status, unsigned int error_value, const char *filename, int line_number);
 
+//Implemented in mbed_retarget.cpp, sends what buffered stdout still holds
+extern void mbed_stdio_flush_from_error(void);
+
 //Helper function to halt the system
 static void mbed_halt_system(void)
 {
@@ -358,6 +361,8 @@ static void print_error_report(mbed_error_ctx *ctx, const char *error_msg)
     uint32_t error_code = MBED_GET_ERROR_CODE(ctx->error_status);
     uint32_t error_module = MBED_GET_ERROR_MODULE(ctx->error_status);
     
+    //Output printed before the error comes first
+    mbed_stdio_flush_from_error();
     mbed_error_printf("\n\n++ MbedOS Error Info ++\nError Status: 0x%x Code: %d Module: %d\nError Message: ", ctx->error_status, error_code, error_module);
     
     //Report error info based on error code, some errors require different 
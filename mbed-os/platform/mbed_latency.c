@@ -0,0 +1,337 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "platform/mbed_latency.h"
+#ifdef MBED_LATENCY_HOST
+#include <time.h>
+#define LATENCY_CLZ(x)  __builtin_clz(x)
+#else
+#include "cmsis.h"
+#define LATENCY_CLZ(x)  __CLZ(x)
+#endif
+
+#if defined(MBED_LATENCY_ENABLED)
+
+#if !defined(MBED_LATENCY_HOST) && !defined(DWT_CTRL_CYCCNTENA_Msk)
+#error "MBED_LATENCY_ENABLED needs the DWT cycle counter of a Cortex-M3, M4 or M7"
+#endif
+
+static mbed_latency_site_t latency_sites[MBED_LATENCY_SITES];
+static uint32_t latency_used;
+static uint32_t latency_drop;
+static volatile uint32_t latency_on;
+
+// Only touched with interrupts masked, by the outermost critical section
+static uint32_t latency_critical_start;
+static uint32_t latency_critical_site;
+
+/* Critical sections are what is being measured, so the bookkeeping masks
+ * interrupts by itself rather than through core_util_critical_section_enter() */
+#ifdef MBED_LATENCY_HOST
+static uint32_t latency_mask(void)
+{
+    return 0;
+}
+
+static void latency_unmask(uint32_t primask)
+{
+    (void)primask;
+}
+#else
+static uint32_t latency_mask(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+static void latency_unmask(uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+#endif
+
+uint32_t mbed_latency_now(void)
+{
+#ifdef MBED_LATENCY_HOST
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)now.tv_sec * 1000000000UL + (uint32_t)now.tv_nsec;
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+uint32_t mbed_latency_frequency(void)
+{
+#ifdef MBED_LATENCY_HOST
+    return 1000000000UL;
+#else
+    return SystemCoreClock;
+#endif
+}
+
+static uint32_t latency_bucket(uint32_t duration)
+{
+    if (duration < 2) {
+        return duration;
+    }
+    uint32_t octave = 31 - LATENCY_CLZ(duration);
+    uint32_t bucket = 2 * octave + ((duration >> (octave - 1)) & 1);
+    return bucket < MBED_LATENCY_BUCKETS ? bucket : MBED_LATENCY_BUCKETS - 1;
+}
+
+static uint32_t latency_bucket_top(uint32_t bucket)
+{
+    if (bucket < 2) {
+        return bucket;
+    }
+    if (bucket == MBED_LATENCY_BUCKETS - 1) {
+        return 0xFFFFFFFFUL;
+    }
+    uint32_t octave = bucket / 2;
+    return ((2 + (bucket & 1)) << (octave - 1)) + (1UL << (octave - 1)) - 1;
+}
+
+void mbed_latency_record(uint32_t kind, uint32_t id, uint32_t start)
+{
+    uint32_t duration = mbed_latency_now() - start;
+
+    if (!latency_on) {
+        return;
+    }
+
+    uint32_t primask = latency_mask();
+    mbed_latency_site_t *site = NULL;
+    for (uint32_t i = 0; i < latency_used; i++) {
+        if (latency_sites[i].id == id && latency_sites[i].kind == kind) {
+            site = &latency_sites[i];
+            break;
+        }
+    }
+    if (site == NULL) {
+        if (latency_used == MBED_LATENCY_SITES) {
+            latency_drop++;
+            latency_unmask(primask);
+            return;
+        }
+        site = &latency_sites[latency_used++];
+        site->kind = kind;
+        site->id = id;
+    }
+
+    site->count++;
+    if (duration > site->max) {
+        site->max = duration;
+    }
+    uint16_t *bucket = &site->buckets[latency_bucket(duration)];
+    if (*bucket != 0xFFFF) {
+        (*bucket)++;
+    }
+    latency_unmask(primask);
+}
+
+void mbed_latency_irq_exit(uint32_t kind, uint32_t start)
+{
+#ifdef MBED_LATENCY_HOST
+    mbed_latency_record(kind, 0, start);
+#else
+    mbed_latency_record(kind, __get_IPSR(), start);
+#endif
+}
+
+void mbed_latency_critical_enter(void *site)
+{
+    latency_critical_site = (uint32_t)(uintptr_t)site;
+    latency_critical_start = mbed_latency_now();
+}
+
+void mbed_latency_critical_exit(void)
+{
+    mbed_latency_record(MBED_LATENCY_CRITICAL, latency_critical_site, latency_critical_start);
+}
+
+void mbed_latency_start(void)
+{
+#ifndef MBED_LATENCY_HOST
+    if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+#endif
+    latency_on = 1;
+}
+
+void mbed_latency_stop(void)
+{
+    latency_on = 0;
+}
+
+void mbed_latency_reset(void)
+{
+    uint32_t primask = latency_mask();
+    memset(latency_sites, 0, sizeof(latency_sites));
+    latency_used = 0;
+    latency_drop = 0;
+    latency_unmask(primask);
+}
+
+size_t mbed_latency_read(mbed_latency_site_t *sites, size_t count)
+{
+    size_t n = 0;
+
+    uint32_t primask = latency_mask();
+    while (n < count && n < latency_used) {
+        sites[n] = latency_sites[n];
+        n++;
+    }
+    latency_unmask(primask);
+    return n;
+}
+
+uint32_t mbed_latency_dropped(void)
+{
+    return latency_drop;
+}
+
+uint32_t mbed_latency_percentile(const mbed_latency_site_t *site, uint32_t percent)
+{
+    uint32_t total = 0;
+
+    // The bucket counts saturate, so rank against their sum rather than site->count
+    for (uint32_t i = 0; i < MBED_LATENCY_BUCKETS; i++) {
+        total += site->buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint32_t rank = (uint32_t)(((uint64_t)total * percent + 99) / 100);
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < MBED_LATENCY_BUCKETS; i++) {
+        seen += site->buckets[i];
+        if (seen >= rank && seen > 0) {
+            uint32_t top = latency_bucket_top(i);
+            return top < site->max ? top : site->max;
+        }
+    }
+    return site->max;
+}
+
+void mbed_latency_print(void)
+{
+    mbed_latency_site_t site;
+    uint32_t i = 0;
+
+    while (1) {
+        uint32_t primask = latency_mask();
+        if (i >= latency_used) {
+            latency_unmask(primask);
+            break;
+        }
+        site = latency_sites[i++];
+        latency_unmask(primask);
+
+        printf("lat: kind=%lu id=0x%08lx count=%lu max=%lu p50=%lu p99=%lu hist=",
+               (unsigned long)site.kind, (unsigned long)site.id, (unsigned long)site.count,
+               (unsigned long)site.max, (unsigned long)mbed_latency_percentile(&site, 50),
+               (unsigned long)mbed_latency_percentile(&site, 99));
+        const char *sep = "";
+        for (uint32_t b = 0; b < MBED_LATENCY_BUCKETS; b++) {
+            if (site.buckets[b]) {
+                printf("%s%lu:%u", sep, (unsigned long)b, (unsigned)site.buckets[b]);
+                sep = ",";
+            }
+        }
+        printf("\r\n");
+    }
+    printf("lat: hz=%lu dropped=%lu\r\n", (unsigned long)mbed_latency_frequency(),
+           (unsigned long)latency_drop);
+}
+
+#else
+
+void mbed_latency_start(void)
+{
+}
+
+void mbed_latency_stop(void)
+{
+}
+
+void mbed_latency_reset(void)
+{
+}
+
+uint32_t mbed_latency_frequency(void)
+{
+    return 0;
+}
+
+uint32_t mbed_latency_now(void)
+{
+    return 0;
+}
+
+void mbed_latency_record(uint32_t kind, uint32_t id, uint32_t start)
+{
+    (void)kind;
+    (void)id;
+    (void)start;
+}
+
+void mbed_latency_irq_exit(uint32_t kind, uint32_t start)
+{
+    (void)kind;
+    (void)start;
+}
+
+void mbed_latency_critical_enter(void *site)
+{
+    (void)site;
+}
+
+void mbed_latency_critical_exit(void)
+{
+}
+
+size_t mbed_latency_read(mbed_latency_site_t *sites, size_t count)
+{
+    (void)sites;
+    (void)count;
+    return 0;
+}
+
+uint32_t mbed_latency_percentile(const mbed_latency_site_t *site, uint32_t percent)
+{
+    (void)site;
+    (void)percent;
+    return 0;
+}
+
+uint32_t mbed_latency_dropped(void)
+{
+    return 0;
+}
+
+void mbed_latency_print(void)
+{
+}
+
+#endif // MBED_LATENCY_ENABLED
@@ -0,0 +1,157 @@
+
+/** \addtogroup platform */
+/** @{*/
+/**
+ * \defgroup platform_latency Interrupt and critical section latency
+ * @{
+ */
+
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_LATENCY_H
+#define MBED_LATENCY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef MBED_LATENCY_ENABLED
+#ifndef MBED_LATENCY_SITES
+#define MBED_LATENCY_SITES      16      /**< Interrupts and critical section call sites tracked */
+#endif
+#endif
+
+/** Histogram buckets: 0, 1, then two per power of two, so the upper bound of a
+ *  bucket is at most 1.5 times its lower bound; the last one is open ended */
+#define MBED_LATENCY_BUCKETS    42
+
+/** What a mbed_latency_site_t measures; the ID is the exception number for
+ *  interrupts and the caller of core_util_critical_section_enter() otherwise */
+typedef enum {
+    MBED_LATENCY_CRITICAL = 0,      /**< Outermost critical section, interrupts masked */
+    MBED_LATENCY_IRQ_TICKER,        /**< ticker_irq_handler(), event handlers included */
+    MBED_LATENCY_IRQ_CHAIN,         /**< InterruptManager dispatch through its CallChain */
+    MBED_LATENCY_IRQ_GPIO,          /**< InterruptIn dispatch to rise and fall callbacks */
+    MBED_LATENCY_IRQ_USER           /**< First kind free for application handlers */
+} mbed_latency_kind_t;
+
+/**
+ * struct mbed_latency_site_t definition
+ */
+typedef struct {
+    uint32_t kind;                              /**< mbed_latency_kind_t */
+    uint32_t id;                                /**< Exception number or call site */
+    uint32_t count;                             /**< Durations recorded */
+    uint32_t max;                               /**< Longest duration, in counter ticks */
+    uint16_t buckets[MBED_LATENCY_BUCKETS];     /**< Durations per bucket, saturating */
+} mbed_latency_site_t;
+
+/** Start recording, and start the cycle counter if needed
+ *
+ *  On target the counter is the DWT cycle counter, at the core clock. On a PC,
+ *  built with MBED_LATENCY_HOST, it is CLOCK_MONOTONIC in nanoseconds.
+ */
+void mbed_latency_start(void);
+
+/** Stop recording. Sites recorded so far stay available.
+ */
+void mbed_latency_stop(void);
+
+/** Forget all sites and drops
+ */
+void mbed_latency_reset(void);
+
+/** Counter ticks per second
+ */
+uint32_t mbed_latency_frequency(void);
+
+/** Read the counter
+ */
+uint32_t mbed_latency_now(void);
+
+/** Record a duration against a site
+ *
+ *  Safe from any context; interrupts are masked while the site is updated.
+ *
+ *  @param kind     mbed_latency_kind_t
+ *  @param id       exception number or call site
+ *  @param start    mbed_latency_now() at the start; the end is now
+ */
+void mbed_latency_record(uint32_t kind, uint32_t id, uint32_t start);
+
+/** Record the end of the handler of the active interrupt
+ *
+ *  Handlers nest, so each one keeps its own start:
+ *  @code
+ *  uint32_t start = mbed_latency_now();
+ *  ... handle the interrupt ...
+ *  mbed_latency_irq_exit(MBED_LATENCY_IRQ_USER, start);
+ *  @endcode
+ *
+ *  @param kind     mbed_latency_kind_t of the handler
+ *  @param start    mbed_latency_now() at handler entry
+ */
+void mbed_latency_irq_exit(uint32_t kind, uint32_t start);
+
+/** Outermost critical section entered. Called by core_util_critical_section_enter()
+ *  with interrupts masked.
+ *
+ *  @param site     caller of core_util_critical_section_enter()
+ */
+void mbed_latency_critical_enter(void *site);
+
+/** Outermost critical section about to be left. Called by
+ *  core_util_critical_section_exit() with interrupts still masked.
+ */
+void mbed_latency_critical_exit(void);
+
+/** Copy the sites, in the order they were first seen
+ *
+ *  @param sites    Array to fill
+ *  @param count    Capacity of the array
+ *  @return         Number of sites copied
+ */
+size_t mbed_latency_read(mbed_latency_site_t *sites, size_t count);
+
+/** Duration that a percentage of the records of a site did not exceed
+ *
+ *  @param site     Site from mbed_latency_read()
+ *  @param percent  0 to 100
+ *  @return         Upper bound of the bucket holding that record, at most the
+ *                  maximum, in counter ticks; 0 if nothing was recorded
+ */
+uint32_t mbed_latency_percentile(const mbed_latency_site_t *site, uint32_t percent);
+
+/** Number of records lost because all sites were in use
+ */
+uint32_t mbed_latency_dropped(void);
+
+/** Print all sites as "lat:" lines on stdout, for tools/latency_report.py
+ */
+void mbed_latency_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/** @}*/
+
+/** @}*/
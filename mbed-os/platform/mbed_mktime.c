@@ -24,48 +24,61 @@
 #define SECONDS_BY_DAY (SECONDS_BY_HOUR * HOURS_BY_DAY)
 #define LAST_VALID_YEAR 206
 
-/* Macros which will be used to determine if we are within valid range. */
-#define EDGE_TIMESTAMP_FULL_LEAP_YEAR_SUPPORT 3220095     // 7th of February 1970 at 06:28:15
-#define EDGE_TIMESTAMP_4_YEAR_LEAP_YEAR_SUPPORT 3133695  // 6th of February 1970 at 06:28:15
+/* Calendar constants, for the proleptic Gregorian calendar. */
+#define DAYS_BY_ERA 146097                      // 400 years
+#define DAYS_FROM_ERA_TO_EPOCH 719468           // 1st of March 0000 to 1st of January 1970
+#define DAYS_TO_MARCH_2100 47541                // 1st of January 1970 to 1st of March 2100
+
+/* Range of the 64-bit conversions, which keeps day counts within 32 bits. */
+#define MAX_YEAR_64 4110000
+#define MAX_DAYS_64 1500000000
 
 /*
- * 2 dimensional array containing the number of seconds elapsed before a given 
- * month.
- * The second index map to the month while the first map to the type of year:
- *   - 0: non leap year 
- *   - 1: leap year
+ * Number of days from the 1st of March to the 1st of a given month. Years are
+ * counted from March so that the leap day, if any, is the last day of the
+ * year, and January and February belong to the previous year.
  */
-static const uint32_t seconds_before_month[2][12] = {
-    {
-        0,
-        31 * SECONDS_BY_DAY,
-        (31 + 28) * SECONDS_BY_DAY,
-        (31 + 28 + 31) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 28 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31 + 30) * SECONDS_BY_DAY,
-    },
-    {
-        0,
-        31 * SECONDS_BY_DAY,
-        (31 + 29) * SECONDS_BY_DAY,
-        (31 + 29 + 31) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31 + 30) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31) * SECONDS_BY_DAY,
-        (31 + 29 + 31 + 30 + 31 + 30 + 31 + 31 + 30 + 31 + 30) * SECONDS_BY_DAY,
-    }
+static const uint16_t days_from_march[12] = {
+    306, 337, 0, 31, 61, 92, 122, 153, 184, 214, 245, 275
 };
 
+/*
+ * Days since epoch of the 1st of January of year + 1900, plus the days before
+ * month mon. The year is split into 400 years eras of DAYS_BY_ERA days each,
+ * so leap days are counted with divisions rather than loops.
+ */
+static int32_t days_from_civil(int32_t year, uint32_t mon)
+{
+    year += 1900 - (mon < 2);
+
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    uint32_t yoe = (uint32_t)(year - era * 400);                     // [0, 399]
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + days_from_march[mon];
+
+    return era * DAYS_BY_ERA + (int32_t)doe - DAYS_FROM_ERA_TO_EPOCH;
+}
+
+/*
+ * Fill the date fields of time_info from the days since epoch: the inverse of
+ * days_from_civil().
+ */
+static void civil_from_days(int32_t days, struct tm *time_info)
+{
+    days += DAYS_FROM_ERA_TO_EPOCH;
+
+    int32_t era = (days >= 0 ? days : days - (DAYS_BY_ERA - 1)) / DAYS_BY_ERA;
+    uint32_t doe = (uint32_t)(days - era * DAYS_BY_ERA);            // [0, 146096]
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (yoe * 365 + yoe / 4 - yoe / 100);          // [0, 365] from the 1st of March
+    uint32_t mp = (doy * 5 + 2) / 153;                              // [0, 11] from March
+    uint32_t march_leap = (yoe % 4 == 0) && (yoe % 100 != 0 || yoe == 0);
+
+    time_info->tm_mday = doy - (mp * 153 + 2) / 5 + 1;
+    time_info->tm_mon = mp < 10 ? mp + 2 : mp - 10;
+    time_info->tm_year = era * 400 + (int32_t)yoe + (mp >= 10) - 1900;
+    time_info->tm_yday = mp < 10 ? doy + 59 + march_leap : doy - 306;
+}
+
 bool _rtc_is_leap_year(int year, rtc_leap_year_support_t leap_year_support) {
     /* 
      * since in practice, the value manipulated by this algorithm lie in the 
@@ -96,39 +109,28 @@ bool _rtc_maketime(const struct tm* time, time_t * seconds, rtc_leap_year_suppor
     }
 
     /* Partial check for the upper bound of the range - check years only. Full check will be performed after the
-     * elapsed time since the beginning of the year is calculated.
+     * elapsed time since epoch is calculated.
      */
-    if ((time->tm_year < 70) || (time->tm_year > LAST_VALID_YEAR)) {
+    if ((time->tm_year < 70) || (time->tm_year > LAST_VALID_YEAR) || ((uint32_t)time->tm_mon > 11)) {
         return false;
     }
 
-    uint32_t result = time->tm_sec;
-    result += time->tm_min * SECONDS_BY_MINUTES;
-    result += time->tm_hour * SECONDS_BY_HOUR;
-    result += (time->tm_mday - 1) * SECONDS_BY_DAY;
-    result += seconds_before_month[_rtc_is_leap_year(time->tm_year, leap_year_support)][time->tm_mon];
+    int32_t days = days_from_civil(time->tm_year, time->tm_mon);
 
-    /* Check if we are within valid range. */
-    if (time->tm_year == LAST_VALID_YEAR) {
-        if ((leap_year_support == RTC_FULL_LEAP_YEAR_SUPPORT && result > EDGE_TIMESTAMP_FULL_LEAP_YEAR_SUPPORT) ||
-            (leap_year_support == RTC_4_YEAR_LEAP_YEAR_SUPPORT && result > EDGE_TIMESTAMP_4_YEAR_LEAP_YEAR_SUPPORT)) {
-        return false;
-        }
+    /* RTCs without full leap year support have a 29th of February 2100. */
+    if (leap_year_support == RTC_4_YEAR_LEAP_YEAR_SUPPORT && days >= DAYS_TO_MARCH_2100) {
+        days++;
     }
 
-    if (time->tm_year > 70) { 
-        /* Valid in the range [70:206]. */
-        uint32_t count_of_leap_days = ((time->tm_year - 1) / 4) - (70 / 4);
-        if (leap_year_support == RTC_FULL_LEAP_YEAR_SUPPORT) {
-            if (time->tm_year > 200) {
-                count_of_leap_days--; // 2100 is not a leap year
-            }
-        }
+    int64_t result = (int64_t)(days + time->tm_mday - 1) * SECONDS_BY_DAY;
+    result += time->tm_hour * SECONDS_BY_HOUR + time->tm_min * SECONDS_BY_MINUTES + time->tm_sec;
 
-        result += (((time->tm_year - 70) * 365) + count_of_leap_days) * SECONDS_BY_DAY;
+    /* Check if we are within valid range. */
+    if (result < 0 || result > UINT32_MAX) {
+        return false;
     }
 
-    *seconds = result;
+    *seconds = (time_t)(uint32_t)result;
 
     return true;
 }
@@ -152,39 +154,70 @@ bool _rtc_localtime(time_t timestamp, struct tm* time_info, rtc_leap_year_suppor
      */
     time_info->tm_wday = (seconds + 4) % 7;
 
-    /* Years start at 70. */
-    time_info->tm_year = 70;
-    while (true) { 
-        if (_rtc_is_leap_year(time_info->tm_year, leap_year_support) && seconds >= 366) {
-            ++time_info->tm_year;
-            seconds -= 366;
-        } else if (!_rtc_is_leap_year(time_info->tm_year, leap_year_support) && seconds >= 365) {
-            ++time_info->tm_year;
-            seconds -= 365;
-        } else {
-            /* The remaining days are less than a years. */
-            break;
+    /* RTCs without full leap year support have a 29th of February 2100. */
+    if (leap_year_support == RTC_4_YEAR_LEAP_YEAR_SUPPORT && seconds >= DAYS_TO_MARCH_2100) {
+        if (seconds == DAYS_TO_MARCH_2100) {
+            time_info->tm_year = 200;
+            time_info->tm_mon = 1;
+            time_info->tm_mday = 29;
+            time_info->tm_yday = 59;
+            return true;
+        }
+
+        civil_from_days(seconds - 1, time_info);
+        if (time_info->tm_year == 200) {
+            time_info->tm_yday++;
         }
+        return true;
     }
 
-    time_info->tm_yday = seconds;
+    civil_from_days(seconds, time_info);
 
-    /* Convert days into seconds and find the current month. */
-    seconds *= SECONDS_BY_DAY;
-    time_info->tm_mon = 11;
-    bool leap = _rtc_is_leap_year(time_info->tm_year, leap_year_support);
-    for (uint32_t i = 0; i < 12; ++i) {
-        if ((uint32_t) seconds < seconds_before_month[leap][i]) {
-            time_info->tm_mon = i - 1;
-            break;
-        }
+    return true;
+}
+
+bool _rtc_maketime64(const struct tm* time, int64_t * seconds) {
+    if (seconds == NULL || time == NULL) {
+        return false;
     }
 
-    /* Remove month from timestamp and compute the number of days.
-     * Note: unlike other fields, days are not 0 indexed.
-     */
-    seconds -= seconds_before_month[leap][time_info->tm_mon];
-    time_info->tm_mday = (seconds / SECONDS_BY_DAY) + 1;
+    if ((time->tm_year < -MAX_YEAR_64 - 1900) || (time->tm_year > MAX_YEAR_64 - 1900) || ((uint32_t)time->tm_mon > 11)) {
+        return false;
+    }
+
+    int64_t days = (int64_t)days_from_civil(time->tm_year, time->tm_mon) + time->tm_mday - 1;
+
+    *seconds = days * SECONDS_BY_DAY + (int64_t)time->tm_hour * SECONDS_BY_HOUR +
+               (int64_t)time->tm_min * SECONDS_BY_MINUTES + time->tm_sec;
+
+    return true;
+}
+
+bool _rtc_localtime64(int64_t timestamp, struct tm* time_info) {
+    if (time_info == NULL) {
+        return false;
+    }
+
+    /* Floor division, so that times before epoch count back from midnight. */
+    int64_t days = timestamp / SECONDS_BY_DAY;
+    int32_t seconds = (int32_t)(timestamp - days * SECONDS_BY_DAY);
+    if (seconds < 0) {
+        seconds += SECONDS_BY_DAY;
+        days--;
+    }
+
+    if (days < -MAX_DAYS_64 || days > MAX_DAYS_64) {
+        return false;
+    }
+
+    time_info->tm_sec = seconds % 60;
+    time_info->tm_min = (seconds / 60) % 60;
+    time_info->tm_hour = seconds / SECONDS_BY_HOUR;
+
+    /* The 1st of January 1970 was a Thursday. */
+    time_info->tm_wday = (int32_t)((days % 7 + 11) % 7);
+
+    civil_from_days((int32_t)days, time_info);
 
     return true;
 }
@@ -120,6 +120,39 @@ bool _rtc_maketime(const struct tm* time, time_t * seconds, rtc_leap_year_suppor
  */
 bool _rtc_localtime(time_t timestamp, struct tm* time_info, rtc_leap_year_support_t leap_year_support);
 
+/* Convert a calendar time into time since UNIX epoch, over a 64-bit range.
+ *
+ * Same as _rtc_maketime() with full leap year support, for times before
+ * 1970 and after 2106 as well.
+ *
+ * @param time The calendar time to convert. The fields used are the same as
+ * for _rtc_maketime(); tm_year shall be in the range [-4111900 : 4108100].
+ * @param seconds holder for the result - calendar time as seconds since UNIX
+ * epoch, negative before it.
+ *
+ * @return true on success, false if conversion error occurred.
+ *
+ * @note Leap seconds are not supported.
+ * @note The proleptic Gregorian calendar is used for all years.
+ */
+bool _rtc_maketime64(const struct tm* time, int64_t * seconds);
+
+/* Convert a given time in seconds since epoch into calendar time, over a
+ * 64-bit range.
+ *
+ * Same as _rtc_localtime() with full leap year support, for times before
+ * 1970 and after 2106 as well.
+ *
+ * @param timestamp The time (in seconds) to convert into calendar time. Valid
+ * input are within 1.5e9 days (about 4 million years) of epoch.
+ * @param time_info Pointer to the object which will contain the result of
+ * the conversion. The fields filled are the same as for _rtc_localtime().
+ * @return true if the conversion was successful, false otherwise.
+ *
+ * @note The proleptic Gregorian calendar is used for all years.
+ */
+bool _rtc_localtime64(int64_t timestamp, struct tm* time_info);
+
 /** @}*/
 
 #ifdef __cplusplus
@@ -17,8 +17,13 @@
 #include "FileHandle.h"
 #if MBED_CONF_RTOS_PRESENT
 #include "rtos/Kernel.h"
-#include "rtos/Thread.h"
+#include "rtos/Semaphore.h"
+#include "platform/mbed_critical.h"
 using namespace rtos;
+
+#ifndef MBED_CONF_PLATFORM_POLL_RESCAN_PERIOD
+#define MBED_CONF_PLATFORM_POLL_RESCAN_PERIOD   0
+#endif
 #else
 #include "Timer.h"
 #include "LowPowerTimer.h"
@@ -26,17 +31,42 @@ using namespace rtos;
 
 namespace mbed {
 
+#if MBED_CONF_RTOS_PRESENT
+// One per blocked poll(), so that the thread flags of the caller are left alone
+struct poll_waiter {
+    poll_waiter() : change(0, 1), next(NULL) {}
+    Semaphore change;
+    poll_waiter *next;
+};
+
+static poll_waiter *poll_waiters;
+
+void poll_change(void)
+{
+    core_util_critical_section_enter();
+    for (poll_waiter *waiter = poll_waiters; waiter; waiter = waiter->next) {
+        waiter->change.release();
+    }
+    core_util_critical_section_exit();
+}
+#else
+void poll_change(void)
+{
+}
+#endif
+
 // timeout -1 forever, or milliseconds
 int poll(pollfh fhs[], unsigned nfhs, int timeout)
 {
     /**
-     * TODO Proper wake-up mechanism.
      * In order to correctly detect availability of read/write a FileHandle, we needed
      * a select or poll mechanisms. We opted for poll as POSIX defines in
-     * http://pubs.opengroup.org/onlinepubs/009695399/functions/poll.html Currently,
-     * mbed::poll() just spins and scans filehandles looking for any events we are
-     * interested in. In future, his spinning behaviour will be replaced with
-     * condition variables.
+     * http://pubs.opengroup.org/onlinepubs/009695399/functions/poll.html
+     *
+     * With the RTOS, a thread that finds nothing blocks until a file handle
+     * calls poll_change(). File handles of an application that never do
+     * need a rescan every MBED_CONF_PLATFORM_POLL_RESCAN_PERIOD milliseconds
+     * (by default 0, for never). Without the RTOS, mbed::poll() still spins.
      */
 #if MBED_CONF_RTOS_PRESENT
     uint64_t start_time = 0;
@@ -44,6 +74,13 @@ int poll(pollfh fhs[], unsigned nfhs, int timeout)
         start_time = Kernel::get_ms_count();
     }
 #define TIME_ELAPSED() int64_t(Kernel::get_ms_count() - start_time)
+
+    // Register before the scan, so that a change during it is not missed
+    poll_waiter self;
+    core_util_critical_section_enter();
+    self.next = poll_waiters;
+    poll_waiters = &self;
+    core_util_critical_section_exit();
 #else
 #if MBED_CONF_PLATFORM_POLL_USE_LOWPOWER_TIMER
     LowPowerTimer timer;
@@ -77,15 +114,31 @@ int poll(pollfh fhs[], unsigned nfhs, int timeout)
         }
 
         /* Nothing selected - this is where timeout handling would be needed */
-        if (timeout == 0 || (timeout > 0 && TIME_ELAPSED() > timeout)) {
+        if (timeout == 0 || (timeout > 0 && TIME_ELAPSED() >= timeout)) {
             break;
         }
-#ifdef MBED_CONF_RTOS_PRESENT
-        // TODO - proper blocking
-        // wait for condition variable, wait queue whatever here
-        rtos::Thread::wait(1);
+#if MBED_CONF_RTOS_PRESENT
+        uint32_t wait = osWaitForever;
+        if (timeout > 0) {
+            wait = timeout - TIME_ELAPSED();
+        }
+        if (MBED_CONF_PLATFORM_POLL_RESCAN_PERIOD > 0 && wait > MBED_CONF_PLATFORM_POLL_RESCAN_PERIOD) {
+            wait = MBED_CONF_PLATFORM_POLL_RESCAN_PERIOD;
+        }
+        self.change.wait(wait);
 #endif
     }
+
+#if MBED_CONF_RTOS_PRESENT
+    core_util_critical_section_enter();
+    for (poll_waiter **link = &poll_waiters; *link; link = &(*link)->next) {
+        if (*link == &self) {
+            *link = self.next;
+            break;
+        }
+    }
+    core_util_critical_section_exit();
+#endif
     return count;
 }
 
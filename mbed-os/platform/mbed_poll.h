@@ -51,6 +51,13 @@ struct pollfh {
  */
 int poll(pollfh fhs[], unsigned nfhs, int timeout);
 
+/** Wake the threads blocked in poll() so that they scan their file handles again.
+ *
+ * A FileHandle calls this, along with its sigio() callback, whenever the result
+ * of its poll() may have changed. Safe to call from interrupt context.
+ */
+void poll_change(void);
+
 /**@}*/
 
 /**@}*/
@@ -26,6 +26,7 @@
 #include "sleep_api.h"
 #include "mbed_toolchain.h"
 #include "hal/ticker_api.h"
+#include "platform/mbed_stats.h"
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -63,8 +64,13 @@ extern "C" {
  *      return _sensor.start(event, callback);
  * }
  * @endcode
+ *
+ * With MBED_SLEEP_TRACING_ENABLED, every lock and unlock is printed, and the
+ * held locks before every sleep. With MBED_SLEEP_LOCK_STATS_ENABLED, the locks
+ * are attributed to the file taking them without printing anything; see
+ * mbed_stats_sleep_lock_get_each().
  */
-#ifdef MBED_SLEEP_TRACING_ENABLED
+#if defined(MBED_SLEEP_TRACING_ENABLED) || defined(MBED_SLEEP_LOCK_STATS_ENABLED)
 
 void sleep_tracker_lock(const char *const filename, int line);
 void sleep_tracker_unlock(const char *const filename, int line);
@@ -91,7 +97,7 @@ void sleep_tracker_unlock(const char *const filename, int line);
 #define sleep_manager_unlock_deep_sleep() \
     sleep_manager_unlock_deep_sleep_internal()
 
-#endif // MBED_SLEEP_TRACING_ENABLED
+#endif // MBED_SLEEP_TRACING_ENABLED || MBED_SLEEP_LOCK_STATS_ENABLED
 
 /** Lock the deep sleep mode
  *
@@ -0,0 +1,186 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "platform/mbed_profiler.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_toolchain.h"
+#include "hal/profiler_timer_api.h"
+#include "cmsis.h"
+#ifdef MBED_CONF_RTOS_PRESENT
+#include "cmsis_os2.h"
+#endif
+
+#if defined(MBED_PROFILER_ENABLED)
+
+MBED_STATIC_ASSERT((MBED_PROFILER_SAMPLES & (MBED_PROFILER_SAMPLES - 1)) == 0,
+                   "MBED_PROFILER_SAMPLES must be a power of two");
+
+static mbed_profiler_sample_t profiler_ring[MBED_PROFILER_SAMPLES];
+static volatile uint32_t profiler_head;     // written by the timer interrupt only
+static volatile uint32_t profiler_tail;     // written by the reader only
+static volatile uint32_t profiler_drop;
+
+/* Exception number of the handler that the sampling interrupt preempted */
+static uint32_t profiler_preempted_exception(void)
+{
+    uint32_t self = __get_IPSR();
+
+    for (uint32_t i = 0; i < sizeof(NVIC->IABR) / sizeof(NVIC->IABR[0]); i++) {
+        uint32_t active = NVIC->IABR[i];
+        while (active) {
+            uint32_t bit = __CLZ(__RBIT(active));
+            uint32_t exception = 16 + i * 32 + bit;
+            if (exception != self) {
+                return exception;
+            }
+            active &= active - 1;
+        }
+    }
+#if defined(SCB_SHCSR_SYSTICKACT_Msk)
+    if (SCB->SHCSR & SCB_SHCSR_SYSTICKACT_Msk) {
+        return 15;
+    }
+    if (SCB->SHCSR & SCB_SHCSR_PENDSVACT_Msk) {
+        return 14;
+    }
+    if (SCB->SHCSR & SCB_SHCSR_SVCALLACT_Msk) {
+        return 11;
+    }
+#endif
+    return 0;
+}
+
+void mbed_profiler_sample_irq(void)
+{
+    mbed_profiler_sample_t sample;
+
+#ifdef MBED_CONF_RTOS_PRESENT
+    if ((SCB->ICSR & SCB_ICSR_RETTOBASE_Msk) && osKernelGetState() == osKernelRunning) {
+        // Only this handler is active, so it interrupted a thread and the
+        // exception frame is on the process stack: R0-R3, R12, LR, PC, xPSR
+        const uint32_t *frame = (const uint32_t *)__get_PSP();
+        sample.pc = frame[6];
+        sample.context = (uint32_t)osThreadGetId();
+    } else
+#endif
+    {
+        sample.pc = 0;
+        sample.context = MBED_PROFILER_CONTEXT_ISR | profiler_preempted_exception();
+    }
+
+    uint32_t head = profiler_head;
+    if (head - profiler_tail == MBED_PROFILER_SAMPLES) {
+        profiler_drop++;
+        return;
+    }
+    profiler_ring[head & (MBED_PROFILER_SAMPLES - 1)] = sample;
+    MBED_COMPILER_BARRIER();
+    profiler_head = head + 1;
+}
+
+void mbed_profiler_start(uint32_t frequency)
+{
+    MBED_ASSERT(frequency >= MBED_PROFILER_FREQUENCY_MIN && frequency <= MBED_PROFILER_FREQUENCY_MAX);
+    profiler_timer_init(frequency, mbed_profiler_sample_irq);
+}
+
+void mbed_profiler_stop(void)
+{
+    profiler_timer_free();
+}
+
+size_t mbed_profiler_read(mbed_profiler_sample_t *samples, size_t count)
+{
+    MBED_ASSERT(samples != NULL);
+    uint32_t tail = profiler_tail;
+    size_t n = 0;
+
+    while (n < count && tail != profiler_head) {
+        MBED_COMPILER_BARRIER();
+        samples[n++] = profiler_ring[tail & (MBED_PROFILER_SAMPLES - 1)];
+        tail++;
+    }
+    MBED_COMPILER_BARRIER();
+    profiler_tail = tail;
+    return n;
+}
+
+uint32_t mbed_profiler_dropped(void)
+{
+    return profiler_drop;
+}
+
+void mbed_profiler_print(void)
+{
+    mbed_profiler_sample_t samples[16];
+    size_t n;
+
+    while ((n = mbed_profiler_read(samples, sizeof(samples) / sizeof(samples[0]))) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            if (samples[i].context & MBED_PROFILER_CONTEXT_ISR) {
+                printf("prof: pc=0x%08lx ctx=irq%lu\r\n", (unsigned long)samples[i].pc,
+                       (unsigned long)(samples[i].context & ~MBED_PROFILER_CONTEXT_ISR));
+                continue;
+            }
+            const char *name = NULL;
+#ifdef MBED_CONF_RTOS_PRESENT
+            name = osThreadGetName((osThreadId_t)samples[i].context);
+#endif
+            if (name) {
+                printf("prof: pc=0x%08lx ctx=%s\r\n", (unsigned long)samples[i].pc, name);
+            } else {
+                printf("prof: pc=0x%08lx ctx=0x%08lx\r\n", (unsigned long)samples[i].pc,
+                       (unsigned long)samples[i].context);
+            }
+        }
+    }
+    printf("prof: dropped=%lu\r\n", (unsigned long)profiler_drop);
+}
+
+#else
+
+void mbed_profiler_start(uint32_t frequency)
+{
+    (void)frequency;
+}
+
+void mbed_profiler_stop(void)
+{
+}
+
+size_t mbed_profiler_read(mbed_profiler_sample_t *samples, size_t count)
+{
+    (void)samples;
+    (void)count;
+    return 0;
+}
+
+uint32_t mbed_profiler_dropped(void)
+{
+    return 0;
+}
+
+void mbed_profiler_print(void)
+{
+}
+
+void mbed_profiler_sample_irq(void)
+{
+}
+
+#endif // MBED_PROFILER_ENABLED
@@ -0,0 +1,98 @@
+
+/** \addtogroup platform */
+/** @{*/
+/**
+ * \defgroup platform_profiler Sampling profiler functions
+ * @{
+ */
+
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_PROFILER_H
+#define MBED_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef MBED_PROFILER_ENABLED
+#ifndef MBED_PROFILER_SAMPLES
+#define MBED_PROFILER_SAMPLES   256     /**< Ring buffer size in samples, must be a power of two */
+#endif
+#endif
+
+/** Flag set in mbed_profiler_sample_t::context when an interrupt handler was sampled;
+ *  the low bits then hold its exception number */
+#define MBED_PROFILER_CONTEXT_ISR   0x80000000UL
+
+/**
+ * struct mbed_profiler_sample_t definition
+ */
+typedef struct {
+    uint32_t pc;        /**< Interrupted program counter, 0 if not known (interrupt handlers) */
+    uint32_t context;   /**< Running thread ID, or MBED_PROFILER_CONTEXT_ISR | exception number */
+} mbed_profiler_sample_t;
+
+#define MBED_PROFILER_FREQUENCY_MIN     16          /**< Lowest sampling rate, a full period of the 16-bit timer at 1 MHz */
+#define MBED_PROFILER_FREQUENCY_MAX     500000      /**< Highest sampling rate, two counts of the timer at 1 MHz */
+
+/** Start sampling the program counter
+ *
+ *  @param frequency    Samples per second, MBED_PROFILER_FREQUENCY_MIN to
+ *                      MBED_PROFILER_FREQUENCY_MAX. Use a rate that is not a multiple
+ *                      of the 1 kHz RTOS tick, e.g. 997, to avoid aliasing with periodic work.
+ *
+ *  @note Samples are only taken while interrupts are enabled; time spent in critical
+ *        sections is credited to the instruction that leaves them.
+ */
+void mbed_profiler_start(uint32_t frequency);
+
+/** Stop sampling. Samples already taken stay available to mbed_profiler_read().
+ */
+void mbed_profiler_stop(void);
+
+/** Move samples out of the ring buffer, oldest first
+ *
+ *  @param samples  Array to fill
+ *  @param count    Capacity of the array
+ *  @return         Number of samples copied
+ */
+size_t mbed_profiler_read(mbed_profiler_sample_t *samples, size_t count);
+
+/** Number of samples lost because the ring buffer was full
+ */
+uint32_t mbed_profiler_dropped(void);
+
+/** Drain the ring buffer as "prof:" lines on stdout, for tools/profile_symbolize.py
+ */
+void mbed_profiler_print(void);
+
+/** Take one sample. Called by the profiler timer interrupt.
+ */
+void mbed_profiler_sample_irq(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/** @}*/
+
+/** @}*/
@@ -29,6 +29,7 @@
 #include "platform/mbed_poll.h"
 #include "platform/PlatformMutex.h"
 #include "drivers/UARTSerial.h"
+#include "platform/BufferedConsole.h"
 #include "us_ticker_api.h"
 #include "lp_ticker_api.h"
 #include <stdlib.h>
@@ -152,9 +153,15 @@ public:
         return 0;
     }
     virtual short poll(short events) const;
+
+private:
+    static void irq_handler(uint32_t id, SerialIrq event);
+
+    bool _irq;
 };
 
-DirectSerial::DirectSerial(PinName tx, PinName rx, int baud) {
+DirectSerial::DirectSerial(PinName tx, PinName rx, int baud) : _irq(false) {
+    // A Serial that already owns the UART also owns its interrupt
     if (stdio_uart_inited) return;
     serial_init(&stdio_uart, tx, rx);
     serial_baud(&stdio_uart, baud);
@@ -165,6 +172,17 @@ DirectSerial::DirectSerial(PinName tx, PinName rx, int baud) {
 #elif CONSOLE_FLOWCONTROL == CONSOLE_FLOWCONTROL_RTSCTS
     serial_set_flow_control(&stdio_uart, FlowControlRTSCTS, STDIO_UART_RTS, STDIO_UART_CTS);
 #endif
+#if MBED_CONF_RTOS_PRESENT
+    serial_irq_handler(&stdio_uart, DirectSerial::irq_handler, (uint32_t) this);
+    _irq = true;
+#endif
+}
+
+/* Armed by poll() for one event only: the UART keeps the character for
+ * read(), so the interrupt would otherwise fire until it is read */
+void DirectSerial::irq_handler(uint32_t id, SerialIrq event) {
+    serial_irq_set(&stdio_uart, event, 0);
+    poll_change();
 }
 
 ssize_t DirectSerial::write(const void *buffer, size_t size) {
@@ -192,6 +210,15 @@ short DirectSerial::poll(short events) const {
     if ((events & POLLOUT) && serial_writable(&stdio_uart)) {
         revents |= POLLOUT;
     }
+    if (_irq && !revents) {
+        // A blocked poll() is woken by the interrupt instead of a rescan
+        if (events & POLLIN) {
+            serial_irq_set(&stdio_uart, RxIrq, 1);
+        }
+        if (events & POLLOUT) {
+            serial_irq_set(&stdio_uart, TxIrq, 1);
+        }
+    }
     return revents;
 }
 #endif
@@ -220,6 +247,27 @@ ssize_t Sink::read(void *buffer, size_t size) {
 }
 
 
+#if MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE
+static BufferedConsole *buffered_console;
+
+extern "C" void mbed_stdio_flush_from_error(void) {
+    if (buffered_console) {
+        buffered_console->flush_from_error();
+    }
+}
+
+/* stdout and stderr share the buffer when they share a console, so that
+ * their output stays in order */
+static FileHandle* get_buffered_console(FileHandle *fh) {
+    static BufferedConsole console(fh);
+    buffered_console = &console;
+    return console.console() == fh ? &console : fh;
+}
+#else
+extern "C" void mbed_stdio_flush_from_error(void) {
+}
+#endif
+
 MBED_WEAK FileHandle* mbed::mbed_target_override_console(int fd)
 {
     return NULL;
@@ -254,14 +302,18 @@ static FileHandle* default_console()
 /* Locate the default console for stdout, stdin, stderr */
 static FileHandle* get_console(int fd) {
     FileHandle *fh = mbed_override_console(fd);
-    if (fh) {
-        return fh;
+    if (!fh) {
+        fh = mbed_target_override_console(fd);
+    }
+    if (!fh) {
+        fh = default_console();
     }
-    fh = mbed_target_override_console(fd);
-    if (fh) {
-        return fh;
+#if MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE
+    if (fd != STDIN_FILENO) {
+        return get_buffered_console(fh);
     }
-    return default_console();
+#endif
+    return fh;
 }
 
 /* Deal with the fact C library may not _open descriptors 0, 1, 2 - auto bind */
@@ -1166,6 +1218,9 @@ extern "C" void exit(int return_code) {
 #if MBED_CONF_PLATFORM_STDIO_FLUSH_AT_EXIT
     fflush(stdout);
     fflush(stderr);
+#if MBED_CONF_PLATFORM_STDIO_BUFFER_SIZE
+    fsync(STDOUT_FILENO);
+#endif
 #endif
 #endif
 
@@ -16,6 +16,156 @@
 #warning CPU statistics are not supported without low power timer support.
 #endif
 
+#if defined(MBED_THREAD_CPU_STATS_ENABLED) && defined(MBED_CONF_RTOS_PRESENT)
+#include "rt_OsEventObserver.h"
+#include "rtx_os.h"
+#include "hal/us_ticker_api.h"
+#include "platform/mbed_critical.h"
+
+typedef struct {
+    osThreadId_t id;
+    us_timestamp_t cpu_time;
+    uint32_t switch_count;
+    us_timestamp_t window_cpu_time;     // cpu_time at the start of the current window
+    uint32_t window_switch_count;       // switch_count at the start of the current window
+} thread_cpu_slot_t;
+
+static thread_cpu_slot_t thread_cpu_slots[MBED_THREAD_CPU_STATS_MAX_THREADS];
+static thread_cpu_slot_t *thread_cpu_current;
+static us_timestamp_t thread_cpu_last_switch;
+static us_timestamp_t thread_cpu_window_start;
+
+/* Charge the time since the last switch to the running thread. Called with interrupts masked. */
+static us_timestamp_t thread_cpu_charge(void)
+{
+    us_timestamp_t now = ticker_read_us(get_us_ticker_data());
+    if (thread_cpu_current) {
+        thread_cpu_current->cpu_time += now - thread_cpu_last_switch;
+    }
+    thread_cpu_last_switch = now;
+    return now;
+}
+
+/* State of a thread, as osThreadGetState() reports it. The observer runs in the SVC
+ * handler, where osThreadGetState() only returns osThreadError, so the thread control
+ * block is read directly. */
+static osThreadState_t thread_cpu_state(osThreadId_t id)
+{
+    const osRtxThread_t *thread = (const osRtxThread_t *)id;
+    if (thread->id != osRtxIdThread) {
+        return osThreadError;
+    }
+    return (osThreadState_t)(thread->state & osRtxThreadStateMask);
+}
+
+/* Free a slot. Called with interrupts masked or from the SVC handler. */
+static void thread_cpu_release(thread_cpu_slot_t *slot)
+{
+    if (slot == thread_cpu_current) {
+        thread_cpu_charge();
+        thread_cpu_current = NULL;
+    }
+    slot->id = NULL;
+}
+
+/* RTX only reports the end of threads that are terminated by osThreadTerminate(), not
+ * of those returning or calling osThreadExit(), so slots of ended threads are freed
+ * here. Called with interrupts masked or from the SVC handler. */
+static void thread_cpu_reap(void)
+{
+    for (unsigned i = 0; i < MBED_THREAD_CPU_STATS_MAX_THREADS; i++) {
+        if (thread_cpu_slots[i].id == NULL) {
+            continue;
+        }
+        osRtxThread_t *thread = (osRtxThread_t *)thread_cpu_slots[i].id;
+        osThreadState_t state = thread_cpu_state(thread);
+        if (state == osThreadTerminated || state == osThreadError || state == osThreadInactive) {
+            if (thread->id == osRtxIdThread) {
+                // A later osThreadTerminate() of a joinable thread must not free the slot again
+                thread->context = NULL;
+            }
+            thread_cpu_release(&thread_cpu_slots[i]);
+        }
+    }
+}
+
+static void *thread_cpu_create(int thread_id, void *context)
+{
+    (void)context;
+    // Also called when the creation failed
+    if (thread_id == 0) {
+        return NULL;
+    }
+    thread_cpu_reap();
+    for (unsigned i = 0; i < MBED_THREAD_CPU_STATS_MAX_THREADS; i++) {
+        // A thread that ended unreported and whose control block is reused
+        if (thread_cpu_slots[i].id == (osThreadId_t)thread_id) {
+            thread_cpu_release(&thread_cpu_slots[i]);
+        }
+    }
+    for (unsigned i = 0; i < MBED_THREAD_CPU_STATS_MAX_THREADS; i++) {
+        if (thread_cpu_slots[i].id == NULL) {
+            memset(&thread_cpu_slots[i], 0, sizeof(thread_cpu_slot_t));
+            thread_cpu_slots[i].id = (osThreadId_t)thread_id;
+            return &thread_cpu_slots[i];
+        }
+    }
+    // Out of slots: the thread runs untracked
+    return NULL;
+}
+
+static void thread_cpu_destroy(void *context)
+{
+    thread_cpu_slot_t *slot = (thread_cpu_slot_t *)context;
+    if (slot) {
+        thread_cpu_release(slot);
+    }
+}
+
+static void thread_cpu_switch(void *context)
+{
+    thread_cpu_slot_t *slot = (thread_cpu_slot_t *)context;
+    // RTX reports the same switch both when it is decided and when it is performed
+    if (slot == thread_cpu_current) {
+        return;
+    }
+    thread_cpu_charge();
+    thread_cpu_current = slot;
+    if (slot) {
+        slot->switch_count++;
+    }
+}
+
+static const OsEventObserver thread_cpu_observer = {
+    .version = 0,
+    .pre_start = NULL,
+    .thread_create = thread_cpu_create,
+    .thread_destroy = thread_cpu_destroy,
+    .thread_switch = thread_cpu_switch,
+};
+
+void mbed_stats_thread_cpu_init(void)
+{
+    thread_cpu_window_start = ticker_read_us(get_us_ticker_data());
+    thread_cpu_last_switch = thread_cpu_window_start;
+    osRegisterForOsEvents(&thread_cpu_observer);
+}
+
+static const thread_cpu_slot_t *thread_cpu_find(osThreadId_t id)
+{
+    for (unsigned i = 0; i < MBED_THREAD_CPU_STATS_MAX_THREADS; i++) {
+        if (thread_cpu_slots[i].id == id) {
+            return &thread_cpu_slots[i];
+        }
+    }
+    return NULL;
+}
+#else
+void mbed_stats_thread_cpu_init(void)
+{
+}
+#endif
+
 void mbed_stats_cpu_get(mbed_stats_cpu_t *stats)
 {
     MBED_ASSERT(stats != NULL);
@@ -101,6 +251,11 @@ size_t mbed_stats_thread_get_each(mbed_stats_thread_t *stats, size_t count)
     MBED_ASSERT(threads != NULL);
 
     osKernelLock();
+#if defined(MBED_THREAD_CPU_STATS_ENABLED)
+    core_util_critical_section_enter();
+    thread_cpu_reap();
+    core_util_critical_section_exit();
+#endif
     count = osThreadEnumerate(threads, count);
 
     for (i = 0; i < count; i++) {
@@ -110,6 +265,16 @@ size_t mbed_stats_thread_get_each(mbed_stats_thread_t *stats, size_t count)
         stats[i].stack_size = osThreadGetStackSize(threads[i]);
         stats[i].stack_space = osThreadGetStackSpace(threads[i]);
         stats[i].name = osThreadGetName(threads[i]);
+#if defined(MBED_THREAD_CPU_STATS_ENABLED)
+        core_util_critical_section_enter();
+        thread_cpu_charge();
+        const thread_cpu_slot_t *slot = thread_cpu_find(threads[i]);
+        if (slot) {
+            stats[i].cpu_time = slot->cpu_time;
+            stats[i].switch_count = slot->switch_count;
+        }
+        core_util_critical_section_exit();
+#endif
     }
     osKernelUnlock();
     free(threads);
@@ -117,6 +282,51 @@ size_t mbed_stats_thread_get_each(mbed_stats_thread_t *stats, size_t count)
     return i;
 }
 
+size_t mbed_stats_thread_cpu_get_each(mbed_stats_thread_cpu_t *stats, size_t count, us_timestamp_t *window)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, count * sizeof(mbed_stats_thread_cpu_t));
+    size_t n = 0;
+    us_timestamp_t length = 0;
+
+#if defined(MBED_THREAD_CPU_STATS_ENABLED) && defined(MBED_CONF_RTOS_PRESENT)
+    osKernelLock();
+    core_util_critical_section_enter();
+    thread_cpu_reap();
+    us_timestamp_t now = thread_cpu_charge();
+    length = now - thread_cpu_window_start;
+    thread_cpu_window_start = now;
+
+    for (unsigned i = 0; i < MBED_THREAD_CPU_STATS_MAX_THREADS; i++) {
+        thread_cpu_slot_t *slot = &thread_cpu_slots[i];
+        if (slot->id == NULL) {
+            continue;
+        }
+        if (n < count) {
+            stats[n].id = (uint32_t)slot->id;
+            stats[n].cpu_time = slot->cpu_time - slot->window_cpu_time;
+            stats[n].switch_count = slot->switch_count - slot->window_switch_count;
+            stats[n].load = length ? (uint32_t)((stats[n].cpu_time * 1000) / length) : 0;
+            n++;
+        }
+        slot->window_cpu_time = slot->cpu_time;
+        slot->window_switch_count = slot->switch_count;
+    }
+    core_util_critical_section_exit();
+
+    // Names are fetched outside the critical section, threads cannot go away while the kernel is locked
+    for (size_t i = 0; i < n; i++) {
+        stats[i].name = osThreadGetName((osThreadId_t)stats[i].id);
+    }
+    osKernelUnlock();
+#endif
+
+    if (window) {
+        *window = length;
+    }
+    return n;
+}
+
 void mbed_stats_sys_get(mbed_stats_sys_t *stats)
 {
     MBED_ASSERT(stats != NULL);
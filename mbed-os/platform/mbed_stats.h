@@ -36,6 +36,20 @@ extern "C" {
 #define MBED_CPU_STATS_ENABLED      1
 #define MBED_HEAP_STATS_ENABLED     1
 #define MBED_THREAD_STATS_ENABLED   1
+#define MBED_THREAD_CPU_STATS_ENABLED 1
+#define MBED_SLEEP_LOCK_STATS_ENABLED 1
+#endif
+
+#ifdef MBED_THREAD_CPU_STATS_ENABLED
+#ifndef MBED_THREAD_CPU_STATS_MAX_THREADS
+#define MBED_THREAD_CPU_STATS_MAX_THREADS 8   /**< Number of threads whose CPU time can be tracked at once; threads created beyond it are not tracked */
+#endif
+#endif
+
+#ifdef MBED_SLEEP_LOCK_STATS_ENABLED
+#ifndef MBED_SLEEP_LOCK_STATS_MAX_HOLDERS
+#define MBED_SLEEP_LOCK_STATS_MAX_HOLDERS 10  /**< Number of modules whose deep sleep locks can be tracked at once */
+#endif
 #endif
 
 /**
@@ -112,6 +126,8 @@ typedef struct {
     uint32_t stack_size;        /**< Thread Stack Size */
     uint32_t stack_space;       /**< Thread remaining stack size */
     const char   *name;         /**< Thread Object name */
+    us_timestamp_t cpu_time;    /**< Time the thread has been running since it was created (MBED_THREAD_CPU_STATS_ENABLED only) */
+    uint32_t switch_count;      /**< Number of times the thread has been switched in (MBED_THREAD_CPU_STATS_ENABLED only) */
 } mbed_stats_thread_t;
 
 /**
@@ -124,6 +140,85 @@ typedef struct {
  */
 size_t mbed_stats_thread_get_each(mbed_stats_thread_t *stats, size_t count);
 
+/**
+ * struct mbed_stats_thread_cpu_t definition
+ */
+typedef struct {
+    uint32_t id;                /**< Thread Object Identifier */
+    const char   *name;         /**< Thread Object name */
+    us_timestamp_t cpu_time;    /**< Time the thread was running during the window */
+    uint32_t switch_count;      /**< Number of times the thread was switched in during the window */
+    uint32_t load;              /**< Share of the window spent in the thread, in tenths of a percent */
+} mbed_stats_thread_cpu_t;
+
+/**
+ *  Fill the passed array with the CPU usage of each tracked thread since the previous call,
+ *  in the manner of top. The first call measures from boot. Each call starts a new window.
+ *
+ *  @param stats    A pointer to an array of mbed_stats_thread_cpu_t structures to fill
+ *  @param count    The number of mbed_stats_thread_cpu_t structures in the provided array
+ *  @param window   If not NULL, receives the length of the window in microseconds
+ *  @return         The number of mbed_stats_thread_cpu_t structures that have been filled
+ *
+ *  @note Time is measured with the us ticker, which does not run in deep sleep; deep sleep
+ *        is therefore not attributed to any thread, including the idle thread.
+ *  @note At most MBED_THREAD_CPU_STATS_MAX_THREADS threads are tracked at once. Threads
+ *        created while all slots are in use are never tracked, even after slots are freed;
+ *        their time is not attributed to any thread.
+ */
+size_t mbed_stats_thread_cpu_get_each(mbed_stats_thread_cpu_t *stats, size_t count, us_timestamp_t *window);
+
+/**
+ *  Start per-thread CPU time accounting. Called by the boot code before the first thread
+ *  is created when MBED_THREAD_CPU_STATS_ENABLED is defined.
+ */
+void mbed_stats_thread_cpu_init(void);
+
+/**
+ * struct mbed_stats_sleep_lock_t definition
+ */
+typedef struct {
+    const char *identifier;         /**< File that took the lock; a header and source of the same name count as one */
+    uint32_t line;                  /**< Line of the latest lock */
+    uint32_t held;                  /**< Locks held now */
+    uint32_t lock_count;            /**< Number of times the lock was taken */
+    us_timestamp_t held_time;       /**< Time at least one lock was held, including the current hold */
+    us_timestamp_t max_held_time;   /**< Longest single hold */
+    uint32_t refused_count;         /**< Number of times deep sleep was refused while the lock was held */
+    us_timestamp_t blocked_time;    /**< Time spent in sleep instead of deep sleep while the lock was held */
+} mbed_stats_sleep_lock_t;
+
+/**
+ * struct mbed_stats_sleep_t definition
+ */
+typedef struct {
+    uint32_t sleep_count;           /**< Number of times the sleep manager slept */
+    uint32_t deep_sleep_count;      /**< Number of those that were deep sleep */
+    uint32_t refused_count;         /**< Number of those where deep sleep was refused because a lock was held */
+    uint32_t lock_count;            /**< Deep sleep locks held now, tracked or not */
+    uint32_t untracked_count;       /**< Locks not tracked because the table was full */
+    uint32_t unmatched_count;       /**< Unlocks from a file that holds no lock */
+} mbed_stats_sleep_t;
+
+/**
+ *  Fill the passed in structure with sleep manager statistics.
+ *
+ *  @param stats    A pointer to the mbed_stats_sleep_t structure to fill
+ */
+void mbed_stats_sleep_get(mbed_stats_sleep_t *stats);
+
+/**
+ *  Fill the passed array of stat structures with the deep sleep lock holders, each file that
+ *  has taken a lock through sleep_manager_lock_deep_sleep() since boot.
+ *
+ *  @param stats    A pointer to an array of mbed_stats_sleep_lock_t structures to fill
+ *  @param count    The number of mbed_stats_sleep_lock_t structures in the provided array
+ *  @return         The number of mbed_stats_sleep_lock_t structures that have been filled
+ *
+ *  @note Times are measured with the us ticker, which runs while a lock is held and in sleep.
+ */
+size_t mbed_stats_sleep_lock_get_each(mbed_stats_sleep_lock_t *stats, size_t count);
+
 /**
  * enum mbed_compiler_id_t definition
  */
@@ -259,6 +259,30 @@
 #endif
 #endif
 
+/** MBED_COMPILER_BARRIER
+ *  Stop the compiler from moving memory accesses across this point.
+ *  Sufficient to order a single-producer/single-consumer handoff between
+ *  a thread and an interrupt on a single-core Cortex-M.
+ *
+ *  @code
+ *  #include "mbed_toolchain.h"
+ *
+ *  void publish(uint32_t index) {
+ *      MBED_COMPILER_BARRIER();
+ *      _head = index;
+ *  }
+ *  @endcode
+ */
+#ifndef MBED_COMPILER_BARRIER
+#if defined(__CC_ARM)
+#define MBED_COMPILER_BARRIER() __memory_changed()
+#elif defined(__GNUC__) || defined(__clang__) || defined(__ICCARM__)
+#define MBED_COMPILER_BARRIER() __asm volatile("" : : : "memory")
+#else
+#define MBED_COMPILER_BARRIER()
+#endif
+#endif
+
 /** MBED_DEPRECATED("message string")
  *  Mark a function declaration as deprecated, if it used then a warning will be
  *  issued by the compiler possibly including the provided message. Note that not
@@ -0,0 +1,256 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef RING_CHANNEL_H
+#define RING_CHANNEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "rtos/EventFlags.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_toolchain.h"
+#include "platform/NonCopyable.h"
+
+namespace rtos {
+/** \addtogroup rtos */
+/** @{*/
+/**
+ * \defgroup rtos_RingChannel RingChannel class
+ * @{
+ */
+
+/** The RingChannel class passes variable-length records from exactly one
+ producer to exactly one consumer without copying and without entering the kernel.
+
+ The producer asks for space with reserve(), writes the record in place and
+ publishes it with commit(). The consumer looks at the oldest record with
+ peek() and hands the space back with release(). Each record lives in one
+ contiguous, word aligned block of the ring, so it can be filled by memcpy, DMA
+ or a parser directly.
+
+ Optionally an EventFlags object can be attached; the producer then sets the
+ given flag only when the channel goes from empty to non-empty, so a sleeping
+ consumer is woken once per burst rather than once per record.
+
+  @tparam  ring_sz  size of the ring in bytes; must be a power of two.
+
+ @note
+ Synchronization level: one producer and one consumer, each of which may be a
+ thread or an interrupt handler. Several producers or several consumers must
+ serialize among themselves.
+
+ @note
+ Memory considerations: the ring storage is part of the object, no RTOS
+ objects are created by the channel itself.
+*/
+template<uint32_t ring_sz>
+class RingChannel : private mbed::NonCopyable<RingChannel<ring_sz> > {
+public:
+    /** Create an empty RingChannel.
+
+      @param   flags     EventFlags to set on an empty to non-empty transition, or NULL. (default: NULL)
+      @param   flag      flag bit to set in @a flags. (default: 1)
+
+      @note You may call this function from ISR context.
+    */
+    RingChannel(EventFlags *flags = NULL, uint32_t flag = 1)
+        : _head(0), _tail(0), _reserved(0), _skip(0), _flags(flags), _flag(flag) {
+        MBED_STATIC_ASSERT((ring_sz & (ring_sz - 1)) == 0, "ring_sz must be a power of two");
+        MBED_STATIC_ASSERT(ring_sz >= 2 * sizeof(uint32_t), "ring_sz too small");
+    }
+
+    /** Largest payload a single record may carry.
+
+      @note You may call this function from ISR context.
+    */
+    static uint32_t max_record_size() {
+        return ring_sz / 2 - sizeof(uint32_t);
+    }
+
+    /** Check if the channel holds no committed records.
+      @return  True if the channel is empty, false if not.
+
+      @note You may call this function from ISR context.
+    */
+    bool empty() const {
+        return _head == _tail;
+    }
+
+    /** Reserve contiguous space for the next record. Producer only.
+      @param   size      number of payload bytes needed.
+      @return  pointer to @a size writable bytes, or NULL if there is not enough free space.
+
+      @note A second reserve() before commit() replaces the first reservation.
+      @note You may call this function from ISR context.
+    */
+    void *reserve(uint32_t size) {
+        if (size > max_record_size()) {
+            return NULL;
+        }
+        uint32_t need = record_size(size);
+        uint32_t head = _head;
+        uint32_t offset = head & (ring_sz - 1);
+        uint32_t skip = 0;
+        if (offset + need > ring_sz) {
+            // Record would straddle the end of the ring: waste the tail end
+            skip = ring_sz - offset;
+        }
+        if (ring_sz - (head - _tail) < skip + need) {
+            return NULL;
+        }
+        _reserved = size;
+        _skip = skip;
+        return data(head + skip + sizeof(uint32_t));
+    }
+
+    /** Publish the record written into the last reservation. Producer only.
+      @param   size      number of payload bytes actually written; must not exceed the reserved size.
+
+      @note You may call this function from ISR context.
+    */
+    void commit(uint32_t size) {
+        MBED_ASSERT(size <= _reserved);
+        uint32_t head = _head;
+        uint32_t start = head;
+        if (_skip) {
+            header(head) = WRAP_MARKER;
+            head += _skip;
+        }
+        header(head) = size;
+        head += record_size(size);
+        _reserved = 0;
+        _skip = 0;
+
+        MBED_COMPILER_BARRIER();
+        _head = head;
+        MBED_COMPILER_BARRIER();
+
+        // Wake only if the consumer had drained everything before this record
+        if (_flags && _tail == start) {
+            _flags->set(_flag);
+        }
+    }
+
+    /** Copy a record into the channel. Producer only.
+      @param   buffer    payload to copy.
+      @param   size      payload size in bytes.
+      @return  True if the record was queued, false if there was not enough space.
+
+      @note You may call this function from ISR context.
+    */
+    bool put(const void *buffer, uint32_t size) {
+        void *dst = reserve(size);
+        if (!dst) {
+            return false;
+        }
+        memcpy(dst, buffer, size);
+        commit(size);
+        return true;
+    }
+
+    /** Look at the oldest record without removing it. Consumer only.
+      @param   size      receives the payload size of the record.
+      @return  pointer to the record payload, or NULL if the channel is empty.
+
+      @note You may call this function from ISR context.
+    */
+    const void *peek(uint32_t &size) {
+        uint32_t tail = _tail;
+        if (_head == tail) {
+            return NULL;
+        }
+        MBED_COMPILER_BARRIER();
+        uint32_t len = header(tail);
+        if (len == WRAP_MARKER) {
+            tail += ring_sz - (tail & (ring_sz - 1));
+            _tail = tail;
+            len = header(tail);
+        }
+        size = len;
+        return data(tail + sizeof(uint32_t));
+    }
+
+    /** Wait for a record and look at it without removing it. Consumer only.
+
+      Requires an EventFlags object to have been passed to the constructor.
+
+      @param   size      receives the payload size of the record.
+      @param   millisec  timeout value or 0 in case of no time-out.
+      @return  pointer to the record payload, or NULL if nothing arrived within the timeout.
+
+      @note You cannot call this function from ISR context.
+    */
+    const void *peek(uint32_t &size, uint32_t millisec) {
+        MBED_ASSERT(_flags);
+        const void *record = peek(size);
+        while (!record) {
+            uint32_t ret = _flags->wait_any(_flag, millisec);
+            record = peek(size);
+            if (ret & osFlagsError) {
+                break;
+            }
+        }
+        return record;
+    }
+
+    /** Drop the record returned by the last peek(). Consumer only.
+
+      @note You may call this function from ISR context.
+    */
+    void release() {
+        uint32_t tail = _tail;
+        MBED_ASSERT(_head != tail);
+        uint32_t len = header(tail);
+        MBED_COMPILER_BARRIER();
+        _tail = tail + record_size(len);
+    }
+
+private:
+    static const uint32_t WRAP_MARKER = 0xFFFFFFFFUL;
+
+    static uint32_t record_size(uint32_t size) {
+        return sizeof(uint32_t) + ((size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1));
+    }
+
+    uint32_t &header(uint32_t index) {
+        return _buf[(index & (ring_sz - 1)) / sizeof(uint32_t)];
+    }
+
+    uint8_t *data(uint32_t index) {
+        return reinterpret_cast<uint8_t *>(_buf) + (index & (ring_sz - 1));
+    }
+
+    uint32_t _buf[ring_sz / sizeof(uint32_t)];
+    volatile uint32_t _head;
+    volatile uint32_t _tail;
+    uint32_t _reserved;
+    uint32_t _skip;
+    EventFlags *_flags;
+    uint32_t _flag;
+};
+
+/** @}*/
+/** @}*/
+
+}
+#endif
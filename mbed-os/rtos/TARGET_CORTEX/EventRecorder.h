@@ -0,0 +1,69 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef MBED_EVENT_RECORDER_H
+#define MBED_EVENT_RECORDER_H
+
+/* Subset of the Keil::Compiler:Event Recorder interface used by rtx_evr.c,
+ * backed by the RAM ring in mbed_rtx_evr.c. Only used when
+ * MBED_EVENT_RECORDER_ENABLED defines RTE_Compiler_EventRecorder. */
+
+#include <stdint.h>
+#include "rtos/rtos_event_recorder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EventLevelError     0x00000U    ///< Run-time error
+#define EventLevelAPI       0x10000U    ///< API function call
+#define EventLevelOp        0x20000U    ///< Internal operation
+#define EventLevelDetail    0x30000U    ///< Additional detail information
+
+#define EventRecordError    RTOS_EVENT_LEVEL_ERROR
+#define EventRecordAPI      RTOS_EVENT_LEVEL_API
+#define EventRecordOp       RTOS_EVENT_LEVEL_OP
+#define EventRecordDetail   RTOS_EVENT_LEVEL_DETAIL
+#define EventRecordAll      RTOS_EVENT_LEVEL_ALL
+
+/// Event ID from level, component number and message number
+#define EventID(level, comp_no, msg_no) \
+    (((level) & 0x30000U) | (((comp_no) & 0xFFU) << 8) | ((msg_no) & 0xFFU))
+
+#define EventRecorderEnable(event_level, comp_start, comp_end) \
+    rtos_event_recorder_enable((event_level), (comp_start), (comp_end))
+#define EventRecorderDisable(event_level, comp_start, comp_end) \
+    rtos_event_recorder_disable((event_level), (comp_start), (comp_end))
+
+/// Record an event with two 32-bit values; returns 1 if recorded
+uint32_t EventRecord2(uint32_t id, uint32_t val1, uint32_t val2);
+
+/// Record an event with four 32-bit values in two consecutive records
+uint32_t EventRecord4(uint32_t id, uint32_t val1, uint32_t val2, uint32_t val3, uint32_t val4);
+
+/// Record the length and the first word of a data block
+uint32_t EventRecordData(uint32_t id, const void *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -169,6 +169,8 @@
 #include "mbed_toolchain.h"
 #include "mbed_error.h"
 #include "mbed_critical.h"
+#include "mbed_stats.h"
+#include "rtos_event_recorder.h"
 #if defined(__IAR_SYSTEMS_ICC__ ) && (__VER__ >= 8000000)
 #include <DLib_Threads.h>
 #endif
@@ -315,6 +317,13 @@ WEAK void mbed_sdk_init(void) {
 
 void mbed_start_main(void)
 {
+#if defined(MBED_THREAD_CPU_STATS_ENABLED)
+    /* Must observe the kernel before any thread exists */
+    mbed_stats_thread_cpu_init();
+#endif
+#if defined(MBED_EVENT_RECORDER_ENABLED)
+    rtos_event_recorder_init();
+#endif
     _main_thread_attr.stack_mem = _main_stack;
     _main_thread_attr.stack_size = sizeof(_main_stack);
     _main_thread_attr.cb_size = sizeof(_main_obj);
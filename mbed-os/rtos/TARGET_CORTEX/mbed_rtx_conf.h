@@ -61,6 +61,15 @@
 #define OS_STACK_WATERMARK          1
 #endif
 
+#if !defined(OS_STACK_WATERMARK) && defined(MBED_STACK_MONITOR_ENABLED)
+#define OS_STACK_WATERMARK          1
+#endif
+
+/* Route the rtx_evr.c event hooks to the ring buffer in mbed_rtx_evr.c */
+#if !defined(RTE_Compiler_EventRecorder) && defined(MBED_EVENT_RECORDER_ENABLED)
+#define RTE_Compiler_EventRecorder
+#endif
+
 /* Run threads unprivileged when uVisor is enabled. */
 #if defined(FEATURE_UVISOR) && defined(TARGET_UVISOR_SUPPORTED)
 # define OS_PRIVILEGE_MODE           0
@@ -0,0 +1,243 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdio.h>
+
+#include "rtos/rtos_event_recorder.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_critical.h"
+#include "platform/mbed_toolchain.h"
+#include "hal/us_ticker_api.h"
+#include "cmsis_os2.h"
+
+#if defined(MBED_EVENT_RECORDER_ENABLED)
+
+#include "EventRecorder.h"
+
+MBED_STATIC_ASSERT((MBED_EVENT_RECORDER_RECORDS & (MBED_EVENT_RECORDER_RECORDS - 1)) == 0,
+                   "MBED_EVENT_RECORDER_RECORDS must be a power of two");
+
+/* Bits 24-30 of a stored ID tag the record with the lap of the ring it was
+ * written in, so that the reader can tell a finished record from a slot that
+ * has been claimed but not written yet. Lap 0 uses tag 1: zeroed RAM never
+ * looks like a valid record. */
+#define EVR_TAG_SHIFT   24
+#define EVR_TAG_MASK    0x7F000000UL
+
+static rtos_event_record_t evr_ring[MBED_EVENT_RECORDER_RECORDS];
+static volatile uint32_t evr_head;          // next sequence number, claimed atomically by writers
+static uint32_t evr_tail;                   // written by the reader only
+static uint32_t evr_lost;
+
+/* RTOS_EVENT_LEVEL_* bits NOT recorded, per component number */
+static volatile uint8_t evr_disabled[256];
+
+static inline uint32_t evr_tag(uint32_t seq)
+{
+    return ((seq / MBED_EVENT_RECORDER_RECORDS + 1) << EVR_TAG_SHIFT) & EVR_TAG_MASK;
+}
+
+static inline int evr_enabled(uint32_t id)
+{
+    return !(evr_disabled[(id >> 8) & 0xFFU] & (1U << ((id >> 16) & 3U)));
+}
+
+static inline void evr_put(uint32_t seq, uint32_t id, uint32_t timestamp, uint32_t val1, uint32_t val2)
+{
+    rtos_event_record_t *record = &evr_ring[seq & (MBED_EVENT_RECORDER_RECORDS - 1)];
+
+    record->timestamp = timestamp;
+    record->val1 = val1;
+    record->val2 = val2;
+    MBED_COMPILER_BARRIER();
+    // Publishing the ID with the current tag completes the record
+    record->id = id | evr_tag(seq);
+}
+
+uint32_t EventRecord2(uint32_t id, uint32_t val1, uint32_t val2)
+{
+    if (!evr_enabled(id)) {
+        return 0U;
+    }
+    uint32_t seq = core_util_atomic_incr_u32(&evr_head, 1) - 1;
+    evr_put(seq, id & RTOS_EVENT_RECORD_ID_MASK, us_ticker_read(), val1, val2);
+    return 1U;
+}
+
+uint32_t EventRecord4(uint32_t id, uint32_t val1, uint32_t val2, uint32_t val3, uint32_t val4)
+{
+    if (!evr_enabled(id)) {
+        return 0U;
+    }
+    uint32_t seq = core_util_atomic_incr_u32(&evr_head, 2) - 2;
+    uint32_t timestamp = us_ticker_read();
+    id &= RTOS_EVENT_RECORD_ID_MASK;
+    evr_put(seq, id, timestamp, val1, val2);
+    evr_put(seq + 1, id | RTOS_EVENT_RECORD_CONTINUED, timestamp, val3, val4);
+    return 1U;
+}
+
+uint32_t EventRecordData(uint32_t id, const void *data, uint32_t len)
+{
+    // Records stay fixed size: keep the length and the first word only
+    uint32_t first = 0;
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (uint32_t i = 0; i < len && i < sizeof(first); i++) {
+        first |= (uint32_t)bytes[i] << (8 * i);
+    }
+    return EventRecord2(id, len, first);
+}
+
+void rtos_event_recorder_init(void)
+{
+    // Start the timer through the ticker layer once; events then read the
+    // counter directly, without the 64-bit software extension
+    (void)ticker_read(get_us_ticker_data());
+    rtos_event_recorder_disable(RTOS_EVENT_LEVEL_ALL, 0x00U, 0xFFU);
+    rtos_event_recorder_enable(MBED_EVENT_RECORDER_LEVELS, 0x00U, 0xFFU);
+}
+
+void rtos_event_recorder_enable(uint32_t levels, uint32_t comp_start, uint32_t comp_end)
+{
+    MBED_ASSERT(comp_start <= comp_end && comp_end <= 0xFFU);
+    for (uint32_t comp = comp_start; comp <= comp_end; comp++) {
+        evr_disabled[comp] &= (uint8_t)~levels;
+    }
+}
+
+void rtos_event_recorder_disable(uint32_t levels, uint32_t comp_start, uint32_t comp_end)
+{
+    MBED_ASSERT(comp_start <= comp_end && comp_end <= 0xFFU);
+    for (uint32_t comp = comp_start; comp <= comp_end; comp++) {
+        evr_disabled[comp] |= (uint8_t)(levels & RTOS_EVENT_LEVEL_ALL);
+    }
+}
+
+/* Copy finished records up to sequence number end */
+static size_t evr_read(rtos_event_record_t *records, size_t count, uint32_t end)
+{
+    size_t n = 0;
+
+    while (n < count) {
+        uint32_t head = evr_head;
+        if (head - evr_tail > MBED_EVENT_RECORDER_RECORDS) {
+            // Writers went round the ring: skip what has been overwritten
+            evr_lost += head - evr_tail - MBED_EVENT_RECORDER_RECORDS;
+            evr_tail = head - MBED_EVENT_RECORDER_RECORDS;
+        }
+        if ((int32_t)(end - evr_tail) <= 0) {
+            break;
+        }
+        const rtos_event_record_t *record = &evr_ring[evr_tail & (MBED_EVENT_RECORDER_RECORDS - 1)];
+        uint32_t id = record->id;
+        if ((id & EVR_TAG_MASK) != evr_tag(evr_tail)) {
+            // Claimed by a writer that has not finished yet
+            break;
+        }
+        MBED_COMPILER_BARRIER();
+        records[n] = *record;
+        MBED_COMPILER_BARRIER();
+        if (evr_head - evr_tail > MBED_EVENT_RECORDER_RECORDS) {
+            // Overwritten while being copied
+            continue;
+        }
+        records[n].id = id & ~EVR_TAG_MASK;
+        n++;
+        evr_tail++;
+    }
+    return n;
+}
+
+size_t rtos_event_recorder_read(rtos_event_record_t *records, size_t count)
+{
+    MBED_ASSERT(records != NULL);
+    return evr_read(records, count, evr_head);
+}
+
+uint32_t rtos_event_recorder_lost(void)
+{
+    return evr_lost;
+}
+
+void rtos_event_recorder_print(void)
+{
+    const ticker_info_t *info = us_ticker_get_info();
+    rtos_event_record_t records[16];
+    size_t n;
+
+    printf("evr: freq=%lu bits=%lu\r\n", (unsigned long)info->frequency, (unsigned long)info->bits);
+
+    // Stop at the current head: printing itself records stdio mutex events
+    uint32_t end = evr_head;
+    while ((n = evr_read(records, sizeof(records) / sizeof(records[0]), end)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            printf("evr: %08lx %08lx %08lx %08lx\r\n", (unsigned long)records[i].timestamp,
+                   (unsigned long)records[i].id, (unsigned long)records[i].val1,
+                   (unsigned long)records[i].val2);
+        }
+    }
+
+    osThreadId_t threads[16];
+    uint32_t count = osThreadEnumerate(threads, sizeof(threads) / sizeof(threads[0]));
+    for (uint32_t i = 0; i < count; i++) {
+        const char *name = osThreadGetName(threads[i]);
+        printf("evr: thread id=0x%08lx name=%s\r\n", (unsigned long)threads[i], name ? name : "");
+    }
+    printf("evr: lost=%lu\r\n", (unsigned long)evr_lost);
+}
+
+#else
+
+void rtos_event_recorder_init(void)
+{
+}
+
+void rtos_event_recorder_enable(uint32_t levels, uint32_t comp_start, uint32_t comp_end)
+{
+    (void)levels;
+    (void)comp_start;
+    (void)comp_end;
+}
+
+void rtos_event_recorder_disable(uint32_t levels, uint32_t comp_start, uint32_t comp_end)
+{
+    (void)levels;
+    (void)comp_start;
+    (void)comp_end;
+}
+
+size_t rtos_event_recorder_read(rtos_event_record_t *records, size_t count)
+{
+    (void)records;
+    (void)count;
+    return 0;
+}
+
+uint32_t rtos_event_recorder_lost(void)
+{
+    return 0;
+}
+
+void rtos_event_recorder_print(void)
+{
+}
+
+#endif // MBED_EVENT_RECORDER_ENABLED
@@ -25,8 +25,8 @@
 #ifdef RTE_Compiler_EventRecorder
 #include "EventRecorder.h"              // Keil::Compiler:Event Recorder
 // Used from rtx_evr.c
-#define EvtRtxThreadExit               EventID(EventLevelAPI, 0xF2U, 0x19U)
-#define EvtRtxThreadTerminate          EventID(EventLevelAPI, 0xF2U, 0x1AU)
+#define EvtRtxThreadExit               EventID(EventLevelAPI, 0xF2U, 0x1AU)
+#define EvtRtxThreadTerminate          EventID(EventLevelAPI, 0xF2U, 0x1BU)
 #endif
 
 extern void rtos_idle_loop(void);
@@ -21,6 +21,7 @@
  */
 
 #include "rtos/rtos_idle.h"
+#include "rtos/rtos_stack_monitor.h"
 #include "platform/mbed_power_mgmt.h"
 #include "TimerEvent.h"
 #include "lp_ticker_api.h"
@@ -147,6 +148,9 @@ extern "C" void rtos_idle_loop(void)
 {
     //Continuously call the idle hook function pointer
     while (1) {
+#if defined(MBED_STACK_MONITOR_ENABLED)
+        rtos_stack_monitor_idle();
+#endif
         idle_hook_fptr();
     }
 }
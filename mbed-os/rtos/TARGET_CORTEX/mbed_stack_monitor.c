@@ -0,0 +1,240 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "rtos/rtos_stack_monitor.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_critical.h"
+#include "platform/mbed_toolchain.h"
+#include "cmsis_os2.h"
+#include "rtx_os.h"
+
+#if defined(MBED_STACK_MONITOR_ENABLED)
+
+#define STACK_MONITOR_MAGIC     0x53544B4DUL    // "STKM"
+
+/* Records survive a reset: they live in .noinit and are validated by a checksum */
+typedef struct {
+    uint32_t stack_mem;
+    uint32_t stack_size;
+    uint32_t peak;
+    uint32_t overflow;
+    char name[RTOS_STACK_MONITOR_NAME_LEN];
+} stack_record_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t count;
+    stack_record_t records[MBED_STACK_MONITOR_MAX_THREADS];
+    uint32_t checksum;
+} stack_retained_t;
+
+static stack_retained_t stack_retained MBED_SECTION(".noinit");
+
+/* Scan position inside each record's stack, in words; not retained */
+static uint32_t stack_cursor[MBED_STACK_MONITOR_MAX_THREADS];
+static uint32_t stack_next;
+static bool stack_valid;
+
+static uint32_t stack_checksum(void)
+{
+    const uint32_t *word = (const uint32_t *)&stack_retained;
+    uint32_t sum = STACK_MONITOR_MAGIC;
+    for (size_t i = 0; i < offsetof(stack_retained_t, checksum) / sizeof(uint32_t); i++) {
+        sum = (sum << 5) + (sum >> 27) + word[i];
+    }
+    return sum;
+}
+
+static void stack_validate(void)
+{
+    if (stack_retained.magic != STACK_MONITOR_MAGIC ||
+            stack_retained.count > MBED_STACK_MONITOR_MAX_THREADS ||
+            stack_retained.checksum != stack_checksum()) {
+        memset(&stack_retained, 0, sizeof(stack_retained));
+        stack_retained.magic = STACK_MONITOR_MAGIC;
+        stack_retained.checksum = stack_checksum();
+    }
+    for (size_t i = 0; i < MBED_STACK_MONITOR_MAX_THREADS; i++) {
+        stack_cursor[i] = 1;
+    }
+    stack_valid = true;
+}
+
+static stack_record_t *stack_record(const osRtxThread_t *thread)
+{
+    for (uint32_t i = 0; i < stack_retained.count; i++) {
+        stack_record_t *record = &stack_retained.records[i];
+        if (record->stack_mem == (uint32_t)thread->stack_mem && record->stack_size == thread->stack_size) {
+            return record;
+        }
+    }
+    if (stack_retained.count == MBED_STACK_MONITOR_MAX_THREADS) {
+        return NULL;
+    }
+    stack_record_t *record = &stack_retained.records[stack_retained.count++];
+    memset(record, 0, sizeof(*record));
+    record->stack_mem = (uint32_t)thread->stack_mem;
+    record->stack_size = thread->stack_size;
+    if (thread->name) {
+        strncpy(record->name, thread->name, RTOS_STACK_MONITOR_NAME_LEN - 1);
+    }
+    stack_retained.checksum = stack_checksum();
+    return record;
+}
+
+/* Continue scanning one stack from the bottom up. The untouched region only ever
+ * shrinks, so each sweep stops at the previous high-water mark and the first word
+ * that no longer holds the fill pattern is the new one.
+ * Returns true when the sweep of this stack is complete.
+ */
+static bool stack_scan(const osRtxThread_t *thread, stack_record_t *record, uint32_t *cursor)
+{
+    const uint32_t *stack = (const uint32_t *)thread->stack_mem;
+    uint32_t limit = (record->stack_size - record->peak) / sizeof(uint32_t);
+    uint32_t budget = MBED_STACK_MONITOR_WORDS_PER_PASS;
+
+    if (stack[0] != osRtxStackMagicWord) {
+        if (!record->overflow || record->peak != record->stack_size) {
+            record->overflow = 1;
+            record->peak = record->stack_size;
+            stack_retained.checksum = stack_checksum();
+        }
+        return true;
+    }
+
+    while (budget--) {
+        if (*cursor >= limit) {
+            *cursor = 1;
+            return true;
+        }
+        if (stack[*cursor] != osRtxStackFillPattern) {
+            record->peak = record->stack_size - *cursor * sizeof(uint32_t);
+            stack_retained.checksum = stack_checksum();
+            *cursor = 1;
+            return true;
+        }
+        (*cursor)++;
+    }
+    return false;
+}
+
+void rtos_stack_monitor_idle(void)
+{
+    osThreadId_t threads[MBED_STACK_MONITOR_MAX_THREADS];
+
+    // Thread stacks cannot be freed while the kernel is locked
+    osKernelLock();
+    if (!stack_valid) {
+        stack_validate();
+    }
+    uint32_t n = osThreadEnumerate(threads, MBED_STACK_MONITOR_MAX_THREADS);
+    if (n) {
+        if (stack_next >= n) {
+            stack_next = 0;
+        }
+        const osRtxThread_t *thread = (const osRtxThread_t *)threads[stack_next];
+        stack_record_t *record = stack_record(thread);
+        if (!record || stack_scan(thread, record, &stack_cursor[record - stack_retained.records])) {
+            stack_next++;
+        }
+    }
+    osKernelUnlock();
+}
+
+static uint32_t stack_recommend(uint32_t peak)
+{
+    uint32_t size = peak + (peak * MBED_STACK_MONITOR_MARGIN_PERCENT) / 100;
+    return (size + 7) & ~7UL;
+}
+
+size_t rtos_stack_monitor_get_each(rtos_stack_monitor_t *stats, size_t count)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, count * sizeof(rtos_stack_monitor_t));
+
+    osKernelLock();
+    if (!stack_valid) {
+        stack_validate();
+    }
+    size_t i;
+    for (i = 0; i < count && i < stack_retained.count; i++) {
+        const stack_record_t *record = &stack_retained.records[i];
+        stats[i].stack_mem = record->stack_mem;
+        stats[i].stack_size = record->stack_size;
+        stats[i].peak = record->peak;
+        stats[i].recommended = stack_recommend(record->peak);
+        stats[i].overflow = record->overflow;
+        memcpy(stats[i].name, record->name, RTOS_STACK_MONITOR_NAME_LEN);
+    }
+    osKernelUnlock();
+    return i;
+}
+
+void rtos_stack_monitor_print(void)
+{
+    rtos_stack_monitor_t stats[MBED_STACK_MONITOR_MAX_THREADS];
+    size_t n = rtos_stack_monitor_get_each(stats, MBED_STACK_MONITOR_MAX_THREADS);
+
+    for (size_t i = 0; i < n; i++) {
+        printf("stackmon: name=%s stack=0x%08lx size=%lu peak=%lu recommended=%lu overflow=%lu\r\n",
+               stats[i].name[0] ? stats[i].name : "-",
+               (unsigned long)stats[i].stack_mem, (unsigned long)stats[i].stack_size,
+               (unsigned long)stats[i].peak, (unsigned long)stats[i].recommended,
+               (unsigned long)stats[i].overflow);
+    }
+}
+
+void rtos_stack_monitor_reset(void)
+{
+    osKernelLock();
+    stack_retained.magic = 0;
+    stack_validate();
+    stack_next = 0;
+    osKernelUnlock();
+}
+
+#else
+
+void rtos_stack_monitor_idle(void)
+{
+}
+
+size_t rtos_stack_monitor_get_each(rtos_stack_monitor_t *stats, size_t count)
+{
+    MBED_ASSERT(stats != NULL);
+    memset(stats, 0, count * sizeof(rtos_stack_monitor_t));
+    return 0;
+}
+
+void rtos_stack_monitor_print(void)
+{
+}
+
+void rtos_stack_monitor_reset(void)
+{
+}
+
+#endif // MBED_STACK_MONITOR_ENABLED
@@ -35,6 +35,7 @@
 #include "rtos/MemoryPool.h"
 #include "rtos/Queue.h"
 #include "rtos/EventFlags.h"
+#include "rtos/RingChannel.h"
 #include "rtos/ConditionVariable.h"
 
 using namespace rtos;
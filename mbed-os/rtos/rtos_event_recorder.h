@@ -0,0 +1,140 @@
+
+/** \addtogroup rtos */
+/** @{*/
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef RTOS_EVENT_RECORDER_H
+#define RTOS_EVENT_RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \defgroup rtos_EventRecorder RTX event recorder
+ * Binary flight recorder for the kernel events defined in rtx_evr.c.
+ *
+ * Each event is one fixed 16 byte record in a RAM ring, claimed with a single
+ * atomic increment, so it can be written from threads, interrupts and the
+ * kernel itself without a critical section. When the ring is full the oldest
+ * records are overwritten. tools/rtx_trace.py turns a dump into a Chrome
+ * trace (chrome://tracing) timeline.
+ * @{
+ */
+
+/** Event levels, as encoded in bits 16-17 of an event ID */
+#define RTOS_EVENT_LEVEL_ERROR      0x01U   /**< Run-time errors */
+#define RTOS_EVENT_LEVEL_API        0x02U   /**< API function calls */
+#define RTOS_EVENT_LEVEL_OP         0x04U   /**< Internal operations such as thread switches */
+#define RTOS_EVENT_LEVEL_DETAIL     0x08U   /**< Additional detail, mostly copies of attributes */
+#define RTOS_EVENT_LEVEL_ALL        0x0FU   /**< All levels */
+
+/** Component numbers of the RTX event classes */
+#define RTOS_EVENT_COMPONENT_MEMORY         0xF0U
+#define RTOS_EVENT_COMPONENT_KERNEL         0xF1U
+#define RTOS_EVENT_COMPONENT_THREAD         0xF2U
+#define RTOS_EVENT_COMPONENT_TIMER          0xF3U
+#define RTOS_EVENT_COMPONENT_EVENT_FLAGS    0xF4U
+#define RTOS_EVENT_COMPONENT_MUTEX          0xF5U
+#define RTOS_EVENT_COMPONENT_SEMAPHORE      0xF6U
+#define RTOS_EVENT_COMPONENT_MEMORY_POOL    0xF7U
+#define RTOS_EVENT_COMPONENT_MESSAGE_QUEUE  0xF8U
+
+#ifdef MBED_EVENT_RECORDER_ENABLED
+#ifndef MBED_EVENT_RECORDER_RECORDS
+#define MBED_EVENT_RECORDER_RECORDS     256     /**< Ring size in records, must be a power of two */
+#endif
+#ifndef MBED_EVENT_RECORDER_LEVELS
+#define MBED_EVENT_RECORDER_LEVELS      (RTOS_EVENT_LEVEL_ERROR | RTOS_EVENT_LEVEL_API | RTOS_EVENT_LEVEL_OP)   /**< Levels enabled at boot for every component */
+#endif
+#endif
+
+/** Set in rtos_event_record_t::id when the record holds the third and fourth
+ *  values of the previous record */
+#define RTOS_EVENT_RECORD_CONTINUED     0x80000000UL
+
+/** Bits of rtos_event_record_t::id that hold the event ID: level, component and message */
+#define RTOS_EVENT_RECORD_ID_MASK       0x0003FFFFUL
+
+/**
+ * struct rtos_event_record_t definition
+ */
+typedef struct {
+    uint32_t timestamp;     /**< Raw us ticker count; see rtos_event_recorder_print() for the scale */
+    uint32_t id;            /**< Event ID, RTOS_EVENT_RECORD_CONTINUED and a sequence tag */
+    uint32_t val1;          /**< First event value */
+    uint32_t val2;          /**< Second event value */
+} rtos_event_record_t;
+
+/** Start the us ticker used for timestamps and apply MBED_EVENT_RECORDER_LEVELS.
+ *  Called before the kernel starts when MBED_EVENT_RECORDER_ENABLED is defined.
+ */
+void rtos_event_recorder_init(void);
+
+/** Record the events of the given levels for a range of components
+ *
+ *  @param levels       Combination of RTOS_EVENT_LEVEL_* flags
+ *  @param comp_start   First component number
+ *  @param comp_end     Last component number, inclusive
+ */
+void rtos_event_recorder_enable(uint32_t levels, uint32_t comp_start, uint32_t comp_end);
+
+/** Stop recording the events of the given levels for a range of components
+ *
+ *  @param levels       Combination of RTOS_EVENT_LEVEL_* flags
+ *  @param comp_start   First component number
+ *  @param comp_end     Last component number, inclusive
+ */
+void rtos_event_recorder_disable(uint32_t levels, uint32_t comp_start, uint32_t comp_end);
+
+/** Move records out of the ring, oldest first
+ *
+ *  A record that is still being written stops the read; it is returned by
+ *  the next call.
+ *
+ *  @param records  Array to fill
+ *  @param count    Capacity of the array
+ *  @return         Number of records copied
+ */
+size_t rtos_event_recorder_read(rtos_event_record_t *records, size_t count);
+
+/** Number of records overwritten before they could be read
+ */
+uint32_t rtos_event_recorder_lost(void);
+
+/** Drain the ring as "evr:" lines on stdout, followed by the name of every
+ *  live thread, for tools/rtx_trace.py
+ */
+void rtos_event_recorder_print(void);
+
+/** @}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/** @}*/
@@ -0,0 +1,96 @@
+
+/** \addtogroup rtos */
+/** @{*/
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef RTOS_STACK_MONITOR_H
+#define RTOS_STACK_MONITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef MBED_STACK_MONITOR_ENABLED
+#ifndef MBED_STACK_MONITOR_MAX_THREADS
+#define MBED_STACK_MONITOR_MAX_THREADS      8   /**< Number of stacks tracked, including idle and timer threads */
+#endif
+#ifndef MBED_STACK_MONITOR_WORDS_PER_PASS
+#define MBED_STACK_MONITOR_WORDS_PER_PASS   32  /**< Stack words inspected each time the idle thread runs */
+#endif
+#ifndef MBED_STACK_MONITOR_MARGIN_PERCENT
+#define MBED_STACK_MONITOR_MARGIN_PERCENT   25  /**< Head room added on top of the peak usage for recommendations */
+#endif
+#endif
+
+/**
+ * \defgroup rtos_StackMonitor Stack high-water monitor
+ * @{
+ */
+
+/** Length of the thread name kept with each record, including the terminator */
+#define RTOS_STACK_MONITOR_NAME_LEN 12
+
+/**
+ * struct rtos_stack_monitor_t definition
+ */
+typedef struct {
+    uint32_t stack_mem;         /**< Address of the stack, identifies the thread across reboots */
+    uint32_t stack_size;        /**< Current number of bytes allocated for the stack */
+    uint32_t peak;              /**< Maximum number of bytes ever seen used, across reboots */
+    uint32_t recommended;       /**< Suggested stack size: peak plus MBED_STACK_MONITOR_MARGIN_PERCENT, 8 byte aligned */
+    uint32_t overflow;          /**< Non-zero if the stack magic word was found overwritten */
+    char name[RTOS_STACK_MONITOR_NAME_LEN]; /**< Thread name, truncated, or empty if unnamed */
+} rtos_stack_monitor_t;
+
+/** Inspect a bounded slice of one thread stack. Called from the idle loop
+ *  when MBED_STACK_MONITOR_ENABLED is defined.
+ */
+void rtos_stack_monitor_idle(void);
+
+/** Fill the passed array with the retained high-water records.
+ *
+ *  @param stats    A pointer to an array of rtos_stack_monitor_t structures to fill
+ *  @param count    The number of rtos_stack_monitor_t structures in the provided array
+ *  @return         The number of rtos_stack_monitor_t structures that have been filled
+ */
+size_t rtos_stack_monitor_get_each(rtos_stack_monitor_t *stats, size_t count);
+
+/** Print the records as one "stackmon:" line per stack, for tools/stack_report.py.
+ */
+void rtos_stack_monitor_print(void);
+
+/** Forget all retained records, e.g. after flashing a different image.
+ */
+void rtos_stack_monitor_reset(void);
+
+/** @}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/** @}*/
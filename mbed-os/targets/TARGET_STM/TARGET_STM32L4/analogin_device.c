@@ -35,6 +35,19 @@
 #include "pinmap.h"
 #include "mbed_error.h"
 #include "PeripheralPins.h"
+#include "analogin_burst_api.h"
+
+/* Conversion mode and channel last programmed into the ADC, so that a single
+ * read on the same channel skips HAL_ADC_ConfigChannel(). Bursts switch the
+ * ADC to continuous, oversampled conversions; the next single read switches
+ * it back. */
+#define ADC_MODE(continuous, oversample)    (((uint32_t)(continuous) << 16) | (oversample))
+#define ADC_MODE_SINGLE     ADC_MODE(0, 1)
+#define ADC_CHANNEL_NONE    0xFF
+
+static ADC_TypeDef *adc_mode_instance;
+static uint32_t adc_mode;
+static uint8_t adc_channel;
 
 void analogin_init(analogin_t *obj, PinName pin)
 {
@@ -90,6 +103,9 @@ void analogin_init(analogin_t *obj, PinName pin)
     if (HAL_ADC_Init(&obj->handle) != HAL_OK) {
         error("Cannot initialize ADC");
     }
+    adc_mode_instance = obj->handle.Instance;
+    adc_mode = ADC_MODE_SINGLE;
+    adc_channel = ADC_CHANNEL_NONE;
 
     // ADC calibration is done only once
     if (!HAL_ADCEx_Calibration_GetValue(&obj->handle, ADC_SINGLE_ENDED)) {
@@ -97,10 +113,53 @@ void analogin_init(analogin_t *obj, PinName pin)
     }
 }
 
-uint16_t adc_read(analogin_t *obj)
+static const uint32_t adc_oversampling_ratio[] = {
+    ADC_OVERSAMPLING_RATIO_2, ADC_OVERSAMPLING_RATIO_4, ADC_OVERSAMPLING_RATIO_8, ADC_OVERSAMPLING_RATIO_16,
+    ADC_OVERSAMPLING_RATIO_32, ADC_OVERSAMPLING_RATIO_64, ADC_OVERSAMPLING_RATIO_128, ADC_OVERSAMPLING_RATIO_256
+};
+
+static const uint32_t adc_oversampling_shift[] = {
+    ADC_RIGHTBITSHIFT_1, ADC_RIGHTBITSHIFT_2, ADC_RIGHTBITSHIFT_3, ADC_RIGHTBITSHIFT_4,
+    ADC_RIGHTBITSHIFT_5, ADC_RIGHTBITSHIFT_6, ADC_RIGHTBITSHIFT_7, ADC_RIGHTBITSHIFT_8
+};
+
+/* Each result is the average of oversample conversions; the ADC must not be converting */
+static void adc_set_mode(analogin_t *obj, uint32_t continuous, uint32_t oversample)
+{
+    uint32_t mode = ADC_MODE(continuous, oversample);
+    uint32_t log2 = 0;
+
+    if (adc_mode_instance == obj->handle.Instance && adc_mode == mode) {
+        return;
+    }
+
+    while ((2U << log2) <= oversample && log2 < 8) {
+        log2++;
+    }
+
+    obj->handle.Init.ContinuousConvMode = continuous ? ENABLE : DISABLE;
+    obj->handle.Init.OversamplingMode = (log2 > 0) ? ENABLE : DISABLE;
+    if (log2 > 0) {
+        obj->handle.Init.Oversampling.Ratio = adc_oversampling_ratio[log2 - 1];
+        obj->handle.Init.Oversampling.RightBitShift = adc_oversampling_shift[log2 - 1];
+        obj->handle.Init.Oversampling.TriggeredMode = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+        obj->handle.Init.Oversampling.OversamplingStopReset = ADC_REGOVERSAMPLING_CONTINUED_MODE;
+    }
+    HAL_ADC_Init(&obj->handle);
+
+    adc_mode_instance = obj->handle.Instance;
+    adc_mode = mode;
+}
+
+/* Returns 0 if the channel does not exist */
+static int adc_set_channel(analogin_t *obj)
 {
     ADC_ChannelConfTypeDef sConfig = {0};
 
+    if (adc_mode_instance == obj->handle.Instance && adc_channel == obj->channel) {
+        return 1;
+    }
+
     // Configure ADC channel
     sConfig.Rank         = ADC_REGULAR_RANK_1;
     sConfig.SamplingTime = ADC_SAMPLETIME_47CYCLES_5; //  default value (1.5 us for 80MHz clock)
@@ -174,6 +233,16 @@ uint16_t adc_read(analogin_t *obj)
     }
 
     HAL_ADC_ConfigChannel(&obj->handle, &sConfig);
+    adc_channel = obj->channel;
+    return 1;
+}
+
+uint16_t adc_read(analogin_t *obj)
+{
+    adc_set_mode(obj, 0, 1);
+    if (!adc_set_channel(obj)) {
+        return 0;
+    }
 
     HAL_ADC_Start(&obj->handle); // Start conversion
 
@@ -185,4 +254,118 @@ uint16_t adc_read(analogin_t *obj)
     }
 }
 
+#if DEVICE_ANALOGIN_BURST
+
+/******************************************************************************
+ * BURST ACQUISITION
+ ******************************************************************************/
+
+#define ADC_OVERSAMPLE_MAX  256
+
+static DMA_HandleTypeDef adc_dma;
+static analogin_burst_handler adc_burst_handler;
+static uint32_t adc_burst_id;
+static uint16_t *adc_burst_buffer;
+static uint32_t adc_burst_count;
+
+static void adc_dma_irq(void)
+{
+    HAL_DMA_IRQHandler(&adc_dma);
+}
+
+static void adc_burst_done(DMA_HandleTypeDef *hdma)
+{
+    ADC_HandleTypeDef *hadc = (ADC_HandleTypeDef *)hdma->Parent;
+    uint32_t count = adc_burst_count - __HAL_DMA_GET_COUNTER(hdma);
+
+    // Continuous conversions go on until stopped; the ADC stays enabled
+    ADC_ConversionStop(hadc, ADC_REGULAR_GROUP);
+    CLEAR_BIT(hadc->Instance->CFGR, ADC_CFGR_DMAEN);
+
+    // 12-bit to 16-bit conversion, as analogin_read_u16()
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t value = adc_burst_buffer[i];
+        adc_burst_buffer[i] = ((value << 4) & (uint16_t)0xFFF0) | ((value >> 8) & (uint16_t)0x000F);
+    }
+    adc_burst_handler(adc_burst_id, count);
+}
+
+int analogin_burst_init(analogin_t *obj, analogin_burst_handler handler, uint32_t id)
+{
+    // ADC1 is served by DMA1 channel 1, request 0; see the DMA request mapping table
+    if (obj->handle.Instance != ADC1 || adc_dma.Instance != NULL) {
+        return DMA_ERROR_OUT_OF_CHANNELS;
+    }
+
+    adc_burst_handler = handler;
+    adc_burst_id = id;
+
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    adc_dma.Instance = DMA1_Channel1;
+    adc_dma.Init.Request = DMA_REQUEST_0;
+    adc_dma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    adc_dma.Init.PeriphInc = DMA_PINC_DISABLE;
+    adc_dma.Init.MemInc = DMA_MINC_ENABLE;
+    adc_dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    adc_dma.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    adc_dma.Init.Mode = DMA_NORMAL;
+    adc_dma.Init.Priority = DMA_PRIORITY_MEDIUM;
+    HAL_DMA_Init(&adc_dma);
+    adc_dma.Parent = &obj->handle;
+    adc_dma.XferCpltCallback = adc_burst_done;
+    // A bus error ends the burst early; the caller still gets its handler
+    adc_dma.XferErrorCallback = adc_burst_done;
+
+    NVIC_SetVector(DMA1_Channel1_IRQn, (uint32_t)&adc_dma_irq);
+    NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+
+    return 0;
+}
+
+void analogin_burst_free(analogin_t *obj)
+{
+    if (adc_dma.Instance == NULL || adc_dma.Parent != &obj->handle) {
+        return;
+    }
+
+    analogin_burst_abort(obj);
+    NVIC_DisableIRQ(DMA1_Channel1_IRQn);
+    HAL_DMA_DeInit(&adc_dma);
+    adc_dma.Instance = NULL;
+}
+
+uint32_t analogin_burst_max_oversample(void)
+{
+    return ADC_OVERSAMPLE_MAX;
+}
+
+void analogin_burst_start(analogin_t *obj, uint16_t *buffer, uint32_t count, uint32_t oversample)
+{
+    MBED_ASSERT(adc_dma.Parent == &obj->handle);
+    MBED_ASSERT(count > 0 && oversample > 0 && oversample <= ADC_OVERSAMPLE_MAX);
+
+    // Continuous mode, so that one start gives count results
+    adc_set_mode(obj, 1, oversample);
+    if (!adc_set_channel(obj)) {
+        adc_burst_handler(adc_burst_id, 0);
+        return;
+    }
+
+    adc_burst_buffer = buffer;
+    adc_burst_count = count;
+    HAL_DMA_Start_IT(&adc_dma, (uint32_t)&obj->handle.Instance->DR, (uint32_t)buffer, count);
+    SET_BIT(obj->handle.Instance->CFGR, ADC_CFGR_DMAEN);
+    HAL_ADC_Start(&obj->handle);
+}
+
+void analogin_burst_abort(analogin_t *obj)
+{
+    ADC_ConversionStop(&obj->handle, ADC_REGULAR_GROUP);
+    CLEAR_BIT(obj->handle.Instance->CFGR, ADC_CFGR_DMAEN);
+    HAL_DMA_Abort(&adc_dma);
+}
+
+#endif /* DEVICE_ANALOGIN_BURST */
+
 #endif
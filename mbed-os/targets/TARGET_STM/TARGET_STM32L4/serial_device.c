@@ -31,6 +31,7 @@
 #if DEVICE_SERIAL
 
 #include "serial_api_hal.h"
+#include "serial_dma_api.h"
 
 #if defined (TARGET_STM32L432xC)
     #define UART_NUM (3)
@@ -45,6 +46,14 @@ UART_HandleTypeDef uart_handlers[UART_NUM];
 
 static uart_irq_handler irq_handler;
 
+#if DEVICE_SERIAL_DMA
+static DMA_HandleTypeDef uart_dma_rx[UART_NUM];
+static DMA_HandleTypeDef uart_dma_tx[UART_NUM];
+static uint32_t uart_dma_rx_size[UART_NUM];
+static serial_dma_handler dma_handler[UART_NUM];
+static uint32_t serial_dma_ids[UART_NUM];
+#endif
+
 // Defined in serial_api.c
 extern int8_t get_uart_index(UARTName uart_name);
 
@@ -75,6 +84,17 @@ static void uart_irq(UARTName uart_name)
                     volatile uint32_t tmpval __attribute__((unused)) = huart->Instance->RDR; // Clear ORE flag
                 }
             }
+#if DEVICE_SERIAL_DMA
+            if (__HAL_UART_GET_FLAG(huart, UART_FLAG_IDLE) != RESET) {
+                if (__HAL_UART_GET_IT_SOURCE(huart, UART_IT_IDLE) != RESET) {
+                    // End of a burst: hand over what DMA received so far
+                    __HAL_UART_CLEAR_IDLEFLAG(huart);
+                    if (dma_handler[id] != NULL) {
+                        dma_handler[id](serial_dma_ids[id], SERIAL_DMA_RX);
+                    }
+                }
+            }
+#endif
         }
     }
 }
@@ -129,52 +149,59 @@ void serial_irq_handler(serial_t *obj, uart_irq_handler handler, uint32_t id)
     serial_irq_ids[obj_s->index] = id;
 }
 
-void serial_irq_set(serial_t *obj, SerialIrq irq, uint32_t enable)
+static uint32_t uart_irq_vector(UARTName uart_name, IRQn_Type *irq_n)
 {
-    struct serial_s *obj_s = SERIAL_S(obj);
-    UART_HandleTypeDef *huart = &uart_handlers[obj_s->index];
-    IRQn_Type irq_n = (IRQn_Type)0;
     uint32_t vector = 0;
 
-    switch (obj_s->uart) {
+    switch (uart_name) {
 #if defined(USART1_BASE)
         case UART_1:
-            irq_n = USART1_IRQn;
+            *irq_n = USART1_IRQn;
             vector = (uint32_t)&uart1_irq;
             break;
 #endif
 #if defined(USART2_BASE)
         case UART_2:
-            irq_n = USART2_IRQn;
+            *irq_n = USART2_IRQn;
             vector = (uint32_t)&uart2_irq;
             break;
 #endif
 #if defined(USART3_BASE)
         case UART_3:
-            irq_n = USART3_IRQn;
+            *irq_n = USART3_IRQn;
             vector = (uint32_t)&uart3_irq;
             break;
 #endif
 #if defined(UART4_BASE)
         case UART_4:
-            irq_n = UART4_IRQn;
+            *irq_n = UART4_IRQn;
             vector = (uint32_t)&uart4_irq;
             break;
 #endif
 #if defined(UART5_BASE)
         case UART_5:
-            irq_n = UART5_IRQn;
+            *irq_n = UART5_IRQn;
             vector = (uint32_t)&uart5_irq;
             break;
 #endif
 #if defined(LPUART1_BASE)
         case LPUART_1:
-            irq_n = LPUART1_IRQn;
+            *irq_n = LPUART1_IRQn;
             vector = (uint32_t)&lpuart1_irq;
             break;
 #endif
     }
 
+    return vector;
+}
+
+void serial_irq_set(serial_t *obj, SerialIrq irq, uint32_t enable)
+{
+    struct serial_s *obj_s = SERIAL_S(obj);
+    UART_HandleTypeDef *huart = &uart_handlers[obj_s->index];
+    IRQn_Type irq_n = (IRQn_Type)0;
+    uint32_t vector = uart_irq_vector(obj_s->uart, &irq_n);
+
     if (enable) {
         if (irq == RxIrq) {
             __HAL_UART_ENABLE_IT(huart, UART_IT_RXNE);
@@ -188,14 +215,14 @@ void serial_irq_set(serial_t *obj, SerialIrq irq, uint32_t enable)
         int all_disabled = 0;
         if (irq == RxIrq) {
             __HAL_UART_DISABLE_IT(huart, UART_IT_RXNE);
-            // Check if TxIrq is disabled too
-            if ((huart->Instance->CR1 & USART_CR1_TXEIE) == 0) {
+            // Check if TxIrq and the DMA idle line interrupt are disabled too
+            if ((huart->Instance->CR1 & (USART_CR1_TXEIE | USART_CR1_IDLEIE)) == 0) {
                 all_disabled = 1;
             }
         } else { // TxIrq
             __HAL_UART_DISABLE_IT(huart, UART_IT_TXE);
-            // Check if RxIrq is disabled too
-            if ((huart->Instance->CR1 & USART_CR1_RXNEIE) == 0) {
+            // Check if RxIrq and the DMA idle line interrupt are disabled too
+            if ((huart->Instance->CR1 & (USART_CR1_RXNEIE | USART_CR1_IDLEIE)) == 0) {
                 all_disabled = 1;
             }
         }
@@ -253,6 +280,320 @@ void serial_break_set(serial_t *obj)
     HAL_LIN_SendBreak(huart);
 }
 
+#if DEVICE_SERIAL_DMA
+
+/******************************************************************************
+ * DMA STREAMING
+ ******************************************************************************/
+
+typedef struct {
+    DMA_Channel_TypeDef *rx_channel;
+    IRQn_Type rx_irq_n;
+    uint32_t rx_vector;
+    DMA_Channel_TypeDef *tx_channel;
+    IRQn_Type tx_irq_n;
+    uint32_t tx_vector;
+    uint32_t request;
+} uart_dma_map_t;
+
+static void uart_dma_irq(UARTName uart_name, DMA_HandleTypeDef *hdma)
+{
+    int8_t id = get_uart_index(uart_name);
+
+    if (id >= 0) {
+        HAL_DMA_IRQHandler(&hdma[id]);
+    }
+}
+
+#if defined(USART1_BASE)
+static void uart1_dma_rx_irq(void)
+{
+    uart_dma_irq(UART_1, uart_dma_rx);
+}
+
+static void uart1_dma_tx_irq(void)
+{
+    uart_dma_irq(UART_1, uart_dma_tx);
+}
+#endif
+
+#if defined(USART2_BASE)
+static void uart2_dma_rx_irq(void)
+{
+    uart_dma_irq(UART_2, uart_dma_rx);
+}
+
+static void uart2_dma_tx_irq(void)
+{
+    uart_dma_irq(UART_2, uart_dma_tx);
+}
+#endif
+
+#if defined(USART3_BASE)
+static void uart3_dma_rx_irq(void)
+{
+    uart_dma_irq(UART_3, uart_dma_rx);
+}
+
+static void uart3_dma_tx_irq(void)
+{
+    uart_dma_irq(UART_3, uart_dma_tx);
+}
+#endif
+
+#if defined(UART4_BASE)
+static void uart4_dma_rx_irq(void)
+{
+    uart_dma_irq(UART_4, uart_dma_rx);
+}
+
+static void uart4_dma_tx_irq(void)
+{
+    uart_dma_irq(UART_4, uart_dma_tx);
+}
+#endif
+
+#if defined(UART5_BASE)
+static void uart5_dma_rx_irq(void)
+{
+    uart_dma_irq(UART_5, uart_dma_rx);
+}
+
+static void uart5_dma_tx_irq(void)
+{
+    uart_dma_irq(UART_5, uart_dma_tx);
+}
+#endif
+
+#if defined(LPUART1_BASE)
+static void lpuart1_dma_rx_irq(void)
+{
+    uart_dma_irq(LPUART_1, uart_dma_rx);
+}
+
+static void lpuart1_dma_tx_irq(void)
+{
+    uart_dma_irq(LPUART_1, uart_dma_tx);
+}
+#endif
+
+/* Fixed channel and request of each UART, see the DMA request mapping tables
+ * of the reference manual. Returns 0 if the UART has no DMA. */
+static int uart_dma_map(UARTName uart_name, uart_dma_map_t *map)
+{
+    switch (uart_name) {
+#if defined(USART1_BASE)
+        case UART_1:
+            map->rx_channel = DMA1_Channel5;
+            map->rx_irq_n = DMA1_Channel5_IRQn;
+            map->rx_vector = (uint32_t)&uart1_dma_rx_irq;
+            map->tx_channel = DMA1_Channel4;
+            map->tx_irq_n = DMA1_Channel4_IRQn;
+            map->tx_vector = (uint32_t)&uart1_dma_tx_irq;
+            map->request = DMA_REQUEST_2;
+            return 1;
+#endif
+#if defined(USART2_BASE)
+        case UART_2:
+            map->rx_channel = DMA1_Channel6;
+            map->rx_irq_n = DMA1_Channel6_IRQn;
+            map->rx_vector = (uint32_t)&uart2_dma_rx_irq;
+            map->tx_channel = DMA1_Channel7;
+            map->tx_irq_n = DMA1_Channel7_IRQn;
+            map->tx_vector = (uint32_t)&uart2_dma_tx_irq;
+            map->request = DMA_REQUEST_2;
+            return 1;
+#endif
+#if defined(USART3_BASE)
+        case UART_3:
+            map->rx_channel = DMA1_Channel3;
+            map->rx_irq_n = DMA1_Channel3_IRQn;
+            map->rx_vector = (uint32_t)&uart3_dma_rx_irq;
+            map->tx_channel = DMA1_Channel2;
+            map->tx_irq_n = DMA1_Channel2_IRQn;
+            map->tx_vector = (uint32_t)&uart3_dma_tx_irq;
+            map->request = DMA_REQUEST_2;
+            return 1;
+#endif
+#if defined(UART4_BASE)
+        case UART_4:
+            map->rx_channel = DMA2_Channel5;
+            map->rx_irq_n = DMA2_Channel5_IRQn;
+            map->rx_vector = (uint32_t)&uart4_dma_rx_irq;
+            map->tx_channel = DMA2_Channel3;
+            map->tx_irq_n = DMA2_Channel3_IRQn;
+            map->tx_vector = (uint32_t)&uart4_dma_tx_irq;
+            map->request = DMA_REQUEST_2;
+            return 1;
+#endif
+#if defined(UART5_BASE)
+        case UART_5:
+            map->rx_channel = DMA2_Channel2;
+            map->rx_irq_n = DMA2_Channel2_IRQn;
+            map->rx_vector = (uint32_t)&uart5_dma_rx_irq;
+            map->tx_channel = DMA2_Channel1;
+            map->tx_irq_n = DMA2_Channel1_IRQn;
+            map->tx_vector = (uint32_t)&uart5_dma_tx_irq;
+            map->request = DMA_REQUEST_2;
+            return 1;
+#endif
+#if defined(LPUART1_BASE)
+        case LPUART_1:
+            map->rx_channel = DMA2_Channel7;
+            map->rx_irq_n = DMA2_Channel7_IRQn;
+            map->rx_vector = (uint32_t)&lpuart1_dma_rx_irq;
+            map->tx_channel = DMA2_Channel6;
+            map->tx_irq_n = DMA2_Channel6_IRQn;
+            map->tx_vector = (uint32_t)&lpuart1_dma_tx_irq;
+            map->request = DMA_REQUEST_4;
+            return 1;
+#endif
+        default:
+            return 0;
+    }
+}
+
+static void uart_dma_rx_event(DMA_HandleTypeDef *hdma)
+{
+    int id = (UART_HandleTypeDef *)hdma->Parent - uart_handlers;
+
+    if (dma_handler[id] != NULL) {
+        dma_handler[id](serial_dma_ids[id], SERIAL_DMA_RX);
+    }
+}
+
+static void uart_dma_tx_event(DMA_HandleTypeDef *hdma)
+{
+    int id = (UART_HandleTypeDef *)hdma->Parent - uart_handlers;
+
+    if (dma_handler[id] != NULL) {
+        dma_handler[id](serial_dma_ids[id], SERIAL_DMA_TX_DONE);
+    }
+}
+
+int serial_dma_init(serial_t *obj, serial_dma_handler handler, uint32_t id)
+{
+    struct serial_s *obj_s = SERIAL_S(obj);
+    UART_HandleTypeDef *huart = &uart_handlers[obj_s->index];
+    DMA_HandleTypeDef *hdma_rx = &uart_dma_rx[obj_s->index];
+    DMA_HandleTypeDef *hdma_tx = &uart_dma_tx[obj_s->index];
+    IRQn_Type irq_n = (IRQn_Type)0;
+    uint32_t vector;
+    uart_dma_map_t map;
+
+    if (!uart_dma_map(obj_s->uart, &map) || hdma_rx->Instance != NULL) {
+        return DMA_ERROR_OUT_OF_CHANNELS;
+    }
+
+    dma_handler[obj_s->index] = handler;
+    serial_dma_ids[obj_s->index] = id;
+
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    hdma_rx->Instance = map.rx_channel;
+    hdma_rx->Init.Request = map.request;
+    hdma_rx->Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_rx->Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_rx->Init.MemInc = DMA_MINC_ENABLE;
+    hdma_rx->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_rx->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_rx->Init.Mode = DMA_CIRCULAR;
+    hdma_rx->Init.Priority = DMA_PRIORITY_HIGH;
+    HAL_DMA_Init(hdma_rx);
+    hdma_rx->Parent = huart;
+    hdma_rx->XferHalfCpltCallback = uart_dma_rx_event;
+    hdma_rx->XferCpltCallback = uart_dma_rx_event;
+
+    hdma_tx->Instance = map.tx_channel;
+    hdma_tx->Init.Request = map.request;
+    hdma_tx->Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_tx->Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_tx->Init.MemInc = DMA_MINC_ENABLE;
+    hdma_tx->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    hdma_tx->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    hdma_tx->Init.Mode = DMA_NORMAL;
+    hdma_tx->Init.Priority = DMA_PRIORITY_MEDIUM;
+    HAL_DMA_Init(hdma_tx);
+    hdma_tx->Parent = huart;
+    hdma_tx->XferCpltCallback = uart_dma_tx_event;
+    // A bus error ends the block early; the data is lost but the writer goes on
+    hdma_tx->XferErrorCallback = uart_dma_tx_event;
+
+    NVIC_SetVector(map.rx_irq_n, map.rx_vector);
+    NVIC_EnableIRQ(map.rx_irq_n);
+    NVIC_SetVector(map.tx_irq_n, map.tx_vector);
+    NVIC_EnableIRQ(map.tx_irq_n);
+
+    // The idle line interrupt shares the UART vector
+    vector = uart_irq_vector(obj_s->uart, &irq_n);
+    __HAL_UART_CLEAR_IDLEFLAG(huart);
+    __HAL_UART_ENABLE_IT(huart, UART_IT_IDLE);
+    NVIC_SetVector(irq_n, vector);
+    NVIC_EnableIRQ(irq_n);
+
+    return 0;
+}
+
+void serial_dma_free(serial_t *obj)
+{
+    struct serial_s *obj_s = SERIAL_S(obj);
+    UART_HandleTypeDef *huart = &uart_handlers[obj_s->index];
+    DMA_HandleTypeDef *hdma_rx = &uart_dma_rx[obj_s->index];
+    DMA_HandleTypeDef *hdma_tx = &uart_dma_tx[obj_s->index];
+    uart_dma_map_t map;
+
+    if (hdma_rx->Instance == NULL || !uart_dma_map(obj_s->uart, &map)) {
+        return;
+    }
+
+    __HAL_UART_DISABLE_IT(huart, UART_IT_IDLE);
+    CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAR | USART_CR3_DMAT);
+
+    NVIC_DisableIRQ(map.rx_irq_n);
+    NVIC_DisableIRQ(map.tx_irq_n);
+
+    HAL_DMA_Abort(hdma_rx);
+    HAL_DMA_DeInit(hdma_rx);
+    hdma_rx->Instance = NULL;
+    HAL_DMA_Abort(hdma_tx);
+    HAL_DMA_DeInit(hdma_tx);
+    hdma_tx->Instance = NULL;
+}
+
+void serial_dma_rx_start(serial_t *obj, uint8_t *buffer, uint32_t size)
+{
+    struct serial_s *obj_s = SERIAL_S(obj);
+    UART_HandleTypeDef *huart = &uart_handlers[obj_s->index];
+    DMA_HandleTypeDef *hdma_rx = &uart_dma_rx[obj_s->index];
+
+    uart_dma_rx_size[obj_s->index] = size;
+    __HAL_UART_CLEAR_OREFLAG(huart);
+    HAL_DMA_Start_IT(hdma_rx, (uint32_t)&huart->Instance->RDR, (uint32_t)buffer, size);
+    SET_BIT(huart->Instance->CR3, USART_CR3_DMAR);
+}
+
+uint32_t serial_dma_rx_head(serial_t *obj)
+{
+    struct serial_s *obj_s = SERIAL_S(obj);
+    uint32_t size = uart_dma_rx_size[obj_s->index];
+    uint32_t head = size - __HAL_DMA_GET_COUNTER(&uart_dma_rx[obj_s->index]);
+
+    // The counter reloads to size when the ring wraps
+    return head < size ? head : 0;
+}
+
+void serial_dma_tx_start(serial_t *obj, const uint8_t *buffer, uint32_t length)
+{
+    struct serial_s *obj_s = SERIAL_S(obj);
+    UART_HandleTypeDef *huart = &uart_handlers[obj_s->index];
+
+    HAL_DMA_Start_IT(&uart_dma_tx[obj_s->index], (uint32_t)buffer, (uint32_t)&huart->Instance->TDR, length);
+    SET_BIT(huart->Instance->CR3, USART_CR3_DMAT);
+}
+
+#endif /* DEVICE_SERIAL_DMA */
+
 #if DEVICE_SERIAL_ASYNCH
 
 /******************************************************************************
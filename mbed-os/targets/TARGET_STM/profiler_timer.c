@@ -0,0 +1,89 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hal/profiler_timer_api.h"
+
+#if defined(MBED_PROFILER_ENABLED)
+
+#include "cmsis.h"
+#include "platform/mbed_assert.h"
+
+// TIM7 is a basic timer not used by any mbed driver
+#if !defined(TIM7)
+#error "The sampling profiler needs TIM7 on this target"
+#endif
+
+static TIM_HandleTypeDef ProfilerTimHandle;
+static void (*profiler_handler)(void);
+
+static void profiler_timer_irq(void)
+{
+    if (__HAL_TIM_GET_FLAG(&ProfilerTimHandle, TIM_FLAG_UPDATE) == SET) {
+        __HAL_TIM_CLEAR_IT(&ProfilerTimHandle, TIM_IT_UPDATE);
+        profiler_handler();
+    }
+}
+
+void profiler_timer_init(uint32_t frequency, void (*handler)(void))
+{
+    RCC_ClkInitTypeDef RCC_ClkInitStruct;
+    uint32_t PclkFreq;
+
+    // The reload value is 16 bits, and the counter stops when it is 0
+    MBED_ASSERT(frequency >= 16 && frequency <= 500000);
+
+    profiler_handler = handler;
+
+    // Get clock configuration
+    // Note: PclkFreq contains here the Latency (not used after)
+    HAL_RCC_GetClockConfig(&RCC_ClkInitStruct, &PclkFreq);
+
+    // TIM7 is on APB1; TIMxCLK = PCLK1 when the APB prescaler = 1 else TIMxCLK = 2 * PCLK1
+    PclkFreq = HAL_RCC_GetPCLK1Freq();
+    if (RCC_ClkInitStruct.APB1CLKDivider != RCC_HCLK_DIV1) {
+        PclkFreq *= 2;
+    }
+
+    __HAL_RCC_TIM7_CLK_ENABLE();
+    __HAL_RCC_TIM7_FORCE_RESET();
+    __HAL_RCC_TIM7_RELEASE_RESET();
+
+    // 1 MHz counter, period in microseconds
+    ProfilerTimHandle.Instance = TIM7;
+    ProfilerTimHandle.Init.Prescaler = (uint16_t)(PclkFreq / 1000000) - 1;
+    ProfilerTimHandle.Init.Period = (1000000 / frequency) - 1;
+    ProfilerTimHandle.Init.ClockDivision = 0;
+    ProfilerTimHandle.Init.CounterMode = TIM_COUNTERMODE_UP;
+#ifdef TIM_AUTORELOAD_PRELOAD_DISABLE
+    ProfilerTimHandle.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+#endif
+    HAL_TIM_Base_Init(&ProfilerTimHandle);
+
+    // Highest priority so that other interrupt handlers are sampled too
+    NVIC_SetVector(TIM7_IRQn, (uint32_t)profiler_timer_irq);
+    NVIC_SetPriority(TIM7_IRQn, 0);
+    NVIC_EnableIRQ(TIM7_IRQn);
+
+    HAL_TIM_Base_Start_IT(&ProfilerTimHandle);
+}
+
+void profiler_timer_free(void)
+{
+    HAL_TIM_Base_Stop_IT(&ProfilerTimHandle);
+    NVIC_DisableIRQ(TIM7_IRQn);
+    __HAL_RCC_TIM7_CLK_DISABLE();
+}
+
+#endif // MBED_PROFILER_ENABLED
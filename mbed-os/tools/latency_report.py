@@ -0,0 +1,263 @@
+#!/usr/bin/env python
+
+"""Interrupt and critical section latency report for ARM mbed
+
+Turns the "lat:" lines printed by mbed_latency_print() into a table of the
+worst and percentile durations per interrupt handler and per critical
+section call site, named from a GCC_ARM or IAR map file. Several logs can be
+given; their histograms are merged.
+
+Given a baseline, a JSON export of an earlier run, it exits with an error
+when any site got slower than the baseline by more than the tolerance, so it
+can gate a benchmark run in CI.
+"""
+from __future__ import print_function, division, absolute_import
+
+import sys
+from sys import stdin, exit
+from os.path import join, abspath, dirname
+from argparse import ArgumentParser
+import re
+import json
+
+# Be sure that the tools directory is in the search path
+ROOT = abspath(join(dirname(__file__), ".."))
+sys.path.insert(0, ROOT)
+
+from prettytable import PrettyTable
+
+SITE_RE = re.compile(
+    r'lat: kind=(?P<kind>\d+) id=0x(?P<id>[0-9a-fA-F]+) count=(?P<count>\d+) '
+    r'max=(?P<max>\d+) p50=\d+ p99=\d+ hist=(?P<hist>[0-9:,]*)')
+TOTAL_RE = re.compile(r'lat: hz=(?P<hz>\d+) dropped=(?P<dropped>\d+)')
+
+# mbed_latency_kind_t
+KINDS = ["critical", "ticker", "chain", "gpio"]
+
+BUCKETS = 42
+
+
+def bucket_top(bucket):
+    """ Largest duration in a bucket of the mbed_latency histogram """
+    if bucket < 2:
+        return bucket
+    if bucket == BUCKETS - 1:
+        return None
+    octave = bucket // 2
+    return ((2 + (bucket & 1)) << (octave - 1)) + (1 << (octave - 1)) - 1
+
+
+class LatencyReport(object):
+    """Merges latency records and reports on them"""
+
+    export_formats = ["table", "json"]
+
+    def __init__(self, symbols=None):
+        self.symbols = symbols
+        self.sites = dict()
+        self.dropped = 0
+
+    def site_name(self, kind, ident):
+        """ Interrupts by exception number, critical sections by caller """
+        if kind != 0:
+            return "irq%d" % ident
+        if self.symbols:
+            _, symbol = self.symbols.resolve(ident & ~1)
+            return symbol
+        return "0x%08x" % ident
+
+    def parse(self, lines):
+        """ Read latency records from log lines
+
+        Durations are converted to microseconds with the counter frequency
+        that ends each dump, so logs from different clock settings merge.
+
+        Positional arguments:
+        lines - iterable of log lines; lines without a record are skipped
+        """
+        pending = []
+        for line in lines:
+            match = SITE_RE.search(line)
+            if match:
+                hist = dict()
+                for pair in match.group('hist').split(','):
+                    if pair:
+                        bucket, count = pair.split(':')
+                        hist[int(bucket)] = int(count)
+                pending.append((int(match.group('kind')),
+                                int(match.group('id'), 16),
+                                int(match.group('count')),
+                                int(match.group('max')), hist))
+                continue
+            match = TOTAL_RE.search(line)
+            if match:
+                self._add(pending, int(match.group('hz')))
+                self.dropped += int(match.group('dropped'))
+                pending = []
+
+    def _add(self, records, hz):
+        for kind, ident, count, maximum, hist in records:
+            kind_name = KINDS[kind] if kind < len(KINDS) else "user%d" % kind
+            key = (kind_name, self.site_name(kind, ident))
+            site = self.sites.setdefault(key, {
+                'kind': key[0], 'site': key[1], 'count': 0, 'max_us': 0.0,
+                'hist': dict()})
+            site['count'] += count
+            site['max_us'] = max(site['max_us'], 1e6 * maximum / hz)
+            for bucket, hits in hist.items():
+                top = bucket_top(bucket)
+                top_us = 1e6 * top / hz if top is not None else None
+                site['hist'][top_us] = site['hist'].get(top_us, 0) + hits
+
+    @staticmethod
+    def percentile(site, percent):
+        """ Bucket bound that percent of the durations of a site did not exceed """
+        total = sum(site['hist'].values())
+        if not total:
+            return 0.0
+        rank = (total * percent + 99) // 100
+        seen = 0
+        for top_us in sorted(site['hist'], key=lambda t: float('inf') if t is None else t):
+            seen += site['hist'][top_us]
+            if seen >= rank:
+                if top_us is None:
+                    return site['max_us']
+                return min(top_us, site['max_us'])
+        return site['max_us']
+
+    def records(self):
+        """ Records sorted by worst case, the longest first """
+        result = []
+        for site in self.sites.values():
+            result.append({
+                'kind': site['kind'],
+                'site': site['site'],
+                'count': site['count'],
+                'max_us': round(site['max_us'], 3),
+                'p50_us': round(self.percentile(site, 50), 3),
+                'p99_us': round(self.percentile(site, 99), 3),
+            })
+        return sorted(result, key=lambda r: r['max_us'], reverse=True)
+
+    def compare(self, baseline, tolerance, slack_us):
+        """ Sites whose worst case or 99th percentile grew past the baseline
+
+        Positional arguments:
+        baseline - records of an earlier run, as exported in JSON
+        tolerance - allowed growth, percent
+        slack_us - allowed growth on top, in microseconds, for very short sites
+        """
+        known = dict(((r['kind'], r['site']), r) for r in baseline)
+        regressions = []
+        for record in self.records():
+            base = known.get((record['kind'], record['site']))
+            if base is None:
+                continue
+            for field in ('max_us', 'p99_us'):
+                limit = base[field] * (1 + tolerance / 100.0) + slack_us
+                if record[field] > limit:
+                    regressions.append((record, field, base[field]))
+        return regressions
+
+    def generate_table(self):
+        """ Human readable report """
+        table = PrettyTable(["Kind", "Site", "Count", "p50 us", "p99 us",
+                             "Max us"])
+        table.align["Site"] = "l"
+        for record in self.records():
+            table.add_row([record['kind'], record['site'], record['count'],
+                           "%.2f" % record['p50_us'], "%.2f" % record['p99_us'],
+                           "%.2f" % record['max_us']])
+        return table.get_string() + "\nDropped records: %d\n" % self.dropped
+
+    def generate_json(self):
+        """ Machine readable report, usable as a baseline """
+        return json.dumps(self.records(), indent=4, separators=(',', ': '))
+
+
+def main():
+    """Entry Point"""
+    version = '0.1.0'
+
+    parser = ArgumentParser(
+        description="Interrupt and critical section latency report for ARM mbed\n"
+        "version %s" % version)
+
+    parser.add_argument(
+        'logs', nargs='*',
+        help='serial logs containing lat lines (default: stdin)')
+
+    parser.add_argument(
+        '-m', '--map', required=False,
+        help='GCC_ARM or IAR memory map file, to name critical section call sites; '
+        'without it they are reported by address, which changes with every build')
+
+    parser.add_argument(
+        '-b', '--baseline', required=False,
+        help='JSON report of an earlier run; exit with an error if any site '
+        'got slower')
+
+    parser.add_argument(
+        '-t', '--tolerance', type=float, default=10.0,
+        help='growth over the baseline allowed, percent (default: 10)')
+
+    parser.add_argument(
+        '-s', '--slack', type=float, default=1.0,
+        help='growth over the baseline allowed on top of the tolerance, '
+        'microseconds (default: 1)')
+
+    parser.add_argument(
+        '-e', '--export', dest='export', required=False, default='table',
+        choices=LatencyReport.export_formats,
+        help="export format (examples: %s: default)" %
+        ", ".join(LatencyReport.export_formats))
+
+    parser.add_argument(
+        '-o', '--output', help='output file name', required=False)
+
+    parser.add_argument('-v', '--version', action='version', version=version)
+
+    args = parser.parse_args()
+
+    symbols = None
+    if args.map:
+        from tools.profile_symbolize import load_symbols
+        symbols = load_symbols(args.map)
+
+    report = LatencyReport(symbols)
+    if args.logs:
+        for log in args.logs:
+            with open(log) as log_file:
+                report.parse(log_file)
+    else:
+        report.parse(stdin)
+
+    if not report.sites:
+        print("No lat records found")
+        exit(1)
+
+    if args.export == 'json':
+        output = report.generate_json()
+    else:
+        output = report.generate_table()
+
+    if args.output:
+        with open(args.output, 'w') as output_file:
+            output_file.write(output)
+    else:
+        print(output)
+
+    if args.baseline:
+        with open(args.baseline) as baseline_file:
+            baseline = json.load(baseline_file)
+        regressions = report.compare(baseline, args.tolerance, args.slack)
+        for record, field, base in regressions:
+            print("Latency regression: %s %s %s %.2f us, baseline %.2f us" %
+                  (record['kind'], record['site'], field, record[field], base))
+        if regressions:
+            exit(1)
+
+    exit(0)
+
+if __name__ == "__main__":
+    main()
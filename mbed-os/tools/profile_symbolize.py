@@ -0,0 +1,357 @@
+#!/usr/bin/env python
+
+"""Sampling profile symbolizer for ARM mbed
+
+Resolves the "prof:" lines printed by mbed_profiler_print() against a GCC_ARM
+or IAR map file and reports a flat profile, folded stacks
+(thread;object;function count), or a flame graph rendered with
+memap_flamegraph.html.
+"""
+from __future__ import print_function, division, absolute_import
+
+import sys
+from sys import stdin, exit
+from os import sep
+from os.path import join, abspath, dirname, basename, splitext
+from bisect import bisect_right
+from collections import defaultdict
+from argparse import ArgumentParser
+import re
+import json
+
+# Be sure that the tools directory is in the search path
+ROOT = abspath(join(dirname(__file__), ".."))
+sys.path.insert(0, ROOT)
+
+from prettytable import PrettyTable
+from jinja2 import FileSystemLoader, StrictUndefined
+from jinja2.environment import Environment
+
+from tools.memap import _GccParser
+
+SAMPLE_RE = re.compile(r'prof: pc=0x(?P<pc>[0-9a-fA-F]+) ctx=(?P<ctx>.+?)\s*$')
+DROPPED_RE = re.compile(r'prof: dropped=(?P<dropped>\d+)')
+
+
+class _SymbolTable(object):
+    """Code ranges of an image, sorted by address"""
+
+    def __init__(self):
+        self.ranges = []
+        self.starts = []
+
+    def sort(self):
+        """ Index the ranges once they are all collected """
+        self.ranges.sort(key=lambda r: r[0])
+        self.starts = [r[0] for r in self.ranges]
+
+    def resolve(self, address):
+        """ Map an address to (object, symbol)
+
+        Positional arguments:
+        address - program counter value
+        """
+        index = bisect_right(self.starts, address) - 1
+        # Walk back over symbols of unknown size to the range holding the address
+        while index >= 0:
+            start, size, obj_name, symbol = self.ranges[index]
+            if size and address >= start + size:
+                break
+            if symbol is not None:
+                return (obj_name, symbol)
+            if size:
+                return (obj_name, '%s+0x%x' % (basename(obj_name), address - start))
+            index -= 1
+        return ('[unknown]', '0x%08x' % address)
+
+
+class _GccSymbolParser(_GccParser, _SymbolTable):
+    """GCC map parser that also keeps the address of every .text symbol"""
+
+    RE_SYMBOL = re.compile(r'^\s+0x(\w{8,16})\s+([^\s=].*)$')
+    RE_ASSIGNMENT = re.compile(r'\s=\s')
+    RE_TEXT_SECTION = re.compile(r'^\s*(\.text\S*)?\s*0x(\w{8,16})\s+0x(\w+)\s(.+)$')
+    RE_SECTION_NAME = re.compile(r'^\s+(\.text\S*)\s*$')
+
+    def __init__(self):
+        _GccParser.__init__(self)
+        _SymbolTable.__init__(self)
+
+    def parse_text(self, file_desc):
+        """ Collect (start, size, object, symbol) for all code in the image
+
+        Positional arguments:
+        file_desc - a stream object to parse as a gcc map file
+        """
+        current_section = 'unknown'
+        current_object = None
+        current_end = 0
+        section_name = None
+
+        with file_desc as infile:
+            for line in infile:
+                if line.startswith('Linker script and memory map'):
+                    break
+
+            for line in infile:
+                next_section = self.check_new_section(line)
+                if next_section == "OUTPUT":
+                    break
+                elif next_section:
+                    current_section = next_section
+                if current_section != '.text':
+                    continue
+
+                # Long input section names get a line of their own
+                is_name = re.match(self.RE_SECTION_NAME, line)
+                if is_name:
+                    section_name = is_name.group(1)
+                    continue
+
+                is_section = re.match(self.RE_TEXT_SECTION, line)
+                if is_section:
+                    start = int(is_section.group(2), 16)
+                    size = int(is_section.group(3), 16)
+                    name = is_section.group(1) or section_name
+                    section_name = None
+                    current_object = None
+                    if size:
+                        current_object = self.parse_object_name(
+                            is_section.group(4).strip())
+                        current_end = start + size
+                        # With -ffunction-sections a static function is
+                        # only known by its section
+                        function = name[len('.text.'):] \
+                            if name and name.startswith('.text.') else None
+                        self.ranges.append([start, size, current_object,
+                                            function])
+                    continue
+
+                is_symbol = re.match(self.RE_SYMBOL, line)
+                if is_symbol and current_object:
+                    address = int(is_symbol.group(1), 16)
+                    symbol = is_symbol.group(2).strip()
+                    if address >= current_end or \
+                            re.search(self.RE_ASSIGNMENT, symbol):
+                        continue
+                    # A symbol runs to the end of its input section at most
+                    self.ranges.append([address, current_end - address,
+                                        current_object, symbol])
+
+        self.sort()
+
+
+class _IarSymbolParser(_SymbolTable):
+    """Code symbols from the entry list of an IAR map file"""
+
+    RE_ENTRY = re.compile(
+        r'^(?P<name>\S+)?\s+0x(?P<address>[0-9a-fA-F\']+)\s+'
+        r'(?:0x(?P<size>[0-9a-fA-F\']+)\s+)?(?P<type>Code|Data|--)\s+'
+        r'(?:Gb|Lc|Wk)\s+(?P<object>.+?)\s*$')
+    RE_OBJECT_INDEX = re.compile(r'\s*\[\d+\]$')
+
+    def parse_text(self, file_desc):
+        """ Collect (start, size, object, symbol) for all code entries
+
+        Positional arguments:
+        file_desc - a stream object to parse as an IAR map file
+        """
+        with file_desc as infile:
+            for line in infile:
+                if line.startswith('*** ENTRY LIST'):
+                    break
+
+            name = None
+            for line in infile:
+                if line.startswith('*******'):
+                    break
+                entry = re.match(self.RE_ENTRY, line.rstrip())
+                if not entry:
+                    # Long names get a line of their own
+                    stripped = line.strip()
+                    name = stripped if stripped and ' ' not in stripped else None
+                    continue
+                if entry.group('name'):
+                    name = entry.group('name')
+                if entry.group('type') == 'Code' and name:
+                    # Thumb code entries are odd
+                    address = int(entry.group('address').replace("'", ""), 16) & ~1
+                    size = entry.group('size')
+                    obj = re.sub(self.RE_OBJECT_INDEX, '', entry.group('object'))
+                    self.ranges.append([address,
+                                        int(size.replace("'", ""), 16) if size else 0,
+                                        obj, name])
+                name = None
+
+        self.sort()
+
+
+def load_symbols(path):
+    """ Symbol table of a GCC_ARM or IAR map file, told apart by their header
+
+    Positional arguments:
+    path - map file
+    """
+    with open(path, 'r') as map_file:
+        head = map_file.read(4096)
+    if 'IAR ELF Linker' in head:
+        symbols = _IarSymbolParser()
+    else:
+        symbols = _GccSymbolParser()
+    symbols.parse_text(open(path, 'r'))
+    return symbols
+
+
+class Profile(object):
+    """Histogram of samples by thread, object and function"""
+
+    export_formats = ["table", "folded", "html"]
+
+    def __init__(self, symbols):
+        self.symbols = symbols
+        self.counts = defaultdict(int)
+        self.total = 0
+        self.dropped = 0
+
+    def parse(self, lines):
+        """ Read samples from log lines
+
+        Positional arguments:
+        lines - iterable of log lines; lines without a sample are skipped
+        """
+        for line in lines:
+            match = SAMPLE_RE.search(line)
+            if match:
+                pc = int(match.group('pc'), 16)
+                ctx = match.group('ctx')
+                if pc == 0:
+                    key = (ctx, '[isr]', ctx)
+                else:
+                    obj, symbol = self.symbols.resolve(pc & ~1)
+                    key = (ctx, obj, symbol)
+                self.counts[key] += 1
+                self.total += 1
+                continue
+            match = DROPPED_RE.search(line)
+            if match:
+                self.dropped += int(match.group('dropped'))
+
+    def flat(self):
+        """ (object, symbol, count) sorted by count """
+        flat = defaultdict(int)
+        for (_, obj, symbol), count in self.counts.items():
+            flat[(obj, symbol)] += count
+        return sorted(((o, s, c) for (o, s), c in flat.items()),
+                      key=lambda r: r[2], reverse=True)
+
+    def generate_table(self):
+        """ Flat profile """
+        table = PrettyTable(["Function", "Object", "Samples", "%"])
+        table.align["Function"] = "l"
+        table.align["Object"] = "l"
+        for obj, symbol, count in self.flat():
+            table.add_row([symbol, obj, count,
+                           "%.1f" % (100.0 * count / self.total)])
+        return table.get_string() + \
+            "\nTotal samples: %d, dropped: %d\n" % (self.total, self.dropped)
+
+    def generate_folded(self):
+        """ One line per stack, as consumed by flamegraph tools """
+        lines = []
+        for (ctx, obj, symbol), count in sorted(self.counts.items()):
+            lines.append("%s;%s;%s %d" % (ctx, obj, symbol, count))
+        return "\n".join(lines) + "\n"
+
+    def generate_html(self, name):
+        """ Flame graph through the memap template: threads and code objects """
+        tree_threads = {"name": "threads", "value": 0}
+        tree_code = {"name": "code", "value": 0}
+        for (ctx, obj, symbol), count in self.counts.items():
+            for tree, path in ((tree_threads, [ctx, obj, symbol]),
+                               (tree_code, obj.split(sep) + [symbol])):
+                node = tree
+                node["value"] += count
+                for part in path:
+                    node = self._child(node, part)
+                    node["value"] += count
+
+        jinja_loader = FileSystemLoader(join(ROOT, "tools"))
+        jinja_environment = Environment(loader=jinja_loader,
+                                        undefined=StrictUndefined)
+        template = jinja_environment.get_template("memap_flamegraph.html")
+        return template.render({
+            "name": "%s CPU profile" % name,
+            "rom": json.dumps(tree_threads),
+            "ram": json.dumps(tree_code),
+        })
+
+    @staticmethod
+    def _child(tree, name):
+        tree.setdefault("children", [])
+        for child in tree["children"]:
+            if child["name"] == name:
+                return child
+        new_child = {"name": name, "value": 0}
+        tree["children"].append(new_child)
+        return new_child
+
+
+def main():
+    """Entry Point"""
+    version = '0.1.0'
+
+    parser = ArgumentParser(
+        description="Sampling profile symbolizer for ARM mbed\nversion %s" %
+        version)
+
+    parser.add_argument('map', help='GCC_ARM or IAR memory map file of the image')
+
+    parser.add_argument(
+        'logs', nargs='*',
+        help='serial logs containing prof lines (default: stdin)')
+
+    parser.add_argument(
+        '-e', '--export', dest='export', required=False, default='table',
+        choices=Profile.export_formats,
+        help="export format (examples: %s: default)" %
+        ", ".join(Profile.export_formats))
+
+    parser.add_argument(
+        '-o', '--output', help='output file name', required=False)
+
+    parser.add_argument('-v', '--version', action='version', version=version)
+
+    args = parser.parse_args()
+
+    symbols = load_symbols(args.map)
+
+    profile = Profile(symbols)
+    if args.logs:
+        for log in args.logs:
+            with open(log) as log_file:
+                profile.parse(log_file)
+    else:
+        profile.parse(stdin)
+
+    if not profile.total:
+        print("No prof samples found")
+        exit(1)
+
+    if args.export == 'folded':
+        output = profile.generate_folded()
+    elif args.export == 'html':
+        name, _ = splitext(basename(args.map))
+        output = profile.generate_html(name)
+    else:
+        output = profile.generate_table()
+
+    if args.output:
+        with open(args.output, 'w') as output_file:
+            output_file.write(output)
+    else:
+        print(output)
+
+    exit(0)
+
+if __name__ == "__main__":
+    main()
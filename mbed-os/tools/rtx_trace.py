@@ -0,0 +1,354 @@
+#!/usr/bin/env python
+
+"""RTX event recorder decoder for ARM mbed
+
+Turns the records of rtos/TARGET_CORTEX/mbed_rtx_evr.c, either the "evr:"
+lines printed by rtos_event_recorder_print() or a raw dump of the evr_ring
+array, into a Chrome trace (load it in chrome://tracing or ui.perfetto.dev).
+
+The trace has one track for the CPU, showing which thread runs, and one track
+per thread with its running time, kernel calls and blocking waits. Heap usage
+is drawn as a counter; every other event is an instant marker.
+"""
+from __future__ import print_function, division, absolute_import
+
+import sys
+from sys import stdin, exit
+from os.path import join, abspath, dirname
+from argparse import ArgumentParser
+from collections import defaultdict
+import struct
+import re
+import json
+
+# Be sure that the tools directory is in the search path
+ROOT = abspath(join(dirname(__file__), ".."))
+sys.path.insert(0, ROOT)
+
+RTX_EVR_SOURCE = join(ROOT, "rtos", "TARGET_CORTEX", "rtx5", "RTX", "Source",
+                      "rtx_evr.c")
+
+HEADER_RE = re.compile(r'evr: freq=(?P<freq>\d+) bits=(?P<bits>\d+)')
+RECORD_RE = re.compile(r'evr: ([0-9a-fA-F]{8}) ([0-9a-fA-F]{8}) '
+                       r'([0-9a-fA-F]{8}) ([0-9a-fA-F]{8})\s*$')
+THREAD_RE = re.compile(r'evr: thread id=0x(?P<id>[0-9a-fA-F]+) name=(?P<name>.*?)\s*$')
+LOST_RE = re.compile(r'evr: lost=(?P<lost>\d+)')
+
+RE_COMPONENT = re.compile(r'#define\s+(EvtRtx\w+No)\s+\(0x([0-9A-Fa-f]+)U\)')
+RE_EVENT = re.compile(r'#define\s+EvtRtx(\w+)\s+EventID\(EventLevel(\w+),\s*'
+                      r'(EvtRtx\w+No),\s*0x([0-9A-Fa-f]+)U\)')
+
+RECORD_CONTINUED = 0x80000000
+RECORD_TAG_MASK = 0x7F000000
+RECORD_ID_MASK = 0x0003FFFF
+RECORD_SIZE = 16
+
+LEVELS = ["Error", "API", "Op", "Detail"]
+
+PID_CPU = 0
+PID_THREADS = 1
+
+
+def load_event_names(path=RTX_EVR_SOURCE):
+    """ Map event IDs to names, e.g. 0x2f219 -> ThreadSwitched
+
+    Positional arguments:
+    path - rtx_evr.c, which defines every event ID
+    """
+    with open(path) as source:
+        text = source.read()
+    components = dict((name, int(number, 16))
+                      for name, number in RE_COMPONENT.findall(text))
+    names = {}
+    for name, level, component, message in RE_EVENT.findall(text):
+        event_id = (LEVELS.index(level) << 16) | \
+            (components[component] << 8) | int(message, 16)
+        names[event_id] = name
+    return names
+
+
+class EventLog(object):
+    """Ordered event records with timestamps in microseconds"""
+
+    def __init__(self, freq=1000000, bits=32):
+        self.freq = freq
+        self.bits = bits
+        self.raw = []
+        self.thread_names = {}
+        self.lost = 0
+
+    def parse(self, lines):
+        """ Read records from log lines
+
+        Positional arguments:
+        lines - iterable of log lines; lines without a record are skipped
+        """
+        for line in lines:
+            match = RECORD_RE.search(line)
+            if match:
+                self.raw.append([int(value, 16) for value in match.groups()])
+                continue
+            match = HEADER_RE.search(line)
+            if match:
+                self.freq = int(match.group('freq'))
+                self.bits = int(match.group('bits'))
+                continue
+            match = THREAD_RE.search(line)
+            if match:
+                self.thread_names[int(match.group('id'), 16)] = match.group('name')
+                continue
+            match = LOST_RE.search(line)
+            if match:
+                self.lost += int(match.group('lost'))
+
+    def parse_raw(self, data):
+        """ Read a memory dump of the evr_ring array
+
+        The ring holds at most two laps; the lap tag of each record tells
+        where the newest record is.
+
+        Positional arguments:
+        data - bytes of the dump, little endian
+        """
+        records = []
+        for offset in range(0, len(data) - RECORD_SIZE + 1, RECORD_SIZE):
+            records.append(list(struct.unpack_from('<4I', data, offset)))
+        if not records:
+            return
+        first_tag = records[0][1] & RECORD_TAG_MASK
+        split = len(records)
+        for index, record in enumerate(records):
+            if record[1] & RECORD_TAG_MASK != first_tag:
+                split = index
+                break
+        for record in records[split:] + records[:split]:
+            if record[1] & RECORD_TAG_MASK:
+                record[1] &= ~RECORD_TAG_MASK
+                self.raw.append(record)
+
+    def events(self):
+        """ Yield (time_us, event_id, values), merging continued records """
+        mask = (1 << self.bits) - 1
+        previous = None
+        elapsed = 0
+        last_time = 0
+        pending = None
+        for timestamp, event_id, val1, val2 in self.raw:
+            if previous is not None:
+                elapsed += (timestamp - previous) & mask
+            previous = timestamp
+            # Sequence order is authoritative: a writer preempted between
+            # claiming a record and reading the timer may be late
+            time_us = max(last_time, elapsed * 1000000.0 / self.freq)
+            last_time = time_us
+            if event_id & RECORD_CONTINUED:
+                if pending and pending[1] == event_id & RECORD_ID_MASK:
+                    pending[2].extend([val1, val2])
+                    yield tuple(pending)
+                pending = None
+                continue
+            if pending:
+                yield tuple(pending)
+            pending = [time_us, event_id & RECORD_ID_MASK, [val1, val2]]
+        if pending:
+            yield tuple(pending)
+
+
+class Timeline(object):
+    """Chrome trace built from the kernel events"""
+
+    def __init__(self, names, thread_names):
+        self.names = names
+        self.thread_names = thread_names
+        self.trace = []
+        self.running = None             # (thread id, start)
+        self.calls = {}                 # thread id -> (API name, start, values)
+        self.last_call = {}             # thread id -> name of its latest API call
+        self.blocked = {}               # thread id -> (reason, start, timeout)
+        self.run_end = defaultdict(float)
+        self.heap = defaultdict(int)
+        self.blocks = {}
+        self.threads = set()
+
+    def thread_name(self, thread):
+        return self.thread_names.get(thread, "0x%08x" % thread)
+
+    def _slice(self, pid, tid, name, start, end, args=None):
+        event = {"ph": "X", "pid": pid, "tid": tid, "name": name,
+                 "ts": start, "dur": max(end - start, 0)}
+        if args:
+            event["args"] = args
+        self.trace.append(event)
+
+    def _end_call(self, thread, end):
+        call = self.calls.pop(thread, None)
+        if call:
+            name, start, values = call
+            self._slice(PID_THREADS, thread, name, start, end,
+                        {"values": ["0x%x" % v for v in values]})
+
+    def add(self, time_us, event_id, values):
+        name = self.names.get(event_id, "Event0x%05x" % event_id)
+        level = (event_id >> 16) & 3
+        current = self.running[0] if self.running else None
+
+        if name == "ThreadSwitched":
+            if self.running:
+                thread, start = self.running
+                self._end_call(thread, time_us)
+                self._slice(PID_CPU, 0, self.thread_name(thread), start, time_us)
+                self._slice(PID_THREADS, thread, "running", start, time_us)
+                self.run_end[thread] = time_us
+            self.running = (values[0], time_us)
+            self.threads.add(values[0])
+            return
+
+        if name == "ThreadBlocked":
+            thread = values[0]
+            reason = self.last_call.get(thread, "blocked")
+            self.blocked[thread] = (reason, time_us, values[1])
+            return
+
+        if name == "ThreadUnblocked":
+            thread = values[0]
+            wait = self.blocked.pop(thread, None)
+            if wait:
+                reason, start, timeout = wait
+                start = max(start, self.run_end[thread])
+                self._slice(PID_THREADS, thread, "wait %s" % reason, start, time_us,
+                            {"timeout": timeout, "ret_val": values[1]})
+            return
+
+        if name == "MemoryAlloc" and len(values) == 4:
+            mem, size, _, block = values
+            if block:
+                self.blocks[(mem, block)] = size
+                self.heap[mem] += size
+                self._counter(mem, time_us)
+            return
+
+        if name == "MemoryFree" and len(values) >= 2:
+            mem, block = values[0], values[1]
+            size = self.blocks.pop((mem, block), 0)
+            if size:
+                self.heap[mem] -= size
+                self._counter(mem, time_us)
+            return
+
+        if current is None:
+            tid, pid = 0, PID_CPU
+        else:
+            tid, pid = current, PID_THREADS
+
+        if level == 1 and current is not None:
+            # An API call runs in the kernel until its next event
+            self._end_call(current, time_us)
+            self.calls[current] = (name, time_us, values)
+            self.last_call[current] = name
+            return
+
+        if current is not None and level in (0, 2):
+            self._end_call(current, time_us)
+
+        self.trace.append({"ph": "i", "s": "t", "pid": pid, "tid": tid,
+                           "name": name, "ts": time_us,
+                           "args": {"values": ["0x%x" % v for v in values]}})
+
+    def _counter(self, mem, time_us):
+        self.trace.append({"ph": "C", "pid": PID_CPU, "name": "heap 0x%08x" % mem,
+                           "ts": time_us, "args": {"bytes": self.heap[mem]}})
+
+    def finish(self, end):
+        """ Close open slices and add the track names """
+        if self.running:
+            thread, start = self.running
+            self._end_call(thread, end)
+            self._slice(PID_CPU, 0, self.thread_name(thread), start, end)
+            self._slice(PID_THREADS, thread, "running", start, end)
+        for thread, (reason, start, timeout) in self.blocked.items():
+            self._slice(PID_THREADS, thread, "wait %s" % reason,
+                        max(start, self.run_end[thread]), end, {"timeout": timeout})
+        self.trace.append({"ph": "M", "pid": PID_CPU, "name": "process_name",
+                           "args": {"name": "CPU"}})
+        self.trace.append({"ph": "M", "pid": PID_THREADS, "name": "process_name",
+                           "args": {"name": "Threads"}})
+        for thread in self.threads:
+            self.trace.append({"ph": "M", "pid": PID_THREADS, "tid": thread,
+                               "name": "thread_name",
+                               "args": {"name": self.thread_name(thread)}})
+
+    def generate_json(self):
+        return json.dumps({"traceEvents": self.trace,
+                           "displayTimeUnit": "ns"}, indent=1)
+
+
+def main():
+    """Entry Point"""
+    version = '0.1.0'
+
+    parser = ArgumentParser(
+        description="RTX event recorder decoder for ARM mbed\nversion %s" %
+        version)
+
+    parser.add_argument(
+        'logs', nargs='*',
+        help='serial logs containing evr lines, or raw dumps with --raw '
+        '(default: stdin)')
+
+    parser.add_argument(
+        '-r', '--raw', action='store_true',
+        help='inputs are memory dumps of the evr_ring array')
+
+    parser.add_argument(
+        '-f', '--freq', type=int, default=1000000,
+        help='us ticker frequency for raw dumps (default: 1000000)')
+
+    parser.add_argument(
+        '-b', '--bits', type=int, default=32,
+        help='us ticker width for raw dumps (default: 32)')
+
+    parser.add_argument(
+        '-o', '--output', help='output file name', required=False)
+
+    parser.add_argument('-v', '--version', action='version', version=version)
+
+    args = parser.parse_args()
+
+    log = EventLog(args.freq, args.bits)
+    if args.raw:
+        for dump in args.logs:
+            with open(dump, 'rb') as dump_file:
+                log.parse_raw(dump_file.read())
+    elif args.logs:
+        for name in args.logs:
+            with open(name) as log_file:
+                log.parse(log_file)
+    else:
+        log.parse(stdin)
+
+    if not log.raw:
+        print("No evr records found")
+        exit(1)
+
+    timeline = Timeline(load_event_names(), log.thread_names)
+    end = 0
+    for time_us, event_id, values in log.events():
+        timeline.add(time_us, event_id, values)
+        end = time_us
+    timeline.finish(end)
+    output = timeline.generate_json()
+
+    if args.output:
+        with open(args.output, 'w') as output_file:
+            output_file.write(output)
+    else:
+        print(output)
+
+    if log.lost:
+        print("%d records were overwritten before they were read" % log.lost,
+              file=sys.stderr)
+
+    exit(0)
+
+if __name__ == "__main__":
+    main()
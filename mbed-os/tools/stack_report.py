@@ -0,0 +1,140 @@
+#!/usr/bin/env python
+
+"""Stack high-water report for ARM mbed
+
+Turns the "stackmon:" lines printed by rtos_stack_monitor_print() into a
+table of per-thread stack usage and recommended stack sizes. Several logs,
+e.g. from several devices or boots, can be given; the worst case wins.
+"""
+from __future__ import print_function, division, absolute_import
+
+from sys import stdin, exit
+import re
+import json
+from argparse import ArgumentParser
+from prettytable import PrettyTable
+
+LINE_RE = re.compile(
+    r'stackmon: name=(?P<name>\S+) stack=(?P<stack>0x[0-9a-fA-F]+) '
+    r'size=(?P<size>\d+) peak=(?P<peak>\d+) '
+    r'recommended=(?P<recommended>\d+) overflow=(?P<overflow>\d+)')
+
+
+class StackReport(object):
+    """Collects stack monitor records and reports on them"""
+
+    export_formats = ["table", "json"]
+
+    def __init__(self):
+        self.stacks = dict()
+
+    def parse(self, lines):
+        """ Read stack monitor records from log lines
+
+        Positional arguments:
+        lines - iterable of log lines; lines without a record are skipped
+        """
+        for line in lines:
+            match = LINE_RE.search(line)
+            if not match:
+                continue
+            key = (match.group('stack'), int(match.group('size')))
+            record = {
+                'name': match.group('name'),
+                'stack': match.group('stack'),
+                'size': int(match.group('size')),
+                'peak': int(match.group('peak')),
+                'recommended': int(match.group('recommended')),
+                'overflow': int(match.group('overflow')) != 0,
+            }
+            known = self.stacks.get(key)
+            if known is None:
+                self.stacks[key] = record
+            else:
+                known['peak'] = max(known['peak'], record['peak'])
+                known['recommended'] = max(known['recommended'],
+                                           record['recommended'])
+                known['overflow'] = known['overflow'] or record['overflow']
+
+    def records(self):
+        """ Records sorted by the number of bytes that could be reclaimed """
+        result = []
+        for record in self.stacks.values():
+            record = dict(record)
+            record['reclaimable'] = record['size'] - record['recommended']
+            result.append(record)
+        return sorted(result, key=lambda r: r['reclaimable'], reverse=True)
+
+    def generate_table(self):
+        """ Human readable report """
+        table = PrettyTable(["Thread", "Stack", "Size", "Peak", "Used %",
+                             "Recommended", "Reclaimable"])
+        table.align["Thread"] = "l"
+        total = 0
+        for record in self.records():
+            used = 100.0 * record['peak'] / record['size'] if record['size'] else 0
+            table.add_row([
+                record['name'] + (" (OVERFLOW)" if record['overflow'] else ""),
+                record['stack'], record['size'], record['peak'],
+                "%.1f" % used, record['recommended'], record['reclaimable']])
+            if record['reclaimable'] > 0:
+                total += record['reclaimable']
+        return table.get_string() + "\nTotal reclaimable RAM: %d bytes\n" % total
+
+    def generate_json(self):
+        """ Machine readable report """
+        return json.dumps(self.records(), indent=4, separators=(',', ': '))
+
+
+def main():
+    """Entry Point"""
+    version = '0.1.0'
+
+    parser = ArgumentParser(
+        description="Stack high-water report for ARM mbed\nversion %s" %
+        version)
+
+    parser.add_argument(
+        'logs', nargs='*',
+        help='serial logs containing stackmon lines (default: stdin)')
+
+    parser.add_argument(
+        '-e', '--export', dest='export', required=False, default='table',
+        choices=StackReport.export_formats,
+        help="export format (examples: %s: default)" %
+        ", ".join(StackReport.export_formats))
+
+    parser.add_argument(
+        '-o', '--output', help='output file name', required=False)
+
+    parser.add_argument('-v', '--version', action='version', version=version)
+
+    args = parser.parse_args()
+
+    report = StackReport()
+    if args.logs:
+        for log in args.logs:
+            with open(log) as log_file:
+                report.parse(log_file)
+    else:
+        report.parse(stdin)
+
+    if not report.stacks:
+        print("No stackmon records found")
+        exit(1)
+
+    if args.export == 'json':
+        output = report.generate_json()
+    else:
+        output = report.generate_table()
+
+    if args.output:
+        with open(args.output, 'w') as output_file:
+            output_file.write(output)
+    else:
+        print(output)
+
+    exit(0)
+
+if __name__ == "__main__":
+    main()
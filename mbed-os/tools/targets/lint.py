@@ -77,12 +77,12 @@ def check_inherits(dict):
     if  ("inherits" in dict and len(dict["inherits"]) > 1):
         yield "multiple inheritance is forbidden"
 
-DEVICE_HAS_ALLOWED = ["ANALOGIN", "ANALOGOUT", "CAN", "ETHERNET", "EMAC",
+DEVICE_HAS_ALLOWED = ["ANALOGIN", "ANALOGIN_BURST", "ANALOGOUT", "CAN", "CRC", "ETHERNET", "EMAC",
                       "FLASH", "I2C", "I2CSLAVE", "I2C_ASYNCH", "INTERRUPTIN",
                       "LPTICKER", "PORTIN", "PORTINOUT", "PORTOUT",
                       "PWMOUT", "RTC", "TRNG","SERIAL", "SERIAL_ASYNCH",
-                      "SERIAL_FC", "SLEEP", "SPI", "SPI_ASYNCH", "SPISLAVE",
-                      "STORAGE", "STCLK_OFF_DURING_SLEEP"]
+                      "SERIAL_DMA", "SERIAL_FC", "SLEEP", "SPI", "SPI_ASYNCH",
+                      "SPISLAVE", "STORAGE", "STCLK_OFF_DURING_SLEEP"]
 def check_device_has(dict):
     for name in dict.get("device_has", []):
         if name not in DEVICE_HAS_ALLOWED:
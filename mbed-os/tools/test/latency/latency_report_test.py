@@ -0,0 +1,30 @@
+from os.path import join, dirname
+
+from tools.profile_symbolize import load_symbols, _IarSymbolParser
+from tools.latency_report import LatencyReport
+
+
+def test_iar_entries():
+    symbols = load_symbols(join(dirname(__file__), "iar.map"))
+
+    assert isinstance(symbols, _IarSymbolParser)
+    assert symbols.resolve(0x08003c40) == \
+        ("mbed_critical.o", "core_util_critical_section_enter")
+    assert symbols.resolve(0x08003c6c + 0x10) == \
+        ("mbed_critical.o", "core_util_critical_section_exit")
+    assert symbols.resolve(0x08004041) == ("main.o", "node_spool_frame")
+    # Data entries are not code, nor is anything past the last function
+    assert symbols.resolve(0x08008000) == ("[unknown]", "0x08008000")
+    assert symbols.resolve(0x08004041 + 0x18) == ("[unknown]", "0x08004059")
+
+
+def test_critical_sites_named_from_iar_map():
+    report = LatencyReport(load_symbols(join(dirname(__file__), "iar.map")))
+    report.parse([
+        "lat: kind=0 id=0x08004013 count=2 max=40 p50=32 p99=40 hist=10:1,11:1",
+        "lat: kind=1 id=0x0000002c count=1 max=8 p50=8 p99=8 hist=6:1",
+        "lat: hz=80000000 dropped=0",
+    ])
+
+    names = sorted(record['site'] for record in report.records())
+    assert names == ["irq44", "main"]
@@ -0,0 +1,109 @@
+from os import sep
+from os.path import join, dirname
+
+from tools.profile_symbolize import load_symbols, Profile, _GccSymbolParser
+
+GCC_MAP = join(dirname(__file__), "gcc.map")
+BUILD = "./BUILD/WISE_1510/GCC_ARM/".replace('/', sep)
+MAIN = BUILD + "main.o"
+CRITICAL = BUILD + join("mbed-os", "platform", "mbed_critical.o")
+MEMCPY = join("[lib]", "c_nano.a", "lib_a-memcpy.o")
+
+
+def test_gcc_symbols():
+    symbols = load_symbols(GCC_MAP)
+
+    assert isinstance(symbols, _GccSymbolParser)
+    assert symbols.resolve(0x08000200) == (MAIN, "main")
+    assert symbols.resolve(0x08000263) == (MAIN, "main")
+    assert symbols.resolve(0x08000270) == (MAIN, "node_spool_frame")
+    assert symbols.resolve(0x080002b0) == \
+        (CRITICAL, "core_util_critical_section_enter")
+    # Demangled C++ names are kept whole
+    assert symbols.resolve(0x080002e0)[1] == \
+        "mbed::RingBuffer<unsigned char, 256ul>::push(unsigned char const&)"
+    assert symbols.resolve(0x08000304) == (MEMCPY, "memcpy")
+
+
+def test_gcc_symbols_bounded_by_their_section():
+    symbols = load_symbols(GCC_MAP)
+
+    assert symbols.resolve(0x080001cf)[1] == "Default_Handler"
+    # Past the last function, or outside the code, nothing is guessed
+    assert symbols.resolve(0x08000310) == ("[unknown]", "0x08000310")
+    assert symbols.resolve(0x08000500) == ("[unknown]", "0x08000500")
+    assert symbols.resolve(0x07fffffe) == ("[unknown]", "0x07fffffe")
+    assert symbols.resolve(0x20000188) == ("[unknown]", "0x20000188")
+    # The vector table is data
+    assert symbols.resolve(0x08000004) == ("[unknown]", "0x08000004")
+
+
+def test_gcc_code_without_symbols():
+    symbols = load_symbols(GCC_MAP)
+
+    # A static function keeps the name of its input section
+    assert symbols.resolve(0x08000298) == (MAIN, "spool_crc")
+    # Assembly without global symbols is named by object and offset
+    assert symbols.resolve(0x080001e4)[1] == "irq_cm4f.o+0x14"
+
+
+def test_gcc_linker_assignments_are_not_symbols():
+    symbols = load_symbols(GCC_MAP)
+
+    names = [r[3] for r in symbols.ranges]
+    assert "_etext = ." not in names
+    assert ". = ALIGN (0x4)" not in names
+    assert "node_count" not in names
+
+
+def profile_of(lines):
+    profile = Profile(load_symbols(GCC_MAP))
+    profile.parse(lines)
+    return profile
+
+
+def test_profile_samples():
+    profile = profile_of([
+        "boot",
+        "prof: pc=0x08000201 ctx=main",
+        "prof: pc=0x08000211 ctx=main",
+        "[00:01] prof: pc=0x08000299 ctx=main",
+        "prof: pc=0x080002b1 ctx=lora",
+        "prof: pc=0x00000000 ctx=irq28",
+        "prof: pc=0x0800ffff ctx=lora",
+        "prof: dropped=3",
+        "prof: dropped=2",
+    ])
+
+    assert profile.total == 6
+    assert profile.dropped == 5
+    # Ties come in any order
+    assert sorted(profile.flat()) == sorted([
+        (MAIN, "main", 2),
+        (MAIN, "spool_crc", 1),
+        (CRITICAL, "core_util_critical_section_enter", 1),
+        ("[isr]", "irq28", 1),
+        ("[unknown]", "0x0800fffe", 1),
+    ])
+    assert profile.flat()[0] == (MAIN, "main", 2)
+
+
+def test_profile_exports():
+    profile = profile_of([
+        "prof: pc=0x08000201 ctx=main",
+        "prof: pc=0x08000201 ctx=main",
+        "prof: pc=0x080002b1 ctx=lora",
+        "prof: dropped=1",
+    ])
+
+    assert profile.generate_folded() == \
+        "lora;%s;core_util_critical_section_enter 1\n" \
+        "main;%s;main 2\n" % (CRITICAL, MAIN)
+
+    table = profile.generate_table()
+    assert "66.7" in table
+    assert "Total samples: 3, dropped: 1" in table
+
+    html = profile.generate_html("loranode")
+    assert "loranode CPU profile" in html
+    assert "core_util_critical_section_enter" in html
@@ -0,0 +1,286 @@
+/**
+ * @file node_energy.cpp
+ *
+ * @brief Energy accounting and battery life projection
+ *
+ * The CPU buckets are fed from the microsecond ticker, which runs while the
+ * CPU is awake, read through its 64-bit count so that no gap between calls
+ * is too long, and from the seconds declared through node_energy_deep_sleep().
+ * Where mbed CPU statistics are available (MBED_CPU_STATS_ENABLED, with a low
+ * power ticker), the sleep manager's sleep and deep sleep times split the
+ * awake time further; otherwise all of it counts as run, so NODE_ENERGY_UA_RUN
+ * should be the average awake current.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef NODE_ENERGY_HOST
+#include "mbed.h"
+#include "platform/mbed_stats.h"
+#include "hal/ticker_api.h"
+#include "hal/us_ticker_api.h"
+#endif
+#include "node_energy.h"
+
+#ifndef NODE_ENERGY_UA_RUN
+#define NODE_ENERGY_UA_RUN          3000
+#endif
+#ifndef NODE_ENERGY_UA_SLEEP
+#define NODE_ENERGY_UA_SLEEP        1200
+#endif
+#ifndef NODE_ENERGY_UA_DEEP_SLEEP
+#define NODE_ENERGY_UA_DEEP_SLEEP   15
+#endif
+#ifndef NODE_ENERGY_UA_RADIO_TX
+#define NODE_ENERGY_UA_RADIO_TX     44000   ///< SX1276 at 14 dBm
+#endif
+#ifndef NODE_ENERGY_UA_RADIO_RX
+#define NODE_ENERGY_UA_RADIO_RX     11500
+#endif
+#ifndef NODE_ENERGY_UA_SENSOR1
+#define NODE_ENERGY_UA_SENSOR1      200     ///< HDC1010 converting
+#endif
+#ifndef NODE_ENERGY_UA_SENSOR2
+#define NODE_ENERGY_UA_SENSOR2      0
+#endif
+
+#define NODE_ENERGY_LORAWAN_OVERHEAD    13  ///< MHDR, FHDR, FPort and MIC
+#define NODE_ENERGY_US_PER_DAY          86400000000ULL
+
+static unsigned int energy_ua[NODE_ENERGY_BUCKETS] =
+{
+    NODE_ENERGY_UA_RUN,
+    NODE_ENERGY_UA_SLEEP,
+    NODE_ENERGY_UA_DEEP_SLEEP,
+    NODE_ENERGY_UA_RADIO_TX,
+    NODE_ENERGY_UA_RADIO_RX,
+    NODE_ENERGY_UA_SENSOR1,
+    NODE_ENERGY_UA_SENSOR2,
+};
+
+void node_energy_set_current(int bucket, unsigned int ua)
+{
+    if (bucket >= 0 && bucket < NODE_ENERGY_BUCKETS)
+        energy_ua[bucket] = ua;
+}
+
+static unsigned int energy_sf(unsigned char data_rate)
+{
+    return (data_rate < 5) ? 12 - data_rate : 7;
+}
+
+/** @brief LoRa symbol time at 125 kHz */
+static unsigned int energy_symbol_us(unsigned int sf)
+{
+    return (1u << sf) * 8;
+}
+
+static unsigned int energy_rx_us(unsigned char data_rate)
+{
+    return 2 * NODE_ENERGY_RX_SYMBOLS * energy_symbol_us(energy_sf(data_rate));
+}
+
+unsigned int node_energy_airtime_us(unsigned char data_rate, unsigned char payload_len)
+{
+    unsigned int sf = energy_sf(data_rate);
+    unsigned int de = (sf >= 11) ? 1 : 0;     // low data rate optimisation
+    int pl = payload_len + NODE_ENERGY_LORAWAN_OVERHEAD;
+    int num = 8 * pl - 4 * (int)sf + 28 + 16;
+    int den = 4 * (sf - 2 * de);
+    unsigned int symbols = 8;
+
+    if (num > 0)
+        symbols += (num + den - 1) / den * 5;
+
+    // 8 preamble symbols and 4.25 for the sync word
+    return (49 + 4 * symbols) * energy_symbol_us(sf) / 4;
+}
+
+void node_energy_fill(const uint64_t *time_us, unsigned int uplinks, struct node_energy_report *report)
+{
+    uint64_t elapsed = time_us[NODE_ENERGY_RUN] + time_us[NODE_ENERGY_SLEEP] + time_us[NODE_ENERGY_DEEP_SLEEP];
+
+    report->total_uah = 0;
+    for (int i = 0; i < NODE_ENERGY_BUCKETS; i++)
+    {
+        report->time_us[i] = time_us[i];
+        report->charge_uah[i] = (float)time_us[i] * energy_ua[i] / 3.6e9f;
+        report->total_uah += report->charge_uah[i];
+    }
+
+    report->uplinks = uplinks;
+    report->uah_per_uplink = uplinks ? report->total_uah / uplinks : 0;
+    report->mah_per_day = elapsed ? report->total_uah / 1000 * ((float)NODE_ENERGY_US_PER_DAY / elapsed) : 0;
+    report->battery_days = (report->mah_per_day > 0) ? NODE_ENERGY_BATTERY_MAH / report->mah_per_day : 0;
+}
+
+void node_energy_simulate(const struct node_energy_profile *profile, struct node_energy_report *report)
+{
+    uint64_t time_us[NODE_ENERGY_BUCKETS] = {0};
+    uint64_t interval = (uint64_t)profile->interval_sec * 1000000;
+    unsigned int uplinks = profile->interval_sec ? 86400 / profile->interval_sec : 0;
+
+    time_us[NODE_ENERGY_RADIO_TX] = node_energy_airtime_us(profile->data_rate, profile->payload_len);
+    time_us[NODE_ENERGY_RADIO_RX] = energy_rx_us(profile->data_rate);
+    time_us[NODE_ENERGY_SENSOR1] = profile->sensor_us[0];
+    time_us[NODE_ENERGY_SENSOR2] = profile->sensor_us[1];
+    time_us[NODE_ENERGY_RUN] = (profile->run_us < interval) ? profile->run_us : interval;
+    time_us[profile->deep_sleep ? NODE_ENERGY_DEEP_SLEEP : NODE_ENERGY_SLEEP] = interval - time_us[NODE_ENERGY_RUN];
+
+    for (int i = 0; i < NODE_ENERGY_BUCKETS; i++)
+        time_us[i] *= uplinks;
+
+    node_energy_fill(time_us, uplinks, report);
+}
+
+#ifndef NODE_ENERGY_HOST
+
+#if defined(MBED_CPU_STATS_ENABLED) && DEVICE_LPTICKER && DEVICE_SLEEP
+#define NODE_ENERGY_CPU_STATS   1
+#else
+#define NODE_ENERGY_CPU_STATS   0
+#endif
+
+static uint64_t energy_us[NODE_ENERGY_BUCKETS];
+static unsigned int energy_uplinks;
+static bool energy_started;
+static uint64_t energy_last;                            ///< Microsecond ticker at the last update
+static uint64_t energy_on_since[NODE_ENERGY_BUCKETS];   ///< Ticker when a load was last accounted
+static bool energy_on[NODE_ENERGY_BUCKETS];
+static bool energy_tx_pending;
+static uint64_t energy_tx_start;
+static unsigned int energy_tx_air_us;
+static unsigned int energy_tx_rx_us;
+#if NODE_ENERGY_CPU_STATS
+static us_timestamp_t energy_sleep_last;
+static us_timestamp_t energy_deep_sleep_last;
+#endif
+
+static uint64_t energy_now(void)
+{
+    return ticker_read_us(get_us_ticker_data());
+}
+
+/** @brief Account the time since the last update; called in a critical section */
+static uint64_t energy_update(void)
+{
+    uint64_t now = energy_now();
+    uint64_t delta = now - energy_last;
+
+    energy_last = now;
+#if NODE_ENERGY_CPU_STATS
+    mbed_stats_cpu_t stats;
+    mbed_stats_cpu_get(&stats);
+    us_timestamp_t sleep = stats.sleep_time - energy_sleep_last;
+    us_timestamp_t deep_sleep = stats.deep_sleep_time - energy_deep_sleep_last;
+    energy_sleep_last = stats.sleep_time;
+    energy_deep_sleep_last = stats.deep_sleep_time;
+    energy_us[NODE_ENERGY_SLEEP] += sleep;
+    energy_us[NODE_ENERGY_DEEP_SLEEP] += deep_sleep;
+    if (sleep + deep_sleep < delta)
+        energy_us[NODE_ENERGY_RUN] += delta - sleep - deep_sleep;
+#else
+    energy_us[NODE_ENERGY_RUN] += delta;
+#endif
+
+    for (int i = NODE_ENERGY_SENSOR1; i < NODE_ENERGY_BUCKETS; i++)
+    {
+        if (energy_on[i])
+        {
+            energy_us[i] += now - energy_on_since[i];
+            energy_on_since[i] = now;
+        }
+    }
+    return now;
+}
+
+void node_energy_init(void)
+{
+    core_util_critical_section_enter();
+    memset(energy_us, 0, sizeof(energy_us));
+    energy_uplinks = 0;
+    energy_tx_pending = false;
+    energy_last = energy_now();
+#if NODE_ENERGY_CPU_STATS
+    mbed_stats_cpu_t stats;
+    mbed_stats_cpu_get(&stats);
+    energy_sleep_last = stats.sleep_time;
+    energy_deep_sleep_last = stats.deep_sleep_time;
+#endif
+    energy_started = true;
+    core_util_critical_section_exit();
+}
+
+void node_energy_load(int bucket, unsigned char on)
+{
+    if (bucket < NODE_ENERGY_SENSOR1 || bucket >= NODE_ENERGY_BUCKETS || !energy_started)
+        return;
+
+    core_util_critical_section_enter();
+    uint64_t now = energy_update();
+    if (on && !energy_on[bucket])
+        energy_on_since[bucket] = now;
+    energy_on[bucket] = on;
+    core_util_critical_section_exit();
+}
+
+void node_energy_tx_start(unsigned char data_rate, unsigned char payload_len)
+{
+    if (!energy_started)
+        return;
+
+    unsigned int air_us = node_energy_airtime_us(data_rate, payload_len);
+    unsigned int rx_us = energy_rx_us(data_rate);
+
+    core_util_critical_section_enter();
+    energy_tx_start = energy_update();
+    energy_tx_air_us = air_us;
+    energy_tx_rx_us = rx_us;
+    energy_tx_pending = true;
+    energy_uplinks++;
+    core_util_critical_section_exit();
+}
+
+void node_energy_tx_done(void)
+{
+    core_util_critical_section_enter();
+    if (energy_tx_pending)
+    {
+        uint64_t elapsed = energy_update() - energy_tx_start;
+        uint64_t tx = (energy_tx_air_us < elapsed) ? energy_tx_air_us : elapsed;
+        uint64_t rx = (energy_tx_rx_us < elapsed - tx) ? energy_tx_rx_us : elapsed - tx;
+
+        energy_us[NODE_ENERGY_RADIO_TX] += tx;
+        energy_us[NODE_ENERGY_RADIO_RX] += rx;
+        energy_tx_pending = false;
+    }
+    core_util_critical_section_exit();
+}
+
+void node_energy_deep_sleep(unsigned int sec)
+{
+    if (!energy_started)
+        return;
+
+    core_util_critical_section_enter();
+    energy_update();
+    energy_us[NODE_ENERGY_DEEP_SLEEP] += (uint64_t)sec * 1000000;
+    core_util_critical_section_exit();
+}
+
+void node_energy_get_report(struct node_energy_report *report)
+{
+    uint64_t time_us[NODE_ENERGY_BUCKETS];
+    unsigned int uplinks;
+
+    core_util_critical_section_enter();
+    if (energy_started)
+        energy_update();
+    memcpy(time_us, energy_us, sizeof(time_us));
+    uplinks = energy_uplinks;
+    core_util_critical_section_exit();
+
+    node_energy_fill(time_us, uplinks, report);
+}
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file node_energy.h
+ *
+ * @brief Energy accounting and battery life projection
+ *
+ * Time is accounted per bucket: the CPU is in one of run, sleep and deep
+ * sleep at any time, while the radio and sensor buckets count the on-time
+ * of loads drawing on top of that. Charge is time times the configured
+ * current of each bucket, so the report is only as good as the figures;
+ * measure them on the bench for the board and firmware in use.
+ *
+ * Radio time is derived from the uplinks: LoRa time on air at the data
+ * rate for TX, and NODE_ENERGY_RX_SYMBOLS symbols per receive window, for
+ * both windows, for RX.
+ *
+ * Built with NODE_ENERGY_HOST defined, only the model is compiled:
+ * node_energy_simulate() projects a firmware profile on a PC, without the
+ * board.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _NODE_ENERGY_H_
+#define _NODE_ENERGY_H_
+
+#include <stdint.h>
+
+#ifndef NODE_ENERGY_BATTERY_MAH
+#define NODE_ENERGY_BATTERY_MAH     2400    ///< Battery capacity for the projection
+#endif
+
+#ifndef NODE_ENERGY_RX_SYMBOLS
+#define NODE_ENERGY_RX_SYMBOLS      8       ///< Symbols the radio listens per receive window without a downlink
+#endif
+
+typedef enum
+{
+    NODE_ENERGY_RUN,            ///< CPU running
+    NODE_ENERGY_SLEEP,          ///< CPU sleeping, clocks on
+    NODE_ENERGY_DEEP_SLEEP,     ///< Stop mode, RTC wakeup
+    NODE_ENERGY_RADIO_TX,       ///< Radio transmitting, on top of the CPU state
+    NODE_ENERGY_RADIO_RX,       ///< Radio receiving, on top of the CPU state
+    NODE_ENERGY_SENSOR1,        ///< Sensor on, on top of the CPU state
+    NODE_ENERGY_SENSOR2,        ///< Sensor on, on top of the CPU state
+    NODE_ENERGY_BUCKETS
+}node_energy_bucket_t;
+
+struct node_energy_report
+{
+    uint64_t time_us[NODE_ENERGY_BUCKETS];      ///< Residency of the CPU states, on-time of the loads
+    float charge_uah[NODE_ENERGY_BUCKETS];
+    float total_uah;
+    unsigned int uplinks;
+    float uah_per_uplink;
+    float mah_per_day;
+    float battery_days;         ///< Days NODE_ENERGY_BATTERY_MAH lasts at mah_per_day
+};
+
+struct node_energy_profile
+{
+    unsigned int interval_sec;  ///< Seconds between uplinks
+    unsigned char data_rate;    ///< LoRaWAN data rate, 0 for SF12 to 5 for SF7
+    unsigned char payload_len;  ///< Application payload of each uplink
+    unsigned int run_us;        ///< CPU running per interval
+    unsigned int sensor_us[2];  ///< Sensor 1 and 2 on-time per interval
+    unsigned char deep_sleep;   ///< 1 if the CPU spends the rest of the interval in deep sleep, 0 in sleep
+};
+
+/** @brief Set the current of a bucket
+ *
+ *  @param bucket node_energy_bucket_t
+ *  @param ua current in uA; for loads, the current they add
+ */
+void node_energy_set_current(int bucket, unsigned int ua);
+
+/** @brief LoRa time on air of an uplink, 125 kHz, coding rate 4/5
+ *
+ *  @param data_rate LoRaWAN data rate, 0 for SF12 to 5 for SF7
+ *  @param payload_len application payload
+ *  @returns time on air in us
+ */
+unsigned int node_energy_airtime_us(unsigned char data_rate, unsigned char payload_len);
+
+/** @brief Fill a report with the charge of given bucket times
+ *
+ *  @param time_us time of each bucket
+ *  @param uplinks uplinks sent in that time
+ *  @param report report to fill
+ */
+void node_energy_fill(const uint64_t *time_us, unsigned int uplinks, struct node_energy_report *report);
+
+/** @brief Project one day of a firmware profile
+ *
+ *  @param profile behaviour per uplink interval
+ *  @param report report to fill
+ */
+void node_energy_simulate(const struct node_energy_profile *profile, struct node_energy_report *report);
+
+#ifndef NODE_ENERGY_HOST
+
+/** @brief Start accounting
+ *
+ */
+void node_energy_init(void);
+
+/** @brief Switch a sensor load on or off
+ *
+ *  @param bucket NODE_ENERGY_SENSOR1 or NODE_ENERGY_SENSOR2
+ *  @param on 1 for on, 0 for off
+ */
+void node_energy_load(int bucket, unsigned char on);
+
+/** @brief An uplink was handed to the radio
+ *
+ *  @param data_rate LoRaWAN data rate
+ *  @param payload_len application payload
+ */
+void node_energy_tx_start(unsigned char data_rate, unsigned char payload_len);
+
+/** @brief The uplink ended, from the TX done callback
+ *
+ */
+void node_energy_tx_done(void);
+
+/** @brief Account time spent in the RTC wakeup sleep of nodeApiSetDevSleepRTCWakeup()
+ *
+ *  The microsecond ticker stops in that sleep, so it is not measured.
+ *  @param sec seconds slept
+ */
+void node_energy_deep_sleep(unsigned int sec);
+
+/** @brief Report since node_energy_init()
+ *
+ *  @param report report to fill
+ */
+void node_energy_get_report(struct node_energy_report *report);
+
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * @file node_filter.cpp
+ *
+ * @brief Streaming filter for noisy analog sensor readings
+ *
+ * All arithmetic is single precision, which the Cortex-M4 FPU does in
+ * hardware. The median sorts a copy of its window by insertion, which is
+ * cheaper than any cleverer structure at these window lengths.
+ *
+ * @author AdvanWISE
+ */
+
+#include <string.h>
+#include "node_filter.h"
+#if NODE_FILTER_CMSIS_DSP
+#include "arm_math.h"
+#endif
+
+int node_filter_init(struct node_filter *filter, const struct node_filter_config *config)
+{
+    if (config->median_len > NODE_FILTER_MEDIAN_MAX || !(config->alpha > 0.0f && config->alpha <= 1.0f))
+        return NODE_FILTER_ERR_PARAM;
+
+    memset(filter, 0, sizeof(*filter));
+    filter->config = *config;
+    return NODE_FILTER_OK;
+}
+
+void node_filter_reset(struct node_filter *filter)
+{
+    filter->count = 0;
+    filter->pos = 0;
+    filter->value = 0.0f;
+    filter->mark = 0.0f;
+    filter->primed = 0;
+}
+
+static float filter_median(struct node_filter *filter, float sample)
+{
+    unsigned char len = filter->config.median_len;
+    float sorted[NODE_FILTER_MEDIAN_MAX];
+
+    if (len <= 1)
+        return sample;
+
+    filter->window[filter->pos] = sample;
+    filter->pos = (filter->pos + 1) % len;
+    if (filter->count < len)
+        filter->count++;
+
+    for (int i = 0; i < filter->count; i++)
+    {
+        float v = filter->window[i];
+        int j = i;
+
+        for (; j > 0 && sorted[j - 1] > v; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+    }
+
+    if (filter->count & 1)
+        return sorted[filter->count / 2];
+    return (sorted[filter->count / 2 - 1] + sorted[filter->count / 2]) / 2.0f;
+}
+
+static float filter_biquad(struct node_filter *filter, float x)
+{
+    float y;
+#if NODE_FILTER_CMSIS_DSP
+    arm_biquad_casd_df1_inst_f32 biquad = { 1, filter->state, filter->config.biquad };
+
+    arm_biquad_cascade_df1_f32(&biquad, &x, &y, 1);
+#else
+    const float *c = filter->config.biquad;
+    float *s = filter->state;
+
+    y = c[0] * x + c[1] * s[0] + c[2] * s[1] + c[3] * s[2] + c[4] * s[3];
+    s[1] = s[0];
+    s[0] = x;
+    s[3] = s[2];
+    s[2] = y;
+#endif
+    return y;
+}
+
+/** @brief Put the biquad in its steady state for a constant input x */
+static void filter_biquad_prime(struct node_filter *filter, float x)
+{
+    const float *c = filter->config.biquad;
+    float den = 1.0f - c[3] - c[4];
+    float y = (den != 0.0f) ? x * (c[0] + c[1] + c[2]) / den : 0.0f;
+
+    filter->state[0] = x;
+    filter->state[1] = x;
+    filter->state[2] = y;
+    filter->state[3] = y;
+}
+
+float node_filter_update(struct node_filter *filter, float sample)
+{
+    float x = filter_median(filter, sample);
+
+    if (!filter->primed)
+        filter_biquad_prime(filter, x);
+    x = filter_biquad(filter, x);
+
+    if (!filter->primed)
+    {
+        filter->value = x;
+        filter->mark = x;
+        filter->primed = 1;
+    }
+    else
+        filter->value += filter->config.alpha * (x - filter->value);
+
+    return filter->value;
+}
+
+float node_filter_value(const struct node_filter *filter)
+{
+    return filter->value;
+}
+
+float node_filter_change(const struct node_filter *filter)
+{
+    float change = filter->value - filter->mark;
+
+    return (change < 0.0f) ? -change : change;
+}
+
+void node_filter_mark(struct node_filter *filter)
+{
+    filter->mark = filter->value;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file node_filter.h
+ *
+ * @brief Streaming filter for noisy analog sensor readings
+ *
+ * Each sample goes through three stages, in order:
+ *  - a moving median, which drops isolated spikes,
+ *  - a biquad IIR section, normally one of the NODE_FILTER_LOWPASS_* low-passes,
+ *  - exponential smoothing.
+ * Any stage can be bypassed. The stages start from the first sample rather
+ * than from zero, so the output needs no warm-up.
+ *
+ * The filter also tracks how far its output moved since node_filter_mark(),
+ * so the caller can tell a real change from noise before reporting.
+ *
+ * With NODE_FILTER_CMSIS_DSP set, the biquad runs on the CMSIS-DSP kernel;
+ * otherwise, and on a PC, on portable C with the same arithmetic.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _NODE_FILTER_H_
+#define _NODE_FILTER_H_
+
+#define NODE_FILTER_OK               0    ///< Node filter Result: OK
+#define NODE_FILTER_ERR_PARAM       -1    ///< Node filter Result: Invalid parameter
+
+#ifndef NODE_FILTER_MEDIAN_MAX
+#define NODE_FILTER_MEDIAN_MAX       9    ///< Longest moving median window
+#endif
+
+#ifndef NODE_FILTER_CMSIS_DSP
+#define NODE_FILTER_CMSIS_DSP        0    ///< Run the biquad on CMSIS-DSP; needs the CMSIS-DSP library linked
+#endif
+
+/* Second order Butterworth low-pass coefficients, for node_filter_config.biquad,
+ * by cutoff as a fraction of the sample rate. Precomputed so that the filter
+ * needs no libm; for another cutoff fc, with w0 = 2 pi fc, c = cos(w0) and
+ * a = sin(w0) / sqrt(2): b0 = b2 = (1 - c) / 2 / (1 + a), b1 = 2 b0,
+ * a1 = 2 c / (1 + a), a2 = -(1 - a) / (1 + a). */
+#define NODE_FILTER_LOWPASS_0_05    { 0.02008337f, 0.04016673f, 0.02008337f, 1.56101808f, -0.64135154f }
+#define NODE_FILTER_LOWPASS_0_1     { 0.06745527f, 0.13491055f, 0.06745527f, 1.14298050f, -0.41280160f }
+#define NODE_FILTER_LOWPASS_0_2     { 0.20657208f, 0.41314417f, 0.20657208f, 0.36952738f, -0.19581571f }
+
+struct node_filter_config
+{
+    unsigned char median_len;   ///< Moving median window; 0 or 1 bypasses the median
+    float biquad[5];            ///< {b0, b1, b2, a1, a2} in CMSIS-DSP form, y = b0 x0 + b1 x1 + b2 x2 + a1 y1 + a2 y2;
+                                ///< {1, 0, 0, 0, 0} bypasses the biquad
+    float alpha;                ///< Weight of a new sample in the smoothing, 0 < alpha <= 1; 1 bypasses the smoothing
+};
+
+struct node_filter
+{
+    struct node_filter_config config;
+    float window[NODE_FILTER_MEDIAN_MAX];   ///< Last samples, oldest at pos once full
+    unsigned char count;
+    unsigned char pos;
+    float state[4];             ///< Biquad {x1, x2, y1, y2}, the CMSIS-DSP DF1 state layout
+    float value;                ///< Last output
+    float mark;                 ///< Output at node_filter_mark()
+    unsigned char primed;
+};
+
+/** @brief Set up a filter
+ *
+ *  @param filter filter
+ *  @param config stages; copied
+ *  @returns NODE_FILTER_OK on success; negative error on failure
+ */
+int node_filter_init(struct node_filter *filter, const struct node_filter_config *config);
+
+/** @brief Restart a filter from the next sample
+ *
+ *  @param filter filter
+ */
+void node_filter_reset(struct node_filter *filter);
+
+/** @brief Filter a sample
+ *
+ *  @param filter filter
+ *  @param sample new sample
+ *  @returns filtered value
+ */
+float node_filter_update(struct node_filter *filter, float sample);
+
+/** @brief Last filtered value
+ *
+ *  @param filter filter
+ *  @returns filtered value; 0 before the first sample
+ */
+float node_filter_value(const struct node_filter *filter);
+
+/** @brief How far the filtered value moved
+ *
+ *  @param filter filter
+ *  @returns magnitude of the change since node_filter_mark(), or since the first sample
+ */
+float node_filter_change(const struct node_filter *filter);
+
+/** @brief Take the current filtered value as the reference for node_filter_change()
+ *
+ *  @param filter filter
+ */
+void node_filter_mark(struct node_filter *filter);
+
+#endif
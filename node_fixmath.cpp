@@ -0,0 +1,116 @@
+/**
+ * @file node_fixmath.cpp
+ *
+ * @brief Fixed-point conversions for the sensor readings
+ *
+ * The HDC1010 transfer functions are linear, so a multiply and a shift is
+ * all they need. The gas curve splits its exponent into an integer part,
+ * looked up as a power of ten, and a fraction, interpolated in a table of
+ * 10^(i/256). Products are 32 x 32 -> 64 bit, a single UMULL/SMULL on the
+ * Cortex-M4.
+ *
+ * @author AdvanWISE
+ */
+
+#include "node_fixmath.h"
+
+#define FIXMATH_TABLE_BITS  8
+#define FIXMATH_MAX         0x7FFFFFFF
+
+/** 10^(i/256) in Q28, for i from 0 to 256; generated with
+ *  round(10 ** (i / 256.0) * 2 ** 28)
+ */
+static const uint32_t fixmath_pow10_frac[(1 << FIXMATH_TABLE_BITS) + 1] =
+{
+     268435456U,  270860782U,  273308022U,  275777372U,  278269033U,  280783206U,
+     283320095U,  285879905U,  288462842U,  291069117U,  293698940U,  296352523U,
+     299030081U,  301731831U,  304457992U,  307208784U,  309984429U,  312785152U,
+     315611180U,  318462741U,  321340066U,  324243388U,  327172941U,  330128964U,
+     333111694U,  336121373U,  339158244U,  342222554U,  345314551U,  348434483U,
+     351582604U,  354759169U,  357964434U,  361198658U,  364462105U,  367755036U,
+     371077719U,  374430423U,  377813419U,  381226980U,  384671383U,  388146906U,
+     391653831U,  395192441U,  398763022U,  402365864U,  406001257U,  409669497U,
+     413370879U,  417105704U,  420874272U,  424676890U,  428513865U,  432385507U,
+     436292129U,  440234048U,  444211583U,  448225054U,  452274788U,  456361111U,
+     460484354U,  464644851U,  468842938U,  473078955U,  477353244U,  481666152U,
+     486018028U,  490409222U,  494840092U,  499310994U,  503822291U,  508374348U,
+     512967533U,  517602218U,  522278777U,  526997589U,  531759036U,  536563503U,
+     541411378U,  546303054U,  551238927U,  556219395U,  561244862U,  566315735U,
+     571432423U,  576595341U,  581804905U,  587061539U,  592365666U,  597717716U,
+     603118123U,  608567322U,  614065755U,  619613867U,  625212106U,  630860925U,
+     636560782U,  642312137U,  648115456U,  653971208U,  659879868U,  665841912U,
+     671857823U,  677928089U,  684053200U,  690233651U,  696469943U,  702762580U,
+     709112071U,  715518931U,  721983676U,  728506831U,  735088923U,  741730485U,
+     748432053U,  755194170U,  762017383U,  768902244U,  775849311U,  782859144U,
+     789932311U,  797069385U,  804270943U,  811537567U,  818869845U,  826268371U,
+     833733743U,  841266565U,  848867446U,  856537001U,  864275851U,  872084622U,
+     879963946U,  887914460U,  895936807U,  904031636U,  912199602U,  920441367U,
+     928757596U,  937148962U,  945616145U,  954159829U,  962780706U,  971479473U,
+     980256834U,  989113498U,  998050183U, 1007067611U, 1016166512U, 1025347622U,
+    1034611684U, 1043959447U, 1053391667U, 1062909108U, 1072512540U, 1082202739U,
+    1091980489U, 1101846581U, 1111801815U, 1121846994U, 1131982932U, 1142210448U,
+    1152530371U, 1162943535U, 1173450782U, 1184052962U, 1194750934U, 1205545562U,
+    1216437720U, 1227428290U, 1238518159U, 1249708226U, 1260999396U, 1272392582U,
+    1283888706U, 1295488698U, 1307193497U, 1319004049U, 1330921309U, 1342946243U,
+    1355079823U, 1367323030U, 1379676854U, 1392142297U, 1404720365U, 1417412076U,
+    1430218458U, 1443140546U, 1456179385U, 1469336031U, 1482611548U, 1496007010U,
+    1509523501U, 1523162113U, 1536923951U, 1550810128U, 1564821767U, 1578960002U,
+    1593225976U, 1607620844U, 1622145771U, 1636801931U, 1651590509U, 1666512704U,
+    1681569721U, 1696762778U, 1712093106U, 1727561944U, 1743170544U, 1758920168U,
+    1774812091U, 1790847597U, 1807027986U, 1823354565U, 1839828655U, 1856451589U,
+    1873224713U, 1890149382U, 1907226966U, 1924458847U, 1941846419U, 1959391089U,
+    1977094275U, 1994957411U, 2012981940U, 2031169322U, 2049521028U, 2068038543U,
+    2086723364U, 2105577003U, 2124600986U, 2143796851U, 2163166151U, 2182710455U,
+    2202431341U, 2222330407U, 2242409262U, 2262669530U, 2283112851U, 2303740878U,
+    2324555280U, 2345557741U, 2366749961U, 2388133653U, 2409710547U, 2431482390U,
+    2453450943U, 2475617982U, 2497985301U, 2520554711U, 2543328036U, 2566307118U,
+    2589493818U, 2612890011U, 2636497589U, 2660318463U, 2684354560U
+};
+
+static const uint32_t fixmath_pow10_int[] =
+{
+    1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U, 1000000000U
+};
+
+int node_fixmath_hdc1010_temp(uint16_t raw)
+{
+    // raw * 165 / 2^16 - 40, in 0.01 C; division truncates toward zero like the float cast did
+    int32_t temp = (int32_t)raw * 16500 - 4000 * 65536;
+
+    return temp / 65536;
+}
+
+unsigned int node_fixmath_hdc1010_hum(uint16_t raw)
+{
+    // raw * 100 / 2^16, in 0.01 %
+    return ((uint32_t)raw * 10000) >> 16;
+}
+
+int32_t node_fixmath_scale(uint32_t raw, uint32_t scale)
+{
+    return (int32_t)(((uint64_t)raw * scale) >> 16);
+}
+
+int32_t node_fixmath_curve_ppm(const struct node_fixmath_curve *curve, int32_t y)
+{
+    int32_t power = curve->x0 + (int32_t)(((int64_t)(y - curve->y0) * curve->inv_slope) >> 16);
+
+    if (power <= curve->x0)
+        return NODE_FIXMATH_ERR_RANGE;
+    if (power < 0)
+        return 0;
+
+    uint32_t n = (uint32_t)power >> 24;
+    uint32_t frac = (uint32_t)power & 0xFFFFFF;
+    uint32_t i = frac >> (24 - FIXMATH_TABLE_BITS);
+    uint32_t rem = frac & ((1 << (24 - FIXMATH_TABLE_BITS)) - 1);
+
+    if (n >= sizeof(fixmath_pow10_int) / sizeof(fixmath_pow10_int[0]))
+        return FIXMATH_MAX;
+
+    uint32_t mant = fixmath_pow10_frac[i] +
+                    (uint32_t)(((uint64_t)(fixmath_pow10_frac[i + 1] - fixmath_pow10_frac[i]) * rem) >> (24 - FIXMATH_TABLE_BITS));
+    uint64_t ppm = ((uint64_t)mant * fixmath_pow10_int[n]) >> 28;
+
+    return (ppm > FIXMATH_MAX) ? FIXMATH_MAX : (int32_t)ppm;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file node_fixmath.h
+ *
+ * @brief Fixed-point conversions for the sensor readings
+ *
+ * The sensor path converts raw readings with integer arithmetic only, so it
+ * pulls in neither the double-precision soft-float routines nor libm. Each
+ * conversion truncates like the float code it replaces, and stays within one
+ * LSB of the float result.
+ *
+ * Fixed-point values are Q24 unless noted: the value times 2^24, in an
+ * int32_t. Constants are converted at compile time by the macros below.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _NODE_FIXMATH_H_
+#define _NODE_FIXMATH_H_
+
+#include <stdint.h>
+
+#define NODE_FIXMATH_ERR_RANGE      -1    ///< Node fixmath Result: Input outside the curve
+
+/** Constant x in Q24 */
+#define NODE_FIXMATH_Q24(x)         ((int32_t)((x) * 16777216.0 + (((x) < 0) ? -0.5 : 0.5)))
+
+/** Constant x in Q16 */
+#define NODE_FIXMATH_Q16(x)         ((int32_t)((x) * 65536.0 + (((x) < 0) ? -0.5 : 0.5)))
+
+/** Scale factor for node_fixmath_scale(), for values per raw unit below 2^-8 */
+#define NODE_FIXMATH_SCALE(x)       ((uint32_t)((x) * 1099511627776.0 + 0.5))
+
+/** Initializer of a node_fixmath_curve, from the float curve {x, y, slope} */
+#define NODE_FIXMATH_CURVE(x, y, slope) { NODE_FIXMATH_Q24(x), NODE_FIXMATH_Q24(y), NODE_FIXMATH_Q16(1.0 / (slope)) }
+
+/** Log-linear gas sensor curve
+ *
+ *  A straight line through the point (x0, y0) on the sensor's log-log
+ *  chart, where x is log10 of the concentration in ppm and y the sensor
+ *  output.
+ */
+struct node_fixmath_curve
+{
+    int32_t x0;                 ///< log10(ppm) of the point, Q24
+    int32_t y0;                 ///< Sensor output at the point, Q24
+    int32_t inv_slope;          ///< 1 / slope of the line, Q16
+};
+
+/** @brief HDC1010 temperature
+ *
+ *  @param raw temperature register
+ *  @returns temperature in 0.01 C
+ */
+int node_fixmath_hdc1010_temp(uint16_t raw);
+
+/** @brief HDC1010 relative humidity
+ *
+ *  @param raw humidity register
+ *  @returns relative humidity in 0.01 %
+ */
+unsigned int node_fixmath_hdc1010_hum(uint16_t raw);
+
+/** @brief Scale a raw reading to Q24
+ *
+ *  @param raw reading
+ *  @param scale value of one raw unit, from NODE_FIXMATH_SCALE()
+ *  @returns raw times the unit value, Q24
+ */
+int32_t node_fixmath_scale(uint32_t raw, uint32_t scale);
+
+/** @brief Concentration on a gas sensor curve
+ *
+ *  Computes 10^((y - y0) / slope + x0) with a 257-entry table of 10^(i/256)
+ *  and linear interpolation; the error stays below 2e-5 of the result.
+ *
+ *  @param curve sensor curve
+ *  @param y sensor output, Q24
+ *  @returns concentration in ppm; NODE_FIXMATH_ERR_RANGE when it is at or
+ *           below the point of the curve; 0x7FFFFFFF when it does not fit
+ */
+int32_t node_fixmath_curve_ppm(const struct node_fixmath_curve *curve, int32_t y);
+
+#endif
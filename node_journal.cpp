@@ -0,0 +1,495 @@
+/**
+ * @file node_journal.cpp
+ *
+ * @brief Store-and-forward journal of unsent sensor frames in internal flash
+ *
+ * Sector layout: an 8 byte header {magic, sequence} followed by records.
+ * Sectors are opened in ring order with consecutive sequence numbers, so at
+ * mount the highest sequence is the head and the run of predecessors before
+ * it is the rest of the ring.
+ *
+ * Record layout, padded with 0xFF to the flash program unit:
+ * {magic, type, len, seq} data crc32
+ *
+ * A data record holds one frame; an ack record holds the sequence number of
+ * the newest acknowledged frame. Each newly opened sector starts with a copy
+ * of the current ack, so reusing the sector of the last ack loses nothing.
+ *
+ * @author AdvanWISE
+ */
+
+#include "mbed.h"
+#include "platform/PlatformMutex.h"
+#include "platform/SingletonPtr.h"
+#include "node_kvstore.h"
+#include "node_journal.h"
+
+#define NODE_JOURNAL_SECTOR_MAGIC   0x4E524A4EUL    ///< "NJRN"
+#define NODE_JOURNAL_RECORD_MAGIC   0x4A52
+
+#define NODE_JOURNAL_DATA           1
+#define NODE_JOURNAL_ACK            2
+
+#define NODE_JOURNAL_HEADER_SIZE    8
+#define NODE_JOURNAL_CRC_SIZE       4
+#define NODE_JOURNAL_BUF_SIZE       128
+
+struct node_journal_record
+{
+    uint16_t magic;
+    uint8_t type;
+    uint8_t len;
+    uint32_t seq;
+};
+
+struct node_journal_sector
+{
+    uint32_t magic;
+    uint32_t seq;
+};
+
+struct node_journal_pos
+{
+    int sector;
+    uint32_t offset;
+};
+
+static FlashIAP jr_flash;
+static MbedCRC<POLY_32BIT_ANSI, 32> jr_crc;
+static SingletonPtr<PlatformMutex> jr_mutex;
+
+static uint32_t jr_addr;
+static uint32_t jr_sector_size;
+static uint32_t jr_page_size;
+static uint32_t jr_sector_seq[NODE_JOURNAL_SECTORS];    ///< 0 for sectors outside the ring
+static int jr_head = -1;            ///< Sector being written, -1 if not mounted
+static uint32_t jr_head_free;       ///< Offset of the next record in the head sector
+static bool jr_head_dirty;          ///< Programmed bytes past jr_head_free, left by an interrupted write
+static uint32_t jr_next_seq;        ///< Sequence number of the next frame
+static uint32_t jr_ack_seq;         ///< Newest acknowledged frame, 0 for none
+static node_journal_pos jr_rd;      ///< Oldest unsent frame, or a record before it
+static unsigned int jr_pending;
+static unsigned int jr_dropped;
+static uint8_t jr_buf[NODE_JOURNAL_BUF_SIZE];
+
+static uint32_t jr_align(uint32_t size)
+{
+    return (size + jr_page_size - 1) / jr_page_size * jr_page_size;
+}
+
+static uint32_t jr_record_size(unsigned int len)
+{
+    return jr_align(NODE_JOURNAL_HEADER_SIZE + len + NODE_JOURNAL_CRC_SIZE);
+}
+
+static uint32_t jr_sector_addr(int sector)
+{
+    return jr_addr + sector * jr_sector_size;
+}
+
+/** @brief Frames newer than the last ack are unsent; sequence numbers wrap */
+static bool jr_unsent(const node_journal_record *rec)
+{
+    return rec->type == NODE_JOURNAL_DATA && (int32_t)(rec->seq - jr_ack_seq) > 0;
+}
+
+static uint32_t jr_checksum(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0;
+
+    jr_crc.compute((void *)data, len, &crc);
+    return crc;
+}
+
+/** @brief Read and check the record at offset of a sector into jr_buf
+ *
+ *  @returns 1 for a valid record, 0 for erased flash, -1 for a damaged record
+ */
+static int jr_load(int sector, uint32_t offset, node_journal_record *rec)
+{
+    uint32_t crc;
+
+    if (offset + NODE_JOURNAL_HEADER_SIZE > jr_sector_size)
+        return 0;
+    if (jr_flash.read(rec, jr_sector_addr(sector) + offset, sizeof(*rec)) != 0)
+        return -1;
+
+    if (rec->magic == 0xFFFF && rec->type == 0xFF && rec->len == 0xFF && rec->seq == 0xFFFFFFFFUL)
+        return 0;
+
+    if (rec->magic != NODE_JOURNAL_RECORD_MAGIC || rec->len > NODE_JOURNAL_FRAME_MAX ||
+        offset + jr_record_size(rec->len) > jr_sector_size)
+        return -1;
+
+    uint32_t len = NODE_JOURNAL_HEADER_SIZE + rec->len;
+    if (jr_flash.read(jr_buf, jr_sector_addr(sector) + offset, len + NODE_JOURNAL_CRC_SIZE) != 0)
+        return -1;
+    memcpy(&crc, &jr_buf[len], sizeof(crc));
+
+    return (crc == jr_checksum(jr_buf, len)) ? 1 : -1;
+}
+
+/** @brief Read the record at pos into jr_buf, moving on to the next sector at the end of one
+ *
+ *  @returns false at the end of the ring
+ */
+static bool jr_read(node_journal_pos *pos, node_journal_record *rec)
+{
+    while (1)
+    {
+        if (!(pos->sector == jr_head && pos->offset >= jr_head_free) &&
+            jr_load(pos->sector, pos->offset, rec) == 1)
+            return true;
+        if (pos->sector == jr_head)
+            return false;
+
+        int next = (pos->sector + 1) % NODE_JOURNAL_SECTORS;
+        if (jr_sector_seq[next] != jr_sector_seq[pos->sector] + 1)
+            return false;
+        pos->sector = next;
+        pos->offset = jr_align(sizeof(node_journal_sector));
+    }
+}
+
+/** @brief Oldest sector of the ring */
+static int jr_tail(void)
+{
+    int tail = jr_head;
+
+    for (int n = 1; n < NODE_JOURNAL_SECTORS; n++)
+    {
+        int prev = (tail + NODE_JOURNAL_SECTORS - 1) % NODE_JOURNAL_SECTORS;
+        if (jr_sector_seq[prev] == 0 || jr_sector_seq[prev] != jr_sector_seq[tail] - 1)
+            break;
+        tail = prev;
+    }
+    return tail;
+}
+
+/** @brief Find the oldest unsent frame and count the unsent frames */
+static void jr_rescan(void)
+{
+    node_journal_record rec;
+    node_journal_pos pos;
+    bool first = true;
+
+    pos.sector = jr_tail();
+    pos.offset = jr_align(sizeof(node_journal_sector));
+    jr_rd = pos;
+    jr_pending = 0;
+    while (jr_read(&pos, &rec))
+    {
+        if (jr_unsent(&rec))
+        {
+            if (first)
+                jr_rd = pos;
+            first = false;
+            jr_pending++;
+        }
+        pos.offset += jr_record_size(rec.len);
+    }
+}
+
+static int jr_program_header(int sector, uint32_t seq)
+{
+    node_journal_sector hdr;
+
+    memset(jr_buf, 0xFF, jr_page_size);
+    hdr.magic = NODE_JOURNAL_SECTOR_MAGIC;
+    hdr.seq = seq;
+    memcpy(jr_buf, &hdr, sizeof(hdr));
+    if (jr_flash.program(jr_buf, jr_sector_addr(sector), jr_align(sizeof(hdr))) != 0)
+        return NODE_JOURNAL_ERR_FLASH;
+    return NODE_JOURNAL_OK;
+}
+
+static int jr_program_record(uint8_t type, uint32_t seq, const void *data, unsigned char len);
+
+/** @brief Erase the sector after the head, dropping its unsent frames, and make it the head */
+static int jr_open_next(void)
+{
+    node_journal_record rec;
+    int next = (jr_head + 1) % NODE_JOURNAL_SECTORS;
+    uint32_t seq = jr_sector_seq[jr_head] + 1;
+    bool reused = (jr_sector_seq[next] != 0);
+
+    if (reused)
+    {
+        uint32_t offset = jr_align(sizeof(node_journal_sector));
+        while (jr_load(next, offset, &rec) == 1)
+        {
+            if (jr_unsent(&rec))
+                jr_dropped++;
+            offset += jr_record_size(rec.len);
+        }
+    }
+
+    jr_sector_seq[next] = 0;
+    int ret = (jr_flash.erase(jr_sector_addr(next), jr_sector_size) == 0) ? jr_program_header(next, seq)
+                                                                          : NODE_JOURNAL_ERR_FLASH;
+    if (ret == NODE_JOURNAL_OK)
+    {
+        jr_sector_seq[next] = seq;
+        jr_head = next;
+        jr_head_free = jr_align(sizeof(node_journal_sector));
+        jr_head_dirty = false;
+        if (jr_ack_seq != 0)
+            ret = jr_program_record(NODE_JOURNAL_ACK, jr_ack_seq, NULL, 0);
+    }
+    if (reused)
+        jr_rescan();
+    return ret;
+}
+
+/** @brief Program a record at the head, opening the next sector if it does not fit */
+static int jr_program_record(uint8_t type, uint32_t seq, const void *data, unsigned char len)
+{
+    node_journal_record rec;
+    uint32_t size = jr_record_size(len);
+
+    if (jr_head_dirty || jr_head_free + size > jr_sector_size)
+    {
+        int ret = jr_open_next();
+        if (ret != NODE_JOURNAL_OK)
+            return ret;
+    }
+
+    rec.magic = NODE_JOURNAL_RECORD_MAGIC;
+    rec.type = type;
+    rec.len = len;
+    rec.seq = seq;
+
+    uint32_t body = NODE_JOURNAL_HEADER_SIZE + len;
+    memcpy(jr_buf, &rec, sizeof(rec));
+    memcpy(&jr_buf[NODE_JOURNAL_HEADER_SIZE], data, len);
+    uint32_t crc = jr_checksum(jr_buf, body);
+    memcpy(&jr_buf[body], &crc, sizeof(crc));
+    memset(&jr_buf[body + NODE_JOURNAL_CRC_SIZE], 0xFF, size - body - NODE_JOURNAL_CRC_SIZE);
+
+    if (jr_flash.program(jr_buf, jr_sector_addr(jr_head) + jr_head_free, size) != 0)
+    {
+        // Part of the record may be programmed; move on to the next sector
+        jr_head_dirty = true;
+        return NODE_JOURNAL_ERR_FLASH;
+    }
+    jr_head_free += size;
+    return NODE_JOURNAL_OK;
+}
+
+static int jr_mount(void)
+{
+    node_journal_sector hdr;
+    node_journal_record rec;
+    node_journal_pos pos;
+
+    MBED_STATIC_ASSERT(NODE_JOURNAL_SECTORS >= 2, "The journal needs at least two sectors");
+    MBED_STATIC_ASSERT(NODE_JOURNAL_HEADER_SIZE + NODE_JOURNAL_FRAME_MAX + NODE_JOURNAL_CRC_SIZE <= NODE_JOURNAL_BUF_SIZE,
+                       "Largest record does not fit jr_buf");
+
+    if (jr_flash.init() != 0)
+        return NODE_JOURNAL_ERR_FLASH;
+
+    uint32_t end = jr_flash.get_flash_start() + jr_flash.get_flash_size();
+    jr_sector_size = jr_flash.get_sector_size(end - 1);
+    jr_addr = (NODE_JOURNAL_ADDR != 0) ? NODE_JOURNAL_ADDR : end - (2 + NODE_JOURNAL_SECTORS) * jr_sector_size;
+    jr_page_size = jr_flash.get_page_size();
+
+    // The application grew into the journal: lower target.mbed_app_size to keep it out
+    MBED_ASSERT(jr_addr >= node_kv_image_end());
+
+    if (jr_page_size > NODE_JOURNAL_BUF_SIZE)
+        return NODE_JOURNAL_ERR_INVALID_ARG;
+    for (int i = 0; i < NODE_JOURNAL_SECTORS; i++)
+    {
+        if (jr_flash.get_sector_size(jr_sector_addr(i)) != jr_sector_size)
+            return NODE_JOURNAL_ERR_INVALID_ARG;
+    }
+
+    jr_head = -1;
+    for (int i = 0; i < NODE_JOURNAL_SECTORS; i++)
+    {
+        jr_sector_seq[i] = 0;
+        if (jr_flash.read(&hdr, jr_sector_addr(i), sizeof(hdr)) == 0 &&
+            hdr.magic == NODE_JOURNAL_SECTOR_MAGIC && hdr.seq != 0)
+        {
+            jr_sector_seq[i] = hdr.seq;
+            if (jr_head < 0 || (int32_t)(hdr.seq - jr_sector_seq[jr_head]) > 0)
+                jr_head = i;
+        }
+    }
+
+    jr_next_seq = 1;
+    jr_ack_seq = 0;
+    if (jr_head < 0)
+    {
+        jr_head = 0;
+        if (jr_flash.erase(jr_sector_addr(0), jr_sector_size) != 0 || jr_program_header(0, 1) != NODE_JOURNAL_OK)
+            return NODE_JOURNAL_ERR_FLASH;
+        jr_sector_seq[0] = 1;
+    }
+
+    // Sectors not chained to the head are left over from an interrupted reuse
+    int tail = jr_tail();
+    for (int i = 0; i < NODE_JOURNAL_SECTORS; i++)
+    {
+        int n = (i - tail + NODE_JOURNAL_SECTORS) % NODE_JOURNAL_SECTORS;
+        if (n > (jr_head - tail + NODE_JOURNAL_SECTORS) % NODE_JOURNAL_SECTORS)
+            jr_sector_seq[i] = 0;
+    }
+
+    // Replay the log for the newest frame and ack
+    jr_head_free = jr_sector_size;
+    pos.sector = tail;
+    pos.offset = jr_align(sizeof(node_journal_sector));
+    while (jr_read(&pos, &rec))
+    {
+        if (rec.type == NODE_JOURNAL_DATA)
+            jr_next_seq = rec.seq + 1;
+        else if (rec.type == NODE_JOURNAL_ACK)
+            jr_ack_seq = rec.seq;
+        pos.offset += jr_record_size(rec.len);
+    }
+    if ((int32_t)(jr_next_seq - jr_ack_seq) <= 0)
+        jr_next_seq = jr_ack_seq + 1;
+
+    // The scan ends in the head sector at the first record that is not valid
+    jr_head_free = pos.offset;
+    jr_head_dirty = (jr_load(jr_head, jr_head_free, &rec) < 0);
+    for (uint32_t offset = jr_head_free; !jr_head_dirty && offset < jr_sector_size; offset += NODE_JOURNAL_BUF_SIZE)
+    {
+        uint32_t len = jr_sector_size - offset;
+        if (len > NODE_JOURNAL_BUF_SIZE)
+            len = NODE_JOURNAL_BUF_SIZE;
+        if (jr_flash.read(jr_buf, jr_sector_addr(jr_head) + offset, len) != 0)
+            return NODE_JOURNAL_ERR_FLASH;
+        for (uint32_t i = 0; i < len; i++)
+        {
+            if (jr_buf[i] != 0xFF)
+            {
+                jr_head_dirty = true;
+                break;
+            }
+        }
+    }
+
+    jr_dropped = 0;
+    jr_rescan();
+    return NODE_JOURNAL_OK;
+}
+
+int node_journal_init(void)
+{
+    jr_mutex->lock();
+    int ret = jr_mount();
+    if (ret != NODE_JOURNAL_OK)
+        jr_head = -1;
+    jr_mutex->unlock();
+    return ret;
+}
+
+int node_journal_append(const void *data, unsigned char len)
+{
+    int ret;
+
+    if (len == 0 || len > NODE_JOURNAL_FRAME_MAX || data == NULL)
+        return NODE_JOURNAL_ERR_INVALID_ARG;
+
+    jr_mutex->lock();
+    if (jr_head < 0)
+    {
+        ret = NODE_JOURNAL_ERR_NOT_READY;
+    }
+    else
+    {
+        ret = jr_program_record(NODE_JOURNAL_DATA, jr_next_seq, data, len);
+        if (ret == NODE_JOURNAL_OK)
+        {
+            jr_next_seq++;
+            jr_pending++;
+        }
+    }
+    jr_mutex->unlock();
+    return ret;
+}
+
+int node_journal_peek(unsigned int skip, unsigned int *seq, void *buf_out, unsigned char buf_len)
+{
+    node_journal_record rec;
+    node_journal_pos pos;
+    int ret = NODE_JOURNAL_ERR_EMPTY;
+
+    if (buf_len && buf_out == NULL)
+        return NODE_JOURNAL_ERR_INVALID_ARG;
+
+    jr_mutex->lock();
+    if (jr_head < 0)
+    {
+        jr_mutex->unlock();
+        return NODE_JOURNAL_ERR_NOT_READY;
+    }
+
+    pos = jr_rd;
+    while (jr_read(&pos, &rec))
+    {
+        if (jr_unsent(&rec) && skip-- == 0)
+        {
+            if (seq)
+                *seq = rec.seq;
+            memcpy(buf_out, &jr_buf[NODE_JOURNAL_HEADER_SIZE], (rec.len < buf_len) ? rec.len : buf_len);
+            ret = rec.len;
+            break;
+        }
+        pos.offset += jr_record_size(rec.len);
+    }
+    jr_mutex->unlock();
+    return ret;
+}
+
+int node_journal_ack(unsigned int count)
+{
+    node_journal_record rec;
+    node_journal_pos pos;
+    unsigned int acked = 0;
+    uint32_t last = 0;
+    int ret = NODE_JOURNAL_OK;
+
+    jr_mutex->lock();
+    if (jr_head < 0)
+    {
+        jr_mutex->unlock();
+        return NODE_JOURNAL_ERR_NOT_READY;
+    }
+
+    pos = jr_rd;
+    while (acked < count && jr_read(&pos, &rec))
+    {
+        if (jr_unsent(&rec))
+        {
+            last = rec.seq;
+            acked++;
+        }
+        pos.offset += jr_record_size(rec.len);
+    }
+
+    if (acked)
+    {
+        // The frames are sent even if the ack cannot be stored; at worst
+        // they are sent again after a reset
+        jr_ack_seq = last;
+        jr_pending -= acked;
+        jr_rd = pos;
+        ret = jr_program_record(NODE_JOURNAL_ACK, last, NULL, 0);
+    }
+    jr_mutex->unlock();
+    return ret;
+}
+
+unsigned int node_journal_pending(void)
+{
+    return jr_pending;
+}
+
+unsigned int node_journal_dropped(void)
+{
+    return jr_dropped;
+}
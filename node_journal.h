@@ -0,0 +1,85 @@
+/**
+ * @file node_journal.h
+ *
+ * @brief Store-and-forward journal of unsent sensor frames in internal flash
+ *
+ * Frames that could not be sent are appended to a ring of flash sectors with
+ * a sequence number, and replayed oldest first once the link is back. The
+ * sectors are written and erased in turn, so wear is spread evenly, and each
+ * is erased once per lap. Acknowledged frames are marked by appending an ack
+ * record rather than by erasing. When the ring is full the oldest sector is
+ * reused and its unsent frames are dropped.
+ *
+ * Records only count once their CRC is complete, so a power loss during a
+ * write loses at most that record.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _NODE_JOURNAL_H_
+#define _NODE_JOURNAL_H_
+
+#include <stdint.h>
+
+#define NODE_JOURNAL_OK               0   ///< Node journal Result: OK
+#define NODE_JOURNAL_ERR_EMPTY       -1   ///< Node journal Result: No frame at that position
+#define NODE_JOURNAL_ERR_INVALID_ARG -2   ///< Node journal Result: Invalid length
+#define NODE_JOURNAL_ERR_FLASH       -3   ///< Node journal Result: Flash erase or program failed
+#define NODE_JOURNAL_ERR_NOT_READY   -4   ///< Node journal Result: node_journal_init() not called or failed
+
+/* The default region is kept out of the application by target.mbed_app_size in
+ * mbed_app.json; a region set with NODE_JOURNAL_ADDR must be reserved the same way. */
+#ifndef NODE_JOURNAL_ADDR
+#define NODE_JOURNAL_ADDR       0    ///< First sector; 0 for the sectors just below node_kvstore's default region
+#endif
+
+#ifndef NODE_JOURNAL_SECTORS
+#define NODE_JOURNAL_SECTORS    8    ///< Sectors in the ring, at least 2
+#endif
+
+#define NODE_JOURNAL_FRAME_MAX  64   ///< Longest frame, in bytes
+
+/** @brief Mount the journal, formatting it if flash holds none
+ *
+ *  @returns NODE_JOURNAL_OK on success; negative error on failure
+ */
+int node_journal_init(void);
+
+/** @brief Append a frame
+ *
+ *  @param data frame
+ *  @param len length of the frame, 1 to NODE_JOURNAL_FRAME_MAX
+ *  @returns NODE_JOURNAL_OK on success; negative error on failure
+ */
+int node_journal_append(const void *data, unsigned char len);
+
+/** @brief Read an unsent frame without removing it
+ *
+ *  @param skip number of older unsent frames to skip, 0 for the oldest
+ *  @param seq sequence number of the frame, may be NULL
+ *  @param buf_out buffer for the frame
+ *  @param buf_len size of buf_out; the frame is truncated to it
+ *  @returns length of the frame; negative error on failure
+ */
+int node_journal_peek(unsigned int skip, unsigned int *seq, void *buf_out, unsigned char buf_len);
+
+/** @brief Mark the oldest unsent frames as sent
+ *
+ *  @param count number of frames
+ *  @returns NODE_JOURNAL_OK on success; negative error on failure
+ */
+int node_journal_ack(unsigned int count);
+
+/** @brief Number of unsent frames
+ *
+ *  @returns frames appended and neither acknowledged nor dropped
+ */
+unsigned int node_journal_pending(void);
+
+/** @brief Number of unsent frames dropped to make room since boot
+ *
+ *  @returns dropped frames
+ */
+unsigned int node_journal_dropped(void);
+
+#endif
@@ -0,0 +1,494 @@
+/**
+ * @file node_kvstore.cpp
+ *
+ * @brief Log-structured key-value store in internal flash
+ *
+ * Sector layout: an 8 byte header {magic, sequence} followed by records.
+ * The header is programmed last when a sector is filled by compaction, so a
+ * sector only becomes valid once all its records are in place; of two valid
+ * sectors the one with the higher sequence is active.
+ *
+ * Record layout, padded with 0xFF to the flash program unit:
+ * {magic, key_len, flags, value_len, 0xFFFF} key value crc32
+ *
+ * @author AdvanWISE
+ */
+
+#include "mbed.h"
+#include "platform/PlatformMutex.h"
+#include "platform/SingletonPtr.h"
+#include "node_kvstore.h"
+
+#define NODE_KV_SECTOR_MAGIC    0x53564B4EUL    ///< "NKVS"
+#define NODE_KV_RECORD_MAGIC    0x4B56
+#define NODE_KV_FLAG_REMOVED    0x01
+
+#define NODE_KV_HEADER_SIZE     8
+#define NODE_KV_CRC_SIZE        4
+#define NODE_KV_INDEX_SIZE      (NODE_KV_MAX_KEYS * 2)
+#define NODE_KV_BUF_SIZE        256
+
+struct node_kv_record
+{
+    uint16_t magic;
+    uint8_t key_len;
+    uint8_t flags;
+    uint16_t value_len;
+    uint16_t reserved;
+};
+
+struct node_kv_sector
+{
+    uint32_t magic;
+    uint32_t seq;
+};
+
+/** Index slot: 16-bit key hash, which also gives the home slot, and record offset */
+struct node_kv_slot
+{
+    uint16_t hash;
+    uint16_t offset;    ///< 0 for an empty slot, as offset 0 is the sector header
+};
+
+static FlashIAP kv_flash;
+static MbedCRC<POLY_32BIT_ANSI, 32> kv_crc;
+static SingletonPtr<PlatformMutex> kv_mutex;
+
+static uint32_t kv_sector_addr[2];
+static uint32_t kv_sector_size;
+static uint32_t kv_page_size;
+static int kv_active = -1;      ///< Active sector, -1 if not mounted
+static uint32_t kv_seq;
+static uint32_t kv_free;        ///< Offset of the next record in the active sector
+static bool kv_dirty;           ///< Programmed bytes past kv_free, left by an interrupted write
+static unsigned int kv_keys;
+static node_kv_slot kv_index[NODE_KV_INDEX_SIZE];
+static uint8_t kv_buf[NODE_KV_BUF_SIZE];
+
+static uint16_t kv_hash(const char *key, unsigned int key_len)
+{
+    uint32_t h = 2166136261UL;  // FNV-1a
+
+    for (unsigned int i = 0; i < key_len; i++)
+    {
+        h = (h ^ (uint8_t)key[i]) * 16777619UL;
+    }
+    return (uint16_t)(h ^ (h >> 16));
+}
+
+static uint32_t kv_align(uint32_t size)
+{
+    return (size + kv_page_size - 1) / kv_page_size * kv_page_size;
+}
+
+static uint32_t kv_record_size(unsigned int key_len, unsigned int value_len)
+{
+    return kv_align(NODE_KV_HEADER_SIZE + key_len + value_len + NODE_KV_CRC_SIZE);
+}
+
+static uint32_t kv_checksum(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0;
+
+    kv_crc.compute((void *)data, len, &crc);
+    return crc;
+}
+
+/** @brief Read and check the record at offset of a sector into kv_buf
+ *
+ *  @returns 1 for a valid record, 0 for erased flash, -1 for a damaged record
+ */
+static int kv_load(int sector, uint32_t offset, node_kv_record *rec)
+{
+    uint32_t crc;
+
+    if (offset + NODE_KV_HEADER_SIZE > kv_sector_size)
+        return 0;
+    if (kv_flash.read(rec, kv_sector_addr[sector] + offset, sizeof(*rec)) != 0)
+        return -1;
+
+    if (rec->magic == 0xFFFF && rec->key_len == 0xFF && rec->flags == 0xFF &&
+        rec->value_len == 0xFFFF && rec->reserved == 0xFFFF)
+        return 0;
+
+    if (rec->magic != NODE_KV_RECORD_MAGIC || rec->key_len == 0 || rec->key_len > NODE_KV_KEY_MAX ||
+        rec->value_len > NODE_KV_VALUE_MAX ||
+        offset + kv_record_size(rec->key_len, rec->value_len) > kv_sector_size)
+        return -1;
+
+    uint32_t len = NODE_KV_HEADER_SIZE + rec->key_len + rec->value_len;
+    if (kv_flash.read(kv_buf, kv_sector_addr[sector] + offset, len + NODE_KV_CRC_SIZE) != 0)
+        return -1;
+    memcpy(&crc, &kv_buf[len], sizeof(crc));
+
+    return (crc == kv_checksum(kv_buf, len)) ? 1 : -1;
+}
+
+/** @brief Find the slot of a key, or the empty slot it would take
+ *
+ *  @returns slot number; *found tells which of the two it is, -1 if the index is full
+ */
+static int kv_find(const char *key, unsigned int key_len, bool *found)
+{
+    node_kv_record rec;
+    uint16_t hash = kv_hash(key, key_len);
+    int slot = hash & (NODE_KV_INDEX_SIZE - 1);
+
+    *found = false;
+    for (int n = 0; n < NODE_KV_INDEX_SIZE; n++)
+    {
+        if (kv_index[slot].offset == 0)
+            return slot;
+
+        if (kv_index[slot].hash == hash)
+        {
+            uint32_t addr = kv_sector_addr[kv_active] + kv_index[slot].offset;
+            if (kv_flash.read(&rec, addr, sizeof(rec)) == 0 && rec.key_len == key_len &&
+                kv_flash.read(kv_buf, addr + NODE_KV_HEADER_SIZE, key_len) == 0 &&
+                memcmp(kv_buf, key, key_len) == 0)
+            {
+                *found = true;
+                return slot;
+            }
+        }
+        slot = (slot + 1) & (NODE_KV_INDEX_SIZE - 1);
+    }
+    return -1;
+}
+
+static int kv_format(int sector, uint32_t seq)
+{
+    node_kv_sector hdr;
+
+    if (kv_flash.erase(kv_sector_addr[sector], kv_sector_size) != 0)
+        return NODE_KV_ERR_FLASH;
+
+    memset(kv_buf, 0xFF, kv_page_size);
+    hdr.magic = NODE_KV_SECTOR_MAGIC;
+    hdr.seq = seq;
+    memcpy(kv_buf, &hdr, sizeof(hdr));
+    if (kv_flash.program(kv_buf, kv_sector_addr[sector], kv_align(sizeof(hdr))) != 0)
+        return NODE_KV_ERR_FLASH;
+
+    return NODE_KV_OK;
+}
+
+/** @brief Copy the live records to the other sector and switch to it
+ *
+ *  The active sector is untouched until the copy is complete, so an error
+ *  or a power loss leaves the store as it was.
+ */
+static int kv_compact(void)
+{
+    node_kv_slot index[NODE_KV_INDEX_SIZE];
+    node_kv_record rec;
+    node_kv_sector hdr;
+    int other = 1 - kv_active;
+    uint32_t dst = kv_align(sizeof(hdr));
+    unsigned int keys = 0;
+
+    if (kv_flash.erase(kv_sector_addr[other], kv_sector_size) != 0)
+        return NODE_KV_ERR_FLASH;
+
+    memset(index, 0, sizeof(index));
+    for (int i = 0; i < NODE_KV_INDEX_SIZE; i++)
+    {
+        if (kv_index[i].offset == 0)
+            continue;
+        // A record damaged since it was written is dropped
+        if (kv_load(kv_active, kv_index[i].offset, &rec) != 1 || (rec.flags & NODE_KV_FLAG_REMOVED))
+            continue;
+
+        uint32_t size = kv_record_size(rec.key_len, rec.value_len);
+        if (dst + size > kv_sector_size)
+            return NODE_KV_ERR_NO_SPACE;
+
+        uint32_t len = NODE_KV_HEADER_SIZE + rec.key_len + rec.value_len + NODE_KV_CRC_SIZE;
+        memset(&kv_buf[len], 0xFF, size - len);
+        if (kv_flash.program(kv_buf, kv_sector_addr[other] + dst, size) != 0)
+            return NODE_KV_ERR_FLASH;
+
+        int slot = kv_index[i].hash & (NODE_KV_INDEX_SIZE - 1);
+        while (index[slot].offset != 0)
+            slot = (slot + 1) & (NODE_KV_INDEX_SIZE - 1);
+        index[slot].hash = kv_index[i].hash;
+        index[slot].offset = dst;
+        keys++;
+        dst += size;
+    }
+
+    // Commit point
+    memset(kv_buf, 0xFF, kv_page_size);
+    hdr.magic = NODE_KV_SECTOR_MAGIC;
+    hdr.seq = kv_seq + 1;
+    memcpy(kv_buf, &hdr, sizeof(hdr));
+    if (kv_flash.program(kv_buf, kv_sector_addr[other], kv_align(sizeof(hdr))) != 0)
+        return NODE_KV_ERR_FLASH;
+
+    memcpy(kv_index, index, sizeof(index));
+    kv_active = other;
+    kv_seq++;
+    kv_free = dst;
+    kv_dirty = false;
+    kv_keys = keys;
+    return NODE_KV_OK;
+}
+
+static int kv_write(const char *key, const void *value, unsigned int value_len, uint8_t flags)
+{
+    node_kv_record rec;
+    unsigned int key_len = key ? strlen(key) : 0;
+    bool found;
+    int slot;
+
+    if (key_len == 0 || key_len > NODE_KV_KEY_MAX || value_len > NODE_KV_VALUE_MAX ||
+        (value_len && value == NULL))
+        return NODE_KV_ERR_INVALID_ARG;
+    if (kv_active < 0)
+        return NODE_KV_ERR_NOT_READY;
+
+    slot = kv_find(key, key_len, &found);
+    if (found)
+    {
+        // Unchanged values and repeated removals cost no flash
+        if (kv_load(kv_active, kv_index[slot].offset, &rec) == 1 &&
+            (rec.flags & NODE_KV_FLAG_REMOVED) == (flags & NODE_KV_FLAG_REMOVED) &&
+            rec.value_len == value_len &&
+            memcmp(&kv_buf[NODE_KV_HEADER_SIZE + key_len], value, value_len) == 0)
+            return NODE_KV_OK;
+    }
+    else if (flags & NODE_KV_FLAG_REMOVED)
+    {
+        return NODE_KV_OK;
+    }
+
+    uint32_t size = kv_record_size(key_len, value_len);
+    if (kv_dirty || kv_free + size > kv_sector_size || (!found && kv_keys >= NODE_KV_MAX_KEYS))
+    {
+        int ret = kv_compact();
+        if (ret != NODE_KV_OK)
+            return ret;
+        slot = kv_find(key, key_len, &found);
+        if (kv_free + size > kv_sector_size)
+            return NODE_KV_ERR_NO_SPACE;
+        if (!found && kv_keys >= NODE_KV_MAX_KEYS)
+            return NODE_KV_ERR_FULL;
+    }
+
+    rec.magic = NODE_KV_RECORD_MAGIC;
+    rec.key_len = key_len;
+    rec.flags = flags;
+    rec.value_len = value_len;
+    rec.reserved = 0xFFFF;
+
+    uint32_t len = NODE_KV_HEADER_SIZE + key_len + value_len;
+    memcpy(kv_buf, &rec, sizeof(rec));
+    memcpy(&kv_buf[NODE_KV_HEADER_SIZE], key, key_len);
+    memcpy(&kv_buf[NODE_KV_HEADER_SIZE + key_len], value, value_len);
+    uint32_t crc = kv_checksum(kv_buf, len);
+    memcpy(&kv_buf[len], &crc, sizeof(crc));
+    memset(&kv_buf[len + NODE_KV_CRC_SIZE], 0xFF, size - len - NODE_KV_CRC_SIZE);
+
+    if (kv_flash.program(kv_buf, kv_sector_addr[kv_active] + kv_free, size) != 0)
+    {
+        // Part of the record may be programmed; compact before the next write
+        kv_dirty = true;
+        return NODE_KV_ERR_FLASH;
+    }
+
+    if (!found)
+    {
+        kv_index[slot].hash = kv_hash(key, key_len);
+        kv_keys++;
+    }
+    kv_index[slot].offset = kv_free;
+    kv_free += size;
+    return NODE_KV_OK;
+}
+
+uint32_t node_kv_image_end(void)
+{
+#if defined(__CC_ARM) || (defined(__ARMCC_VERSION) && (__ARMCC_VERSION >= 6010050))
+    extern uint32_t Load$$LR$$LR_IROM1$$Limit[];
+    return (uint32_t)Load$$LR$$LR_IROM1$$Limit;
+#elif defined(__ICCARM__)
+    // The linker keeps all of ROM_region, ending at MBED_APP_START + MBED_APP_SIZE, for the image
+    extern const uint8_t __region_ROM_end__[];
+    return (uint32_t)__region_ROM_end__ + 1;
+#elif defined(__GNUC__) && defined(__arm__)
+    // .data is loaded from just after the code
+    extern uint32_t __etext[], _sdata[], _edata[];
+    return (uint32_t)__etext + ((uint32_t)_edata - (uint32_t)_sdata);
+#else
+    return 0;
+#endif
+}
+
+static int kv_mount(void)
+{
+    node_kv_sector hdr[2];
+    node_kv_record rec;
+    bool valid[2];
+
+    MBED_STATIC_ASSERT((NODE_KV_MAX_KEYS & (NODE_KV_MAX_KEYS - 1)) == 0, "NODE_KV_MAX_KEYS must be a power of two");
+    MBED_STATIC_ASSERT(NODE_KV_HEADER_SIZE + NODE_KV_KEY_MAX + NODE_KV_VALUE_MAX + NODE_KV_CRC_SIZE <= NODE_KV_BUF_SIZE,
+                       "Largest record does not fit kv_buf");
+
+    if (kv_flash.init() != 0)
+        return NODE_KV_ERR_FLASH;
+
+    if (NODE_KV_ADDR == 0)
+    {
+        uint32_t end = kv_flash.get_flash_start() + kv_flash.get_flash_size();
+        kv_sector_size = kv_flash.get_sector_size(end - 1);
+        kv_sector_addr[0] = end - 2 * kv_sector_size;
+    }
+    else
+    {
+        kv_sector_addr[0] = NODE_KV_ADDR;
+        kv_sector_size = kv_flash.get_sector_size(NODE_KV_ADDR);
+    }
+    kv_sector_addr[1] = kv_sector_addr[0] + kv_sector_size;
+    kv_page_size = kv_flash.get_page_size();
+
+    // The application grew into the store: lower target.mbed_app_size to keep it out
+    MBED_ASSERT(kv_sector_addr[0] >= node_kv_image_end());
+
+    // Offsets are kept in 16 bits
+    if (kv_sector_size > 0x10000 || kv_page_size > NODE_KV_BUF_SIZE ||
+        kv_flash.get_sector_size(kv_sector_addr[1]) != kv_sector_size)
+        return NODE_KV_ERR_INVALID_ARG;
+
+    for (int i = 0; i < 2; i++)
+    {
+        valid[i] = kv_flash.read(&hdr[i], kv_sector_addr[i], sizeof(hdr[i])) == 0 &&
+                   hdr[i].magic == NODE_KV_SECTOR_MAGIC;
+    }
+
+    if (valid[0] && valid[1])
+        kv_active = ((int32_t)(hdr[1].seq - hdr[0].seq) > 0) ? 1 : 0;
+    else if (valid[0] || valid[1])
+        kv_active = valid[1] ? 1 : 0;
+    else
+    {
+        if (kv_format(0, 1) != NODE_KV_OK)
+            return NODE_KV_ERR_FLASH;
+        kv_active = 0;
+        hdr[0].seq = 1;
+    }
+    kv_seq = hdr[kv_active].seq;
+
+    // Rebuild the index from the log; later records supersede earlier ones
+    memset(kv_index, 0, sizeof(kv_index));
+    kv_keys = 0;
+    kv_dirty = false;
+    kv_free = kv_align(sizeof(node_kv_sector));
+    while (1)
+    {
+        int ret = kv_load(kv_active, kv_free, &rec);
+        if (ret == 0)
+            break;
+        if (ret < 0)
+        {
+            // Interrupted write: everything after it is ignored
+            kv_dirty = true;
+            break;
+        }
+
+        bool found;
+        char key[NODE_KV_KEY_MAX];
+        memcpy(key, &kv_buf[NODE_KV_HEADER_SIZE], rec.key_len);
+        int slot = kv_find(key, rec.key_len, &found);
+        if (slot >= 0)
+        {
+            if (!found)
+            {
+                kv_index[slot].hash = kv_hash(key, rec.key_len);
+                kv_keys++;
+            }
+            kv_index[slot].offset = kv_free;
+        }
+        kv_free += kv_record_size(rec.key_len, rec.value_len);
+    }
+
+    // The rest of the sector must be erased to be programmed
+    for (uint32_t offset = kv_free; !kv_dirty && offset < kv_sector_size; offset += NODE_KV_BUF_SIZE)
+    {
+        uint32_t len = kv_sector_size - offset;
+        if (len > NODE_KV_BUF_SIZE)
+            len = NODE_KV_BUF_SIZE;
+        if (kv_flash.read(kv_buf, kv_sector_addr[kv_active] + offset, len) != 0)
+            return NODE_KV_ERR_FLASH;
+        for (uint32_t i = 0; i < len; i++)
+        {
+            if (kv_buf[i] != 0xFF)
+            {
+                kv_dirty = true;
+                break;
+            }
+        }
+    }
+
+    return NODE_KV_OK;
+}
+
+int node_kv_init(void)
+{
+    kv_mutex->lock();
+    kv_active = -1;
+    int ret = kv_mount();
+    if (ret != NODE_KV_OK)
+        kv_active = -1;
+    kv_mutex->unlock();
+    return ret;
+}
+
+int node_kv_get(const char *key, void *buf_out, unsigned short buf_len)
+{
+    node_kv_record rec;
+    unsigned int key_len = key ? strlen(key) : 0;
+    bool found;
+    int ret;
+
+    if (key_len == 0 || key_len > NODE_KV_KEY_MAX || (buf_len && buf_out == NULL))
+        return NODE_KV_ERR_INVALID_ARG;
+
+    kv_mutex->lock();
+    if (kv_active < 0)
+    {
+        ret = NODE_KV_ERR_NOT_READY;
+    }
+    else
+    {
+        int slot = kv_find(key, key_len, &found);
+        if (!found)
+            ret = NODE_KV_ERR_NOT_FOUND;
+        else if (kv_load(kv_active, kv_index[slot].offset, &rec) != 1)
+            ret = NODE_KV_ERR_FLASH;
+        else if (rec.flags & NODE_KV_FLAG_REMOVED)
+            ret = NODE_KV_ERR_NOT_FOUND;
+        else
+        {
+            memcpy(buf_out, &kv_buf[NODE_KV_HEADER_SIZE + key_len], (rec.value_len < buf_len) ? rec.value_len : buf_len);
+            ret = rec.value_len;
+        }
+    }
+    kv_mutex->unlock();
+    return ret;
+}
+
+int node_kv_set(const char *key, const void *buf_in, unsigned short len)
+{
+    kv_mutex->lock();
+    int ret = kv_write(key, buf_in, len, 0);
+    kv_mutex->unlock();
+    return ret;
+}
+
+int node_kv_remove(const char *key)
+{
+    kv_mutex->lock();
+    int ret = kv_write(key, NULL, 0, NODE_KV_FLAG_REMOVED);
+    kv_mutex->unlock();
+    return ret;
+}
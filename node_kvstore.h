@@ -0,0 +1,86 @@
+/**
+ * @file node_kvstore.h
+ *
+ * @brief Log-structured key-value store in internal flash
+ *
+ * Values are appended to one of two flash sectors as CRC protected records,
+ * so changing one setting programs a few double words instead of rewriting
+ * the whole configuration. When the active sector is full, the live records
+ * are copied to the other sector, which then takes over. A RAM index maps
+ * each key to its newest record, so reads do not scan the flash.
+ *
+ * Every step is power-loss safe: a record only counts once its CRC is
+ * complete, and a compacted sector only once its header, written last, is.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _NODE_KVSTORE_H_
+#define _NODE_KVSTORE_H_
+
+#include <stdint.h>
+
+#define NODE_KV_OK               0   ///< Node KV Result: OK
+#define NODE_KV_ERR_NOT_FOUND   -1   ///< Node KV Result: Key not found
+#define NODE_KV_ERR_INVALID_ARG -2   ///< Node KV Result: Invalid key or length
+#define NODE_KV_ERR_NO_SPACE    -3   ///< Node KV Result: Live records do not fit in a sector
+#define NODE_KV_ERR_FULL        -4   ///< Node KV Result: No room in the index for a new key
+#define NODE_KV_ERR_FLASH       -5   ///< Node KV Result: Flash erase or program failed
+#define NODE_KV_ERR_NOT_READY   -6   ///< Node KV Result: node_kv_init() not called or failed
+
+/* The default region is kept out of the application by target.mbed_app_size in
+ * mbed_app.json; a region set with NODE_KV_ADDR must be reserved the same way. */
+#ifndef NODE_KV_ADDR
+#define NODE_KV_ADDR            0    ///< First of the two sectors; 0 for the last two sectors of flash
+#endif
+
+#ifndef NODE_KV_MAX_KEYS
+#define NODE_KV_MAX_KEYS        32   ///< Keys the RAM index holds, including removed ones until compaction
+#endif
+
+#define NODE_KV_KEY_MAX         32   ///< Longest key, in bytes
+#define NODE_KV_VALUE_MAX       200  ///< Longest value, in bytes
+
+/** @brief Mount the store, formatting it if flash holds none
+ *
+ *  @returns NODE_KV_OK on success; negative error on failure
+ */
+int node_kv_init(void);
+
+/** @brief Read a value
+ *
+ *  @param key NUL terminated key
+ *  @param buf_out buffer for the value
+ *  @param buf_len size of buf_out; the value is truncated to it
+ *  @returns length of the stored value; negative error on failure
+ */
+int node_kv_get(const char *key, void *buf_out, unsigned short buf_len);
+
+/** @brief Store a value
+ *
+ *  Storing the value a key already has writes nothing.
+ *
+ *  @param key NUL terminated key
+ *  @param buf_in value
+ *  @param len length of the value, up to NODE_KV_VALUE_MAX
+ *  @returns NODE_KV_OK on success; negative error on failure
+ */
+int node_kv_set(const char *key, const void *buf_in, unsigned short len);
+
+/** @brief Remove a key
+ *
+ *  @param key NUL terminated key
+ *  @returns NODE_KV_OK on success, also if the key did not exist; negative error on failure
+ */
+int node_kv_remove(const char *key);
+
+/** @brief End of the linked image in flash, code and initialised data
+ *
+ *  Flash regions used for storage must start at or above it.
+ *
+ *  @returns address of the first byte after the image, or after the flash region
+ *           reserved for it with IAR; 0 in host builds
+ */
+uint32_t node_kv_image_end(void);
+
+#endif
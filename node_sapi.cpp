@@ -0,0 +1,300 @@
+/**
+ * @file node_sapi.cpp
+ *
+ * @brief Binary serial API server for provisioning
+ *
+ * Received bytes are parsed as they arrive, so several pipelined requests
+ * may be handled in one pass; their replies are gathered in one buffer and
+ * written together once the receive buffer runs dry.
+ *
+ * @author AdvanWISE
+ */
+
+#include "mbed.h"
+#include "node_api.h"
+#include "node_sapi.h"
+
+#ifndef NODE_SAPI_STACK_SIZE
+#define NODE_SAPI_STACK_SIZE    2048
+#endif
+
+#define NODE_SAPI_VALUE_MAX     128     ///< Longest value, with the NUL
+#define NODE_SAPI_OVERHEAD      5       ///< Sync, length and CRC
+#define NODE_SAPI_TX_SIZE       (2 * (NODE_SAPI_FRAME_MAX + NODE_SAPI_OVERHEAD))
+
+extern unsigned short nodeApiGetDevRptIntvlSec(char * buf_out, unsigned short buf_len);
+
+typedef unsigned short (*node_sapi_get_fp)(char *, unsigned short);
+typedef unsigned short (*node_sapi_set_fp)(char *);
+
+struct node_sapi_key
+{
+    node_sapi_get_fp get;
+    node_sapi_set_fp set;
+};
+
+static const node_sapi_key sapi_keys[NODE_SAPI_KEY_LAST] =
+{
+    {NULL, NULL},
+    {nodeApiGetAppEui, nodeApiSetAppEui},
+    {nodeApiGetAppKey, nodeApiSetAppKey},
+    {nodeApiGetDevAddr, nodeApiSetDevAddr},
+    {nodeApiGetNwkSKey, nodeApiSetNwkSKey},
+    {nodeApiGetAppSKey, nodeApiSetAppSKey},
+    {nodeApiGetDevActMode, nodeApiSetDevActMode},
+    {nodeApiGetDevOpMode, nodeApiSetDevOpMode},
+    {nodeApiGetDevClass, nodeApiSetDevClass},
+    {nodeApiGetDevAdvwiseFreq, nodeApiSetDevAdvwiseFreq},
+    {nodeApiGetDevAdvwiseDataRate, nodeApiSetDevAdvwiseDataRate},
+    {nodeApiGetDevNetId, nodeApiSetDevNetId},
+    {nodeApiGetDevAdvwiseTxPwr, nodeApiSetDevAdvwiseTxPwr},
+    {nodeApiGetSpsConf, nodeApiSetSpsConf},
+    {nodeApiGetBKey, nodeApiSetBKey},
+    {nodeApiGetDevRptIntvlSec, NULL},
+    {nodeApiGetVersion, NULL},
+    {nodeApiGetFuseDevEui, NULL},
+};
+
+static FileHandle *sapi_fh;                            ///< Being served
+static MbedCRC<POLY_16BIT_CCITT, 16> sapi_crc;
+
+static uint8_t sapi_rx[2 + NODE_SAPI_FRAME_MAX + 2];   ///< Length, tag, command, body, CRC
+static unsigned int sapi_rx_count;
+static bool sapi_rx_sync;                               ///< Sync seen, frame being received
+static uint8_t sapi_tx[NODE_SAPI_TX_SIZE];              ///< Replies not yet written
+static unsigned int sapi_tx_len;
+static unsigned int sapi_dropped;
+
+static uint16_t sapi_checksum(const uint8_t *data, unsigned int len)
+{
+    uint32_t crc = 0;
+
+    sapi_crc.compute((void *)data, len, &crc);
+    return crc;
+}
+
+static void sapi_flush(void)
+{
+    if (sapi_tx_len)
+        sapi_fh->write(sapi_tx, sapi_tx_len);
+    sapi_tx_len = 0;
+}
+
+/** @brief Read keys into reply
+ *
+ *  @returns reply length; 0 if it would not fit in a frame
+ */
+static unsigned int sapi_get(const uint8_t *body, unsigned int len, uint8_t *reply, unsigned int reply_max)
+{
+    char value[NODE_SAPI_VALUE_MAX];
+    unsigned int n = 0;
+
+    for (unsigned int i = 0; i < len; i++)
+    {
+        uint8_t id = body[i];
+        unsigned short rc = NODE_SAPI_KEY_UNKNOWN;
+        unsigned int value_len = 0;
+
+        memset(value, 0, sizeof(value));
+        if (id < NODE_SAPI_KEY_LAST && sapi_keys[id].get)
+        {
+            rc = sapi_keys[id].get(value, sizeof(value) - 1);
+            if (rc == NODE_API_OK)
+                value_len = strlen(value);
+        }
+
+        if (n + 3 + value_len > reply_max)
+            return 0;
+        reply[n] = id;
+        reply[n + 1] = rc;
+        reply[n + 2] = value_len;
+        memcpy(&reply[n + 3], value, value_len);
+        n += 3 + value_len;
+    }
+    return n;
+}
+
+/** @brief Write keys, replying with each result
+ *
+ *  @returns reply length; 0 if the body is malformed or the reply would not fit in a frame
+ */
+static unsigned int sapi_set(const uint8_t *body, unsigned int len, uint8_t *reply, unsigned int reply_max)
+{
+    char value[NODE_SAPI_VALUE_MAX];
+    unsigned int n = 0;
+
+    for (unsigned int i = 0; i < len; )
+    {
+        if (i + 2 > len || i + 2 + body[i + 1] > len || body[i + 1] >= sizeof(value) || n + 2 > reply_max)
+            return 0;
+
+        uint8_t id = body[i];
+        unsigned short rc = NODE_SAPI_KEY_UNKNOWN;
+
+        memcpy(value, &body[i + 2], body[i + 1]);
+        value[body[i + 1]] = '\0';
+        if (id < NODE_SAPI_KEY_LAST && sapi_keys[id].set)
+            rc = sapi_keys[id].set(value);
+        else if (id < NODE_SAPI_KEY_LAST && sapi_keys[id].get)
+            rc = NODE_SAPI_KEY_READ_ONLY;
+
+        reply[n] = id;
+        reply[n + 1] = rc;
+        n += 2;
+        i += 2 + body[i + 1];
+    }
+    return n;
+}
+
+/** @brief Handle a checked frame, appending the reply to sapi_tx */
+static void sapi_handle(const uint8_t *payload, unsigned int len)
+{
+    if (sapi_tx_len + NODE_SAPI_FRAME_MAX + NODE_SAPI_OVERHEAD > sizeof(sapi_tx))
+        sapi_flush();
+
+    uint8_t *frame = &sapi_tx[sapi_tx_len];
+    uint8_t *reply = &frame[3];
+    const uint8_t *body = &payload[2];
+    unsigned int body_len = len - 2;
+    unsigned int reply_max = NODE_SAPI_FRAME_MAX - 3;
+    unsigned int n = 0;
+    uint8_t status = NODE_SAPI_STATUS_OK;
+
+    reply[0] = payload[0];
+    reply[1] = payload[1] | NODE_SAPI_CMD_REPLY;
+
+    switch (payload[1])
+    {
+        case NODE_SAPI_CMD_PING:
+            if (body_len > reply_max)
+            {
+                status = NODE_SAPI_STATUS_BAD_LEN;
+                break;
+            }
+            memcpy(&reply[3], body, body_len);
+            n = body_len;
+            break;
+        case NODE_SAPI_CMD_GET:
+            n = sapi_get(body, body_len, &reply[3], reply_max);
+            if (n == 0 && body_len)
+                status = NODE_SAPI_STATUS_BAD_LEN;
+            break;
+        case NODE_SAPI_CMD_SET:
+            n = sapi_set(body, body_len, &reply[3], reply_max);
+            if (n == 0 && body_len)
+                status = NODE_SAPI_STATUS_BAD_LEN;
+            break;
+        case NODE_SAPI_CMD_APPLY:
+            reply[3] = nodeApiApplyCfg();
+            n = 1;
+            break;
+        case NODE_SAPI_CMD_SAVE:
+            reply[3] = nodeApiSaveCfg();
+            n = 1;
+            break;
+        default:
+            status = NODE_SAPI_STATUS_BAD_CMD;
+            break;
+    }
+    reply[2] = status;
+    len = 3 + n;
+
+    frame[0] = NODE_SAPI_SYNC;
+    frame[1] = len & 0xFF;
+    frame[2] = len >> 8;
+    uint16_t crc = sapi_checksum(&frame[1], 2 + len);
+    frame[3 + len] = crc & 0xFF;
+    frame[4 + len] = crc >> 8;
+    sapi_tx_len += len + NODE_SAPI_OVERHEAD;
+}
+
+static void sapi_input(uint8_t c)
+{
+    if (!sapi_rx_sync)
+    {
+        sapi_rx_sync = (c == NODE_SAPI_SYNC);
+        sapi_rx_count = 0;
+        return;
+    }
+
+    sapi_rx[sapi_rx_count++] = c;
+    if (sapi_rx_count < 2)
+        return;
+
+    unsigned int len = sapi_rx[0] | (sapi_rx[1] << 8);
+    if (len < 2 || len > NODE_SAPI_FRAME_MAX)
+    {
+        sapi_dropped++;
+        sapi_rx_sync = false;
+    }
+    else if (sapi_rx_count == 2 + len + 2)
+    {
+        uint16_t crc = sapi_rx[2 + len] | (sapi_rx[3 + len] << 8);
+        if (crc == sapi_checksum(sapi_rx, 2 + len))
+            sapi_handle(&sapi_rx[2], len);
+        else
+            sapi_dropped++;
+        sapi_rx_sync = false;
+    }
+}
+
+void node_sapi_serve(FileHandle *fh)
+{
+    uint8_t buf[64];
+
+    sapi_fh = fh;
+    while (fh->poll(POLLIN) & POLLIN)
+    {
+        ssize_t n = fh->read(buf, sizeof(buf));
+        for (ssize_t i = 0; i < n; i++)
+            sapi_input(buf[i]);
+    }
+    sapi_flush();
+}
+
+unsigned int node_sapi_dropped(void)
+{
+    return sapi_dropped;
+}
+
+#ifndef NODE_SAPI_HOST
+
+static UARTSerial *sapi_serial;
+static EventQueue *sapi_queue;
+static Thread *sapi_thread;
+static volatile bool sapi_poll_pending;
+
+/** @brief Serve the UART, in the server thread */
+static void sapi_poll(void)
+{
+    sapi_poll_pending = false;
+    node_sapi_serve(sapi_serial);
+}
+
+/** @brief UART event, in interrupt context */
+static void sapi_sigio(void)
+{
+    if (!sapi_poll_pending)
+    {
+        sapi_poll_pending = true;
+        if (!sapi_queue->call(sapi_poll))
+            sapi_poll_pending = false;
+    }
+}
+
+int node_sapi_start(PinName tx, PinName rx, int baud)
+{
+    if (sapi_serial)
+        return NODE_SAPI_ERR_NOT_READY;
+
+    sapi_queue = new EventQueue(4 * EVENTS_EVENT_SIZE);
+    sapi_thread = new Thread(osPriorityNormal, NODE_SAPI_STACK_SIZE);
+    if (sapi_thread->start(callback(sapi_queue, &EventQueue::dispatch_forever)) != osOK)
+        return NODE_SAPI_ERR_NOT_READY;
+
+    sapi_serial = new UARTSerial(tx, rx, baud);
+    sapi_serial->sigio(callback(sapi_sigio));
+    return NODE_SAPI_OK;
+}
+
+#endif
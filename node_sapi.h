@@ -0,0 +1,97 @@
+/**
+ * @file node_sapi.h
+ *
+ * @brief Binary serial API server for provisioning
+ *
+ * Frames, in both directions:
+ * 0x7E, length (2 bytes, little endian), tag, command, body, CRC (2 bytes)
+ *
+ * The length counts tag, command and body. The CRC is CRC-16/CCITT over the
+ * length and everything up to the CRC, little endian. A frame with a bad CRC
+ * is dropped without a reply.
+ *
+ * Every request is answered in order with a frame carrying the same tag, the
+ * command with bit 7 set and a body starting with a NODE_SAPI_STATUS_* byte.
+ * Requests need not wait for earlier replies, so a host can pipeline them.
+ *
+ * GET body: key ids. Reply: per key, id, result, length, value.
+ * SET body: per key, id, length, value. Reply: per key, id, result.
+ * Values are the strings of the matching nodeApiGet and nodeApiSet calls, and
+ * the results their return codes.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _NODE_SAPI_H_
+#define _NODE_SAPI_H_
+
+#include "mbed.h"
+
+#define NODE_SAPI_OK                 0    ///< Node SAPI Result: OK
+#define NODE_SAPI_ERR_NOT_READY     -1    ///< Node SAPI Result: Out of memory or already started
+
+#define NODE_SAPI_SYNC               0x7E
+#define NODE_SAPI_FRAME_MAX          512  ///< Longest tag, command and body
+
+#define NODE_SAPI_CMD_PING           0x00 ///< Echo the body
+#define NODE_SAPI_CMD_GET            0x01 ///< Read keys
+#define NODE_SAPI_CMD_SET            0x02 ///< Write keys
+#define NODE_SAPI_CMD_APPLY          0x03 ///< nodeApiApplyCfg()
+#define NODE_SAPI_CMD_SAVE           0x04 ///< nodeApiSaveCfg()
+#define NODE_SAPI_CMD_REPLY          0x80 ///< Set in the command of a reply
+
+#define NODE_SAPI_STATUS_OK          0x00
+#define NODE_SAPI_STATUS_BAD_CMD     0x01 ///< Unknown command
+#define NODE_SAPI_STATUS_BAD_LEN     0x02 ///< Body malformed, or reply would not fit in a frame
+
+#define NODE_SAPI_KEY_UNKNOWN        0xFE ///< Per key result: no such key
+#define NODE_SAPI_KEY_READ_ONLY      0xFD ///< Per key result: key cannot be set
+
+typedef enum
+{
+    NODE_SAPI_KEY_APP_EUI = 1,
+    NODE_SAPI_KEY_APP_KEY,
+    NODE_SAPI_KEY_DEV_ADDR,
+    NODE_SAPI_KEY_NWK_SKEY,
+    NODE_SAPI_KEY_APP_SKEY,
+    NODE_SAPI_KEY_ACT_MODE,
+    NODE_SAPI_KEY_OP_MODE,
+    NODE_SAPI_KEY_CLASS,
+    NODE_SAPI_KEY_FREQ,
+    NODE_SAPI_KEY_DATA_RATE,
+    NODE_SAPI_KEY_NET_ID,
+    NODE_SAPI_KEY_TX_PWR,
+    NODE_SAPI_KEY_SPS_CONF,
+    NODE_SAPI_KEY_BKEY,
+    NODE_SAPI_KEY_RPT_INTVL,        ///< Read only
+    NODE_SAPI_KEY_VERSION,          ///< Read only
+    NODE_SAPI_KEY_FUSE_DEV_EUI,     ///< Read only
+    NODE_SAPI_KEY_LAST
+}node_sapi_key_t;
+
+/** @brief Start serving on a UART, from a thread of its own
+ *
+ *  @param tx UART transmit pin
+ *  @param rx UART receive pin
+ *  @param baud baud rate
+ *  @returns NODE_SAPI_OK on success; negative error on failure
+ */
+int node_sapi_start(PinName tx, PinName rx, int baud);
+
+/** @brief Handle what has arrived on a file handle, then write the replies
+ *         to it in one go
+ *
+ *  Called from the server thread on each UART event; the host tests call it
+ *  on a loopback file handle.
+ *
+ *  @param fh file handle to serve
+ */
+void node_sapi_serve(FileHandle *fh);
+
+/** @brief Number of frames dropped for a bad CRC or length
+ *
+ *  @returns dropped frames
+ */
+unsigned int node_sapi_dropped(void);
+
+#endif
@@ -0,0 +1,339 @@
+/**
+ * @file node_timebase.cpp
+ *
+ * @brief Drift-compensated monotonic timebase
+ *
+ * The fit is computed in double precision relative to the newest sample, so
+ * differences of microsecond timestamps stay exact, but only once per sample.
+ * Reading the clock is integer only: the rate is kept in 2^-32 units and the
+ * clock rebased at every sample, so the product never overflows.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef NODE_TIMEBASE_HOST
+#include "mbed.h"
+#include "hal/ticker_api.h"
+#include "hal/us_ticker_api.h"
+#include "platform/PlatformMutex.h"
+#include "platform/SingletonPtr.h"
+#endif
+#include <math.h>
+#include <string.h>
+#include "node_timebase.h"
+
+#define TIMEBASE_RATE_ONE       4294967296.0    ///< 2^32, rate units per 1
+#define TIMEBASE_RATE_MAX       (1 << 30)
+
+/** @brief d times the rate, in 2^-32 units, without overflow */
+static int64_t timebase_scale(uint64_t d, int32_t rate)
+{
+    int64_t hi = (int64_t)(d >> 32) * rate;
+    int64_t lo = ((int64_t)(d & 0xFFFFFFFF) * rate) >> 32;
+
+    return hi + lo;
+}
+
+static unsigned char timebase_newest(const struct node_timebase *tb)
+{
+    return (tb->pos + NODE_TIMEBASE_SAMPLES - 1) % NODE_TIMEBASE_SAMPLES;
+}
+
+void node_timebase_reset(struct node_timebase *tb, uint64_t local_us)
+{
+    memset(tb, 0, sizeof(*tb));
+    tb->base_local = local_us;
+    tb->base = local_us;
+}
+
+uint64_t node_timebase_convert(const struct node_timebase *tb, uint64_t local_us)
+{
+    uint64_t d = (local_us > tb->base_local) ? local_us - tb->base_local : 0;
+
+    return tb->base + d + timebase_scale(d, tb->rate);
+}
+
+int node_timebase_update(struct node_timebase *tb, uint64_t local_us, uint64_t ref_us, unsigned int resolution_us)
+{
+    int rc = NODE_TIMEBASE_OK;
+
+    if (tb->count > 0)
+    {
+        unsigned char last = timebase_newest(tb);
+
+        if (local_us <= tb->local[last] || ref_us <= tb->ref[last])
+            return NODE_TIMEBASE_ERR_IGNORED;
+    }
+
+    uint64_t now = node_timebase_convert(tb, local_us);
+    int64_t off = (int64_t)(ref_us - now);
+
+    // Both the sample and the clock, fitted to earlier samples, may be off by the resolution
+    int64_t resync = NODE_TIMEBASE_RESYNC_US + 2 * (int64_t)resolution_us;
+
+    if (tb->count >= 2 && (off > resync || off < -resync))
+    {
+        tb->count = 0;
+        tb->pos = 0;
+        rc = NODE_TIMEBASE_ERR_RESYNC;
+    }
+
+    tb->local[tb->pos] = local_us;
+    tb->ref[tb->pos] = ref_us;
+    tb->pos = (tb->pos + 1) % NODE_TIMEBASE_SAMPLES;
+    if (tb->count < NODE_TIMEBASE_SAMPLES)
+        tb->count++;
+
+    unsigned char last = timebase_newest(tb);
+    unsigned char oldest = (tb->count < NODE_TIMEBASE_SAMPLES) ? 0 : tb->pos;
+
+    // The slope of two samples may be off by twice the resolution over their
+    // distance; with a coarse reference that is noise, not drift
+    tb->base_local = local_us;
+    if (tb->count == 1 ||
+            (tb->count == 2 && 2e6 * resolution_us > NODE_TIMEBASE_SLEW_PPM * (double)(local_us - tb->local[oldest])))
+    {
+        // Catch up with the reference if ahead, keep the rate
+        tb->base = (ref_us > now) ? ref_us : now;
+        return rc;
+    }
+
+    double mx = 0, my = 0, sxx = 0, sxy = 0, sres = 0;
+
+    for (int i = 0; i < tb->count; i++)
+    {
+        mx += (double)(int64_t)(tb->local[i] - tb->local[last]);
+        my += (double)(int64_t)(tb->ref[i] - tb->ref[last]);
+    }
+    mx /= tb->count;
+    my /= tb->count;
+    for (int i = 0; i < tb->count; i++)
+    {
+        double x = (double)(int64_t)(tb->local[i] - tb->local[last]) - mx;
+        double y = (double)(int64_t)(tb->ref[i] - tb->ref[last]) - my;
+
+        sxx += x * x;
+        sxy += x * y;
+    }
+
+    double slope = sxy / sxx;
+
+    // Summed directly: syy - slope * sxy cancels to noise when the fit is good
+    for (int i = 0; i < tb->count; i++)
+    {
+        double x = (double)(int64_t)(tb->local[i] - tb->local[last]) - mx;
+        double y = (double)(int64_t)(tb->ref[i] - tb->ref[last]) - my;
+
+        sres += (y - slope * x) * (y - slope * x);
+    }
+
+    double resid = (tb->count > 2) ? sres / (tb->count - 2) : 0;
+    double err = (my - slope * mx) + (double)(int64_t)(tb->ref[last] - now);
+    double interval = (double)(tb->local[last] - tb->local[oldest]) / (tb->count - 1);
+    double slew = 0;
+
+    if (err > NODE_TIMEBASE_STEP_US + (double)resolution_us && tb->count > 2)
+    {
+        // With a rate fitted to earlier samples, the reference stepped ahead.
+        // Those samples would bend the slope towards the step, so the fit
+        // restarts from this sample and the clock keeps its rate.
+        tb->base = (ref_us > now) ? ref_us : now;
+        tb->local[0] = local_us;
+        tb->ref[0] = ref_us;
+        tb->count = 1;
+        tb->pos = 1;
+        return rc;
+    }
+
+    tb->spread_us = (resid > 0) ? (float)sqrt(resid) : 0;
+    tb->drift_sd = (float)(tb->spread_us / sqrt(sxx));
+    tb->drift_ppb = (int32_t)((1.0 / slope - 1.0) * 1e9);
+
+    if (err > NODE_TIMEBASE_STEP_US + (double)resolution_us)
+        tb->base = now + (uint64_t)err;
+    else
+    {
+        tb->base = now;
+        slew = err / interval;
+        if (slew > NODE_TIMEBASE_SLEW_PPM * 1e-6)
+            slew = NODE_TIMEBASE_SLEW_PPM * 1e-6;
+        else if (slew < -NODE_TIMEBASE_SLEW_PPM * 1e-6)
+            slew = -NODE_TIMEBASE_SLEW_PPM * 1e-6;
+    }
+
+    double rate = (slope - 1.0 + slew) * TIMEBASE_RATE_ONE;
+    if (rate > TIMEBASE_RATE_MAX)
+        rate = TIMEBASE_RATE_MAX;
+    else if (rate < -TIMEBASE_RATE_MAX)
+        rate = -TIMEBASE_RATE_MAX;
+    tb->rate = (int32_t)rate;
+
+    return rc;
+}
+
+unsigned int node_timebase_uncertainty(const struct node_timebase *tb, uint64_t ahead_us)
+{
+    if (tb->count < 3)
+        return 0xFFFFFFFF;
+
+    // One more microsecond for the rounding of the clock itself
+    double window = 3.0 * (tb->spread_us + (double)tb->drift_sd * ahead_us) + 1.0;
+
+    return (window < 4294967295.0) ? (unsigned int)window : 0xFFFFFFFF;
+}
+
+/** @brief Reference time of a beacon
+ *
+ *  The first beacon starts the reference at the corrected clock; the next
+ *  ones are whole periods after the last sample.
+ *
+ *  @returns reference time; 0 for a repeat of the last beacon
+ */
+static uint64_t timebase_beacon_ref(const struct node_timebase *tb, uint64_t local_us, uint64_t period_us)
+{
+    if (tb->count == 0)
+        return node_timebase_convert(tb, local_us);
+
+    unsigned char last = timebase_newest(tb);
+    uint64_t elapsed = node_timebase_convert(tb, local_us) - node_timebase_convert(tb, tb->local[last]);
+    uint64_t periods = (elapsed + period_us / 2) / period_us;
+
+    return periods ? tb->ref[last] + periods * period_us : 0;
+}
+
+void node_timebase_simulate(int32_t drift_ppb, unsigned int jitter_us, uint64_t period_us,
+                            unsigned int samples, struct node_timebase_sim *sim)
+{
+    struct node_timebase tb;
+    const uint64_t boot_us = 1000000;
+    uint64_t origin = 0;
+    uint64_t prev = 0;
+    unsigned int window = 0xFFFFFFFF;
+    uint32_t seed = 1;
+
+    memset(sim, 0, sizeof(*sim));
+    sim->monotonic = 1;
+    node_timebase_reset(&tb, boot_us);
+
+    for (unsigned int k = 0; k < samples; k++)
+    {
+        uint64_t t;
+        uint64_t local;
+
+        seed = seed * 1664525 + 1013904223;
+        t = k * period_us + (jitter_us ? (seed >> 8) % (jitter_us + 1) : 0);
+        local = boot_us + period_us + t + (uint64_t)((int64_t)t * drift_ppb / 1000000000);
+
+        uint64_t corrected = node_timebase_convert(&tb, local);
+        if (corrected < prev)
+            sim->monotonic = 0;
+        prev = corrected;
+
+        if (k == 0)
+            origin = corrected;
+        else if (k >= samples / 2)
+        {
+            int64_t error = (int64_t)(corrected - (origin + k * period_us));
+            unsigned int magnitude = (unsigned int)((error < 0) ? -error : error);
+
+            if (magnitude > sim->max_error_us)
+                sim->max_error_us = magnitude;
+            if (magnitude > window)
+                sim->missed++;
+        }
+
+        uint64_t ref = timebase_beacon_ref(&tb, local, period_us);
+        if (ref)
+            node_timebase_update(&tb, local, ref, 0);
+        window = node_timebase_uncertainty(&tb, period_us);
+    }
+
+    sim->drift_ppb = tb.drift_ppb;
+    sim->drift_error_ppb = tb.drift_ppb - drift_ppb;
+    sim->window_us = window;
+}
+
+#ifndef NODE_TIMEBASE_HOST
+
+static struct node_timebase tb_state;
+static struct node_timebase tb_next;            ///< Updated under tb_mutex, then swapped in
+static SingletonPtr<PlatformMutex> tb_mutex;
+static uint64_t tb_last_beacon;
+static uint64_t tb_last_rtc;
+
+static uint64_t timebase_local(void)
+{
+    return ticker_read_us(get_us_ticker_data());
+}
+
+static void timebase_commit(void)
+{
+    core_util_critical_section_enter();
+    tb_state = tb_next;
+    core_util_critical_section_exit();
+}
+
+void node_timebase_init(void)
+{
+    tb_mutex->lock();
+    node_timebase_reset(&tb_next, timebase_local());
+    tb_last_beacon = 0;
+    tb_last_rtc = 0;
+    timebase_commit();
+    tb_mutex->unlock();
+}
+
+void node_timebase_beacon(void)
+{
+    tb_mutex->lock();
+    uint64_t local = timebase_local();
+    uint64_t ref = timebase_beacon_ref(&tb_next, local, NODE_TIMEBASE_BEACON_PERIOD_MS * 1000ULL);
+
+    if (ref && node_timebase_update(&tb_next, local, ref, 0) != NODE_TIMEBASE_ERR_IGNORED)
+        timebase_commit();
+    tb_last_beacon = local;
+    tb_mutex->unlock();
+}
+
+void node_timebase_rtc(void)
+{
+    tb_mutex->lock();
+    uint64_t local = timebase_local();
+
+    if ((tb_last_beacon == 0 || local - tb_last_beacon > 2 * NODE_TIMEBASE_BEACON_PERIOD_MS * 1000ULL) &&
+            (tb_last_rtc == 0 || local - tb_last_rtc >= NODE_TIMEBASE_RTC_PERIOD_S * 1000000ULL))
+    {
+        // The sample is anywhere in the second: take its middle
+        uint64_t ref = (uint64_t)time(NULL) * 1000000 + 500000;
+
+        if (node_timebase_update(&tb_next, local, ref, 500000) != NODE_TIMEBASE_ERR_IGNORED)
+            timebase_commit();
+        tb_last_rtc = local;
+    }
+    tb_mutex->unlock();
+}
+
+uint64_t node_timebase_now_us(void)
+{
+    core_util_critical_section_enter();
+    uint64_t now = node_timebase_convert(&tb_state, timebase_local());
+    core_util_critical_section_exit();
+
+    return now;
+}
+
+int32_t node_timebase_drift_ppb(void)
+{
+    return tb_state.drift_ppb;
+}
+
+unsigned int node_timebase_window_us(uint64_t ahead_us)
+{
+    core_util_critical_section_enter();
+    unsigned int window = node_timebase_uncertainty(&tb_state, ahead_us);
+    core_util_critical_section_exit();
+
+    return window;
+}
+
+#endif
@@ -0,0 +1,179 @@
+/**
+ * @file node_timebase.h
+ *
+ * @brief Drift-compensated monotonic timebase
+ *
+ * The microsecond ticker is the local clock: fine grained but only as
+ * accurate as the system clock. A reference, the LoRa beacons when the node
+ * tracks them and the RTC otherwise, is accurate in the long run but coarse
+ * or sparse. Pairs of local and reference timestamps are fitted by least
+ * squares over the last NODE_TIMEBASE_SAMPLES samples, which gives the drift
+ * of the local clock and the spread of the reference around the fit.
+ *
+ * The corrected clock runs on the local clock at the fitted rate, and slews
+ * by up to NODE_TIMEBASE_SLEW_PPM to follow the reference. It only steps
+ * forward, on the first sample or when far behind. It never goes backward.
+ *
+ * node_timebase_uncertainty() gives how wide a receive window must be to
+ * catch an event some time ahead, from the spread of the fit, so windows
+ * can shrink as the estimate converges.
+ *
+ * Built with NODE_TIMEBASE_HOST defined, only the estimator is compiled:
+ * node_timebase_simulate() runs it on a PC against a clock with a known
+ * drift and jitter, without the board.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _NODE_TIMEBASE_H_
+#define _NODE_TIMEBASE_H_
+
+#include <stdint.h>
+
+#define NODE_TIMEBASE_OK             0    ///< Node timebase Result: OK
+#define NODE_TIMEBASE_ERR_IGNORED   -1    ///< Node timebase Result: Sample out of order, or a repeat of the last one
+#define NODE_TIMEBASE_ERR_RESYNC    -2    ///< Node timebase Result: Sample far off the fit; the fit restarted from it
+
+#ifndef NODE_TIMEBASE_SAMPLES
+#define NODE_TIMEBASE_SAMPLES       16    ///< Samples in the fit
+#endif
+
+#ifndef NODE_TIMEBASE_SLEW_PPM
+#define NODE_TIMEBASE_SLEW_PPM      500   ///< Largest rate correction used to follow the reference
+#endif
+
+#ifndef NODE_TIMEBASE_STEP_US
+#define NODE_TIMEBASE_STEP_US       10000 ///< Corrected clock steps forward when further behind the reference
+#endif
+
+#ifndef NODE_TIMEBASE_RESYNC_US
+#define NODE_TIMEBASE_RESYNC_US     100000 ///< Sample further off the fit restarts it, e.g. after the ticker stopped in deep sleep
+#endif
+
+#ifndef NODE_TIMEBASE_BEACON_PERIOD_MS
+#define NODE_TIMEBASE_BEACON_PERIOD_MS 128000 ///< Beacon period of the network
+#endif
+
+#ifndef NODE_TIMEBASE_RTC_PERIOD_S
+#define NODE_TIMEBASE_RTC_PERIOD_S  600   ///< Shortest time between RTC samples
+#endif
+
+struct node_timebase
+{
+    uint64_t local[NODE_TIMEBASE_SAMPLES];  ///< Local time of the samples, us
+    uint64_t ref[NODE_TIMEBASE_SAMPLES];    ///< Reference time of the samples, us
+    unsigned char count;
+    unsigned char pos;                      ///< Next slot, the oldest sample once full
+    uint64_t base_local;                    ///< Local time at the last correction
+    uint64_t base;                          ///< Corrected time at base_local
+    int32_t rate;                           ///< Corrected clock rate less one, in 2^-32
+    int32_t drift_ppb;                      ///< Local clock rate against the reference, less one, in ppb
+    float spread_us;                        ///< RMS distance of the samples to the fit
+    float drift_sd;                         ///< Standard deviation of the fitted rate
+};
+
+struct node_timebase_sim
+{
+    int32_t drift_ppb;          ///< Fitted drift at the end
+    int32_t drift_error_ppb;    ///< Fitted less injected drift
+    unsigned int max_error_us;  ///< Largest distance of the corrected clock to the reference, over the second half of the samples
+    unsigned int window_us;     ///< Half-width of a window one period ahead, at the end
+    unsigned int missed;        ///< Samples in the second half outside the window predicted one period before
+    unsigned char monotonic;    ///< 1 if the corrected clock never went backward
+};
+
+/** @brief Start a timebase with no samples
+ *
+ *  @param tb timebase
+ *  @param local_us local time, where the corrected clock starts
+ */
+void node_timebase_reset(struct node_timebase *tb, uint64_t local_us);
+
+/** @brief Add a sample
+ *
+ *  @param tb timebase
+ *  @param local_us local time of the sample
+ *  @param ref_us reference time of the sample
+ *  @param resolution_us how far the reference time may be off, e.g. half a
+ *                       second for a seconds counter; widens the offsets
+ *                       that step the clock or restart the fit
+ *  @returns NODE_TIMEBASE_OK; NODE_TIMEBASE_ERR_RESYNC if the sample restarted
+ *           the fit; NODE_TIMEBASE_ERR_IGNORED if it was not used
+ */
+int node_timebase_update(struct node_timebase *tb, uint64_t local_us, uint64_t ref_us, unsigned int resolution_us);
+
+/** @brief Corrected time
+ *
+ *  @param tb timebase
+ *  @param local_us local time, not before the last sample
+ *  @returns corrected time, us
+ */
+uint64_t node_timebase_convert(const struct node_timebase *tb, uint64_t local_us);
+
+/** @brief Uncertainty of the corrected clock
+ *
+ *  @param tb timebase
+ *  @param ahead_us how far ahead of the last sample the event is
+ *  @returns half-width of a window that catches the event, three standard
+ *           deviations; 0xFFFFFFFF before three samples
+ */
+unsigned int node_timebase_uncertainty(const struct node_timebase *tb, uint64_t ahead_us);
+
+/** @brief Simulate beacon tracking
+ *
+ *  Beacons come every period_us of reference time. Each is timestamped by a
+ *  local clock that drifts by drift_ppb, with a latency spread uniformly over
+ *  jitter_us. The timestamps feed the estimator.
+ *
+ *  @param drift_ppb drift of the local clock
+ *  @param jitter_us timestamp latency spread
+ *  @param period_us reference time between samples
+ *  @param samples number of samples
+ *  @param sim result
+ */
+void node_timebase_simulate(int32_t drift_ppb, unsigned int jitter_us, uint64_t period_us,
+                            unsigned int samples, struct node_timebase_sim *sim);
+
+#ifndef NODE_TIMEBASE_HOST
+
+/** @brief Start the timebase on the microsecond ticker
+ */
+void node_timebase_init(void);
+
+/** @brief Add a beacon reception as a sample; call when a beacon was received
+ *
+ *  Beacons are NODE_TIMEBASE_BEACON_PERIOD_MS apart. Their reference time
+ *  continues the corrected clock from the first beacon.
+ */
+void node_timebase_beacon(void);
+
+/** @brief Add the RTC as a sample, at most every NODE_TIMEBASE_RTC_PERIOD_S
+ *
+ *  Ignored while beacons are received. The RTC only counts seconds, so it
+ *  takes hours of samples to reach ppm accuracy.
+ */
+void node_timebase_rtc(void);
+
+/** @brief Corrected time
+ *
+ *  @returns corrected time since node_timebase_init(), or since the epoch
+ *           once the RTC was sampled, us
+ */
+uint64_t node_timebase_now_us(void);
+
+/** @brief Fitted drift of the microsecond ticker
+ *
+ *  @returns drift in ppb, positive if the ticker runs fast
+ */
+int32_t node_timebase_drift_ppb(void);
+
+/** @brief Half-width of a receive window for an event ahead
+ *
+ *  @param ahead_us time to the event
+ *  @returns half-width in us; 0xFFFFFFFF before three samples
+ */
+unsigned int node_timebase_window_us(uint64_t ahead_us);
+
+#endif
+
+#endif
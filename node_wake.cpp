@@ -0,0 +1,236 @@
+/**
+ * @file node_wake.cpp
+ *
+ * @brief Wake coalescing scheduler for periodic node tasks
+ *
+ * Waking at the earliest deadline plus tolerance and running all tasks due by
+ * then is the greedy solution to stabbing the tolerance intervals with the
+ * fewest points, so no other plan wakes less often. The thread sleeps in one
+ * Thread::wait() per wakeup, which gives the RTOS idle loop a single timer to
+ * program and the longest possible sleep.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef NODE_WAKE_HOST
+#include "mbed.h"
+#endif
+#include <string.h>
+#include "node_wake.h"
+
+#ifndef NODE_WAKE_STACK_SIZE
+#define NODE_WAKE_STACK_SIZE    OS_STACK_SIZE   ///< Sensor tasks print through NODE_DEBUG, which needs a large stack
+#endif
+
+uint64_t node_wake_window(const struct node_wake_task *tasks, int count)
+{
+    uint64_t window = NODE_WAKE_NEVER;
+
+    for (int i = 0; i < count; i++)
+    {
+        uint64_t latest = tasks[i].due_ms + tasks[i].tolerance_ms;
+        if (latest < window)
+            window = latest;
+    }
+    return window;
+}
+
+struct wake_sim_state
+{
+    uint64_t start;             ///< Awake interval being merged
+    uint64_t end;
+    bool open;
+    uint64_t awake;
+    uint64_t sleep;
+    uint64_t deep_sleep;
+    unsigned int wakeups;
+};
+
+static void wake_sim_gap(struct wake_sim_state *state, uint64_t gap)
+{
+    if (gap >= NODE_WAKE_DEEP_SLEEP_MIN_MS)
+        state->deep_sleep += gap;
+    else
+        state->sleep += gap;
+}
+
+/** @brief Add an awake interval; overlapping intervals are one wakeup */
+static void wake_sim_awake(struct wake_sim_state *state, uint64_t start, uint64_t end)
+{
+    if (state->open && start <= state->end)
+    {
+        if (end > state->end)
+            state->end = end;
+        return;
+    }
+
+    if (state->open)
+    {
+        state->awake += state->end - state->start;
+        wake_sim_gap(state, start - state->end);
+    }
+    else
+        wake_sim_gap(state, start);
+
+    state->start = start;
+    state->end = end;
+    state->open = true;
+    state->wakeups++;
+}
+
+void node_wake_simulate(const struct node_wake_task *tasks, int count, uint64_t duration_ms,
+                        unsigned int wake_ms, unsigned char coalesce, struct node_wake_sim *sim)
+{
+    struct node_wake_task plan[NODE_WAKE_TASKS];
+    struct wake_sim_state state;
+
+    memset(sim, 0, sizeof(*sim));
+    memset(&state, 0, sizeof(state));
+    if (count <= 0 || count > NODE_WAKE_TASKS || duration_ms == 0)
+        return;
+
+    memcpy(plan, tasks, count * sizeof(plan[0]));
+    for (int i = 0; i < count; i++)
+        plan[i].due_ms = plan[i].period_ms;
+
+    while (1)
+    {
+        uint64_t at = NODE_WAKE_NEVER;
+        uint64_t end;
+
+        if (coalesce)
+        {
+            at = node_wake_window(plan, count);
+            if (at >= duration_ms)
+                break;
+
+            end = at + wake_ms;
+            for (int i = 0; i < count; i++)
+            {
+                if (plan[i].due_ms <= at)
+                {
+                    end += plan[i].run_ms;
+                    while (plan[i].due_ms <= at)
+                        plan[i].due_ms += plan[i].period_ms;
+                }
+            }
+        }
+        else
+        {
+            int next = 0;
+
+            for (int i = 0; i < count; i++)
+            {
+                if (plan[i].due_ms < at)
+                {
+                    at = plan[i].due_ms;
+                    next = i;
+                }
+            }
+            if (at >= duration_ms)
+                break;
+
+            // The thread waits its period again after the run
+            end = at + wake_ms + plan[next].run_ms;
+            plan[next].due_ms = end + plan[next].period_ms;
+        }
+
+        wake_sim_awake(&state, at, (end < duration_ms) ? end : duration_ms);
+    }
+
+    if (state.open)
+    {
+        state.awake += state.end - state.start;
+        wake_sim_gap(&state, duration_ms - state.end);
+    }
+    else
+        wake_sim_gap(&state, duration_ms);
+
+    sim->wakeups = state.wakeups;
+    sim->wakeups_per_hour = (float)state.wakeups * 3600000 / duration_ms;
+    sim->awake = (float)state.awake / duration_ms;
+    sim->sleep = (float)state.sleep / duration_ms;
+    sim->deep_sleep = (float)state.deep_sleep / duration_ms;
+}
+
+#ifndef NODE_WAKE_HOST
+
+static struct node_wake_task wake_tasks[NODE_WAKE_TASKS];
+static int wake_task_count;
+static Thread *wake_thread;
+static volatile unsigned int wake_count;
+
+/** @brief Next deadline after now, on a multiple of the period */
+static uint64_t wake_align(uint64_t now, unsigned int period_ms)
+{
+    return (now / period_ms + 1) * period_ms;
+}
+
+static void wake_thread_main(void)
+{
+    uint64_t now = Kernel::get_ms_count();
+
+    for (int i = 0; i < wake_task_count; i++)
+        wake_tasks[i].due_ms = wake_align(now, wake_tasks[i].period_ms);
+
+    while (1)
+    {
+        uint64_t window = node_wake_window(wake_tasks, wake_task_count);
+
+        now = Kernel::get_ms_count();
+        if (window > now)
+            Thread::wait((uint32_t)(window - now));
+        wake_count++;
+
+        now = Kernel::get_ms_count();
+        for (int i = 0; i < wake_task_count; i++)
+        {
+            if (wake_tasks[i].due_ms <= now)
+            {
+                wake_tasks[i].fp();
+                wake_tasks[i].due_ms += wake_tasks[i].period_ms;
+            }
+        }
+
+        // Skip deadlines missed behind a slow task rather than running it back to back
+        now = Kernel::get_ms_count();
+        for (int i = 0; i < wake_task_count; i++)
+        {
+            if (wake_tasks[i].due_ms + wake_tasks[i].tolerance_ms < now)
+                wake_tasks[i].due_ms = wake_align(now, wake_tasks[i].period_ms);
+        }
+    }
+}
+
+int node_wake_add(unsigned int period_ms, unsigned int tolerance_ms, node_wake_fp fp)
+{
+    if (wake_thread)
+        return NODE_WAKE_ERR_NOT_READY;
+    if (period_ms == 0 || tolerance_ms >= period_ms || fp == NULL)
+        return NODE_WAKE_ERR_PARAM;
+    if (wake_task_count >= NODE_WAKE_TASKS)
+        return NODE_WAKE_ERR_FULL;
+
+    wake_tasks[wake_task_count].period_ms = period_ms;
+    wake_tasks[wake_task_count].tolerance_ms = tolerance_ms;
+    wake_tasks[wake_task_count].fp = fp;
+    return wake_task_count++;
+}
+
+int node_wake_start(void)
+{
+    if (wake_thread || wake_task_count == 0)
+        return NODE_WAKE_ERR_NOT_READY;
+
+    wake_thread = new Thread(osPriorityNormal, NODE_WAKE_STACK_SIZE);
+    if (wake_thread->start(callback(wake_thread_main)) != osOK)
+        return NODE_WAKE_ERR_NOT_READY;
+    return NODE_WAKE_OK;
+}
+
+unsigned int node_wake_count(void)
+{
+    return wake_count;
+}
+
+#endif
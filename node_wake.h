@@ -0,0 +1,112 @@
+/**
+ * @file node_wake.h
+ *
+ * @brief Wake coalescing scheduler for periodic node tasks
+ *
+ * Each task is due every period and may run up to its tolerance late. The
+ * scheduler wakes once at the latest time that is still within the tolerance
+ * of the earliest task, and runs every task due by then, so tasks with close
+ * deadlines share one wakeup instead of each keeping a thread and a timer.
+ * First deadlines are aligned to a multiple of the period, which keeps tasks
+ * with related periods in phase.
+ *
+ * All tasks run one after the other from the scheduler thread; a task that
+ * blocks delays the others.
+ *
+ * Built with NODE_WAKE_HOST defined, only the planning is compiled:
+ * node_wake_simulate() compares wakeups and sleep residency of a task set
+ * with and without coalescing on a PC, without the board.
+ *
+ * @author AdvanWISE
+ */
+
+#ifndef _NODE_WAKE_H_
+#define _NODE_WAKE_H_
+
+#include <stdint.h>
+
+#define NODE_WAKE_OK                 0    ///< Node wake Result: OK
+#define NODE_WAKE_ERR_FULL          -1    ///< Node wake Result: No free task slot
+#define NODE_WAKE_ERR_NOT_READY     -2    ///< Node wake Result: Already started, or thread could not start
+#define NODE_WAKE_ERR_PARAM         -3    ///< Node wake Result: Invalid parameter
+
+#ifndef NODE_WAKE_TASKS
+#define NODE_WAKE_TASKS             4     ///< Number of tasks that can be scheduled
+#endif
+
+#ifndef NODE_WAKE_DEEP_SLEEP_MIN_MS
+#define NODE_WAKE_DEEP_SLEEP_MIN_MS 10    ///< Shortest gap between wakeups that the simulation counts as deep sleep
+#endif
+
+#define NODE_WAKE_NEVER             (~(uint64_t)0)
+
+typedef void (*node_wake_fp)(void);
+
+struct node_wake_task
+{
+    unsigned int period_ms;     ///< Time between deadlines
+    unsigned int tolerance_ms;  ///< How late after its deadline the task may run
+    unsigned int run_ms;        ///< Time the task keeps the CPU awake; for the simulation
+    uint64_t due_ms;            ///< Next deadline
+    node_wake_fp fp;
+};
+
+struct node_wake_sim
+{
+    unsigned int wakeups;       ///< Wakeups in the simulated time
+    float wakeups_per_hour;
+    float awake;                ///< Share of the time awake
+    float sleep;                ///< Share of the time in gaps shorter than NODE_WAKE_DEEP_SLEEP_MIN_MS
+    float deep_sleep;           ///< Share of the time in longer gaps
+};
+
+/** @brief Time of the next wakeup
+ *
+ *  @param tasks tasks with their deadlines set
+ *  @param count number of tasks
+ *  @returns earliest deadline plus tolerance over the tasks; NODE_WAKE_NEVER without tasks
+ */
+uint64_t node_wake_window(const struct node_wake_task *tasks, int count);
+
+/** @brief Simulate a task set
+ *
+ *  Without coalescing, every task is modelled as a thread of its own that waits
+ *  its period after each run, as the sensor threads did. With coalescing, the
+ *  tasks are planned by node_wake_window().
+ *
+ *  @param tasks tasks; period_ms, tolerance_ms and run_ms are used
+ *  @param count number of tasks
+ *  @param duration_ms simulated time
+ *  @param wake_ms time every wakeup keeps the CPU awake besides the tasks
+ *  @param coalesce 1 to coalesce, 0 for a thread per task
+ *  @param sim result
+ */
+void node_wake_simulate(const struct node_wake_task *tasks, int count, uint64_t duration_ms,
+                        unsigned int wake_ms, unsigned char coalesce, struct node_wake_sim *sim);
+
+#ifndef NODE_WAKE_HOST
+
+/** @brief Add a periodic task; must be called before node_wake_start()
+ *
+ *  @param period_ms time between deadlines
+ *  @param tolerance_ms how late the task may run, less than the period
+ *  @param fp task
+ *  @returns task id on success; negative error on failure
+ */
+int node_wake_add(unsigned int period_ms, unsigned int tolerance_ms, node_wake_fp fp);
+
+/** @brief Start running the tasks, from a thread of their own
+ *
+ *  @returns NODE_WAKE_OK on success; negative error on failure
+ */
+int node_wake_start(void);
+
+/** @brief Number of times the scheduler woke up
+ *
+ *  @returns wakeups since node_wake_start()
+ */
+unsigned int node_wake_count(void);
+
+#endif
+
+#endif